@@ -0,0 +1,137 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+// Benchmark of checkpointing: execution time (ms per simulated second) of a network with plastic input synapses and
+// fixed recurrent synapses, without checkpoints and with a checkpoint at the end of every simulated second. The
+// checkpoints are written to a temporary directory by a background thread.
+//
+// usage: ./benchmark_checkpoint numNeurons simTimeSec randSeed results.csv
+// e.g. for n in 1000 10000 100000; do ./benchmark_checkpoint $n 10 42 checkpoint.csv; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include "benchmark_utils.h"
+
+#include <string>
+#include <vector>
+
+#include <algorithm>
+
+#define CHECKPOINT_DIR "results"
+
+// runs the network for simTimeSec seconds, and returns the time spent in runNetwork (ms)
+long int runNetwork(int numN, int simTimeSec, int randSeed, bool withCheckpoints) {
+	int numExc = numN * 8 / 10;
+	int numInh = numN * 2 / 10;
+	int numInput = numN;
+	float prob = std::min(1.0f, 100.0f / numN); // 100 synapses per neuron and projection
+
+	Stopwatch watch(false);
+	CARLsim sim("benchmark_checkpoint", CPU_MODE, SILENT, 0, randSeed);
+
+	int gExc = sim.createGroup("exc", numExc, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+	int gInh = sim.createGroup("inh", numInh, INHIBITORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+	int gInput = sim.createSpikeGeneratorGroup("input", numInput, EXCITATORY_NEURON, 0, CPU_CORES);
+
+	sim.connect(gInput, gExc, "random", RangeWeight(0.0f, 0.25f, 0.5f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_PLASTIC);
+	sim.connect(gExc, gExc, "random", RangeWeight(0.1f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gExc, gInh, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gInh, gExc, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+	sim.setConductances(true);
+	sim.setESTDP(gExc, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+
+	if (withCheckpoints)
+		sim.setCheckpoint(1, CHECKPOINT_DIR);
+
+	sim.setupNetwork();
+
+	PoissonRate in(numInput);
+	in.setRates(10.0f);
+	sim.setSpikeRate(gInput, &in);
+
+	watch.start();
+	sim.runNetwork(simTimeSec, 0, false);
+	watch.stop(false);
+
+	return watch.getLapTime(0);
+}
+
+int main(int argc, char* argv[]) {
+	int numN;
+	int simTimeSec;
+	int randSeed;
+	FILE* retFile;
+
+	if (argc != 5) return 1; // 4 input parameters are required
+
+	// setup benchmark parameters
+	numN = atoi(argv[1]);
+	simTimeSec = atoi(argv[2]);
+	randSeed = atoi(argv[3]);
+
+	retFile = fopen(argv[4], "a");
+	if (retFile == NULL) return 1;
+
+	char workDir[4096];
+	if (getcwd(workDir, sizeof(workDir)) == NULL) return 1;
+	std::string tempDir = enterTempDir("checkpoint");
+	if (tempDir.empty()) return 1;
+
+	long int plainMs = runNetwork(numN, simTimeSec, randSeed, false);
+	long int checkpointMs = runNetwork(numN, simTimeSec, randSeed, true);
+
+	float plainMsPerSec = (float)plainMs / simTimeSec;
+	float checkpointMsPerSec = (float)checkpointMs / simTimeSec;
+	fprintf(retFile, "%d,%d,%f,%f\n", numN, simTimeSec, plainMsPerSec, checkpointMsPerSec);
+	printf("neurons %d: %.1f ms per simulated second without checkpoints, %.1f ms with a checkpoint every second "
+		"(%+.1f%%)\n", numN, plainMsPerSec, checkpointMsPerSec, 100.0f * (checkpointMsPerSec / plainMsPerSec - 1.0f));
+	fclose(retFile);
+	leaveTempDir(tempDir, workDir);
+
+	return 0;
+}
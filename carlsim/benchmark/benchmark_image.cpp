@@ -0,0 +1,129 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+// Benchmark of network images: startup time (ms) of a network whose connections are generated, compared to the
+// same network loaded from a network image written by CARLsim::saveSimulation. The network consists of a randomly
+// connected excitatory-inhibitory population driven by Poisson input, so that the generation of the connections
+// dominates the time spent in setupNetwork.
+//
+// usage: ./benchmark_image numNeurons randSeed results.csv
+// e.g. for n in 1000 10000 100000; do ./benchmark_image $n 42 image.csv; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include <algorithm>
+
+#define IMAGE_FILE "results/benchmark_image.dat"
+
+// configures the network, and returns the time spent in setupNetwork (ms)
+long int setupNetwork(int numN, int randSeed, bool loadImage) {
+	int numExc = numN * 8 / 10;
+	int numInh = numN * 2 / 10;
+	int numInput = numN;
+	float prob = std::min(1.0f, 100.0f / numN); // 100 synapses per neuron and projection
+
+	Stopwatch watch(false);
+	CARLsim sim("benchmark_image", CPU_MODE, SILENT, 0, randSeed);
+
+	int gExc = sim.createGroup("exc", numExc, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+	int gInh = sim.createGroup("inh", numInh, INHIBITORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+	int gInput = sim.createSpikeGeneratorGroup("input", numInput, EXCITATORY_NEURON, 0, CPU_CORES);
+
+	sim.connect(gInput, gExc, "random", RangeWeight(0.0f, 0.25f, 0.5f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_PLASTIC);
+	sim.connect(gExc, gExc, "random", RangeWeight(0.1f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gExc, gInh, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gInh, gExc, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+	sim.setConductances(true);
+	sim.setESTDP(gExc, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+
+	FILE* fid = NULL;
+	if (loadImage) {
+		fid = fopen(IMAGE_FILE, "rb");
+		if (fid == NULL) return -1;
+		sim.loadSimulation(fid);
+	}
+
+	// build the network
+	watch.start();
+	sim.setupNetwork();
+	watch.stop(false);
+
+	if (loadImage)
+		fclose(fid);
+	else
+		sim.saveSimulation(IMAGE_FILE, true);
+
+	return watch.getLapTime(0);
+}
+
+int main(int argc, char* argv[]) {
+	int numN;
+	int randSeed;
+	FILE* retFile;
+
+	if (argc != 4) return 1; // 3 input parameters are required
+
+	// setup benchmark parameters
+	numN = atoi(argv[1]);
+	randSeed = atoi(argv[2]);
+
+	retFile = fopen(argv[3], "a");
+	if (retFile == NULL) return 1;
+
+	// generate the connections (and save the image), then load the image
+	long int generateMs = setupNetwork(numN, randSeed, false);
+	long int loadMs = setupNetwork(numN, randSeed, true);
+	if (loadMs < 0) return 1;
+
+	fprintf(retFile, "%d,%ld,%ld,%f\n", numN, generateMs, loadMs, (float)generateMs / std::max(loadMs, 1L));
+	printf("neurons %d: setup with generated connections %ld ms, setup from image %ld ms (%.1fx)\n",
+		numN, generateMs, loadMs, (float)generateMs / std::max(loadMs, 1L));
+	fclose(retFile);
+
+	return 0;
+}
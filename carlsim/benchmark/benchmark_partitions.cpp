@@ -0,0 +1,148 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+
+// Benchmark of the CPU runtime: wall-clock time per simulated second (ms) for a network that is split into a
+// number of CPU partitions. Every partition holds the same excitatory/inhibitory sub-network driven by Poisson
+// input, and neighboring partitions are sparsely coupled so that spikes also have to be routed between runtimes.
+//
+// usage: ./benchmark_partitions numPartitions numNeuronsPerPartition randSeed results.csv [numThreadsPerPartition]
+// e.g. for numPart in 1 4 8; do ./benchmark_partitions $numPart 1000 42 p.csv; done
+// e.g. for numThreads in 1 2 4; do ./benchmark_partitions 1 100000 42 t.csv $numThreads; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include <vector>
+#include <sstream>
+
+#define SIM_TIME_SEC 10
+
+int main(int argc, char* argv[]) {
+	int numPartitions, numN, numExc, numInh, numInput;
+	int randSeed;
+	int numThreads = 0; // automatic
+	float pConn;
+	FILE* retFile;
+
+	if (argc != 5 && argc != 6) return 1; // 4 input parameters are required, the number of threads is optional
+
+	// setup benchmark parameters
+	numPartitions = atoi(argv[1]);
+	numN = atoi(argv[2]);
+	numExc = numN * 8 / 10;
+	numInh = numN * 2 / 10;
+	numInput = numExc / 10;
+	pConn = 100.0f / numN; // connection probability
+
+	randSeed = atoi(argv[3]);
+
+	if (argc == 6)
+		numThreads = atoi(argv[5]);
+
+	retFile = fopen(argv[4], "a");
+	if (retFile == NULL) return 1;
+
+	// create CARLsim object
+	Stopwatch watch(false);
+	CARLsim sim("benchmark_partitions", CPU_MODE, SILENT, 0, randSeed);
+	sim.setNumThreadsPerPartition(numThreads);
+
+	// configure the network: one sub-network per CPU partition
+	watch.start();
+	std::vector<int> gExc(numPartitions), gInh(numPartitions), gInput(numPartitions);
+	for (int p = 0; p < numPartitions; p++) {
+		std::stringstream suffix;
+		suffix << p;
+
+		gExc[p] = sim.createGroup("exc" + suffix.str(), numExc, EXCITATORY_NEURON, p, CPU_CORES);
+		sim.setNeuronParameters(gExc[p], 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		gInh[p] = sim.createGroup("inh" + suffix.str(), numInh, INHIBITORY_NEURON, p, CPU_CORES);
+		sim.setNeuronParameters(gInh[p], 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+		gInput[p] = sim.createSpikeGeneratorGroup("input" + suffix.str(), numInput, EXCITATORY_NEURON, p, CPU_CORES);
+	}
+
+	for (int p = 0; p < numPartitions; p++) {
+		sim.connect(gInput[p], gExc[p], "random", RangeWeight(30.0f), pConn, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+		sim.connect(gExc[p], gExc[p], "random", RangeWeight(6.0f), pConn, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+		sim.connect(gExc[p], gInh[p], "random", RangeWeight(6.0f), pConn, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+		sim.connect(gInh[p], gExc[p], "random", RangeWeight(5.0f), pConn * 1.25f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		// sparse coupling to the neighboring partition (spikes are routed between runtimes)
+		if (numPartitions > 1)
+			sim.connect(gExc[p], gExc[(p + 1) % numPartitions], "random", RangeWeight(6.0f), pConn * 0.1f,
+				RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+	}
+
+	sim.setConductances(false);
+
+	// build the network
+	watch.lap();
+	sim.setupNetwork();
+
+	// setup some baseline input
+	std::vector<PoissonRate*> in(numPartitions);
+	for (int p = 0; p < numPartitions; p++) {
+		in[p] = new PoissonRate(numInput);
+		in[p]->setRates(5.0f);
+		sim.setSpikeRate(gInput[p], in[p]);
+	}
+
+	// run the network
+	watch.lap();
+	sim.runNetwork(SIM_TIME_SEC, 0);
+	watch.stop(false);
+
+	float msPerSimSec = (float)watch.getLapTime(2) / SIM_TIME_SEC;
+	fprintf(retFile, "%d,%d,%d,%ld,%ld,%ld,%f\n", numPartitions, numN, numThreads, watch.getLapTime(0),
+		watch.getLapTime(1), watch.getLapTime(2), msPerSimSec);
+	printf("partitions %d, neurons/partition %d, threads/partition %d: config %ld, setup %ld, run %ld, %.2f ms per simulated second\n",
+		numPartitions, numN, numThreads, watch.getLapTime(0), watch.getLapTime(1), watch.getLapTime(2), msPerSimSec);
+	fclose(retFile);
+
+	for (int p = 0; p < numPartitions; p++)
+		delete in[p];
+
+	return 0;
+}
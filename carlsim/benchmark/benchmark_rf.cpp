@@ -0,0 +1,98 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+// Benchmark of the network setup of a retinotopic network: time (ms) spent in setupNetwork for a 2D map of size x size
+// neurons, which projects to an excitatory map of the same size (Gaussian RF, radius 3) and to an inhibitory map of
+// half the size (full connections within a RF of radius 2). Every neuron has a few dozen synapses, independent of the
+// size of the map, so the time spent in finding the neurons within the RF dominates the setup of large maps.
+//
+// usage: ./benchmark_rf size randSeed results.csv
+// e.g. for s in 64 128 256; do ./benchmark_rf $s 42 rf.csv; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+int main(int argc, char* argv[]) {
+	int size;
+	int randSeed;
+	FILE* retFile;
+
+	if (argc != 4) return 1; // 3 input parameters are required
+
+	// setup benchmark parameters
+	size = atoi(argv[1]);
+	randSeed = atoi(argv[2]);
+
+	retFile = fopen(argv[3], "a");
+	if (retFile == NULL) return 1;
+
+	Stopwatch watch(false);
+	CARLsim sim("benchmark_rf", CPU_MODE, SILENT, 0, randSeed);
+
+	Grid3D gridMap(size, size, 1);
+	Grid3D gridInh(size / 2, 2.0f, 0.5f, size / 2, 2.0f, 0.5f, 1, 1.0f, 0.0f); // covers the same area as gridMap
+
+	int gInput = sim.createSpikeGeneratorGroup("input", gridMap, EXCITATORY_NEURON, 0, CPU_CORES);
+
+	int gExc = sim.createGroup("exc", gridMap, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+	int gInh = sim.createGroup("inh", gridInh, INHIBITORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+	sim.connect(gInput, gExc, "gaussian", RangeWeight(0.5f), 1.0f, RangeDelay(1, 5), RadiusRF(3, 3, 0), SYN_FIXED);
+	sim.connect(gExc, gInh, "full", RangeWeight(0.2f), 1.0f, RangeDelay(1), RadiusRF(2, 2, -1), SYN_FIXED);
+	sim.connect(gInh, gExc, "random", RangeWeight(0.2f), 0.5f, RangeDelay(1), RadiusRF(4, 4, -1), SYN_FIXED);
+
+	sim.setConductances(true);
+
+	// build the network
+	watch.start();
+	sim.setupNetwork();
+	watch.stop(false);
+
+	fprintf(retFile, "%d,%d,%d,%ld\n", size, size * size, sim.getNumSynapses(), watch.getLapTime(0));
+	printf("map %dx%d, synapses %d: setup %ld ms\n", size, size, sim.getNumSynapses(), watch.getLapTime(0));
+	fclose(retFile);
+
+	return 0;
+}
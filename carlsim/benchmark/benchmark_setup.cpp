@@ -0,0 +1,141 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+// Benchmark of the network setup: time (ms) spent in setupNetwork and peak memory (MB) of a randomly connected
+// excitatory-inhibitory population driven by Poisson input, with synPerNeuron (default: 100) synapses per neuron and
+// projection. The peak memory is the maximum resident set size of the process, which is reached while the
+// connections are generated and converted to the runtime layout. The connections are generated by numThreads threads
+// (0: all CPU cores, the default).
+//
+// The network of 1M neurons with 100 synapses per neuron and projection has 176M synapses and needs an estimated
+// 19 GB, of which 8 GB are the firing tables of the 2M neurons (NEURON_MAX_FIRING_RATE spikes per neuron, in the
+// runtime and in the manager). synPerNeuron scales the number of synapses down while the number of neurons stays the
+// same.
+//
+// usage: ./benchmark_setup numNeurons randSeed results.csv [numThreads] [synPerNeuron]
+// e.g. for t in 1 2 4 8; do ./benchmark_setup 1000000 42 setup.csv $t; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include <algorithm>
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+#include <sys/resource.h>
+#endif
+
+// returns the peak resident set size of the process (MB), or -1 if it is not available
+float getPeakMemoryMB() {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1.0f;
+#if defined(__APPLE__)
+	return usage.ru_maxrss / (1024.0f * 1024.0f); // bytes
+#else
+	return usage.ru_maxrss / 1024.0f; // kilobytes
+#endif
+#else
+	return -1.0f;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+	int numN;
+	int randSeed;
+	int numThreads = 0;
+	int synPerNeuron = 100;
+	FILE* retFile;
+
+	if (argc < 4 || argc > 6) return 1; // 3 input parameters are required, threads and synapses are optional
+
+	// setup benchmark parameters
+	numN = atoi(argv[1]);
+	randSeed = atoi(argv[2]);
+	if (argc >= 5)
+		numThreads = atoi(argv[4]);
+	if (argc >= 6)
+		synPerNeuron = atoi(argv[5]);
+
+	retFile = fopen(argv[3], "a");
+	if (retFile == NULL) return 1;
+
+	int numExc = numN * 8 / 10;
+	int numInh = numN * 2 / 10;
+	int numInput = numN;
+	float prob = std::min(1.0f, (float)synPerNeuron / numN);
+
+	Stopwatch watch(false);
+	CARLsim sim("benchmark_setup", CPU_MODE, SILENT, 0, randSeed);
+
+	int gExc = sim.createGroup("exc", numExc, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+	int gInh = sim.createGroup("inh", numInh, INHIBITORY_NEURON, 0, CPU_CORES);
+	sim.setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+	int gInput = sim.createSpikeGeneratorGroup("input", numInput, EXCITATORY_NEURON, 0, CPU_CORES);
+
+	sim.connect(gInput, gExc, "random", RangeWeight(0.0f, 0.25f, 0.5f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_PLASTIC);
+	sim.connect(gExc, gExc, "random", RangeWeight(0.1f), prob, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gExc, gInh, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+	sim.connect(gInh, gExc, "random", RangeWeight(0.2f), prob, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+	sim.setConductances(true);
+	sim.setESTDP(gExc, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+	sim.setNumConnectionThreads(numThreads);
+
+	// build the network
+	float configMB = getPeakMemoryMB();
+	watch.start();
+	sim.setupNetwork();
+	watch.stop(false);
+	float peakMB = getPeakMemoryMB();
+
+	fprintf(retFile, "%d,%d,%d,%d,%ld,%f\n", numN, numThreads, synPerNeuron, sim.getNumSynapses(), watch.getLapTime(0),
+		peakMB);
+	printf("neurons %d, threads %d, synapses %d: setup %ld ms, peak memory %.1f MB (%.1f MB before setup)\n", numN,
+		numThreads, sim.getNumSynapses(), watch.getLapTime(0), peakMB, configMB);
+	fclose(retFile);
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ */
+
+// Microbenchmark of the vectorized neuron kernels: number of neurons integrated per second of wall-clock time for
+// every SIMD level that is supported by the CPU. The kernels are called directly on a homogeneous population, so
+// the numbers do not include spike propagation or any other part of a simulation step.
+//
+// usage: ./benchmark_simd numNeurons numSteps randSeed results.csv
+// e.g. ./benchmark_simd 100000 1000 42 simd.csv
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+#include <neuron_simd.h>
+
+#include <vector>
+#include <cstdlib>
+
+// returns the number of neurons integrated per second
+static double measure(Stopwatch& watch, int numN, int numSteps) {
+	watch.stop(false);
+	uint64_t ms = watch.getLapTime(0);
+	return (double)numN * numSteps / (ms > 0 ? ms : 1) * 1000.0;
+}
+
+int main(int argc, char* argv[]) {
+	int numN, numSteps, randSeed;
+	FILE* retFile;
+
+	if (argc != 5) return 1; // 4 input parameters are required
+
+	numN = atoi(argv[1]);
+	numSteps = atoi(argv[2]);
+	randSeed = atoi(argv[3]);
+
+	retFile = fopen(argv[4], "a");
+	if (retFile == NULL) return 1;
+
+	// regular spiking neurons, driven by a current that lets most of them fire
+	IzhParams izh = {0.02f, 0.2f, -65.0f, 8.0f, 1.0f / 100.0f, 0.7f, -60.0f, -40.0f, 35.0f};
+	LIFParams lif = {10, 2, -50.0f, -65.0f, 1.0f, 0.0f};
+
+	std::vector<float> volt(numN), nextVolt(numN), recov(numN), current(numN), I_sum(numN);
+	std::vector<float> gAMPA(numN), gNMDA(numN), gGABAa(numN), gGABAb(numN);
+	std::vector<int> refCount(numN);
+	bool* curSpike = new bool[numN];
+
+	SimdLevel maxLevel = NeuronSimd::getSupportedLevel();
+	for (int level = SIMD_NONE; level <= maxLevel; level++) {
+		SimdLevel simd = (SimdLevel)level;
+		double rate[4];
+
+		for (int kernel = 0; kernel < 4; kernel++) {
+			srand48(randSeed);
+			for (int i = 0; i < numN; i++) {
+				volt[i] = -65.0f + 10.0f * (float)drand48();
+				recov[i] = 0.2f * volt[i];
+				current[i] = 20.0f * (float)drand48();
+				gAMPA[i] = (float)drand48();
+				gNMDA[i] = (float)drand48();
+				gGABAa[i] = (float)drand48();
+				gGABAb[i] = (float)drand48();
+				refCount[i] = 0;
+				curSpike[i] = false;
+			}
+
+			Stopwatch watch(false);
+			watch.start();
+			for (int t = 0; t < numSteps; t++) {
+				switch (kernel) {
+				case 0:
+					NeuronSimd::updateIzhikevich(simd, false, FORWARD_EULER, numN, izh, 0.5f, &volt[0], &nextVolt[0],
+						&recov[0], &current[0], curSpike);
+					break;
+				case 1:
+					NeuronSimd::updateIzhikevich(simd, true, RUNGE_KUTTA4, numN, izh, 0.5f, &volt[0], &nextVolt[0],
+						&recov[0], &current[0], curSpike);
+					break;
+				case 2:
+					NeuronSimd::updateLIF(simd, numN, lif, 0.5f, (t % 2) == 1, &volt[0], &nextVolt[0], &refCount[0],
+						&current[0], curSpike);
+					break;
+				default:
+					NeuronSimd::conductanceCurrent(simd, numN, &volt[0], &gAMPA[0], &gNMDA[0], NULL, &gGABAa[0],
+						&gGABAb[0], NULL, &I_sum[0]);
+					break;
+				}
+				volt.swap(nextVolt);
+			}
+			rate[kernel] = measure(watch, numN, numSteps);
+		}
+
+		fprintf(retFile, "%s,%d,%d,%f,%f,%f,%f\n", NeuronSimd::getLevelName(simd), numN, numSteps, rate[0], rate[1],
+			rate[2], rate[3]);
+		printf("%-7s (width %2d): izh4/euler %.3e, izh9/rk4 %.3e, lif %.3e, coba current %.3e neurons per second\n",
+			NeuronSimd::getLevelName(simd), NeuronSimd::getWidth(simd), rate[0], rate[1], rate[2], rate[3]);
+	}
+	fclose(retFile);
+
+	delete[] curSpike;
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+
+// Benchmark of STDP on the CPU runtime: wall-clock time per simulated second (ms) for a network in which every
+// synapse is plastic. Poisson input is fully connected to an excitatory group with E-STDP, and an inhibitory group
+// projects onto the same group with I-STDP, so that every pre- and post-synaptic spike evaluates the STDP curves
+// of thousands of synapses.
+//
+// usage: ./benchmark_stdp numNeurons inputRate randSeed results.csv
+// e.g. for rate in 10 20 40; do ./benchmark_stdp 1000 $rate 42 stdp.csv; done
+
+// include CARLsim user interface
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include "benchmark_utils.h"
+
+#include <string>
+#include <vector>
+
+#define SIM_TIME_SEC 10
+
+int main(int argc, char* argv[]) {
+	int numN, numExc, numInh, numInput;
+	int randSeed;
+	float inputRate;
+	FILE* retFile;
+
+	if (argc != 5) return 1; // 4 input parameters are required
+
+	// setup benchmark parameters
+	numN = atoi(argv[1]);
+	numExc = numN * 8 / 10;
+	numInh = numN * 2 / 10;
+	numInput = numN;
+	inputRate = (float)atof(argv[2]);
+
+	randSeed = atoi(argv[3]);
+
+	retFile = fopen(argv[4], "a");
+	if (retFile == NULL) return 1;
+
+	char workDir[4096];
+	if (getcwd(workDir, sizeof(workDir)) == NULL) return 1;
+	std::string tempDir = enterTempDir("stdp");
+	if (tempDir.empty()) return 1;
+
+	// create CARLsim object
+	Stopwatch watch(false);
+	CARLsim* sim = new CARLsim("benchmark_stdp", CPU_MODE, SILENT, 0, randSeed);
+
+	// configure the network
+	watch.start();
+	int gExc = sim->createGroup("exc", numExc, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+	int gInh = sim->createGroup("inh", numInh, INHIBITORY_NEURON, 0, CPU_CORES);
+	sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+	int gInput = sim->createSpikeGeneratorGroup("input", numInput, EXCITATORY_NEURON, 0, CPU_CORES);
+
+	sim->connect(gInput, gExc, "full", RangeWeight(0.0f, 200.0f / numInput, 400.0f / numInput), 1.0f, RangeDelay(1, 20),
+		RadiusRF(-1), SYN_PLASTIC);
+	sim->connect(gInput, gInh, "random", RangeWeight(400.0f / numInput), 0.5f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+	sim->connect(gInh, gExc, "full", RangeWeight(0.0f, 200.0f / numInh, 400.0f / numInh), 1.0f, RangeDelay(1),
+		RadiusRF(-1), SYN_PLASTIC);
+
+	sim->setConductances(false);
+	sim->setESTDP(gExc, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+	sim->setISTDP(gExc, true, STANDARD, ExpCurve(-1e-4f, 20.0f, 1e-4f, 20.0f));
+
+	// build the network
+	watch.lap();
+	sim->setupNetwork();
+
+	PoissonRate in(numInput);
+	in.setRates(inputRate);
+	sim->setSpikeRate(gInput, &in);
+
+	// run the network
+	watch.lap();
+	sim->runNetwork(SIM_TIME_SEC, 0);
+	watch.stop(false);
+
+	float msPerSimSec = (float)watch.getLapTime(2) / SIM_TIME_SEC;
+	fprintf(retFile, "%d,%f,%ld,%ld,%ld,%f\n", numN, inputRate, watch.getLapTime(0), watch.getLapTime(1),
+		watch.getLapTime(2), msPerSimSec);
+	printf("neurons %d, input rate %.1f Hz: config %ld, setup %ld, run %ld, %.2f ms per simulated second\n",
+		numN, inputRate, watch.getLapTime(0), watch.getLapTime(1), watch.getLapTime(2), msPerSimSec);
+	fclose(retFile);
+	delete sim;
+	leaveTempDir(tempDir, workDir);
+
+	return 0;
+}
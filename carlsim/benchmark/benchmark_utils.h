@@ -0,0 +1,77 @@
+/* * Copyright (c) 2015 Regents of the University of California. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. The names of its contributors may not be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * *********************************************************************************************** *
+ * CARLsim
+ * created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+ * maintained by:
+ * (MA) Mike Avery <averym@uci.edu>
+ * (MB) Michael Beyeler <mbeyeler@uci.edu>,
+ * (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+ * (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+ *
+ * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+ * Ver 10/17/2026
+ */
+// Helpers shared by the benchmarks.
+#ifndef _BENCHMARK_UTILS_H_
+#define _BENCHMARK_UTILS_H_
+
+#include <ftw.h>		// nftw
+#include <unistd.h>		// chdir, getcwd
+#include <stdio.h>		// remove
+#include <stdlib.h>		// getenv, mkdtemp
+#include <string>
+#include <vector>
+
+// the files a benchmark writes (log file, default save file, checkpoints) go to a temporary working directory outside
+// the source tree, which is removed at the end of the benchmark
+static int removeTempDirEntry(const char* path, const struct stat* sb, int typeflag, struct FTW* ftwbuf) {
+	return remove(path);
+}
+
+// creates the directory $TMPDIR/benchmark_<name>_XXXXXX and makes it the working directory, returns its path or an
+// empty string on failure
+static std::string enterTempDir(const std::string& name) {
+	const char* tmpDir = getenv("TMPDIR");
+	std::string templ = std::string(tmpDir != NULL ? tmpDir : "/tmp") + "/benchmark_" + name + "_XXXXXX";
+	std::vector<char> dirName(templ.begin(), templ.end());
+	dirName.push_back('\0');
+	if (mkdtemp(&dirName[0]) == NULL || chdir(&dirName[0]) != 0)
+		return "";
+	return std::string(&dirName[0]);
+}
+
+// changes back to workDir and removes the directory created by enterTempDir with everything in it
+static void leaveTempDir(const std::string& dirName, const std::string& workDir) {
+	if (chdir(workDir.c_str()) == 0)
+		nftw(dirName.c_str(), removeTempDirEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+#endif
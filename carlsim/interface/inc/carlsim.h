@@ -240,12 +240,22 @@ public:
 	 *                       excitatory, and GABAa in the case of inhibitory connections). Default: 1.0
 	 * \param[in] mulSynSlow a multiplication factor to be applied to the slow synaptic current (NMDA in the case of
 	 *                       excitatory, and GABAb in the case of inhibitory connections). Default: 1.0
+	 * \param[in] wtPrecision the precision in which a CPU runtime stores the weights of the connection (WT_FP32,
+	 *                       WT_FP16, WT_BF16, or WT_INT8). Reduced precision saves memory at the cost of rounding every
+	 *                       weight (and every weight update) to the nearest representable value. WT_INT8 stores 255
+	 *                       levels between -s and s, where s is the largest weight magnitude of the connection. The
+	 *                       weight change of plastic synapses is always kept in 32-bit floating point. If the
+	 *                       connections of a runtime use different precisions, the WT_FP32 weights are kept in 32 bits
+	 *                       and all others in the widest reduced precision of the runtime (16 bits if any of them is
+	 *                       WT_FP16 or WT_BF16), at an extra 1.5 bits per synapse for indexing. GPU runtimes ignore the
+	 *                       setting. Default: WT_FP32
 	 * \returns a unique ID associated with the newly created connection
 	 * \see ch4s1_primitive_types
+	 * \see WeightPrecision
 	 */
 	short int connect(int grpId1, int grpId2, const std::string& connType, const RangeWeight& wt, float connProb,
 		const RangeDelay& delay=RangeDelay(1), const RadiusRF& radRF=RadiusRF(-1.0), bool synWtType=SYN_FIXED,
-		float mulSynFast=1.0f, float mulSynSlow=1.0f);
+		float mulSynFast=1.0f, float mulSynSlow=1.0f, WeightPrecision wtPrecision=WT_FP32);
 
 	/*!
 	 * \brief Shortcut to make connections with custom connectivity profile but omit scaling factors for synaptic
@@ -254,7 +264,8 @@ public:
 	 * \STATE ::CONFIG_STATE
 	 * \see ch4s3_user_defined
 	 */
-	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType=SYN_FIXED);
+	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType=SYN_FIXED,
+		WeightPrecision wtPrecision=WT_FP32);
 
 	/*!
 	 * \brief make connections with custom connectivity profile
@@ -263,7 +274,7 @@ public:
 	 * \see ch4s3_user_defined
 	 */
 	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, float mulSynFast, float mulSynSlow,
-						bool synWtType=SYN_FIXED);
+						bool synWtType=SYN_FIXED, WeightPrecision wtPrecision=WT_FP32);
 
 	/*!
 	* \brief make a compartmental connection between two compartmentally enabled groups
@@ -498,6 +509,76 @@ public:
 	*/
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	/*!
+	 * \brief Sets the number of worker threads of each CPU partition
+	 *
+	 * In CPU mode, the neuron loops of a partition (integration and spike detection) can be split into contiguous
+	 * neuron ranges that are processed by several worker threads in parallel. Spike counts and the order of spikes do
+	 * not depend on the number of threads.
+	 *
+	 * By default (<tt>numThreads</tt>=0), the available CPU cores are shared evenly among the CPU partitions, and
+	 * partitions with fewer than 2048 neurons per thread are not split. This setting has no effect on Windows and on
+	 * GPU partitions.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] numThreads the number of threads per CPU partition, or 0 to choose it automatically
+	 * \since v4.0
+	 */
+	void setNumThreadsPerPartition(int numThreads);
+
+	/*!
+	 * \brief Sets the number of CPU partitions for groups without a preferred partition
+	 *
+	 * In CPU_MODE and HYBRID_MODE, groups created with <tt>preferredPartition</tt>=ANY are distributed among the CPU
+	 * partitions 0, ..., numPartitions-1 by a load-balancing partitioner. The partitioner estimates the cost of every
+	 * group from its number of neurons, neuron model and incoming synapses, keeps the load of the partitions balanced,
+	 * and places groups that exchange many spikes on the same partition. Groups with a preferred partition are not
+	 * moved, but count towards the load of their partition.
+	 *
+	 * By default, all these groups are placed on a single partition, so that the partitioning (and thus a network image
+	 * saved with saveSimulation) does not depend on the machine. With <tt>numPartitions</tt>=0, one partition per
+	 * available CPU core is used (or per setNumThreadsPerPartition cores), and small networks are not split; a network
+	 * image saved this way can only be loaded on a machine with the same number of cores. The predicted and measured
+	 * load of every partition are printed in the simulation summary.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] numPartitions the number of CPU partitions, or 0 to choose it automatically
+	 * \since v4.0
+	 */
+	void setNumCPUPartitions(int numPartitions);
+
+	/*!
+	 * \brief Sets the number of threads that generate the connections in setupNetwork
+	 *
+	 * Random, full and gaussian connections are split into ranges of pre-synaptic neurons, which are generated by
+	 * several threads in parallel. The random numbers of a synapse only depend on the random seed, the connection and
+	 * the pre- and post-synaptic neuron, so the generated network does not depend on the number of threads.
+	 * One-to-one and user-defined connections are always generated by the calling thread.
+	 *
+	 * By default (<tt>numThreads</tt>=0), one thread per available CPU core is used. This setting has no effect on
+	 * Windows.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] numThreads the number of threads, or 0 to use all CPU cores
+	 * \since v4.0
+	 */
+	void setNumConnectionThreads(int numThreads);
+
+	/*!
+	 * \brief Sets whether CPU partitions evaluate STDP from per-neuron spike traces
+	 *
+	 * By default, CPU partitions store the arrival time of the last pre-synaptic spike of every plastic synapse. With
+	 * STDP traces, every neuron instead keeps the times of its recent spikes, and the arrival time of a synapse is
+	 * derived from the spikes of its pre-synaptic neuron and its axonal delay when the post-synaptic neuron fires. This
+	 * saves 4 bytes per plastic synapse and a memory write per delivered spike. Weight changes follow the same
+	 * nearest-spike rules for all STDP curves. This setting has no effect on GPU partitions.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] isSet whether to use STDP traces (default: false)
+	 * \since v4.0
+	 */
+	void setSTDPTraces(bool isSet);
+
 	/*!
 	 * \brief Sets Izhikevich params a, b, c, and d with as mean +- standard deviation
 	 *
@@ -794,6 +875,22 @@ public:
 	 */
 	void setWeightAndWeightChangeUpdate(UpdateInterval wtANDwtChangeUpdateInterval, bool enableWtChangeDecay, float wtChangeDecay=0.9f);
 
+	/*!
+	 * \brief Sets whether CPU partitions update only the weights of neurons with recent STDP activity
+	 *
+	 * By default, every weight update (see CARLsim::setWeightAndWeightChangeUpdate) visits all plastic synapses. With
+	 * sparse weight updates, a CPU partition marks the post-synaptic neurons whose weight changes were modified since
+	 * the last update and only visits their synapses. The decay of the remaining weight changes (if enabled) of all
+	 * other neurons is applied in one step when a neuron becomes active again or when the weights are read.
+	 * Groups with homeostasis or dopamine-modulated STDP are always updated in full. This setting has no effect on
+	 * GPU partitions.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] isSet whether to use sparse weight updates (default: false)
+	 * \since v4.0
+	 */
+	void setSparseWeightUpdate(bool isSet);
+
 
 	// +++++ PUBLIC METHODS: RUNNING A SIMULATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
@@ -831,6 +928,12 @@ public:
 	 * default which causes the synaptic weight values to be output by default along with the rest of the
 	 * network information.
 	 *
+	 * The file is a versioned binary network image: a header and tables describing the groups, connections, and
+	 * local networks, followed by the connectivity arrays of every local network (synapse counts, pre- and
+	 * post-synaptic ids, delays, weights) and the membrane potential and recovery variable of every neuron. Each
+	 * table and array starts at a 64-byte boundary, so that CARLsim::loadSimulation can map the file into memory and
+	 * copy the arrays directly. The image uses the byte order of the machine it was saved on.
+	 *
 	 * \STATE ::SETUP_STATE, ::RUN_STATE
 	 * \param[in] fileName          string of filename of saved simulation data.
 	 * \param[in] saveSynapseInfo   boolean value that determines if the weight values are written to
@@ -840,6 +943,31 @@ public:
 	 */
 	void saveSimulation(const std::string& fileName, bool saveSynapseInfo=true);
 
+	/*!
+	 * \brief Writes a checkpoint of the simulation state every intervalSec seconds of simulated time
+	 *
+	 * A checkpoint contains the mutable state of the simulation: the neuron state (membrane potential, recovery
+	 * variable, currents, and conductances), the STP buffers, the synaptic weights and weight changes, the firing and
+	 * time tables, the spike schedule of Poisson neurons, and the simulation time (which also determines the state of
+	 * the random number generators). Checkpoints are taken during CARLsim::runNetwork, at the end of every
+	 * intervalSec-th second. The state is copied into a staging buffer and written to the directory by a background
+	 * thread, so that the simulation continues while the checkpoint is written. Only the parts of the state that
+	 * changed since the last checkpoint in the same data file are written, so that fixed weights cost little after the
+	 * first checkpoints.
+	 *
+	 * The directory holds the manifest <tt>checkpoint.hdr</tt> and two data files, which are used alternately, so
+	 * that a crash while a checkpoint is written leaves the previous checkpoint intact. Use CARLsim::loadCheckpoint to
+	 * resume a simulation from the last complete checkpoint.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] intervalSec interval between two checkpoints (seconds of simulated time)
+	 * \param[in] dirName     existing directory the checkpoints are written to
+	 * \note Checkpoints are only supported on CPU runtimes.
+	 * \see CARLsim::loadCheckpoint
+	 * \since v4.0
+	 */
+	void setCheckpoint(int intervalSec, const std::string& dirName);
+
 	/*!
 	 * \brief Sets the name of the log file
 	 *
@@ -912,6 +1040,11 @@ public:
 	 * as was used to store the network via CARLsim::saveSimulation, and then calling CARLsim::loadSimulation to
 	 * overwrite all corresponding synaptic weight and delay values from file.
 	 *
+	 * The image is read during CARLsim::setupNetwork, which then skips the generation of the connections: the
+	 * connectivity, weights, delays, and neuron state are copied from the image instead (no ConnectionGenerator
+	 * callbacks are invoked). The configured network is checked against the image, and any mismatch (e.g., in the
+	 * number of neurons, group names, connection types, or the partitioning into local networks) is an error.
+	 *
 	 * \STATE ::CONFIG_STATE
 	 * \param[in] fid       file pointer to a save file created with CARLsim::saveSimulation
 	 *
@@ -925,6 +1058,23 @@ public:
 	 */
 	void loadSimulation(FILE* fid);
 
+	/*!
+	 * \brief Restores the simulation state from the last checkpoint in a directory
+	 *
+	 * Set up the same network (same groups, connections, random seed, and number of CPU runtimes) that wrote the
+	 * checkpoint with CARLsim::setCheckpoint, call CARLsim::setupNetwork, and then CARLsim::loadCheckpoint. The
+	 * simulation time and state are restored, so that the next call to CARLsim::runNetwork continues the simulation
+	 * where the checkpoint was taken, and produces the same spikes as the original simulation.
+	 *
+	 * \STATE ::SETUP_STATE
+	 * \param[in] dirName directory that holds the checkpoint
+	 * \note Call CARLsim::setSpikeRate before CARLsim::loadCheckpoint, the spike schedule of the Poisson neurons is
+	 * restored from the checkpoint. The state of monitors and SpikeGenerator callbacks is not part of a checkpoint.
+	 * \see CARLsim::setCheckpoint
+	 * \since v4.0
+	 */
+	void loadCheckpoint(const std::string& dirName);
+
 	/*!
 	 * \brief reset Spike Counter to zero
 	 *
@@ -1590,6 +1740,16 @@ public:
 	 */
 	int getGroupNumNeurons(int grpId);
 
+	/*!
+	 * \brief returns the partition a group specified by grpId has been assigned to
+	 *
+	 * This is either the preferred partition of the group (see createGroup), or the partition chosen by the
+	 * partitioner for groups with <tt>preferredPartition</tt>=ANY (see setNumCPUPartitions).
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \since v4.0
+	 */
+	int getGroupPartition(int grpId);
+
 	/*!
 	 * \brief returns the stdp information of a group specified by grpId
 	 *
@@ -243,6 +243,25 @@ static const char* updateInterval_string[] = {
 	"10 ms interval", "100 ms interval", "1000 ms interval"
 };
 
+/*!
+ * \brief Storage precision of synaptic weights
+ *
+ * CPU runtimes can store the weights of a connection in reduced precision to save memory
+ * WT_FP32: 32-bit floating point (default)
+ * WT_FP16: 16-bit IEEE half precision floating point (11 significant bits, weights up to 65504)
+ * WT_BF16: 16-bit bfloat16 floating point (8 significant bits, same range as 32-bit floating point)
+ * WT_INT8: 8-bit integer times a per-connection scale (255 levels in [-maxWt, maxWt])
+ */
+enum WeightPrecision {
+	WT_FP32,		//!< 32-bit floating point
+	WT_FP16,		//!< 16-bit IEEE half precision floating point
+	WT_BF16,		//!< 16-bit bfloat16 floating point
+	WT_INT8			//!< 8-bit integer with a per-connection scale
+};
+static const char* weightPrecision_string[] = {
+	"fp32", "fp16", "bfloat16", "int8"
+};
+
 /*!
  * \brief CARLsim states
  *
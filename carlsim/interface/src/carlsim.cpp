@@ -129,7 +129,8 @@ public:
 
 	// Connects a presynaptic to a postsynaptic group using one of the primitive types
 	short int connect(int grpId1, int grpId2, const std::string& connType, const RangeWeight& wt, float connProb,
-			const RangeDelay& delay, const RadiusRF& radRF, bool synWtType, float mulSynFast, float mulSynSlow)
+			const RangeDelay& delay, const RadiusRF& radRF, bool synWtType, float mulSynFast, float mulSynSlow,
+			WeightPrecision wtPrecision)
 	{
 		std::string funcName = "connect(\""+getGroupName(grpId1)+"\",\""+getGroupName(grpId2)+"\")";
 		std::stringstream grpId1str; grpId1str << "Group Id " << grpId1;
@@ -154,6 +155,8 @@ public:
 			UserErrors::MUST_BE_IDENTICAL, funcName, "For fixed synapses, initWt and maxWt");
 		UserErrors::assertTrue(mulSynFast>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynFast");
 		UserErrors::assertTrue(mulSynSlow>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynSlow");
+		UserErrors::assertTrue(wtPrecision>=WT_FP32 && wtPrecision<=WT_INT8, UserErrors::MUST_BE_IN_RANGE, funcName,
+			"wtPrecision", "[WT_FP32,WT_INT8]");
 
 		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
 			"CONFIG.");
@@ -183,11 +186,11 @@ public:
 		connSyn_[grpId1].push_back(grpId2);
 
 		return snn_->connect(grpId1, grpId2, connType, wt.init, wt.max, connProb, delay.min, delay.max,
-			radRF, mulSynFast, mulSynSlow, synWtType);
+			radRF, mulSynFast, mulSynSlow, synWtType, wtPrecision);
 	}
 
 	// custom connectivity profile
-	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType) {
+	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType, WeightPrecision wtPrecision) {
 		std::string funcName = "connect(\""+getGroupName(grpId1)+"\",\""+getGroupName(grpId2)+"\")";
 		std::stringstream grpId1str; grpId1str << ". Group Id " << grpId1;
 		std::stringstream grpId2str; grpId2str << ". Group Id " << grpId2;
@@ -196,6 +199,8 @@ public:
 		UserErrors::assertTrue(!isPoissonGroup(grpId2), UserErrors::WRONG_NEURON_TYPE, funcName, grpId2str.str() +
 			" is PoissonGroup, connect");
 		UserErrors::assertTrue(conn!=NULL, UserErrors::CANNOT_BE_NULL, funcName, "ConnectionGenerator* conn");
+		UserErrors::assertTrue(wtPrecision>=WT_FP32 && wtPrecision<=WT_INT8, UserErrors::MUST_BE_IN_RANGE, funcName,
+			"wtPrecision", "[WT_FP32,WT_INT8]");
 
 		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG.");
 		assert(++numConnections_ <= MAX_CONN_PER_SNN);
@@ -215,12 +220,12 @@ public:
 		// ConnectionGeneratorCore* CGC = new ConnectionGeneratorCore(this, conn);
 		ConnectionGeneratorCore* CGC = new ConnectionGeneratorCore(sim_, conn);
 		connGen_.push_back(CGC);
-		return snn_->connect(grpId1, grpId2, CGC, 1.0f, 1.0f, synWtType);
+		return snn_->connect(grpId1, grpId2, CGC, 1.0f, 1.0f, synWtType, wtPrecision);
 	}
 
 	// custom connectivity profile
 	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, float mulSynFast, float mulSynSlow,
-		bool synWtType)
+		bool synWtType, WeightPrecision wtPrecision)
 	{
 		std::string funcName = "connect(\""+getGroupName(grpId1)+"\",\""+getGroupName(grpId2)+"\")";
 		std::stringstream grpId1str; grpId1str << ". Group Id " << grpId1;
@@ -232,6 +237,8 @@ public:
 		UserErrors::assertTrue(conn!=NULL, UserErrors::CANNOT_BE_NULL, funcName);
 		UserErrors::assertTrue(mulSynFast>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynFast");
 		UserErrors::assertTrue(mulSynSlow>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynSlow");
+		UserErrors::assertTrue(wtPrecision>=WT_FP32 && wtPrecision<=WT_INT8, UserErrors::MUST_BE_IN_RANGE, funcName,
+			"wtPrecision", "[WT_FP32,WT_INT8]");
 		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, 
 			funcName, "CONFIG.");
 		assert(++numConnections_ <= MAX_CONN_PER_SNN);
@@ -250,7 +257,7 @@ public:
 		// ConnectionGeneratorCore* CGC = new ConnectionGeneratorCore(this, conn);
 		ConnectionGeneratorCore* CGC = new ConnectionGeneratorCore(sim_, conn);
 		connGen_.push_back(CGC);
-		return snn_->connect(grpId1, grpId2, CGC, mulSynFast, mulSynSlow, synWtType);
+		return snn_->connect(grpId1, grpId2, CGC, mulSynFast, mulSynSlow, synWtType, wtPrecision);
 	}
 
 	short int connectCompartments(int grpIdLower, int grpIdUpper) {
@@ -558,6 +565,46 @@ public:
 		//std::cout << "numStepsPerMs is (in interface): " + numStepsPerMs << std::endl;
 	}
 
+	// sets the number of worker threads per CPU partition
+	void setNumThreadsPerPartition(int numThreads) {
+		std::string funcName = "setNumThreadsPerPartition()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numThreads >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "numThreads");
+
+		snn_->setNumThreadsPerPartition(numThreads);
+	}
+
+	// sets the number of CPU partitions for groups without preferred partition
+	void setNumCPUPartitions(int numPartitions) {
+		std::string funcName = "setNumCPUPartitions()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numPartitions >= 0 && numPartitions <= MAX_NET_PER_SNN - CPU_RUNTIME_BASE,
+			UserErrors::MUST_BE_IN_RANGE, funcName, "numPartitions", "[0, number of CPU runtimes]");
+
+		snn_->setNumCPUPartitions(numPartitions);
+	}
+
+	// sets the number of threads that generate the connections in setupNetwork
+	void setNumConnectionThreads(int numThreads) {
+		std::string funcName = "setNumConnectionThreads()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numThreads >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "numThreads");
+
+		snn_->setNumConnectionThreads(numThreads);
+	}
+
+	// sets whether CPU partitions evaluate STDP from per-neuron spike traces
+	void setSTDPTraces(bool isSet) {
+		std::string funcName = "setSTDPTraces()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setSTDPTraces(isSet);
+	}
+
 	// set neuron parameters for Izhikevich neuron, with standard deviations
 	void setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -839,6 +886,15 @@ public:
 		snn_->setWeightAndWeightChangeUpdate(wtANDwtChangeUpdateInterval, enableWtChangeDecay, wtChangeDecay);
 	}
 
+	// sets whether CPU partitions update only the weights of neurons with recent STDP activity
+	void setSparseWeightUpdate(bool isSet) {
+		std::string funcName = "setSparseWeightUpdate()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setSparseWeightUpdate(isSet);
+	}
+
 
 	// +++++++++ PUBLIC METHODS: RUNNING A SIMULATION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
@@ -894,6 +950,22 @@ public:
 		fclose(fpSave);
 	}
 
+	void setCheckpoint(int intervalSec, const std::string& dirName) {
+		std::stringstream funcName; funcName << "setCheckpoint(" << intervalSec << "," << dirName << ")";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "CONFIG or SETUP.");
+		UserErrors::assertTrue(intervalSec > 0, UserErrors::MUST_BE_POSITIVE, funcName.str(), "intervalSec");
+
+		// make sure the directory exists and is writable
+		std::string probeName = dirName + "/checkpoint.probe";
+		FILE* fpProbe = fopen(probeName.c_str(), "wb");
+		UserErrors::assertTrue(fpProbe != NULL, UserErrors::FILE_CANNOT_OPEN, funcName.str(), probeName);
+		fclose(fpProbe);
+		remove(probeName.c_str());
+
+		snn_->setCheckpoint(intervalSec, dirName);
+	}
+
 	void setLogFile(const std::string& fileName) {
 		std::string funcName = "setLogFile("+fileName+")";
 		UserErrors::assertTrue(loggerMode_!=CUSTOM,UserErrors::CANNOT_BE_SET_TO, funcName, "Logger mode", "CUSTOM");
@@ -957,10 +1029,20 @@ public:
 		std::string funcName = "loadSimulation()";
 		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, 
 			funcName, "CONFIG.");
+		UserErrors::assertTrue(fid!=NULL, UserErrors::CANNOT_BE_NULL, funcName, "fid");
 
 		snn_->loadSimulation(fid);
 	}
 
+	// restores the simulation state from the last checkpoint in a directory
+	void loadCheckpoint(const std::string& dirName) {
+		std::string funcName = "loadCheckpoint(" + dirName + ")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+			funcName, "SETUP.");
+
+		snn_->loadCheckpoint(dirName);
+	}
+
 	// scales the weight of every synapse in the connection with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange) {
 		std::stringstream funcName;	funcName << "scaleWeights(" << connId << "," << scale << "," << updateWeightRange
@@ -1305,6 +1387,16 @@ public:
 		return snn_->getGroupNumNeurons(grpId);
 	}
 
+	int getGroupPartition(int grpId) {
+		std::stringstream funcName; funcName << "getGroupPartition(" << grpId << ")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+		UserErrors::assertTrue(grpId>=0 && grpId<getNumGroups(), UserErrors::MUST_BE_IN_RANGE, funcName.str(), "grpId",
+			"[0,getNumGroups()]");
+
+		return snn_->getGroupPartition(grpId);
+	}
+
 	Point3D getNeuronLocation3D(int neurId) {
 		std::stringstream funcName;	funcName << "getNeuronLocation3D(" << neurId << ")";
 		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
@@ -1737,19 +1829,22 @@ CARLsim::~CARLsim() { delete _impl; }
 
 // connect with primitive type
 short int CARLsim::connect(int grpId1, int grpId2, const std::string& connType, const RangeWeight& wt, float connProb,
-		const RangeDelay& delay, const RadiusRF& radRF, bool synWtType, float mulSynFast, float mulSynSlow) {
-	return _impl->connect(grpId1, grpId2, connType, wt, connProb, delay, radRF, synWtType, mulSynFast, mulSynSlow);
+		const RangeDelay& delay, const RadiusRF& radRF, bool synWtType, float mulSynFast, float mulSynSlow,
+		WeightPrecision wtPrecision) {
+	return _impl->connect(grpId1, grpId2, connType, wt, connProb, delay, radRF, synWtType, mulSynFast, mulSynSlow,
+		wtPrecision);
 }
 
 // connect with custom ConnectionGenerator (short)
 // TODO: don't need two versions of this... make it (grpId1, grpId2, conn, synWtType, mulSynFast, mulSynSlow)
-short int CARLsim::connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType) {
-	return _impl->connect(grpId1, grpId2, conn, synWtType);
+short int CARLsim::connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType,
+	WeightPrecision wtPrecision) {
+	return _impl->connect(grpId1, grpId2, conn, synWtType, wtPrecision);
 }
 short int CARLsim::connect(int grpId1, int grpId2, ConnectionGenerator* conn, float mulSynFast, float mulSynSlow, 
-	bool synWtType)
+	bool synWtType, WeightPrecision wtPrecision)
 {
-	return _impl->connect(grpId1, grpId2, conn, mulSynFast, mulSynSlow, synWtType);
+	return _impl->connect(grpId1, grpId2, conn, mulSynFast, mulSynSlow, synWtType, wtPrecision);
 }
 
 short int CARLsim::connectCompartments(int grpIdLower, int grpIdUpper) {
@@ -1811,6 +1906,22 @@ void CARLsim::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs
 	_impl->setIntegrationMethod(method, numStepsPerMs);
 }
 
+void CARLsim::setNumThreadsPerPartition(int numThreads) {
+	_impl->setNumThreadsPerPartition(numThreads);
+}
+
+void CARLsim::setNumCPUPartitions(int numPartitions) {
+	_impl->setNumCPUPartitions(numPartitions);
+}
+
+void CARLsim::setNumConnectionThreads(int numThreads) {
+	_impl->setNumConnectionThreads(numThreads);
+}
+
+void CARLsim::setSTDPTraces(bool isSet) {
+	_impl->setSTDPTraces(isSet);
+}
+
 // set neuron params
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd, float izh_c, 
 	float izh_c_sd, float izh_d, float izh_d_sd)
@@ -1904,6 +2015,10 @@ void CARLsim::setWeightAndWeightChangeUpdate(UpdateInterval wtANDwtChangeUpdateI
 	_impl->setWeightAndWeightChangeUpdate(wtANDwtChangeUpdateInterval, enableWtChangeDecay, wtChangeDecay);
 }
 
+void CARLsim::setSparseWeightUpdate(bool isSet) {
+	_impl->setSparseWeightUpdate(isSet);
+}
+
 
 // run the simulation for time=(nSec*seconds + nMsec*milliseconds)
 int CARLsim::runNetwork(int nSec, int nMsec, bool printRunSummary) {
@@ -1923,6 +2038,9 @@ void CARLsim::saveSimulation(const std::string& fileName, bool saveSynapseInfo)
 	_impl->saveSimulation(fileName, saveSynapseInfo);
 }
 
+// Writes a checkpoint of the simulation state every intervalSec seconds
+void CARLsim::setCheckpoint(int intervalSec, const std::string& dirName) { _impl->setCheckpoint(intervalSec, dirName); }
+
 // Sets the name of the log file
 void CARLsim::setLogFile(const std::string& fileName) { _impl->setLogFile(fileName); }
 
@@ -1940,6 +2058,9 @@ void CARLsim::biasWeights(short int connId, float bias, bool updateWeightRange)
 // Loads a simulation (and network state) from file. The file pointer fid must point to a
 void CARLsim::loadSimulation(FILE* fid) { _impl->loadSimulation(fid); }
 
+// Restores the simulation state from the last checkpoint in a directory
+void CARLsim::loadCheckpoint(const std::string& dirName) { _impl->loadCheckpoint(dirName); }
+
 // Multiplies the weight of every synapse in the connection with a scaling factor
 void CARLsim::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	_impl->scaleWeights(connId, scale, updateWeightRange);
@@ -2075,6 +2196,9 @@ int CARLsim::getGroupEndNeuronId(int grpId) { return _impl->getGroupEndNeuronId(
 // returns the number of neurons of a group specified by grpId
 int CARLsim::getGroupNumNeurons(int grpId) { return _impl->getGroupNumNeurons(grpId); }
 
+// returns the partition a group has been assigned to
+int CARLsim::getGroupPartition(int grpId) { return _impl->getGroupPartition(grpId); }
+
 // returns the stdp information of a group specified by grpId
 GroupSTDPInfo CARLsim::getGroupSTDPInfo(int grpId) { return _impl->getGroupSTDPInfo(grpId); }
 
@@ -0,0 +1,178 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _CHECKPOINT_WRITER_H_
+#define _CHECKPOINT_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// A checkpoint directory holds the manifest checkpoint.hdr (a CheckpointHeader followed by
+// CheckpointArrayInfo[numArrays]) and two data files checkpoint_0.dat and checkpoint_1.dat. Consecutive checkpoints
+// alternate between the data files, and the manifest is replaced (atomically on POSIX) only after its data file has
+// been flushed, so that a crash during a write never destroys the last complete checkpoint.
+
+#define CHECKPOINT_SIGNATURE   294338572 //!< identifies checkpoint manifests
+#define CHECKPOINT_VERSION     0.1f      //!< version of the layout below
+#define CHECKPOINT_CHUNK_SIZE  65536     //!< granularity of the incremental writes (bytes)
+#define CHECKPOINT_NAME_LENGTH 32        //!< maximum length of an array name, including the terminating '\0'
+
+//! header of the checkpoint manifest
+typedef struct CheckpointHeader_s {
+	int32_t  signature;
+	float    version;
+	int32_t  sequence;  //!< number of the checkpoint in the directory, starting at 1
+	int32_t  slot;      //!< data file (checkpoint_<slot>.dat) that holds the checkpoint
+	int32_t  simTime;   //!< simulation time of the checkpoint (ms)
+	int32_t  numArrays;
+	uint64_t dataSize;  //!< size of the data file (bytes)
+	uint64_t chunkSize; //!< CHECKPOINT_CHUNK_SIZE of the writer
+} CheckpointHeader;
+
+//! an array of the simulation state stored in a checkpoint
+typedef struct CheckpointArrayInfo_s {
+	char     name[CHECKPOINT_NAME_LENGTH];
+	int32_t  netId;  //!< local network of the array, -1 for the state of the manager
+	uint64_t offset; //!< byte offset of the array in the data file
+	uint64_t size;   //!< size of the array (bytes)
+} CheckpointArrayInfo;
+
+/*!
+ * \brief Writes incremental checkpoints of the simulation state in a background thread
+ *
+ * The layout of a checkpoint is defined once via CheckpointWriter::addArray. For every checkpoint, the simulation
+ * copies its state into the staging buffer with CheckpointWriter::beginCheckpoint and CheckpointWriter::setArray, and
+ * hands it over with CheckpointWriter::commitCheckpoint. A background thread then writes the buffer to the directory,
+ * while the simulation continues. Only the chunks (CHECKPOINT_CHUNK_SIZE bytes) that changed since the data file was
+ * last written are written again, so that state that rarely changes (e.g., fixed weights) is essentially free after
+ * the first two checkpoints. The staging buffer keeps the previous checkpoint, so CheckpointWriter::setArray finds
+ * the changed chunks by comparing the new state with it.
+ *
+ * On Windows, checkpoints are written in CheckpointWriter::commitCheckpoint.
+ *
+ * \since v4.0
+ */
+class CheckpointWriter {
+public:
+	/*!
+	 * \brief CheckpointWriter Constructor
+	 *
+	 * \param[in] dirName existing directory the checkpoints are written to. A checkpoint that is already stored in
+	 * the directory is kept until the first checkpoint of this writer is complete.
+	 */
+	CheckpointWriter(const std::string& dirName);
+
+	/*!
+	 * \brief CheckpointWriter Destructor
+	 *
+	 * Completes the pending checkpoint, then shuts down the background thread.
+	 */
+	~CheckpointWriter();
+
+	/*!
+	 * \brief Appends an array to the layout of the checkpoints
+	 *
+	 * Must be called before the first CheckpointWriter::beginCheckpoint.
+	 * \returns byte offset of the array in the staging buffer
+	 */
+	size_t addArray(const std::string& name, int netId, size_t size);
+
+	//! returns the layout of the checkpoints
+	const std::vector<CheckpointArrayInfo>& getArrays();
+
+	/*!
+	 * \brief Starts the next checkpoint
+	 *
+	 * Blocks until the previous checkpoint has been written.
+	 * \returns false if writing a previous checkpoint failed
+	 */
+	bool beginCheckpoint();
+
+	/*!
+	 * \brief Copies an array of the next checkpoint into the staging buffer
+	 *
+	 * Must be called after CheckpointWriter::beginCheckpoint for every array that changed since the last checkpoint.
+	 * \param[in] index index of the array in the layout (order of CheckpointWriter::addArray)
+	 * \param[in] data contents of the array, CheckpointArrayInfo::size bytes
+	 */
+	void setArray(size_t index, const void* data);
+
+	//! hands the staging buffer over to the background thread, which writes it as the checkpoint at simTime (ms)
+	void commitCheckpoint(int simTime);
+
+	//! blocks until the pending checkpoint has been written, returns false if writing a checkpoint failed
+	bool wait();
+
+	//! returns the number of checkpoints written by this writer
+	int getNumCheckpoints();
+
+	//! returns the number of bytes written to the data files by this writer (the incremental writes)
+	uint64_t getBytesWritten();
+
+	/*!
+	 * \brief Reads the last complete checkpoint of a directory
+	 *
+	 * \param[in] dirName directory that holds the checkpoint
+	 * \param[out] header header of the manifest
+	 * \param[out] arrays layout of the checkpoint
+	 * \param[out] data contents of the data file
+	 * \returns false if there is no valid checkpoint in the directory
+	 */
+	static bool read(const std::string& dirName, CheckpointHeader& header, std::vector<CheckpointArrayInfo>& arrays,
+		std::vector<char>& data);
+
+private:
+	// This class provides a pImpl for the (pthread-based) implementation.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+
+#endif
@@ -0,0 +1,162 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _CONNECTION_BUFFER_H_
+#define _CONNECTION_BUFFER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#include <string.h>
+#include <vector>
+
+
+/*!
+ * \brief Columnar buffer of the synapses generated during setupNetwork
+ *
+ * The synapses created by the connect methods are stored as structs-of-arrays in fixed-size chunks, so that pushing a
+ * synapse never moves the synapses already stored and a synapse only occupies the bytes of its columns (19 bytes
+ * instead of a list node per synapse). Neuron ids are global ids, the groups of a synapse are given by its
+ * connection id. SNN::generateConnectionRuntime consumes the buffer and releases its memory.
+ * \since v4.0
+ */
+class ConnectionBuffer {
+public:
+	static const size_t CHUNK_BITS = 12;
+	static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS; //!< number of synapses per chunk
+	static const size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+	ConnectionBuffer() : numSynapses_(0) {}
+	~ConnectionBuffer() { clear(); }
+
+	//! allocates the chunks for (at least) numSynapses synapses in total, so that pushing them allocates no memory
+	void reserve(size_t numSynapses) {
+		while (chunks_.size() * CHUNK_SIZE < numSynapses)
+			chunks_.push_back(new Chunk);
+	}
+
+	void push_back(int nSrc, int nDest, short int connId, float initWt, float maxWt, uint8_t delay) {
+		size_t offset = numSynapses_ & CHUNK_MASK;
+		if (offset == 0 && (numSynapses_ >> CHUNK_BITS) == chunks_.size())
+			chunks_.push_back(new Chunk);
+
+		Chunk* chunk = chunks_[numSynapses_ >> CHUNK_BITS];
+		chunk->nSrc[offset] = nSrc;
+		chunk->nDest[offset] = nDest;
+		chunk->initWt[offset] = initWt;
+		chunk->maxWt[offset] = maxWt;
+		chunk->connId[offset] = connId;
+		chunk->delay[offset] = delay;
+		numSynapses_++;
+	}
+
+	//! appends all synapses of another buffer, in their order
+	void append(const ConnectionBuffer& other) {
+		size_t i = 0;
+		while (i < other.numSynapses_) {
+			size_t offset = numSynapses_ & CHUNK_MASK;
+			if (offset == 0 && (numSynapses_ >> CHUNK_BITS) == chunks_.size())
+				chunks_.push_back(new Chunk);
+
+			// copy the longest run that neither crosses a chunk of this buffer nor of the other buffer
+			size_t otherOffset = i & CHUNK_MASK;
+			size_t n = other.numSynapses_ - i;
+			if (n > CHUNK_SIZE - offset) n = CHUNK_SIZE - offset;
+			if (n > CHUNK_SIZE - otherOffset) n = CHUNK_SIZE - otherOffset;
+
+			Chunk* chunk = chunks_[numSynapses_ >> CHUNK_BITS];
+			const Chunk* otherChunk = other.chunks_[i >> CHUNK_BITS];
+			memcpy(&chunk->nSrc[offset], &otherChunk->nSrc[otherOffset], sizeof(int) * n);
+			memcpy(&chunk->nDest[offset], &otherChunk->nDest[otherOffset], sizeof(int) * n);
+			memcpy(&chunk->initWt[offset], &otherChunk->initWt[otherOffset], sizeof(float) * n);
+			memcpy(&chunk->maxWt[offset], &otherChunk->maxWt[otherOffset], sizeof(float) * n);
+			memcpy(&chunk->connId[offset], &otherChunk->connId[otherOffset], sizeof(short int) * n);
+			memcpy(&chunk->delay[offset], &otherChunk->delay[otherOffset], sizeof(uint8_t) * n);
+			numSynapses_ += n;
+			i += n;
+		}
+	}
+
+	size_t size() const { return numSynapses_; }
+	bool empty() const { return numSynapses_ == 0; }
+
+	//! removes all synapses and releases the memory of the buffer
+	void clear() {
+		for (size_t i = 0; i < chunks_.size(); i++)
+			delete chunks_[i];
+		std::vector<Chunk*>().swap(chunks_);
+		numSynapses_ = 0;
+	}
+
+	// accessors of the i-th synapse in the order the synapses were pushed
+	int getSrc(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->nSrc[i & CHUNK_MASK]; }
+	int getDest(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->nDest[i & CHUNK_MASK]; }
+	float getInitWt(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->initWt[i & CHUNK_MASK]; }
+	float getMaxWt(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->maxWt[i & CHUNK_MASK]; }
+	short int getConnId(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->connId[i & CHUNK_MASK]; }
+	uint8_t getDelay(size_t i) const { assert(i < numSynapses_); return chunks_[i >> CHUNK_BITS]->delay[i & CHUNK_MASK]; }
+
+private:
+	struct Chunk {
+		int       nSrc[CHUNK_SIZE];   //!< global id of the pre-synaptic neuron
+		int       nDest[CHUNK_SIZE];  //!< global id of the post-synaptic neuron
+		float     initWt[CHUNK_SIZE]; //!< initial weight, sign-adjusted to the pre-synaptic group
+		float     maxWt[CHUNK_SIZE];  //!< maximum weight, sign-adjusted to the pre-synaptic group
+		short int connId[CHUNK_SIZE];
+		uint8_t   delay[CHUNK_SIZE];
+	};
+
+	// the buffer is owned by the SNN and is never copied
+	ConnectionBuffer(const ConnectionBuffer&);
+	ConnectionBuffer& operator=(const ConnectionBuffer&);
+
+	std::vector<Chunk*> chunks_;
+	size_t numSynapses_;
+};
+
+#endif
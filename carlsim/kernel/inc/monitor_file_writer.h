@@ -0,0 +1,109 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _MONITOR_FILE_WRITER_H_
+#define _MONITOR_FILE_WRITER_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define MONITOR_WRITER_BLOCK_SIZE  (1<<20)  //!< size of the write buffer of a file, written in one block (bytes)
+#define MONITOR_WRITER_MAX_PENDING (64<<20) //!< maximum size of the blocks waiting for the writer thread (bytes)
+
+/*!
+ * \brief Writes the files of the monitors (SpikeMonitor, NeuronMonitor, GroupMonitor) in a background thread
+ *
+ * The simulation appends the records of a file to its write buffer via MonitorFileWriter::write. Once the buffer
+ * holds MONITOR_WRITER_BLOCK_SIZE bytes, or when MonitorFileWriter::flush is called (once per simulated second), the
+ * buffer is handed over to a background thread, which writes it with a single fwrite, and the simulation continues
+ * with a second buffer. The blocks are written in the order they were handed over, so that the contents of the
+ * files are identical to writing them directly.
+ *
+ * At most MONITOR_WRITER_MAX_PENDING bytes wait for the background thread: if the disk cannot keep up, handing over
+ * a block blocks the simulation until the writer thread caught up.
+ *
+ * MonitorFileWriter::sync has to be called before a file is written or closed by anyone else (e.g., when a monitor
+ * is deleted), and at the end of CARLsim::runNetwork, so that the files are complete whenever the user can access
+ * them.
+ *
+ * On Windows, the blocks are written in MonitorFileWriter::flush and when a buffer is full.
+ *
+ * \since v4.0
+ */
+class MonitorFileWriter {
+public:
+	//! constructor, the background thread is started with the first block
+	MonitorFileWriter();
+
+	//! destructor, writes the pending blocks, then shuts down the background thread
+	~MonitorFileWriter();
+
+	//! appends size bytes to the write buffer of a file
+	void write(FILE* fid, const void* data, size_t size);
+
+	//! hands the write buffer of a file over to the background thread, which writes and fflushes it
+	void flush(FILE* fid);
+
+	/*!
+	 * \brief Writes the buffers of all files, then blocks until the background thread has written all blocks
+	 *
+	 * \returns false if a block could not be written since the last call
+	 */
+	bool sync();
+
+	//! returns the number of bytes written by the background thread
+	size_t getBytesWritten();
+
+private:
+	// This class provides a pImpl for the (pthread-based) implementation.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+
+#endif
@@ -0,0 +1,165 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _NETWORK_IMAGE_H_
+#define _NETWORK_IMAGE_H_
+
+#include <stdint.h>
+
+
+// Layout of the binary network image written by SNN::saveSimulation and read by SNN::loadSimulation.
+//
+// An image stores the compiled network: the group and connection configs it was built from, and for every local
+// network the arrays generated by SNN::generateConnectionRuntime (Npre, Npre_plastic, Npost, cumulativePre,
+// cumulativePost, preSynapticIds, postSynapticIds, postDelayInfo, wt, maxSynWt, connIdsPreIdx) together with the
+// neuron state (voltage, recovery). All records have a fixed size and every array starts at a multiple of
+// NETWORK_IMAGE_ALIGNMENT bytes, so that the image can be mapped into memory and its arrays used in place.
+// Numbers are stored in the byte order of the machine that wrote the image.
+//
+// file layout:
+//   NetworkImageHeader
+//   NetworkImageGroup[numGroups]           at header.groupOffset
+//   NetworkImageConnection[numConnections] at header.connectOffset
+//   NetworkImageNetwork[numNetworks]       at header.networkOffset
+//   per network: NetworkImagePartition[numGroupsAssigned] at groupOffset, followed by the arrays at arrayOffset[]
+
+#define NETWORK_IMAGE_SIGNATURE   294338571 //!< identifies files written by SNN::saveSimulation
+#define NETWORK_IMAGE_VERSION     0.3f      //!< version of the layout below
+#define NETWORK_IMAGE_ALIGNMENT   64        //!< alignment of tables and arrays (bytes)
+#define NETWORK_IMAGE_NAME_LENGTH 96        //!< maximum length of a group name, including the terminating '\0'
+
+//! the arrays of a local network stored in an image
+enum NetworkImageArray {
+	IMG_NPRE,                //!< unsigned short[numNAssigned]
+	IMG_NPRE_PLASTIC,        //!< unsigned short[numNAssigned]
+	IMG_NPOST,               //!< unsigned short[numNAssigned]
+	IMG_CUMULATIVE_PRE,      //!< unsigned int[numNAssigned]
+	IMG_CUMULATIVE_POST,     //!< unsigned int[numNAssigned]
+	IMG_PRE_SYNAPTIC_IDS,    //!< SynInfo[numPreSynNet]
+	IMG_POST_SYNAPTIC_IDS,   //!< SynInfo[numPostSynNet]
+	IMG_POST_DELAY_INFO,     //!< DelayInfo[numNAssigned * (maxDelay + 1)]
+	IMG_WT,                  //!< float[numPreSynNet]
+	IMG_MAX_SYN_WT,          //!< float[numPreSynNet]
+	IMG_CONN_IDS_PRE_IDX,    //!< short int[numPreSynNet]
+	IMG_VOLTAGE,             //!< float[numNReg]
+	IMG_RECOVERY,            //!< float[numNReg]
+	IMG_NUM_ARRAYS
+};
+
+typedef struct NetworkImageHeader_s {
+	int32_t  signature;        //!< NETWORK_IMAGE_SIGNATURE
+	float    version;          //!< NETWORK_IMAGE_VERSION
+	uint32_t headerSize;       //!< sizeof(NetworkImageHeader), guards against images of a different layout
+	uint32_t hasSynapseInfo;   //!< whether the networks contain the arrays (see saveSimulation(saveSynapseInfo))
+	float    simTimeSec;       //!< simulation time when the image was written (s)
+	float    executionTimeSec; //!< execution time when the image was written (s)
+	int32_t  numN;             //!< number of neurons in the global network
+	int32_t  numGroups;
+	int32_t  numConnections;
+	int32_t  maxDelay;         //!< maximum axonal delay in the global network, stride of postDelayInfo is maxDelay + 1
+	int32_t  numNetworks;      //!< number of local networks (CPU and GPU runtimes)
+	int32_t  randSeed;         //!< random seed of the simulation that wrote the image
+	uint64_t groupOffset;      //!< byte offset of the NetworkImageGroup table
+	uint64_t connectOffset;    //!< byte offset of the NetworkImageConnection table
+	uint64_t networkOffset;    //!< byte offset of the NetworkImageNetwork table
+	uint64_t fileSize;         //!< total size of the image (bytes)
+} NetworkImageHeader;
+
+typedef struct NetworkImageGroup_s {
+	int32_t  gGrpId;
+	int32_t  netId;            //!< the local network that simulates the group
+	int32_t  gStartN;
+	int32_t  gEndN;
+	int32_t  sizeX;
+	int32_t  sizeY;
+	int32_t  sizeZ;
+	uint32_t type;
+	char     name[NETWORK_IMAGE_NAME_LENGTH];
+} NetworkImageGroup;
+
+typedef struct NetworkImageConnection_s {
+	int32_t  connId;
+	int32_t  grpSrc;
+	int32_t  grpDest;
+	int32_t  type;             //!< conType_t
+	uint32_t connProp;
+	int32_t  minDelay;
+	int32_t  maxDelay;         //!< for user-defined connections, the maximum delay of the generated synapses
+	int32_t  numberOfConnections;
+	float    maxWt;            //!< for user-defined connections, the maximum weight of the generated synapses
+} NetworkImageConnection;
+
+//! a group of a local network, in the order of SNN::groupPartitionLists (local or external)
+typedef struct NetworkImagePartition_s {
+	int32_t  gGrpId;
+	int32_t  lGrpId;
+	int32_t  numPostSynapses;
+	int32_t  numPreSynapses;
+} NetworkImagePartition;
+
+typedef struct NetworkImageNetwork_s {
+	int32_t  netId;
+	int32_t  numGroupsAssigned;
+	int32_t  numNAssigned;
+	int32_t  numNReg;
+	int32_t  numPreSynNet;
+	int32_t  numPostSynNet;
+	int32_t  maxNumPreSynN;
+	int32_t  maxNumPostSynN;
+	uint64_t groupOffset;                   //!< byte offset of the NetworkImagePartition table
+	uint64_t arrayOffset[IMG_NUM_ARRAYS];   //!< byte offset of each array, 0 if the image has no synapse info
+	uint64_t arraySize[IMG_NUM_ARRAYS];     //!< size of each array (bytes)
+} NetworkImageNetwork;
+
+// rounds a byte offset up to the next multiple of NETWORK_IMAGE_ALIGNMENT
+inline
+uint64_t alignImageOffset(uint64_t offset) {
+	return (offset + NETWORK_IMAGE_ALIGNMENT - 1) / NETWORK_IMAGE_ALIGNMENT * NETWORK_IMAGE_ALIGNMENT;
+}
+
+#endif
@@ -0,0 +1,184 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _NEURON_SIMD_H_
+#define _NEURON_SIMD_H_
+
+#include <carlsim_datastructures.h> // integrationMethod_t
+
+
+// single integration step for voltage equation of 4-param Izhikevich
+inline
+float dvdtIzhikevich4(float volt, float recov, float totalCurrent, float timeStep = 1.0f) {
+	return (((0.04f * volt + 5.0f) * volt + 140.0f - recov + totalCurrent) * timeStep);
+}
+
+// single integration step for recovery equation of 4-param Izhikevich
+inline
+float dudtIzhikevich4(float volt, float recov, float izhA, float izhB, float timeStep = 1.0f) {
+	return (izhA * (izhB * volt - recov) * timeStep);
+}
+
+// single integration step for voltage equation of 9-param Izhikevich
+inline
+float dvdtIzhikevich9(float volt, float recov, float invCapac, float izhK, float voltRest,
+	float voltInst, float totalCurrent, float timeStep = 1.0f)
+{
+	return ((izhK * (volt - voltRest) * (volt - voltInst) - recov + totalCurrent) * invCapac * timeStep);
+}
+
+// single integration step for recovery equation of 9-param Izhikevich
+inline
+float dudtIzhikevich9(float volt, float recov, float voltRest, float izhA, float izhB, float timeStep = 1.0f) {
+	return (izhA * (izhB * (volt - voltRest) - recov) * timeStep);
+}
+
+// single integration step for voltage equation of LIF neurons
+inline
+float dvdtLIF(float volt, float lif_vReset, float lif_gain, float lif_bias, int lif_tau_m, float totalCurrent, float timeStep = 1.0f) {
+	return ((lif_vReset -volt + ((totalCurrent * lif_gain) + lif_bias))/ (float) lif_tau_m) * timeStep;
+}
+
+// synaptic current of a COBA neuron
+inline
+float currentCOBA(float volt, float gAMPA, float gNMDA, float gGABAa, float gGABAb) {
+	float NMDAtmp = (volt + 80.0f) * (volt + 80.0f) / 60.0f / 60.0f;
+	return -(gAMPA * (volt - 0.0f)
+		+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (volt - 0.0f)
+		+ gGABAa * (volt + 70.0f)
+		+ gGABAb * (volt + 90.0f));
+}
+
+//! SIMD instruction sets of the neuron update kernels, from narrowest to widest
+enum SimdLevel {
+	SIMD_NONE,   //!< scalar code
+	SIMD_SSE42,  //!< 4 neurons per instruction
+	SIMD_AVX2,   //!< 8 neurons per instruction
+	SIMD_AVX512  //!< 16 neurons per instruction
+};
+
+//! neuron parameters shared by all neurons of an Izhikevich group
+typedef struct IzhParams_s {
+	float a, b, c, d;
+	float inverse_C, k, vr, vt, vpeak; //!< only used by the 9-param model
+} IzhParams;
+
+//! neuron parameters shared by all neurons of a LIF group
+typedef struct LIFParams_s {
+	int   tau_m, tau_ref;
+	float vTh, vReset, gain, bias;
+} LIFParams;
+
+/*!
+ * \brief SIMD kernels that integrate a contiguous range of neurons sharing the same parameters
+ *
+ * Each SIMD lane integrates one neuron. Spikes are detected with a mask compare and the reset is a blend, so the
+ * kernels do not branch per neuron. The kernels perform the same floating-point operations in the same order as the
+ * scalar integration functions above (dvdtIzhikevich4, etc.) and never contract them into fused multiply-adds, so
+ * their results are identical to the scalar path at every level.
+ *
+ * The level is chosen by the caller, usually NeuronSimd::getSupportedLevel(). The SSE4.2, AVX2 and AVX-512 kernels
+ * are compiled for x86 with GCC-compatible compilers only. On other platforms every level falls back to scalar code.
+ *
+ * \since v4.0
+ */
+class NeuronSimd {
+public:
+	//! returns the widest level supported by both this build and the CPU, detected once at runtime
+	static SimdLevel getSupportedLevel();
+
+	//! returns the name of a level, e.g. "AVX2"
+	static const char* getLevelName(SimdLevel level);
+
+	//! returns the number of neurons integrated per instruction at a level
+	static int getWidth(SimdLevel level);
+
+	/*!
+	 * \brief computes the synaptic current of n COBA neurons (see currentCOBA)
+	 *
+	 * \param[in] gNMDA NMDA conductance, or its decay component if NMDA has a rise time
+	 * \param[in] gNMDA_r rise component of the NMDA conductance, NULL if NMDA has no rise time
+	 * \param[in] gGABAb GABAb conductance, or its decay component if GABAb has a rise time
+	 * \param[in] gGABAb_r rise component of the GABAb conductance, NULL if GABAb has no rise time
+	 * \param[out] I_sum synaptic current of each neuron
+	 */
+	static void conductanceCurrent(SimdLevel level, int n, const float* volt, const float* gAMPA, const float* gNMDA,
+		const float* gNMDA_r, const float* gGABAa, const float* gGABAb, const float* gGABAb_r, float* I_sum);
+
+	/*!
+	 * \brief integrates n Izhikevich neurons for one integration step
+	 *
+	 * \param[in] withParamModel_9 true for the 9-param model, false for the 4-param model
+	 * \param[in] method FORWARD_EULER or RUNGE_KUTTA4
+	 * \param[in] volt membrane potential at the beginning of the step
+	 * \param[out] nextVolt membrane potential at the end of the step
+	 * \param[in,out] recov recovery variable
+	 * \param[in] totalCurrent total input current
+	 * \param[out] curSpike set to true for the neurons that spiked, other entries are left unchanged
+	 */
+	static void updateIzhikevich(SimdLevel level, bool withParamModel_9, integrationMethod_t method, int n,
+		const IzhParams& p, float timeStep, const float* volt, float* nextVolt, float* recov, const float* totalCurrent,
+		bool* curSpike);
+
+	/*!
+	 * \brief integrates n LIF neurons for one (forward Euler) integration step
+	 *
+	 * \param[in] lastIter whether this is the last integration step of the current ms
+	 * \param[in] volt membrane potential at the beginning of the step
+	 * \param[in,out] nextVolt membrane potential of the previous step, overwritten with the potential at the end of
+	 *                the step
+	 * \param[in,out] refCount remaining refractory period of each neuron
+	 * \param[in] totalCurrent total input current
+	 * \param[out] curSpike set to true for the neurons that spiked, other entries are left unchanged
+	 */
+	static void updateLIF(SimdLevel level, int n, const LIFParams& p, float timeStep, bool lastIter,
+		const float* volt, float* nextVolt, int* refCount, const float* totalCurrent, bool* curSpike);
+};
+
+
+#endif
@@ -0,0 +1,128 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+
+#ifndef _PHILOX_RNG_H_
+#define _PHILOX_RNG_H_
+
+#include <stdint.h>
+
+
+/*!
+ * \brief Counter-based random number generator (Philox4x32-10)
+ *
+ * Philox maps a 128-bit counter and a 64-bit key to 128 random bits (Salmon et al., "Parallel random numbers: as easy
+ * as 1, 2, 3", SC'11). The generator has no state: the same (key, counter) always gives the same numbers. Random
+ * numbers can therefore be drawn by any thread in any order, and a simulation is reproducible for the same seed
+ * regardless of the number of partitions and threads. The key is built from the random seed and a stream id, so that
+ * different purposes (Poisson spikes, connectivity, ...) draw independent numbers.
+ *
+ * Every call to PhiloxRNG::generate yields four 32-bit numbers (lanes).
+ *
+ * \since v4.0
+ */
+class PhiloxRNG {
+public:
+	/*!
+	 * \brief PhiloxRNG Constructor
+	 *
+	 * \param[in] seed random seed
+	 * \param[in] stream id of an independent stream of random numbers
+	 */
+	PhiloxRNG(uint32_t seed, uint32_t stream) : _key0(seed), _key1(stream) {}
+
+	//! returns the four random 32-bit numbers of counter (c0, c1, c2, c3)
+	void generate(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t out[4]) const {
+		uint32_t ctr[4] = {c0, c1, c2, c3};
+		uint32_t k0 = _key0, k1 = _key1;
+		for (int r = 0; r < PHILOX_ROUNDS; r++) {
+			if (r > 0) {
+				k0 += PHILOX_W0;
+				k1 += PHILOX_W1;
+			}
+			round(ctr[0], ctr[1], ctr[2], ctr[3], k0, k1);
+		}
+		for (int i = 0; i < 4; i++)
+			out[i] = ctr[i];
+	}
+
+	//! returns a uniformly distributed float in [0,1) from lane (0..3) of counter (c0, c1, c2, 0)
+	float uniform(uint32_t c0, uint32_t c1, uint32_t c2, int lane) const {
+		uint32_t out[4];
+		generate(c0, c1, c2, 0, out);
+		return toFloat(out[lane & 3]);
+	}
+
+	//! converts a random 32-bit number to a float in [0,1) (24 significant bits)
+	static float toFloat(uint32_t x) {
+		return (x >> 8) * (1.0f / 16777216.0f);
+	}
+
+private:
+	static const int PHILOX_ROUNDS = 10;
+	static const uint32_t PHILOX_M0 = 0xD2511F53;
+	static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+	static const uint32_t PHILOX_W0 = 0x9E3779B9;
+	static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+	static void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+		uint64_t prod0 = (uint64_t)PHILOX_M0 * c0;
+		uint64_t prod1 = (uint64_t)PHILOX_M1 * c2;
+		uint32_t y0 = (uint32_t)(prod1 >> 32) ^ c1 ^ k0;
+		uint32_t y2 = (uint32_t)(prod0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)prod1;
+		c3 = (uint32_t)prod0;
+		c0 = y0;
+		c2 = y2;
+	}
+
+	uint32_t _key0;
+	uint32_t _key1;
+};
+
+#endif
@@ -88,6 +88,9 @@
 
 #include <snn_definitions.h>
 #include <snn_datastructures.h>
+#include <neuron_simd.h>
+#include <network_image.h>
+#include <connection_buffer.h>
 
 // #include <spike_buffer.h>
 #include <poisson_rate.h>
@@ -100,6 +103,9 @@ class ConnectionMonitorCore;
 class ConnectionMonitor;
 
 class SpikeBuffer;
+class ThreadPool;
+class CheckpointWriter;
+class MonitorFileWriter;
 
 
 /// **************************************************************************************************************** ///
@@ -158,11 +164,12 @@ public:
 	 * \param maxdelay: the maximum delay allowed (ms)
 	 * \param synWtType: (optional) connection type, either SYN_FIXED or SYN_PLASTIC, default = SYN_FIXED.
 	 * \param wtType: (optional) DEPRECATED
+	 * \param wtPrecision: storage precision of the weights on CPU runtimes
 	 * \return number of created synaptic projections
 	 */
 	short int connect(int gIDpre, int gIDpost, const std::string& _type, float initWt, float maxWt, float prob,
 		uint8_t minDelay, uint8_t maxDelay, RadiusRF radius,
-		float mulSynFast, float mulSynSlow, bool synWtType);
+		float mulSynFast, float mulSynSlow, bool synWtType, WeightPrecision wtPrecision);
 
 	/* Creates synaptic projections using a callback mechanism.
 	 *
@@ -170,10 +177,11 @@ public:
 	 * \param _grpIdPost ID of the post-synaptic group
 	 * \param _conn: pointer to an instance of class ConnectionGenerator
 	 * \param _synWtType: (optional) connection type, either SYN_FIXED or SYN_PLASTIC, default = SYN_FIXED
+	 * \param wtPrecision: storage precision of the weights on CPU runtimes
 	 * \return number of created synaptic projections
 	 */
 	short int connect(int gIDpre, int gIDpost, ConnectionGeneratorCore* conn, float mulSynFast, float mulSynSlow,
-		bool synWtType);
+		bool synWtType, WeightPrecision wtPrecision);
 
 	/* Creates synaptic projections using a callback mechanism.
 	*
@@ -244,6 +252,18 @@ public:
 	//! Sets the integration method and the number of integration steps per 1ms simulation time step
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	//! Sets the number of worker threads that share the neuron loops of each CPU runtime (0 for automatic)
+	void setNumThreadsPerPartition(int numThreads);
+
+	//! Sets the number of CPU runtimes the groups with preferredPartition=ANY are distributed to (0 for automatic)
+	void setNumCPUPartitions(int numPartitions);
+
+	//! Sets the number of threads that generate the connections in setupNetwork (0 for all CPU cores)
+	void setNumConnectionThreads(int numThreads);
+
+	//! Sets whether CPU runtimes evaluate STDP from per-neuron spike traces instead of per-synapse spike times
+	void setSTDPTraces(bool isSet);
+
 	//! Sets the Izhikevich parameters a, b, c, and d of a neuron group.
 	/*!
 	 * \brief Parameter values for each neuron are given by a normal distribution with mean _a, _b, _c, _d and standard deviation _a_sd, _b_sd, _c_sd, and _d_sd, respectively
@@ -378,6 +398,9 @@ public:
 	 */
 	void setWeightAndWeightChangeUpdate(UpdateInterval wtANDwtChangeUpdateInterval, bool enableWtChangeDecay, float wtChangeDecay);
 
+	//! Sets whether CPU runtimes update only the weights of neurons with STDP activity since the last weight update
+	void setSparseWeightUpdate(bool isSet);
+
 	// +++++ PUBLIC METHODS: RUNNING A SIMULATION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
 	/*!
@@ -402,10 +425,11 @@ public:
 	void exitSimulation(int val = 1);
 
 	//! reads the network state from file
-	//! Reads a CARLsim network file. Such a file can be created using SNN:writeNetwork.
+	//! Reads a CARLsim network image. Such a file can be created using SNN::saveSimulation.
 	/*
-	 * \brief After calling SNN::loadSimulation, you should run SNN::runNetwork before calling fclose(fp).
-	 * \param fid: file pointer
+	 * \brief The image is read during setupNetwork, which then skips the generation of the connections (see
+	 * loadSimulation_internal). Do not call fclose(fp) before setupNetwork.
+	 * \param fid: file pointer, the image starts at the beginning of the file
 	 * \sa SNN::saveSimulation()
 	 */
 	void loadSimulation(FILE* fid);
@@ -497,12 +521,32 @@ public:
 	*/
 	void updateNeuronMonitor(int grpId = ALL);
 
-	//! stores the pre and post synaptic neuron ids with the weight and delay
+	/*!
+	 * \brief blocks until the background thread has written the spike, neuron state and group status files
+	 *
+	 * Monitor cores have to call it before they close or replace their file.
+	 */
+	void syncMonitorFiles();
+
+	//! stores the compiled network (connectivity, weights, delays, and neuron state) as a network image
 	/*
 	 * \param fid file pointer
+	 * \param saveSynapseInfo whether to store the synapses, an image without them cannot be loaded
+	 * \sa network_image.h
 	 */
 	void saveSimulation(FILE* fid, bool saveSynapseInfo = false);
 
+	//! writes a checkpoint of the simulation state every intervalSec seconds of simulated time
+	/*
+	 * \param intervalSec interval between two checkpoints (seconds of simulated time)
+	 * \param dirName existing directory the checkpoints are written to (see checkpoint_writer.h)
+	 * \sa SNN::loadCheckpoint
+	 */
+	void setCheckpoint(int intervalSec, const std::string& dirName);
+
+	//! restores the simulation state (and time) from the last checkpoint written to dirName
+	void loadCheckpoint(const std::string& dirName);
+
 	//! function writes population weights from gIDpre to gIDpost to file fname in binary.
 	//void writePopWeights(std::string fname, int gIDpre, int gIDpost);
 
@@ -556,6 +600,7 @@ public:
 	int getGroupStartNeuronId(int gGrpId) { return groupConfigMDMap[gGrpId].gStartN; }
 	int getGroupEndNeuronId(int gGrpId) { return groupConfigMDMap[gGrpId].gEndN; }
 	int getGroupNumNeurons(int gGrpId) { return groupConfigMap[gGrpId].numN; }
+	int getGroupPartition(int gGrpId) { int netId = groupConfigMDMap[gGrpId].netId; return netId >= CPU_RUNTIME_BASE ? netId - CPU_RUNTIME_BASE : netId - GPU_RUNTIME_BASE; }
 
 	std::string getNetworkName() { return networkName_; }
 
@@ -599,6 +644,7 @@ public:
 	float* getCurrent() { return managerRuntimeData.current; }
 
 	std::vector< std::vector<float> > getWeightMatrix2D(short int connId);
+	void getWeightMatrixSparse(short int connId, SparseWeightMatrix& wtConnId); //!< existing synapses in CSR format
 
 	std::vector<float> getConductanceAMPA(int grpId);
 	std::vector<float> getConductanceNMDA(int grpId);
@@ -645,6 +691,21 @@ public:
 	// **************************************************************************************************************** //
 
 private:
+	//! neuron update kernel of a regular group of a CPU runtime, see updateNeuronGroup_CPU
+	typedef void (SNN::*NeuronUpdateKernel)(int netId, int lGrpId, int lStartN, int lEndN, bool lastIter);
+
+	//! an array of the simulation state that is stored in a checkpoint, see SNN::collectCheckpointArrays
+	typedef struct CheckpointArray_s {
+		CheckpointArray_s(const char* _name, int _netId, void* _ptr, size_t _size)
+			: name(_name), netId(_netId), ptr(_ptr), size(_size)
+		{}
+
+		const char* name;
+		int netId; //!< local network of the array, -1 for the state of the manager
+		void* ptr;
+		size_t size; //!< size of the array (bytes)
+	} CheckpointArray;
+
 	//! all unsafe operations of constructor
 	void SNNinit();
 
@@ -659,6 +720,7 @@ private:
 	void generateGroupRuntime(int netId, int lGrpId);
 	void generatePoissonGroupRuntime(int netId, int lGrpId);
 	void generateConnectionRuntime(int netId);
+	void loadConnectionRuntime(int netId);
 	void generateCompConnectionRuntime(int netId);
 
 	/*!
@@ -681,13 +743,19 @@ private:
 	 * \brief generate connections among groups according to connect configuration
 	 */
 	void connectNetwork();
-	inline void connectNeurons(int netId, int srcGrp, int destGrp, int srcN, int destN, short int connId, int externalNetId);
-	inline void connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId);
-	void connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	size_t estimateNumSynapses(const ConnectConfig& connConfig);
+	inline void connectNeurons(ConnectionTask* task, int nSrc, int nDest);
+	inline void connectNeurons(ConnectionTask* task, int nSrc, int nDest, float initWt, float maxWt, uint8_t delay);
+	void connectFull(ConnectionTask* task);
+	void connectOneToOne(ConnectionTask* task);
+	void connectRandom(ConnectionTask* task);
+	void connectGaussian(ConnectionTask* task);
+	void connectUserDefined(ConnectionTask* task);
+	void generateConnections(ConnectionTask* task);
+	static void* helperGenerateConnections(void*);
+	void updateGroupNumSynapses(int netId, int grpSrc, int grpDest, int numSynapses);
+	std::vector<Point3D>& getGroupLocations(int gGrpId, std::map<int, std::vector<Point3D> >& groupLocations);
+	static Point3D getNeuronLocation3D(const Grid3D& grid, int relNeurId); //!< location of a neuron in the grid of its group
 
 	void deleteObjects();			//!< deallocates all used data structures in snn_cpu.cpp
 
@@ -699,6 +767,8 @@ private:
 		int& _numNReg, int& _numNExcReg, int& _numNInhReg,
 		int& _numNPois, int& _numNExcPois, int& _numNInhPois);
 	void findNumNSpikeGenAndOffset(int _netId);
+	void findNumThreads(int _netId, int _numCPURuntimes, int& _numThreads); //!< find the number of worker threads of a CPU runtime
+	void findThreadNeuronRange(int _numN, int _numThreads, int _threadId, int& _startIdx, int& _endIdx);
 
 	void generatePostSynapticSpike(int preNId, int postNId, int synId, int tD, int netId);
 	void fillSpikeGenBits(int netId);
@@ -725,6 +795,26 @@ private:
 
 	void partitionSNN();
 
+	/*!
+	 * \brief assigns the groups with preferredPartition=ANY to CPU runtimes
+	 *
+	 * Groups are placed greedily, in the order of decreasing estimated cost, on the CPU runtime they exchange the most
+	 * spikes with, as long as the runtime stays within PARTITION_IMBALANCE_TOLERANCE of the average load. A refinement
+	 * pass then moves single groups if that reduces the spike traffic between runtimes. Compartmentally connected
+	 * groups are always placed together. Sets GroupConfigMD::netId of the assigned groups.
+	 * \since v4.0
+	 */
+	void partitionAnyGroups();
+
+	//! estimates the computational cost of a group per ms, in units of the update of a 4-parameter Izhikevich neuron
+	float estimateGroupCost(int gGrpId);
+
+	//! estimates the number of synapses of a connection before it is generated
+	float estimateNumSynapses(int connId);
+
+	//! finds the number of CPU runtimes to distribute the groups with preferredPartition=ANY to
+	int findNumCPUPartitions(float _totalCost);
+
 	void generateRuntimeSNN();
 
 	/*!
@@ -752,12 +842,18 @@ private:
 	void printGroupInfo(int grpId);
 	void printGroupInfo(int netId, std::list<GroupConfigMD>::iterator grpIt);
 	void printSimSummary(); //!< prints a simulation summary at the end of sim
+	void printPartitionLoad(); //!< prints the predicted vs. measured load of the CPU runtimes
 	void printStatusConnectionMonitor(int connId = ALL);
 	void printStatusGroupMonitor(int gGrpId = ALL);
 	void printStatusSpikeMonitor(int gGrpId = ALL);
 	void printSikeRoutingInfo();
 
-	int loadSimulation_internal(bool onlyPlastic);
+	void loadSimulation_internal();
+	const NetworkImageNetwork* findImageNetwork(int netId);
+	void releaseSimImage();
+
+	void collectCheckpointArrays(std::vector<CheckpointArray>& arrays);
+	void saveCheckpoint();
 
 	void resetConductances(int netId);
 	void resetCurrent(int netId);
@@ -827,6 +923,7 @@ private:
 	void fetchGrpIdsLookupArray(int netId);
 	void fetchConnIdsLookupArray(int netId);
 	void fetchLastSpikeTime(int netId);
+	void fetchNeuronVariables(int netId);
 	void fetchPreConnectionInfo(int netId);
 	void fetchPostConnectionInfo(int netId);
 	void fetchSynapseState(int netId);
@@ -912,6 +1009,7 @@ private:
 	void copyGrpIdsLookupArray(int netId, cudaMemcpyKind kind);
 	void copyConnIdsLookupArray(int netId, cudaMemcpyKind kind);
 	void copyLastSpikeTime(int netId, cudaMemcpyKind kind);
+	void copyNeuronVariables(int netId, cudaMemcpyKind kind);
 	void copyNetworkSpikeCount(int netId, cudaMemcpyKind kind,
 		unsigned int* spikeCountD1, unsigned int* spikeCountD2,
 		unsigned int* spikeCountExtD1, unsigned int* spikeCountExtD2);
@@ -947,6 +1045,7 @@ private:
 	void copyGrpIdsLookupArray(int netId, cudaMemcpyKind kind) { assert(false); }
 	void copyConnIdsLookupArray(int netId, cudaMemcpyKind kind) { assert(false); }
 	void copyLastSpikeTime(int netId, cudaMemcpyKind kind) { assert(false); }
+	void copyNeuronVariables(int netId, cudaMemcpyKind kind) { assert(false); }
 	void copyNetworkSpikeCount(int netId, cudaMemcpyKind kind,
 	unsigned int* spikeCountD1, unsigned int* spikeCountD2,
 	unsigned int* spikeCountExtD1, unsigned int* spikeCountExtD2) { assert(false); }
@@ -960,40 +1059,38 @@ private:
 	//allocates runtime data on CPU memory
 	void allocateSNN_CPU(int netId); 
 
-	// runNetwork functions - multithreaded in POSIX using pthreads
-#if defined(WIN32) || defined(WIN64)
+	// runNetwork functions - dispatched to the CPU worker pool in POSIX
 	void assignPoissonFiringRate_CPU(int netId);
 	void clearExtFiringTable_CPU(int netId);
 	void convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
 	void convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
 	void doCurrentUpdateD2_CPU(int netId);
+	void doCurrentUpdateD2_CPU(int netId, int startIdx, int endIdx);
 	void doCurrentUpdateD1_CPU(int netId);
+	void doCurrentUpdateD1_CPU(int netId, int startIdx, int endIdx);
+	int findFirstPostSynapse_CPU(int netId, unsigned int offset, DelayInfo dPar, int lNIdStart);
 	void doSTPUpdateAndDecayCond_CPU(int netId);
 	void deleteRuntimeData_CPU(int netId);
+	void detectFiring_CPU(int netId, int startIdx, int endIdx);
 	void findFiring_CPU(int netId);
 	void globalStateUpdate_CPU(int netId);
+	void globalStateUpdate_CPU(int netId, int startIdx, int endIdx);
+	template<int neuronModel, integrationMethod_t method, int condFlags, bool withSharedParams, bool withNM>
+	void updateNeuronGroup_CPU(int netId, int lGrpId, int lStartN, int lEndN, bool lastIter);
+	template<int neuronModel, integrationMethod_t method, int condFlags>
+	NeuronUpdateKernel getNeuronUpdateKernel_CPU(bool withSharedParams, bool withNM);
+	template<int condFlags>
+	NeuronUpdateKernel getNeuronUpdateKernel_CPU(int neuronModel, integrationMethod_t method, bool withSharedParams, bool withNM);
+	void selectNeuronUpdateKernel_CPU(int netId, int lGrpId);
 	void resetSpikeCnt_CPU(int netId, int lGrpId); //!< Resets the spike count for a particular group.
 	void shiftSpikeTables_CPU(int netId);
 	void spikeGeneratorUpdate_CPU(int netId);
+	void updateFiredNeurons_CPU(int netId, int startIdx, int endIdx);
+	void updateFiringTable_CPU(int netId);
 	void updateTimingTable_CPU(int netId);
 	void updateWeights_CPU(int netId);
-#else // for POSIX systems - returns a void* to pthread_create - only differ in the return type compared to the counterparts above
-	void* assignPoissonFiringRate_CPU(int netId);
-	void* clearExtFiringTable_CPU(int netId);
-	void* convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* doCurrentUpdateD2_CPU(int netId);
-	void* doCurrentUpdateD1_CPU(int netId);
-	void* doSTPUpdateAndDecayCond_CPU(int netId);
-	void* deleteRuntimeData_CPU(int netId);
-	void* findFiring_CPU(int netId);
-	void* globalStateUpdate_CPU(int netId);
-	void* resetSpikeCnt_CPU(int netId, int lGrpId); //!< Resets the spike count for a particular group.
-	void* shiftSpikeTables_CPU(int netId);
-	void* spikeGeneratorUpdate_CPU(int netId);
-	void* updateTimingTable_CPU(int netId);
-	void* updateWeights_CPU(int netId);
 
+#if !defined(WIN32) && !defined(WIN64) // POSIX
 	// static multithreading helper methods for the above CPU runNetwork() methods
 	static void* helperAssignPoissonFiringRate_CPU(void*);
 	static void* helperClearExtFiringTable_CPU(void*);
@@ -1003,13 +1100,19 @@ private:
 	static void* helperDoCurrentUpdateD1_CPU(void*);
 	static void* helperDoSTPUpdateAndDecayCond_CPU(void*);
 	static void* helperDeleteRuntimeData_CPU(void*);
+	static void* helperDetectFiring_CPU(void*);
 	static void* helperFindFiring_CPU(void*);
 	static void* helperGlobalStateUpdate_CPU(void*);
 	static void* helperResetSpikeCnt_CPU(void*);
 	static void* helperShiftSpikeTables_CPU(void*);
 	static void* helperSpikeGeneratorUpdate_CPU(void*);
+	static void* helperUpdateFiredNeurons_CPU(void*);
+	static void* helperUpdateFiringTable_CPU(void*);
 	static void* helperUpdateTimingTable_CPU(void*);
 	static void* helperUpdateWeights_CPU(void*);
+
+	//! returns the slot in the worker pool that runs the threadId-th neuron range of a CPU runtime
+	int getWorkerId(int netId, int threadId) { return netId - CPU_RUNTIME_BASE + threadId * MAX_NET_PER_SNN; }
 #endif
 
 	// CPU computing backend: data transfer function
@@ -1027,12 +1130,16 @@ private:
 	void copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocateMem);	
 	void copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem, int destOffset);	
 	void copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool allocateMem);	
+	void copyMaxSynWt(int netId, int lNId);
+	void allocateMaxSynWt_CPU(int netId);
+	void copySynWt(int netId, int pos, int length);
 	void copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem);	
 	void copyWeightState(int netId, int lGrpId);
 	void copyNetworkConfig(int netId);
 	void copyGrpIdsLookupArray(int netId);
 	void copyConnIdsLookupArray(int netId);
 	void copyLastSpikeTime(int netId);
+	void copyNeuronVariables(int netId);
 	void copyNetworkSpikeCount(int netId,
 	unsigned int* spikeCountD1, unsigned int* spikeCountD2,
 	unsigned int* spikeCountExtD1, unsigned int* spikeCountExtD2);
@@ -1043,13 +1150,30 @@ private:
 	// CPU backend: utility function
 	void firingUpdateSTP(int lNId, int lGrpId, int netId);
 	void updateLTP(int lNId, int lGrpId, int netId);
+	void generateSTDPLUT(int netId, RuntimeData* dest);
+	void markWtChange_CPU(int netId, int lNId);
+	void applyPendingWtUpdates_CPU(int netId, int lNId);
+	void flushWtUpdates_CPU(int netId);
+	void updateNeuronWeights_CPU(int netId, int lGrpId, int lNId);
+	void setConnWtScale_CPU(int netId, short int connId, float scale);
+	void collectCheckpointArrays_CPU(int netId, std::vector<CheckpointArray>& arrays);
+	int getSynSpikeTime_CPU(int netId, unsigned int pos);
 	void resetFiredNeuron(int lNId, short int lGrpId, int netId);
-	bool getPoissonSpike(int lNId, int netId);
+	unsigned int drawPoissonInterval(int lNId, int netId, unsigned int counter);
+	void schedulePoissonSpikes_CPU(int netId);
 	bool getSpikeGenBit(unsigned int nIdPos, int netId);
 
 	// +++++ PRIVATE PROPERTIES +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 	SNNState snnState; //!< state of the network
 	FILE* loadSimFID;
+	const char* loadSimImage;  //!< the network image read from loadSimFID, only valid during setupNetwork
+	size_t loadSimImageSize;   //!< size of loadSimImage (bytes)
+	bool loadSimImageMapped;   //!< whether loadSimImage is memory-mapped (POSIX) or a copy on the heap
+
+	CheckpointWriter* checkpointWriter_; //!< writes the checkpoints in the background, NULL if disabled
+	int checkpointIntervalSec_;          //!< interval between two checkpoints (seconds of simulated time)
+
+	MonitorFileWriter* monitorFileWriter_; //!< writes the spike, neuron state and group status files in the background
 
 	const std::string networkName_;	//!< network name
 	const LoggerMode loggerMode_;	//!< current logger mode (USER, DEVELOPER, SILENT, CUSTOM)
@@ -1058,6 +1182,11 @@ private:
 
 	int numGPUs;    //!< number of GPU(s) is used in the simulation
 	int numCores;   //!< number of CPU Core(s) is used in the simulation
+	int numCPUThreads; //!< total number of worker threads of all CPU runtimes
+	float predictedLoad[MAX_NET_PER_SNN]; //!< estimated cost of each local network per ms (see estimateGroupCost)
+	std::vector<std::vector<int> > poissonWheel[MAX_NET_PER_SNN]; //!< Poisson neurons of each CPU runtime, bucketed by next spike time modulo POISSON_WHEEL_SIZE
+	std::vector<NeuronUpdateKernel> neuronUpdateKernels[MAX_NET_PER_SNN]; //!< update kernel of each group of a CPU runtime (see selectNeuronUpdateKernel_CPU)
+	SimdLevel simdLevel; //!< instruction set of the vectorized neuron update of the CPU runtimes (see NeuronSimd)
 
 	int numAvailableGPUs; //!< number of available GPU(s) in the machine
 
@@ -1082,7 +1211,7 @@ private:
 	std::list<ConnectConfig> externalConnectLists[MAX_NET_PER_SNN];
 	std::list<compConnectConfig> localCompConnectLists[MAX_NET_PER_SNN];
 
-	std::list<ConnectionInfo> connectionLists[MAX_NET_PER_SNN];
+	ConnectionBuffer connectionBuffers[MAX_NET_PER_SNN]; //!< the synapses generated by connectNetwork, consumed by generateConnectionRuntime
 
 	std::list<RoutingTableEntry> spikeRoutingTable;
 
@@ -1092,6 +1221,9 @@ private:
 	//! Buffer to store spikes
 	SpikeBuffer* spikeBuf;
 
+	//! persistent worker threads running the CPU runtimes, one pinned worker per CPU runtime (POSIX only)
+	ThreadPool* threadPool;
+
 	bool sim_with_conductances; //!< flag to inform whether we run in COBA mode (true) or CUBA mode (false)
 	bool sim_with_NMDA_rise;    //!< a flag to inform whether to compute NMDA rise time
 	bool sim_with_GABAb_rise;   //!< a flag to inform whether to compute GABAb rise time
@@ -70,6 +70,15 @@ enum MemType {
 	GPU_MEM,     //!< runtime data is allocated on GPU memory
 };
 
+//! the precomputed STDP curves of a group, used internally \sa GroupConfigRT::stdpLUTOffset
+enum STDPLUTType {
+	STDP_LUT_LTP_EXC, //!< E-STDP, the pre-synaptic spike arrives before the post-synaptic neuron fires
+	STDP_LUT_LTD_EXC, //!< E-STDP, the post-synaptic neuron fires before the pre-synaptic spike arrives
+	STDP_LUT_LTP_INB, //!< I-STDP, the pre-synaptic spike arrives before the post-synaptic neuron fires
+	STDP_LUT_LTD_INB, //!< I-STDP, the post-synaptic neuron fires before the pre-synaptic spike arrives
+	STDP_LUT_NUM
+};
+
 //! connection types, used internally (externally it's a string)
 enum conType_t { CONN_RANDOM, CONN_ONE_TO_ONE, CONN_FULL, CONN_FULL_NO_DIRECT, CONN_GAUSSIAN, CONN_USER_DEFINED, CONN_UNKNOWN};
 
@@ -91,22 +100,40 @@ typedef struct SynInfo_s {
 	int nId; //!< neuron id
 } SynInfo;
 
-typedef struct ConnectionInfo_s {
-	int grpSrc;
-	int grpDest;
-	int nSrc;
-	int nDest;
-	int srcGLoffset;
-	float initWt;
-	float maxWt;
-	int preSynId;
-	short int connId;
-	uint8_t delay;
-
-	bool operator== (const struct ConnectionInfo_s& conn) {
-		return (nSrc + srcGLoffset == conn.nSrc);
-	}
-} ConnectionInfo;
+/*!
+ * \brief compact form of an array of SynInfo, used by CPU runtimes
+ *
+ * The neuron id of a synapse is stored as a 16-bit offset to the base id of its block of COMPACT_SYN_BLOCK_SIZE
+ * consecutive synapses, the synapse id is stored in 16 bits as well. The group id is not stored, because it is the
+ * local group of the neuron. Blocks whose neuron ids span more than COMPACT_SYN_MAX_OFFSET keep the full ids in
+ * wideNId. On average, a synapse takes 4 bytes instead of 8 bytes.
+ *
+ * \since v4.0
+ */
+typedef struct CompactSynInfo_s {
+	unsigned short* nIdOffset; //!< neuron id relative to the base of the block
+	unsigned short* synId;     //!< synapse id
+	int* blockBase;            //!< base neuron id of each block, or -1 - (index of the first id of the block in wideNId)
+	int* wideNId;              //!< full neuron ids of the blocks that do not fit into 16-bit offsets
+	int numBlocks;             //!< number of blocks
+	int numWideBlocks;         //!< number of blocks stored in wideNId
+} CompactSynInfo;
+
+/*!
+ * \brief recent spike times of a neuron, used by the trace-based STDP of CPU runtimes
+ *
+ * The nearest-spike STDP traces of a neuron are reset to 1 by every spike and decay exponentially in between, so the
+ * value of a trace at time t is determined by the time of the last spike before t alone. Bit i of recent is set if the
+ * neuron fired at lastSpike - i. Together with older, this gives the last spike before any time t >= lastSpike - 63,
+ * which covers every axonal delay.
+ *
+ * \since v4.0
+ */
+typedef struct SpikeTrace_s {
+	unsigned long long recent; //!< spikes within the 64 ms up to lastSpike, bit i is set for a spike at lastSpike - i
+	int lastSpike;             //!< time of the last spike, MAX_SIMULATION_TIME if the neuron has not fired yet
+	int older;                 //!< time of the last spike before the window of recent, MAX_SIMULATION_TIME if there is none
+} SpikeTrace;
 
 /*!
  * \brief The configuration of a connection
@@ -132,6 +159,7 @@ typedef struct ConnectConfig_s {
 	ConnectionGeneratorCore* conn;
 	conType_t                type;
 	float                    connProbability; //!< connection probability
+	WeightPrecision          wtPrecision; //!< storage precision of the weights on CPU runtimes
 	short int                connId; //!< connectID of the element in the linked list
 	int                      numberOfConnections; // ToDo: move to ConnectConfigMD
 } ConnectConfig;
@@ -420,6 +448,13 @@ typedef struct GroupConfigRT_s {
 	float        LAMBDA;            //!< published by GroupConfig \sa GroupConfig
 	float        DELTA;             //!< published by GroupConfig \sa GroupConfig
 
+	//! offset of the precomputed STDP curves of the group in RuntimeData::stdpLUT, only used on CPU
+	int stdpLUTOffset[STDP_LUT_NUM];
+	//! number of entries of each STDP curve, the weight change is zero for larger spike time differences
+	int stdpLUTLength[STDP_LUT_NUM];
+	//! True = only the neurons marked in RuntimeData::wtDirty are visited by weight updates, only used on CPU
+	bool withSparseWtUpdate;
+
 									//!< homeostatic plasticity variables
 	float avgTimeScale;             //!< published by GroupConfig \sa GroupConfig
 	float avgTimeScale_decay;       //!< published by GroupConfig \sa GroupConfig
@@ -439,6 +474,26 @@ typedef struct GroupConfigRT_s {
 	bool withParamModel_9; //!< False = 4 parameter model; 1 = 9 parameter model.
 	bool isLIF; //!< True = a LIF spiking group
 
+	//! True = all neurons of the group share the same neuron parameters, which are then stored in the group config
+	//! instead of per-neuron arrays, only used on CPU
+	bool withSharedParams;
+	int   paramOffset; //!< offset from a local neuron id to its entry in the per-neuron parameter arrays, only used on CPU
+	float Izh_C;       //!< shared neuron parameters, valid if withSharedParams is set
+	float Izh_k;
+	float Izh_vr;
+	float Izh_vt;
+	float Izh_vpeak;
+	float Izh_a;
+	float Izh_b;
+	float Izh_c;
+	float Izh_d;
+	int   lif_tau_m;
+	int   lif_tau_ref;
+	float lif_vTh;
+	float lif_vReset;
+	float lif_gain;
+	float lif_bias;
+
 	bool withCompartments;
 	float compCouplingUp;
 	float compCouplingDown;
@@ -464,7 +519,7 @@ typedef struct RuntimeData_s {
 	float* voltage; //!< membrane potential for each regular neuron
 	float* nextVoltage; //!< membrane potential buffer (next/future time step) for each regular neuron
 	float* recovery;
-	float* Izh_C;
+	float* Izh_C; //!< on CPU only allocated for neurons of heterogeneous groups, indexed by lNId + GroupConfigRT::paramOffset
 	float* Izh_k;
 	float* Izh_vr;
 	float* Izh_vt;
@@ -477,9 +532,9 @@ typedef struct RuntimeData_s {
 	float* totalCurrent;
 	float* extCurrent;
 	
-	int* lif_tau_m; //!< parameters for a LIF spiking group
+	int* lif_tau_m; //!< parameters for a LIF spiking group, on CPU laid out like Izh_C
 	int* lif_tau_ref;
-	int* lif_tau_ref_c; // current refractory of the neuron
+	int* lif_tau_ref_c; // current refractory of the neuron, allocated for all regular neurons
 	float* lif_vTh;
 	float* lif_vReset;
 	float* lif_gain;
@@ -517,14 +572,29 @@ typedef struct RuntimeData_s {
 	unsigned short* Npost;				//!< stores the number of output connections from a neuron.
 
 	int* lastSpikeTime; //!< stores the last spike time of a neuron
-	int* synSpikeTime;  //!< stores the last spike time of a synapse
-
-	float* wtChange; //!< stores the weight change of a synaptic connection
-	float* wt;       //!< stores the weight change of a synaptic connection
-	float* maxSynWt; //!< maximum synaptic weight for a connection
+	int* synSpikeTime;  //!< stores the last spike time of a synapse, only plastic synapses on CPU (see cumulativePlasticPre), NULL with STDP traces
+	SpikeTrace* spikeTraces; //!< recent spike times of every local and external neuron, only used on CPU with STDP traces
+
+	float* wtChange; //!< stores the weight change of a synaptic connection, only plastic synapses on CPU
+	float* stdpLUT;  //!< the weight change per spike time difference (ms) of all STDP curves, only used on CPU
+
+	unsigned int* wtDirty; //!< one bit per regular neuron, set if its wtChange was modified since the last weight update, only used on CPU with sparse weight updates
+	int* wtUpdateEpoch;    //!< the number of weight updates already applied to wt and wtChange of a regular neuron, only used on CPU with sparse weight updates
+	int numWtUpdates;      //!< the number of weight updates of the runtime, only used on CPU with sparse weight updates
+	float wtUpdateScale;   //!< the STDP scale factor of the weight updates not yet applied to all neurons, only used on CPU with sparse weight updates
+	float* wt;       //!< stores the weight change of a synaptic connection, on CPU only the NetworkConfigRT::numWtFp32 fp32 weights
+	void* wtReduced; //!< stores the weights of reduced precision (see WeightPrecision), only used on CPU
+	WeightPrecision* connWtPrecision; //!< the precision of each connection if they differ, NULL otherwise, only used on CPU
+	unsigned long long* wtFp32Bits; //!< bit pos is set if synapse pos is stored in wt, only used on CPU if the precisions differ, NULL if no connection is WT_FP32
+	unsigned int* wtFp32Rank;       //!< the number of synapses stored in wt before each word of wtFp32Bits, only used on CPU
+	int wtReducedBytes;             //!< the bytes per weight in wtReduced if the precisions differ (2 if any reduced connection is WT_FP16 or WT_BF16, 1 otherwise), only used on CPU
+	float* connWtScale; //!< the scale of the weights of each WT_INT8 connection, only used on CPU
+	float* maxSynWt; //!< maximum synaptic weight for a connection, only plastic synapses on CPU, NULL if connMaxWt is used
+	float* connMaxWt; //!< maximum synaptic weight of each connection if it is the same for all its synapses, only used on CPU
 	
 	unsigned int* cumulativePost;
 	unsigned int* cumulativePre;
+	unsigned int* cumulativePlasticPre; //!< position of the first plastic synapse of a neuron in wtChange, synSpikeTime, maxSynWt, only used on CPU
 
 	short int* connIdsPreIdx; //!< connectId, per synapse, presynaptic cumulative indexing
 	short int* grpIds;
@@ -537,6 +607,8 @@ typedef struct RuntimeData_s {
 	 */
 	SynInfo* postSynapticIds;
 	SynInfo* preSynapticIds;
+	CompactSynInfo postSynapticCompact; //!< replaces postSynapticIds on CPU
+	CompactSynInfo preSynapticCompact;  //!< replaces preSynapticIds on CPU
 
 	DelayInfo* postDelayInfo;  	//!< delay information
 	unsigned int* timeTableD1; //!< firing table, only used in CPU_MODE currently
@@ -552,7 +624,11 @@ typedef struct RuntimeData_s {
 	int* extFiringTableEndIdxD2;
 
 	float* poissonFireRate;
-	float* randNum;		//!< firing random number. max value is 10,000
+	float* randNum;		//!< firing random number. max value is 10,000, only used on GPU
+	unsigned int* poissonNextSpikeTime; //!< scheduled time of the next spike of each Poisson neuron, only used on CPU
+	int* poissonFiredIds;	//!< ids of the Poisson neurons that fire in the current step in ascending order, only used on CPU
+	int numPoissonFired;	//!< number of entries in poissonFiredIds, only used on CPU
+	int* firedNeuronIds;	//!< neurons fired in the current step, grouped by the neuron range of each CPU thread, only used on CPU
 #ifndef __NO_CUDA__
 	int2* neuronAllocation;		//!< .x: [31:0] index of the first neuron, .y: [31:16] number of neurons, [15:0] group id
 	int3* groupIdInfo;			//!< .x , .y: the start and end index of neurons in a group, .z: gourd id, used for group Id calculations
@@ -595,7 +671,8 @@ typedef struct GlobalNetworkConfig_s {
 							  numNExcReg(0), numNInhReg(0), numNExcPois(0), numNInhPois(0),
 							  numSynNet(0), maxDelay(-1), numN1msDelay(0), numN2msDelay(0),
 							  simIntegrationMethod(FORWARD_EULER),
-							  simNumStepsPerMs(2), timeStep(0.5)
+							  simNumStepsPerMs(2), timeStep(0.5), numThreadsPerPartition(0), numCPUPartitions(1), numConnectionThreads(0),
+							  stdpTraces(false), sparseWtUpdate(false)
 	{}
 
 	int numN;		  //!< number of neurons in the global network
@@ -614,6 +691,12 @@ typedef struct GlobalNetworkConfig_s {
 	integrationMethod_t simIntegrationMethod; //!< integration method (forward-Euler or Fourth-order Runge-Kutta)
 	int simNumStepsPerMs;					  //!< number of steps per 1 millisecond
 	float timeStep;						      //!< inverse of simNumStepsPerMs
+
+	int numThreadsPerPartition; //!< number of worker threads per CPU runtime, 0 selects it automatically
+	int numCPUPartitions;       //!< number of CPU runtimes the groups without preferred partition are distributed to (default 1), 0 selects it automatically
+	int numConnectionThreads;   //!< number of threads that generate the connections in setupNetwork, 0 uses all CPU cores
+	bool stdpTraces;            //!< whether CPU runtimes evaluate STDP from per-neuron spike traces instead of per-synapse spike times
+	bool sparseWtUpdate;        //!< whether CPU runtimes only update the weights of neurons with recent STDP activity
 } GlobalNetworkConfig;
 
 //! runtime network configuration
@@ -646,6 +729,8 @@ typedef struct NetworkConfigRT_s  {
 	size_t       STP_Pitch;   //!< numN rounded upwards to the nearest 256 boundary, used for GPU only
 	int numPostSynNet;        //!< the total number of post-connections in a network
 	int numPreSynNet;         //!< the total number of pre-connections in a network
+	int numPlasticPreSynNet;  //!< the total number of plastic pre-connections in a network, only used on CPU
+	int numNParamReg;         //!< the number of regular neurons with per-neuron parameters (heterogeneous groups), only used on CPU
 	int maxNumPostSynN;       //!< the maximum number of post-synaptic connections among neurons
 	int maxNumPreSynN;        //!< the maximum number of pre-syanptic connections among neurons 
 	unsigned int maxSpikesD2; //!< the estimated maximum number of spikes with delay >= 2 in a network
@@ -662,9 +747,14 @@ typedef struct NetworkConfigRT_s  {
 	bool sim_with_conductances;
 	bool sim_with_compartments;
 	bool sim_with_stdp;
+	bool sim_with_stdp_traces; //!< whether STDP is evaluated from spikeTraces instead of synSpikeTime, only used on CPU
+	bool sim_with_sparse_wt_update; //!< whether weights are only updated for neurons marked in wtDirty, only used on CPU
+	WeightPrecision wtPrecision; //!< the precision in which the weights are stored, WT_FP32 if the precisions of the connections differ, only used on CPU
+	int numWtFp32;               //!< the number of weights stored in RuntimeData::wt, the others are in wtReduced, only used on CPU
 	bool sim_with_modulated_stdp;
 	bool sim_with_homeostasis;
 	bool sim_with_stp;
+	bool sim_with_DA_release; //!< a flag to inform whether a (external) group of the local network releases dopamine
 	bool sim_in_testing;
 	
 	// please note that spike monitor and connection monitor don't need this flag because no extra buffer is required
@@ -690,6 +780,8 @@ typedef struct NetworkConfigRT_s  {
 	integrationMethod_t simIntegrationMethod; //!< integration method (forward-Euler or Fourth-order Runge-Kutta)
 	int simNumStepsPerMs;					  //!< number of steps per 1 millisecond
 	float timeStep;						      //!< inverse of simNumStepsPerMs
+
+	int numThreads; //!< number of worker threads sharing the neuron loops of a CPU runtime, always 1 on GPU
 } NetworkConfigRT;
 
 
@@ -728,4 +820,32 @@ typedef struct ThreadStruct_s {
 	int GtoLOffset;
 } ThreadStruct;
 
+class ConnectionBuffer;
+
+/*!
+ * \brief A range of pre-synaptic neurons of a connection, generated by one task of SNN::connectNetwork
+ *
+ * The group layout a task needs (including the neuron locations tested against receptive fields) is prepared before
+ * the tasks are dispatched, so that workers do not access the (non thread-safe) config maps. The synapses of a task are stored in its own buffer.
+ * \since v4.0
+ */
+typedef struct ConnectionTask_s {
+	void* snn_pointer;
+	ConnectConfig* connConfig; //!< the connection, an element of SNN::localConnectLists or SNN::externalConnectLists
+	int netId;                 //!< the network the connection is generated for
+	int externalNetId;         //!< the network of the post-synaptic group of an external connection, -1 otherwise
+	int gPreStartN;            //!< first pre-synaptic neuron (global id) of the task
+	int gPreEndN;              //!< last pre-synaptic neuron (global id) of the task
+	int gSrcStartN;            //!< first neuron of the pre-synaptic group
+	int gDestStartN;           //!< first neuron of the post-synaptic group
+	int gDestEndN;             //!< last neuron of the post-synaptic group
+	Grid3D srcGrid;            //!< 3D grid of the pre-synaptic group
+	Grid3D destGrid;           //!< 3D grid of the post-synaptic group
+	bool isExcitatorySrc;      //!< whether the pre-synaptic group is excitatory (sign of the weights)
+	const Point3D* srcLocations;  //!< cached locations of the pre-synaptic neurons, NULL if the connection has no RF
+	const Point3D* destLocations; //!< cached locations of the post-synaptic neurons, NULL if the connection has no RF
+	ConnectionBuffer* connBuf; //!< the synapses generated by the task
+	int numberOfConnections;   //!< the number of synapses generated by the task
+} ConnectionTask;
+
 #endif
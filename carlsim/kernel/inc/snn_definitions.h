@@ -139,6 +139,24 @@
 #endif
 
 #define NUM_CPU_CORES sysconf(_SC_NPROCESSORS_ONLN)
+#define MIN_NEURONS_PER_CPU_THREAD 2048 // a CPU runtime is only split across worker threads above this size
+#define PARTITION_EXPECTED_FIRING_RATE 10.0f // mean firing rate (Hz) assumed by the partitioner to estimate spike traffic
+#define PARTITION_IMBALANCE_TOLERANCE 0.05f // the partitioner may exceed the average load of a partition by 5%
+
+// independent streams of the counter-based random number generator (see PhiloxRNG)
+#define RNG_STREAM_POISSON 1 // inter-spike intervals of Poisson neurons, counter: (global neuron id, simulation time, 0: spike / 1: rate change)
+#define RNG_STREAM_CONNECT 2 // connectivity and delays, counter: (global pre-neuron id, global post-neuron id, connId)
+
+#define POISSON_WHEEL_SIZE 1024 // number of 1 ms slots of the timing wheel that schedules Poisson neurons on CPU
+#define POISSON_NO_SPIKE 0xFFFFFFFFu // next spike time of a Poisson neuron that does not fire (zero rate)
+
+// template parameters of the neuron update kernels of CPU runtimes (see SNN::updateNeuronGroup_CPU)
+#define NEURON_MODEL_IZH4 0 // 4-param Izhikevich neuron
+#define NEURON_MODEL_IZH9 1 // 9-param Izhikevich neuron
+#define NEURON_MODEL_LIF 2 // LIF neuron
+#define COND_FLAG_COBA 1 // conductance-based synapses (CUBA if not set)
+#define COND_FLAG_NMDA_RISE 2 // NMDA conductance with rise time
+#define COND_FLAG_GABAB_RISE 4 // GABAb conductance with rise time
 
 #define GPU_RUNTIME_BASE 0
 
@@ -190,6 +208,10 @@
 #define GET_CONN_SYN_ID(val) (val.gsId & SYNAPSE_ID_MASK)
 #define GET_CONN_GRP_ID(val) ((val.gsId >> NUM_SYNAPSE_BITS) & GROUP_ID_MASK)
 
+// compact synapse ids of CPU runtimes (see CompactSynInfo)
+#define COMPACT_SYN_BLOCK_SIZE 32 // number of synapses that share the base neuron id of a block
+#define COMPACT_SYN_MAX_OFFSET 0xFFFF // maximum neuron id offset to the base of a block
+
 #define CONNECTION_INITWTS_RANDOM    	0
 #define CONNECTION_CONN_PRESENT  		1
 #define CONNECTION_FIXED_PLASTIC		2
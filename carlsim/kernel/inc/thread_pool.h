@@ -0,0 +1,131 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+
+/*!
+ * \brief Persistent pool of pinned worker threads for the CPU runtimes
+ *
+ * Each CPU runtime (netId >= CPU_RUNTIME_BASE) owns a long-lived worker thread that is pinned to a CPU core.
+ * Instead of spawning and joining a pthread per partition in every phase of a simulation step, SNN hands the static
+ * helper routines (SNN::helperFindFiring_CPU, etc.) to the worker of the partition via ThreadPool::dispatch and
+ * waits for all of them with ThreadPool::barrier. Tasks dispatched to the same worker are executed in FIFO order.
+ *
+ * The pool is only available on POSIX systems.
+ *
+ * \since v4.0
+ */
+class ThreadPool {
+public:
+	//! task routine, same signature as a pthread start routine
+	typedef void* (*TaskRoutine)(void*);
+
+	/*!
+	 * \brief ThreadPool Constructor
+	 *
+	 * Creates an empty pool. Workers are added one at a time via ThreadPool::startWorker.
+	 */
+	ThreadPool();
+
+	/*!
+	 * \brief ThreadPool Destructor
+	 *
+	 * Completes all pending tasks, then shuts down and joins all workers.
+	 */
+	~ThreadPool();
+
+	/*!
+	 * \brief Spawns a new worker thread
+	 *
+	 * \param[in] workerId slot of the new worker, must not be occupied yet
+	 * \param[in] cpuId CPU core the worker is pinned to (no pinning if negative)
+	 */
+	void startWorker(int workerId, int cpuId);
+
+	//! returns true if a worker is running in slot workerId
+	bool hasWorker(int workerId);
+
+	//! returns the number of running workers
+	int getNumWorkers();
+
+	/*!
+	 * \brief Queues a task at a worker
+	 *
+	 * The call returns immediately. The argument must stay valid until the next ThreadPool::barrier.
+	 * \param[in] workerId slot of the worker that executes the task
+	 * \param[in] routine task routine
+	 * \param[in] args argument passed to the task routine
+	 */
+	void dispatch(int workerId, TaskRoutine routine, void* args);
+
+	//! blocks until all dispatched tasks have completed
+	void barrier();
+
+	/*!
+	 * \brief Returns the time a worker has spent executing tasks
+	 *
+	 * The time is accumulated from the start of the worker or the last call to ThreadPool::resetBusyTime.
+	 * \param[in] workerId slot of the worker
+	 * \returns busy time in milliseconds (wall clock), 0 if there is no worker in this slot
+	 */
+	double getBusyTime(int workerId);
+
+	//! resets the busy time of all workers
+	void resetBusyTime();
+
+private:
+	// This class provides a pImpl for the pthread-based implementation.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+
+#endif
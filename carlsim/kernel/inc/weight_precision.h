@@ -0,0 +1,199 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _WEIGHT_PRECISION_H_
+#define _WEIGHT_PRECISION_H_
+
+#include <carlsim_datastructures.h> // WeightPrecision
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+
+// Conversion of synaptic weights between 32-bit floats and the reduced-precision formats of CPU runtimes (see
+// WeightPrecision). All conversions round to the nearest representable value (ties to even), values beyond the
+// range of a format saturate.
+
+// returns the number of bytes a weight occupies in a format
+inline
+int getWeightBytes(WeightPrecision precision) {
+	switch (precision) {
+	case WT_FP16:
+	case WT_BF16:
+		return 2;
+	case WT_INT8:
+		return 1;
+	case WT_FP32:
+	default:
+		return 4;
+	}
+}
+
+inline
+uint32_t floatToBits(float f) {
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+inline
+float bitsToFloat(uint32_t u) {
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+// IEEE 754 half precision: 1 sign bit, 5 exponent bits, 10 mantissa bits
+inline
+uint16_t floatToHalf(float f) {
+	uint32_t u = floatToBits(f);
+	uint16_t sign = (uint16_t)((u >> 16) & 0x8000);
+	uint32_t absU = u & 0x7fffffff;
+
+	if (absU >= 0x7f800000) // inf or NaN
+		return sign | 0x7c00 | (absU > 0x7f800000 ? 0x200 : 0);
+	if (absU >= 0x477ff000) // rounds to a value beyond 65504, saturate at the largest finite half
+		return sign | 0x7bff;
+	if (absU < 0x38800000) { // subnormal half (or zero)
+		// shift the mantissa with its implicit bit into place, rounding to nearest even
+		if (absU < 0x33000000)
+			return sign;
+		uint32_t mant = (absU & 0x007fffff) | 0x00800000;
+		int shift = 126 - (int)(absU >> 23);
+		uint32_t half = mant >> shift;
+		uint32_t rem = mant & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (rem > halfway || (rem == halfway && (half & 1)))
+			half++;
+		return sign | (uint16_t)half;
+	}
+
+	// normal half, rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits
+	uint32_t half = ((absU - 0x38000000) >> 13);
+	uint32_t rem = absU & 0x1fff;
+	if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+		half++;
+	return sign | (uint16_t)half;
+}
+
+inline
+float halfToFloat(uint16_t h) {
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exp = (h >> 10) & 0x1f;
+	uint32_t mant = h & 0x3ff;
+
+	if (exp == 0x1f) // inf or NaN
+		return bitsToFloat(sign | 0x7f800000 | (mant << 13));
+	if (exp == 0) { // zero or subnormal, the value is mant * 2^-24
+		float f = (float)mant * 5.9604644775390625e-8f;
+		return sign ? -f : f;
+	}
+	return bitsToFloat(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+// bfloat16: the upper 16 bits of a 32-bit float
+inline
+uint16_t floatToBFloat16(float f) {
+	uint32_t u = floatToBits(f);
+	if ((u & 0x7fffffff) > 0x7f800000) // NaN, keep it quiet
+		return (uint16_t)((u >> 16) | 0x40);
+	if ((u & 0x7f800000) != 0x7f800000) {
+		u += 0x7fff + ((u >> 16) & 1);
+		if ((u & 0x7f800000) == 0x7f800000) // rounded up to inf, saturate at the largest finite bfloat16
+			u -= 0x10000;
+	}
+	return (uint16_t)(u >> 16);
+}
+
+inline
+float bFloat16ToFloat(uint16_t b) {
+	return bitsToFloat((uint32_t)b << 16);
+}
+
+// signed 8-bit integer times a per-connection scale, codes are in [-127, 127]
+inline
+int8_t floatToInt8(float f, float scale) {
+	float q = f / scale;
+	if (!(q == q)) // NaN
+		return 0;
+	if (q >= 127.0f)
+		return 127;
+	if (q <= -127.0f)
+		return -127;
+	return (int8_t)lrintf(q);
+}
+
+inline
+float int8ToFloat(int8_t q, float scale) {
+	return (float)q * scale;
+}
+
+// rounds a weight to the nearest value that can be stored in a format, scale is only used by WT_INT8
+inline
+float roundWeight(float wt, WeightPrecision precision, float scale) {
+	switch (precision) {
+	case WT_FP16:
+		return halfToFloat(floatToHalf(wt));
+	case WT_BF16:
+		return bFloat16ToFloat(floatToBFloat16(wt));
+	case WT_INT8:
+		return int8ToFloat(floatToInt8(wt, scale), scale);
+	case WT_FP32:
+	default:
+		return wt;
+	}
+}
+
+// returns the scale of an int8 connection whose weights do not exceed maxAbsWt in magnitude
+inline
+float getInt8WeightScale(float maxAbsWt) {
+	return (maxAbsWt > 0.0f) ? maxAbsWt / 127.0f : 1.0f;
+}
+
+#endif
@@ -0,0 +1,411 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <checkpoint_writer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+
+// flushes a file to the disk
+static bool syncFile(FILE* fid) {
+	if (fflush(fid) != 0)
+		return false;
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	return fsync(fileno(fid)) == 0;
+#else
+	return true;
+#endif
+}
+
+// moves the file position to a byte offset, which may exceed 2 GB
+static bool seekFile(FILE* fid, uint64_t offset) {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	return fseeko(fid, (off_t)offset, SEEK_SET) == 0;
+#else
+	return _fseeki64(fid, (__int64)offset, SEEK_SET) == 0;
+#endif
+}
+
+static std::string getManifestName(const std::string& dirName) {
+	return dirName + "/checkpoint.hdr";
+}
+
+static std::string getDataName(const std::string& dirName, int slot) {
+	char fileName[32];
+	sprintf(fileName, "/checkpoint_%d.dat", slot);
+	return dirName + fileName;
+}
+
+// reads the manifest of a checkpoint directory
+static bool readManifest(const std::string& dirName, CheckpointHeader& header, std::vector<CheckpointArrayInfo>& arrays) {
+	FILE* fid = fopen(getManifestName(dirName).c_str(), "rb");
+	if (fid == NULL)
+		return false;
+
+	bool readOk = fread(&header, sizeof(CheckpointHeader), 1, fid) == 1
+		&& header.signature == CHECKPOINT_SIGNATURE && header.version == CHECKPOINT_VERSION
+		&& (header.slot == 0 || header.slot == 1) && header.numArrays >= 0;
+	if (readOk) {
+		arrays.resize(header.numArrays);
+		readOk = header.numArrays == 0
+			|| fread(&arrays[0], sizeof(CheckpointArrayInfo), header.numArrays, fid) == (size_t)header.numArrays;
+	}
+	fclose(fid);
+
+	for (int i = 0; i < header.numArrays && readOk; i++)
+		readOk = arrays[i].offset <= header.dataSize && arrays[i].size <= header.dataSize - arrays[i].offset;
+
+	return readOk;
+}
+
+
+class CheckpointWriter::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl(const std::string& dirName) : _dirName(dirName), _dataSize(0), _staging(NULL), _sequence(1),
+		_numCheckpoints(0), _bytesWritten(0), _pending(false), _failed(false), _shutdown(false), _pendingSimTime(0)
+	{
+		_slotValid[0] = _slotValid[1] = false;
+
+		// continue the sequence of the checkpoint in the directory, so that it is not overwritten by the first write
+		CheckpointHeader header;
+		std::vector<CheckpointArrayInfo> arrays;
+		if (readManifest(_dirName, header, arrays))
+			_sequence = header.sequence + 1;
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_cond, NULL);
+		_threadStarted = false;
+#endif
+	}
+
+	~Impl() {
+		wait();
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		if (_threadStarted) {
+			pthread_mutex_lock(&_mutex);
+			_shutdown = true;
+			pthread_cond_broadcast(&_cond);
+			pthread_mutex_unlock(&_mutex);
+			pthread_join(_thread, NULL);
+		}
+		pthread_cond_destroy(&_cond);
+		pthread_mutex_destroy(&_mutex);
+#endif
+
+		delete[] _staging;
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	size_t addArray(const std::string& name, int netId, size_t size) {
+		assert(_staging == NULL);
+		assert(name.length() < CHECKPOINT_NAME_LENGTH);
+
+		CheckpointArrayInfo info;
+		memset(&info, 0, sizeof(CheckpointArrayInfo));
+		strncpy(info.name, name.c_str(), CHECKPOINT_NAME_LENGTH - 1);
+		info.netId = netId;
+		info.offset = _dataSize;
+		info.size = size;
+		_arrays.push_back(info);
+
+		// keep every array 8-byte aligned in the staging buffer
+		_dataSize += (size + 7) & ~(size_t)7;
+
+		return (size_t)info.offset;
+	}
+
+	const std::vector<CheckpointArrayInfo>& getArrays() {
+		return _arrays;
+	}
+
+	bool beginCheckpoint() {
+		if (!wait())
+			return false;
+
+		if (_staging == NULL) {
+			_staging = new char[std::max(_dataSize, (size_t)1)];
+			memset(_staging, 0, _dataSize); // padding between arrays
+			size_t numChunks = (_dataSize + CHECKPOINT_CHUNK_SIZE - 1) / CHECKPOINT_CHUNK_SIZE;
+			for (int slot = 0; slot < 2; slot++)
+				_chunkChanged[slot].assign(numChunks, true);
+		}
+
+		return true;
+	}
+
+	void setArray(size_t index, const void* data) {
+		assert(_staging != NULL && index < _arrays.size());
+
+		// the staging buffer still holds the previous checkpoint, so the chunks that change are known right here
+		const char* src = (const char*)data;
+		size_t offset = (size_t)_arrays[index].offset;
+		size_t size = (size_t)_arrays[index].size;
+		while (size > 0) {
+			size_t chunk = offset / CHECKPOINT_CHUNK_SIZE;
+			size_t length = std::min(size, (chunk + 1) * CHECKPOINT_CHUNK_SIZE - offset);
+			if (memcmp(_staging + offset, src, length) != 0) {
+				memcpy(_staging + offset, src, length);
+				_chunkChanged[0][chunk] = _chunkChanged[1][chunk] = true;
+			}
+			offset += length;
+			src += length;
+			size -= length;
+		}
+	}
+
+	void commitCheckpoint(int simTime) {
+		assert(_staging != NULL);
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		if (!_threadStarted) {
+			if (pthread_create(&_thread, NULL, &Impl::writerRoutine, (void*)this) != 0) {
+				fprintf(stderr, "CheckpointWriter: could not create writer thread\n");
+				exit(EXIT_FAILURE);
+			}
+			_threadStarted = true;
+		}
+
+		pthread_mutex_lock(&_mutex);
+		assert(!_pending);
+		_pendingSimTime = simTime;
+		_pending = true;
+		pthread_cond_broadcast(&_cond);
+		pthread_mutex_unlock(&_mutex);
+#else
+		if (!writeCheckpoint(simTime))
+			_failed = true;
+#endif
+	}
+
+	bool wait() {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+		while (_pending)
+			pthread_cond_wait(&_cond, &_mutex);
+		bool ok = !_failed;
+		pthread_mutex_unlock(&_mutex);
+		return ok;
+#else
+		return !_failed;
+#endif
+	}
+
+	int getNumCheckpoints() {
+		wait();
+		return _numCheckpoints;
+	}
+
+	uint64_t getBytesWritten() {
+		wait();
+		return _bytesWritten;
+	}
+
+private:
+	// writes the staging buffer to the data file of the next slot, then replaces the manifest
+	bool writeCheckpoint(int simTime) {
+		int slot = _sequence % 2;
+		std::string dataName = getDataName(_dirName, slot);
+
+		// the first write of this writer to a slot rewrites the whole file
+		FILE* fid = fopen(dataName.c_str(), _slotValid[slot] ? "r+b" : "wb");
+		if (fid == NULL)
+			return false;
+
+		bool writeOk = true;
+		for (size_t offset = 0; offset < _dataSize && writeOk; offset += CHECKPOINT_CHUNK_SIZE) {
+			size_t chunk = offset / CHECKPOINT_CHUNK_SIZE;
+			size_t size = std::min((size_t)CHECKPOINT_CHUNK_SIZE, _dataSize - offset);
+			if (_slotValid[slot] && !_chunkChanged[slot][chunk])
+				continue;
+
+			writeOk = seekFile(fid, offset) && fwrite(_staging + offset, 1, size, fid) == size;
+			_chunkChanged[slot][chunk] = false;
+			_bytesWritten += size;
+		}
+		writeOk = syncFile(fid) && writeOk;
+		fclose(fid);
+
+		if (!writeOk) {
+			_slotValid[slot] = false;
+			return false;
+		}
+		_slotValid[slot] = true;
+
+		// the new manifest only becomes visible once it is complete
+		CheckpointHeader header;
+		memset(&header, 0, sizeof(CheckpointHeader));
+		header.signature = CHECKPOINT_SIGNATURE;
+		header.version = CHECKPOINT_VERSION;
+		header.sequence = _sequence;
+		header.slot = slot;
+		header.simTime = simTime;
+		header.numArrays = (int32_t)_arrays.size();
+		header.dataSize = _dataSize;
+		header.chunkSize = CHECKPOINT_CHUNK_SIZE;
+
+		std::string manifestName = getManifestName(_dirName);
+		std::string tmpName = manifestName + ".tmp";
+		fid = fopen(tmpName.c_str(), "wb");
+		if (fid == NULL)
+			return false;
+		writeOk = fwrite(&header, sizeof(CheckpointHeader), 1, fid) == 1
+			&& (_arrays.empty() || fwrite(&_arrays[0], sizeof(CheckpointArrayInfo), _arrays.size(), fid) == _arrays.size());
+		writeOk = syncFile(fid) && writeOk;
+		fclose(fid);
+
+#if defined(WIN32) || defined(WIN64)
+		remove(manifestName.c_str()); // rename does not replace existing files
+#endif
+		if (!writeOk || rename(tmpName.c_str(), manifestName.c_str()) != 0)
+			return false;
+
+		_sequence++;
+		_numCheckpoints++;
+		return true;
+	}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// main loop of the writer thread: sleep until a checkpoint is committed, write it, report back
+	static void* writerRoutine(void* arguments) {
+		Impl* w = (Impl*)arguments;
+
+		pthread_mutex_lock(&w->_mutex);
+		while (true) {
+			while (!w->_pending && !w->_shutdown)
+				pthread_cond_wait(&w->_cond, &w->_mutex);
+
+			if (!w->_pending) // shutdown and nothing left to do
+				break;
+
+			int simTime = w->_pendingSimTime;
+			pthread_mutex_unlock(&w->_mutex);
+			bool writeOk = w->writeCheckpoint(simTime);
+			pthread_mutex_lock(&w->_mutex);
+
+			if (!writeOk)
+				w->_failed = true;
+			w->_pending = false;
+			pthread_cond_broadcast(&w->_cond);
+		}
+		pthread_mutex_unlock(&w->_mutex);
+
+		return NULL;
+	}
+
+	pthread_t _thread;
+	pthread_mutex_t _mutex; //!< protects _pending, _failed, _shutdown
+	pthread_cond_t _cond;   //!< signaled when a checkpoint is committed or written, or the writer shuts down
+	bool _threadStarted;
+#endif
+
+	std::string _dirName;
+	std::vector<CheckpointArrayInfo> _arrays;
+	size_t _dataSize;      //!< size of the staging buffer and the data files
+	char* _staging;        //!< owned by the writer thread while a checkpoint is pending
+	std::vector<bool> _chunkChanged[2]; //!< chunks that changed since the data file was last written
+	bool _slotValid[2];    //!< whether the data file was completely written by this writer
+	int _sequence;         //!< sequence number of the next checkpoint
+	int _numCheckpoints;
+	uint64_t _bytesWritten;
+	bool _pending;         //!< a committed checkpoint has not been written yet
+	bool _failed;          //!< writing a checkpoint failed
+	bool _shutdown;
+	int _pendingSimTime;
+};
+
+
+// ****************************************************************************************************************** //
+// CHECKPOINTWRITER API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+// constructor / destructor
+CheckpointWriter::CheckpointWriter(const std::string& dirName) : _impl( new Impl(dirName) ) {}
+CheckpointWriter::~CheckpointWriter() { delete _impl; }
+
+// public methods
+size_t CheckpointWriter::addArray(const std::string& name, int netId, size_t size) {
+	return _impl->addArray(name, netId, size);
+}
+const std::vector<CheckpointArrayInfo>& CheckpointWriter::getArrays() { return _impl->getArrays(); }
+bool CheckpointWriter::beginCheckpoint() { return _impl->beginCheckpoint(); }
+void CheckpointWriter::setArray(size_t index, const void* data) { _impl->setArray(index, data); }
+void CheckpointWriter::commitCheckpoint(int simTime) { _impl->commitCheckpoint(simTime); }
+bool CheckpointWriter::wait() { return _impl->wait(); }
+int CheckpointWriter::getNumCheckpoints() { return _impl->getNumCheckpoints(); }
+uint64_t CheckpointWriter::getBytesWritten() { return _impl->getBytesWritten(); }
+
+bool CheckpointWriter::read(const std::string& dirName, CheckpointHeader& header,
+	std::vector<CheckpointArrayInfo>& arrays, std::vector<char>& data)
+{
+	if (!readManifest(dirName, header, arrays))
+		return false;
+
+	FILE* fid = fopen(getDataName(dirName, header.slot).c_str(), "rb");
+	if (fid == NULL)
+		return false;
+
+	data.resize(header.dataSize);
+	bool readOk = header.dataSize == 0 || fread(&data[0], 1, header.dataSize, fid) == header.dataSize;
+	fclose(fid);
+
+	return readOk;
+}
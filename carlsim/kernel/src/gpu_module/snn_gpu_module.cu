@@ -1428,7 +1428,7 @@ __global__ void kernel_updateWeights() {
 __global__ void kernel_shiftFiringTable() {
 	int gnthreads = blockDim.x * gridDim.x;
 
-	for(int p = timeTableD2GPU[999], k = 0; p < timeTableD2GPU[999 + networkConfigGPU.maxDelay + 1]; p += gnthreads, k += gnthreads) {
+	for(int p = timeTableD2GPU[1000], k = 0; p < timeTableD2GPU[999 + networkConfigGPU.maxDelay + 1]; p += gnthreads, k += gnthreads) {
 		if ((p + threadIdx.x) < timeTableD2GPU[999 + networkConfigGPU.maxDelay + 1])
 			runtimeDataGPU.firingTableD2[k + threadIdx.x] = runtimeDataGPU.firingTableD2[p + threadIdx.x];
 	}
@@ -2836,6 +2836,15 @@ void SNN::copyLastSpikeTime(int netId, cudaMemcpyKind kind) {
 	CUDA_CHECK_ERRORS(cudaMemcpy(managerRuntimeData.lastSpikeTime, runtimeData[netId].lastSpikeTime, sizeof(int) *  networkConfigs[netId].numN, cudaMemcpyDeviceToHost));
 }
 
+void SNN::copyNeuronVariables(int netId, cudaMemcpyKind kind) {
+	checkAndSetGPUDevice(netId);
+	checkDestSrcPtrs(&managerRuntimeData, &runtimeData[netId], cudaMemcpyDeviceToHost, false, ALL, 0); // check that the destination pointer is properly allocated..
+	assert(kind == cudaMemcpyDeviceToHost);
+
+	CUDA_CHECK_ERRORS(cudaMemcpy(managerRuntimeData.voltage, runtimeData[netId].voltage, sizeof(float) * networkConfigs[netId].numNReg, cudaMemcpyDeviceToHost));
+	CUDA_CHECK_ERRORS(cudaMemcpy(managerRuntimeData.recovery, runtimeData[netId].recovery, sizeof(float) * networkConfigs[netId].numNReg, cudaMemcpyDeviceToHost));
+}
+
 // spikeGeneratorUpdate on GPUs..
 void SNN::spikeGeneratorUpdate_GPU(int netId) {
 	assert(runtimeData[netId].allocated);
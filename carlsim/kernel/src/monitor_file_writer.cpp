@@ -0,0 +1,292 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <monitor_file_writer.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+#include <pthread.h>
+#endif
+
+
+class MonitorFileWriter::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl() : _lastFid(NULL), _lastBuffer(NULL), _pendingBytes(0), _bytesWritten(0), _writing(false), _failed(false),
+		_shutdown(false)
+	{
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_cond, NULL);
+		_threadStarted = false;
+#endif
+	}
+
+	~Impl() {
+		sync();
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		if (_threadStarted) {
+			pthread_mutex_lock(&_mutex);
+			_shutdown = true;
+			pthread_cond_broadcast(&_cond);
+			pthread_mutex_unlock(&_mutex);
+			pthread_join(_thread, NULL);
+		}
+		pthread_cond_destroy(&_cond);
+		pthread_mutex_destroy(&_mutex);
+#endif
+
+		for (size_t i = 0; i < _freeBuffers.size(); i++)
+			delete _freeBuffers[i];
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	void write(FILE* fid, const void* data, size_t size) {
+		assert(fid != NULL);
+
+		// the monitors write many small records to the same file in a row
+		if (fid != _lastFid) {
+			std::vector<char>*& buffer = _buffers[fid];
+			if (buffer == NULL)
+				buffer = newBuffer();
+			_lastFid = fid;
+			_lastBuffer = buffer;
+		}
+
+		const char* bytes = (const char*)data;
+		_lastBuffer->insert(_lastBuffer->end(), bytes, bytes + size);
+		if (_lastBuffer->size() >= MONITOR_WRITER_BLOCK_SIZE)
+			handOver(fid, false);
+	}
+
+	void flush(FILE* fid) {
+		assert(fid != NULL);
+		handOver(fid, true);
+	}
+
+	bool sync() {
+		for (std::map<FILE*, std::vector<char>*>::iterator it = _buffers.begin(); it != _buffers.end(); it++) {
+			if (!it->second->empty())
+				handOver(it->first, true);
+		}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+		while (!_queue.empty() || _writing)
+			pthread_cond_wait(&_cond, &_mutex);
+#endif
+
+		// the files might be closed after the sync, so forget their buffers (the writer thread also returns its
+		// buffers to _freeBuffers, so this must hold the lock)
+		for (std::map<FILE*, std::vector<char>*>::iterator it = _buffers.begin(); it != _buffers.end(); it++)
+			_freeBuffers.push_back(it->second);
+		_buffers.clear();
+		_lastFid = NULL;
+		_lastBuffer = NULL;
+
+		bool ok = !_failed;
+		_failed = false;
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_unlock(&_mutex);
+#endif
+		return ok;
+	}
+
+	size_t getBytesWritten() {
+		sync();
+		return _bytesWritten;
+	}
+
+private:
+	//! a write buffer handed over to the background thread
+	struct Block {
+		FILE* fid;
+		std::vector<char>* data;
+		bool flush; //!< whether to fflush the file after the block
+	};
+
+	// returns an empty buffer, reusing the buffers of the blocks already written
+	std::vector<char>* newBuffer() {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+#endif
+		std::vector<char>* buffer = NULL;
+		if (!_freeBuffers.empty()) {
+			buffer = _freeBuffers.back();
+			_freeBuffers.pop_back();
+		}
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_unlock(&_mutex);
+#endif
+
+		if (buffer == NULL) {
+			buffer = new std::vector<char>;
+			buffer->reserve(MONITOR_WRITER_BLOCK_SIZE + 64);
+		}
+		return buffer;
+	}
+
+	// hands the buffer of a file over to the background thread, and gives the file a new buffer
+	void handOver(FILE* fid, bool flush) {
+		std::vector<char>*& buffer = _buffers[fid];
+		if (buffer == NULL)
+			buffer = newBuffer();
+
+		Block block;
+		block.fid = fid;
+		block.data = buffer;
+		block.flush = flush;
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		if (!_threadStarted) {
+			if (pthread_create(&_thread, NULL, &Impl::writerRoutine, (void*)this) != 0) {
+				fprintf(stderr, "MonitorFileWriter: could not create writer thread\n");
+				exit(EXIT_FAILURE);
+			}
+			_threadStarted = true;
+		}
+
+		pthread_mutex_lock(&_mutex);
+		// backpressure: wait until the writer thread caught up (a single block larger than the limit is accepted)
+		while (_pendingBytes > 0 && _pendingBytes + block.data->size() > MONITOR_WRITER_MAX_PENDING)
+			pthread_cond_wait(&_cond, &_mutex);
+		_pendingBytes += block.data->size();
+		_queue.push_back(block);
+		pthread_cond_broadcast(&_cond);
+		pthread_mutex_unlock(&_mutex);
+
+		buffer = newBuffer();
+#else
+		writeBlock(block);
+		block.data->clear();
+#endif
+		if (_lastFid == fid)
+			_lastBuffer = buffer;
+	}
+
+	// writes a block to its file
+	void writeBlock(const Block& block) {
+		size_t size = block.data->size();
+		if (size > 0 && fwrite(&(*block.data)[0], 1, size, block.fid) != size)
+			_failed = true;
+		if (block.flush && fflush(block.fid) != 0)
+			_failed = true;
+		_bytesWritten += size;
+	}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// routine of the background thread: writes the blocks in the order they were handed over
+	static void* writerRoutine(void* arg) {
+		Impl* impl = (Impl*)arg;
+
+		pthread_mutex_lock(&impl->_mutex);
+		while (true) {
+			while (impl->_queue.empty() && !impl->_shutdown)
+				pthread_cond_wait(&impl->_cond, &impl->_mutex);
+			if (impl->_queue.empty())
+				break; // shut down
+
+			Block block = impl->_queue.front();
+			impl->_queue.pop_front();
+			impl->_writing = true;
+			pthread_mutex_unlock(&impl->_mutex);
+
+			size_t size = block.data->size();
+			impl->writeBlock(block);
+			block.data->clear();
+
+			pthread_mutex_lock(&impl->_mutex);
+			impl->_pendingBytes -= size;
+			impl->_freeBuffers.push_back(block.data);
+			impl->_writing = false;
+			pthread_cond_broadcast(&impl->_cond);
+		}
+		pthread_mutex_unlock(&impl->_mutex);
+
+		return NULL;
+	}
+
+	pthread_t _thread;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	bool _threadStarted;
+#endif
+
+	std::map<FILE*, std::vector<char>*> _buffers;  //!< write buffer of every file, filled by the simulation
+	FILE* _lastFid;                                //!< file of the last write (fast path)
+	std::vector<char>* _lastBuffer;                //!< write buffer of _lastFid
+	std::deque<Block> _queue;                      //!< blocks handed over to the writer thread
+	std::vector< std::vector<char>* > _freeBuffers; //!< buffers of written blocks, to be reused
+	size_t _pendingBytes; //!< size of the blocks in the queue and being written
+	size_t _bytesWritten; //!< bytes written by the writer thread
+	bool _writing;        //!< whether the writer thread is writing a block
+	bool _failed;         //!< whether writing a block failed since the last sync
+	bool _shutdown;       //!< set to stop the writer thread
+};
+
+
+// ****************************************************************************************************************** //
+// MONITORFILEWRITER API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+MonitorFileWriter::MonitorFileWriter() : _impl( new Impl() ) {}
+MonitorFileWriter::~MonitorFileWriter() { delete _impl; }
+
+void MonitorFileWriter::write(FILE* fid, const void* data, size_t size) { _impl->write(fid, data, size); }
+void MonitorFileWriter::flush(FILE* fid) { _impl->flush(fid); }
+bool MonitorFileWriter::sync() { return _impl->sync(); }
+size_t MonitorFileWriter::getBytesWritten() { return _impl->getBytesWritten(); }
@@ -0,0 +1,356 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <neuron_simd.h>
+
+#include <cstddef> // NULL
+
+// the SIMD kernels rely on GCC's target pragmas and x86 intrinsics, other compilers only get the scalar code
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+	#define NEURON_SIMD_X86
+	#include <immintrin.h>
+#endif
+
+
+// +++++ SCALAR KERNELS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+// these are used for SIMD_NONE and for the remainder of a range that does not fill a whole SIMD vector
+
+static void conductanceCurrentScalar(int n, const float* volt, const float* gAMPA, const float* gNMDA,
+	const float* gNMDA_r, const float* gGABAa, const float* gGABAb, const float* gGABAb_r, float* I_sum)
+{
+	for (int i = 0; i < n; i++) {
+		float g_NMDA = (gNMDA_r != NULL) ? (gNMDA[i] - gNMDA_r[i]) : gNMDA[i];
+		float g_GABAb = (gGABAb_r != NULL) ? (gGABAb[i] - gGABAb_r[i]) : gGABAb[i];
+		I_sum[i] = currentCOBA(volt[i], gAMPA[i], g_NMDA, gGABAa[i], g_GABAb);
+	}
+}
+
+template<bool model9, bool rk4>
+static void updateIzhikevichScalar(int n, const IzhParams& p, float timeStep, const float* volt, float* nextVolt,
+	float* recov, const float* totalCurrent, bool* curSpike)
+{
+	float vpeak = model9 ? p.vpeak : 30.0f;
+	for (int i = 0; i < n; i++) {
+		float v = volt[i];
+		float u = recov[i];
+		float I = totalCurrent[i];
+		float v_next, du = 0.0f;
+
+		if (!rk4) {
+			v_next = v + (model9 ? dvdtIzhikevich9(v, u, p.inverse_C, p.k, p.vr, p.vt, I, timeStep)
+				: dvdtIzhikevich4(v, u, I, timeStep));
+		} else if (!model9) {
+			float k1 = dvdtIzhikevich4(v, u, I, timeStep);
+			float l1 = dudtIzhikevich4(v, u, p.a, p.b, timeStep);
+			float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, I, timeStep);
+			float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, p.a, p.b, timeStep);
+			float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, I, timeStep);
+			float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, p.a, p.b, timeStep);
+			float k4 = dvdtIzhikevich4(v + k3, u + l3, I, timeStep);
+			float l4 = dudtIzhikevich4(v + k3, u + l3, p.a, p.b, timeStep);
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			du = (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		} else {
+			float k1 = dvdtIzhikevich9(v, u, p.inverse_C, p.k, p.vr, p.vt, I, timeStep);
+			float l1 = dudtIzhikevich9(v, u, p.vr, p.a, p.b, timeStep);
+			float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, p.inverse_C, p.k, p.vr, p.vt, I, timeStep);
+			float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, p.vr, p.a, p.b, timeStep);
+			float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, p.inverse_C, p.k, p.vr, p.vt, I, timeStep);
+			float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, p.vr, p.a, p.b, timeStep);
+			float k4 = dvdtIzhikevich9(v + k3, u + l3, p.inverse_C, p.k, p.vr, p.vt, I, timeStep);
+			float l4 = dudtIzhikevich9(v + k3, u + l3, p.vr, p.a, p.b, timeStep);
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			du = (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+
+		if (v_next > vpeak) {
+			curSpike[i] = true;
+			v_next = p.c;
+			u += p.d;
+		}
+		if (v_next < -90.0f) v_next = -90.0f;
+
+		if (!rk4)
+			u += model9 ? dudtIzhikevich9(v_next, u, p.vr, p.a, p.b, timeStep) : dudtIzhikevich4(v_next, u, p.a, p.b, timeStep);
+		else
+			u += du;
+
+		nextVolt[i] = v_next;
+		recov[i] = u;
+	}
+}
+
+static void updateLIFScalar(int n, const LIFParams& p, float timeStep, bool lastIter, const float* volt,
+	float* nextVolt, int* refCount, const float* totalCurrent, bool* curSpike)
+{
+	for (int i = 0; i < n; i++) {
+		float v_next = nextVolt[i];
+		if (refCount[i] > 0) {
+			if (lastIter) {
+				refCount[i] -= 1;
+				v_next = p.vReset;
+			}
+		} else if (v_next > p.vTh) {
+			curSpike[i] = true;
+			v_next = p.vReset;
+			refCount[i] = lastIter ? p.tau_ref : p.tau_ref + 1;
+		} else {
+			v_next = volt[i] + dvdtLIF(volt[i], p.vReset, p.gain, p.bias, p.tau_m, totalCurrent[i], timeStep);
+		}
+		if (v_next < p.vReset) v_next = p.vReset;
+		nextVolt[i] = v_next;
+	}
+}
+
+
+// +++++ SIMD KERNELS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+// Each instruction set gets its own copy of the kernels in neuron_simd_kernels.h, compiled for that instruction set
+// only. fp-contract=off keeps the compiler from fusing multiplies and adds, which would round differently than the
+// scalar code.
+
+#ifdef NEURON_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+#pragma GCC optimize("fp-contract=off")
+namespace simd_sse42 {
+	typedef __m128 vfloat;
+	typedef __m128 vmask;
+	static const int SIMD_WIDTH = 4;
+
+	static inline vfloat vset1(float x) { return _mm_set1_ps(x); }
+	static inline vfloat vload(const float* p) { return _mm_loadu_ps(p); }
+	static inline void vstore(float* p, vfloat x) { _mm_storeu_ps(p, x); }
+	static inline vfloat vloadint(const int* p) { return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p)); }
+	static inline void vstoreint(int* p, vfloat x) { _mm_storeu_si128((__m128i*)p, _mm_cvtps_epi32(x)); }
+	static inline vfloat vadd(vfloat x, vfloat y) { return _mm_add_ps(x, y); }
+	static inline vfloat vsub(vfloat x, vfloat y) { return _mm_sub_ps(x, y); }
+	static inline vfloat vmul(vfloat x, vfloat y) { return _mm_mul_ps(x, y); }
+	static inline vfloat vdiv(vfloat x, vfloat y) { return _mm_div_ps(x, y); }
+	static inline vmask vcmpgt(vfloat x, vfloat y) { return _mm_cmpgt_ps(x, y); }
+	static inline vmask vcmplt(vfloat x, vfloat y) { return _mm_cmplt_ps(x, y); }
+	static inline vfloat vblend(vmask m, vfloat x, vfloat y) { return _mm_blendv_ps(x, y, m); } // y where m is set
+	static inline vmask vmaskandnot(vmask m1, vmask m2) { return _mm_andnot_ps(m1, m2); } // ~m1 & m2
+	static inline unsigned int vmaskbits(vmask m) { return (unsigned int)_mm_movemask_ps(m); }
+
+	#include "neuron_simd_kernels.h"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+namespace simd_avx2 {
+	typedef __m256 vfloat;
+	typedef __m256 vmask;
+	static const int SIMD_WIDTH = 8;
+
+	static inline vfloat vset1(float x) { return _mm256_set1_ps(x); }
+	static inline vfloat vload(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void vstore(float* p, vfloat x) { _mm256_storeu_ps(p, x); }
+	static inline vfloat vloadint(const int* p) { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+	static inline void vstoreint(int* p, vfloat x) { _mm256_storeu_si256((__m256i*)p, _mm256_cvtps_epi32(x)); }
+	static inline vfloat vadd(vfloat x, vfloat y) { return _mm256_add_ps(x, y); }
+	static inline vfloat vsub(vfloat x, vfloat y) { return _mm256_sub_ps(x, y); }
+	static inline vfloat vmul(vfloat x, vfloat y) { return _mm256_mul_ps(x, y); }
+	static inline vfloat vdiv(vfloat x, vfloat y) { return _mm256_div_ps(x, y); }
+	static inline vmask vcmpgt(vfloat x, vfloat y) { return _mm256_cmp_ps(x, y, _CMP_GT_OQ); }
+	static inline vmask vcmplt(vfloat x, vfloat y) { return _mm256_cmp_ps(x, y, _CMP_LT_OQ); }
+	static inline vfloat vblend(vmask m, vfloat x, vfloat y) { return _mm256_blendv_ps(x, y, m); } // y where m is set
+	static inline vmask vmaskandnot(vmask m1, vmask m2) { return _mm256_andnot_ps(m1, m2); } // ~m1 & m2
+	static inline unsigned int vmaskbits(vmask m) { return (unsigned int)_mm256_movemask_ps(m); }
+
+	#include "neuron_simd_kernels.h"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+namespace simd_avx512 {
+	typedef __m512 vfloat;
+	typedef __mmask16 vmask;
+	static const int SIMD_WIDTH = 16;
+
+	static inline vfloat vset1(float x) { return _mm512_set1_ps(x); }
+	static inline vfloat vload(const float* p) { return _mm512_loadu_ps(p); }
+	static inline void vstore(float* p, vfloat x) { _mm512_storeu_ps(p, x); }
+	// the maskz variants avoid _mm512_undefined, which makes GCC warn about uninitialized values
+	static inline vfloat vloadint(const int* p) { return _mm512_maskz_cvtepi32_ps(0xFFFF, _mm512_loadu_si512(p)); }
+	static inline void vstoreint(int* p, vfloat x) { _mm512_storeu_si512(p, _mm512_maskz_cvtps_epi32(0xFFFF, x)); }
+	static inline vfloat vadd(vfloat x, vfloat y) { return _mm512_add_ps(x, y); }
+	static inline vfloat vsub(vfloat x, vfloat y) { return _mm512_sub_ps(x, y); }
+	static inline vfloat vmul(vfloat x, vfloat y) { return _mm512_mul_ps(x, y); }
+	static inline vfloat vdiv(vfloat x, vfloat y) { return _mm512_div_ps(x, y); }
+	static inline vmask vcmpgt(vfloat x, vfloat y) { return _mm512_cmp_ps_mask(x, y, _CMP_GT_OQ); }
+	static inline vmask vcmplt(vfloat x, vfloat y) { return _mm512_cmp_ps_mask(x, y, _CMP_LT_OQ); }
+	static inline vfloat vblend(vmask m, vfloat x, vfloat y) { return _mm512_mask_blend_ps(m, x, y); } // y where m is set
+	static inline vmask vmaskandnot(vmask m1, vmask m2) { return (vmask)(~m1 & m2); }
+	static inline unsigned int vmaskbits(vmask m) { return (unsigned int)m; }
+
+	#include "neuron_simd_kernels.h"
+}
+#pragma GCC pop_options
+
+#endif // NEURON_SIMD_X86
+
+
+// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+SimdLevel NeuronSimd::getSupportedLevel() {
+#ifdef NEURON_SIMD_X86
+	static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SIMD_AVX512
+		: (__builtin_cpu_supports("avx2") ? SIMD_AVX2
+		: (__builtin_cpu_supports("sse4.2") ? SIMD_SSE42 : SIMD_NONE));
+	return level;
+#else
+	return SIMD_NONE;
+#endif
+}
+
+const char* NeuronSimd::getLevelName(SimdLevel level) {
+	switch (level) {
+	case SIMD_SSE42: return "SSE4.2";
+	case SIMD_AVX2: return "AVX2";
+	case SIMD_AVX512: return "AVX-512";
+	default: return "scalar";
+	}
+}
+
+int NeuronSimd::getWidth(SimdLevel level) {
+	switch (level) {
+	case SIMD_SSE42: return 4;
+	case SIMD_AVX2: return 8;
+	case SIMD_AVX512: return 16;
+	default: return 1;
+	}
+}
+
+void NeuronSimd::conductanceCurrent(SimdLevel level, int n, const float* volt, const float* gAMPA,
+	const float* gNMDA, const float* gNMDA_r, const float* gGABAa, const float* gGABAb, const float* gGABAb_r,
+	float* I_sum)
+{
+	switch (level) {
+#ifdef NEURON_SIMD_X86
+	case SIMD_SSE42:
+		simd_sse42::conductanceCurrentSimd(n, volt, gAMPA, gNMDA, gNMDA_r, gGABAa, gGABAb, gGABAb_r, I_sum);
+		break;
+	case SIMD_AVX2:
+		simd_avx2::conductanceCurrentSimd(n, volt, gAMPA, gNMDA, gNMDA_r, gGABAa, gGABAb, gGABAb_r, I_sum);
+		break;
+	case SIMD_AVX512:
+		simd_avx512::conductanceCurrentSimd(n, volt, gAMPA, gNMDA, gNMDA_r, gGABAa, gGABAb, gGABAb_r, I_sum);
+		break;
+#endif
+	default:
+		conductanceCurrentScalar(n, volt, gAMPA, gNMDA, gNMDA_r, gGABAa, gGABAb, gGABAb_r, I_sum);
+		break;
+	}
+}
+
+// dispatches an Izhikevich kernel with fixed model and integration method to the given level
+template<bool model9, bool rk4>
+static void updateIzhikevichLevel(SimdLevel level, int n, const IzhParams& p, float timeStep, const float* volt,
+	float* nextVolt, float* recov, const float* totalCurrent, bool* curSpike)
+{
+	switch (level) {
+#ifdef NEURON_SIMD_X86
+	case SIMD_SSE42:
+		simd_sse42::updateIzhikevichSimd<model9, rk4>(n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		break;
+	case SIMD_AVX2:
+		simd_avx2::updateIzhikevichSimd<model9, rk4>(n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		break;
+	case SIMD_AVX512:
+		simd_avx512::updateIzhikevichSimd<model9, rk4>(n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		break;
+#endif
+	default:
+		updateIzhikevichScalar<model9, rk4>(n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		break;
+	}
+}
+
+void NeuronSimd::updateIzhikevich(SimdLevel level, bool withParamModel_9, integrationMethod_t method, int n,
+	const IzhParams& p, float timeStep, const float* volt, float* nextVolt, float* recov, const float* totalCurrent,
+	bool* curSpike)
+{
+	if (withParamModel_9) {
+		if (method == RUNGE_KUTTA4)
+			updateIzhikevichLevel<true, true>(level, n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		else
+			updateIzhikevichLevel<true, false>(level, n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+	} else {
+		if (method == RUNGE_KUTTA4)
+			updateIzhikevichLevel<false, true>(level, n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+		else
+			updateIzhikevichLevel<false, false>(level, n, p, timeStep, volt, nextVolt, recov, totalCurrent, curSpike);
+	}
+}
+
+void NeuronSimd::updateLIF(SimdLevel level, int n, const LIFParams& p, float timeStep, bool lastIter,
+	const float* volt, float* nextVolt, int* refCount, const float* totalCurrent, bool* curSpike)
+{
+	switch (level) {
+#ifdef NEURON_SIMD_X86
+	case SIMD_SSE42:
+		simd_sse42::updateLIFSimd(n, p, timeStep, lastIter, volt, nextVolt, refCount, totalCurrent, curSpike);
+		break;
+	case SIMD_AVX2:
+		simd_avx2::updateLIFSimd(n, p, timeStep, lastIter, volt, nextVolt, refCount, totalCurrent, curSpike);
+		break;
+	case SIMD_AVX512:
+		simd_avx512::updateLIFSimd(n, p, timeStep, lastIter, volt, nextVolt, refCount, totalCurrent, curSpike);
+		break;
+#endif
+	default:
+		updateLIFScalar(n, p, timeStep, lastIter, volt, nextVolt, refCount, totalCurrent, curSpike);
+		break;
+	}
+}
@@ -0,0 +1,224 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+// SIMD kernel bodies of NeuronSimd, included by neuron_simd.cpp once per instruction set.
+//
+// The including namespace provides the vector type vfloat, the mask type vmask, SIMD_WIDTH and the wrappers vset1,
+// vload, vstore, vloadint, vstoreint, vadd, vsub, vmul, vdiv, vcmpgt, vcmplt, vblend, vmaskandnot and vmaskbits.
+// Each function mirrors the operation order of its scalar counterpart in neuron_simd.h.
+
+static inline vfloat vdvdtIzhikevich4(vfloat volt, vfloat recov, vfloat totalCurrent, vfloat timeStep) {
+	vfloat x = vadd(vmul(vset1(0.04f), volt), vset1(5.0f));
+	x = vadd(vmul(x, volt), vset1(140.0f));
+	return vmul(vadd(vsub(x, recov), totalCurrent), timeStep);
+}
+
+static inline vfloat vdudtIzhikevich4(vfloat volt, vfloat recov, vfloat izhA, vfloat izhB, vfloat timeStep) {
+	return vmul(vmul(izhA, vsub(vmul(izhB, volt), recov)), timeStep);
+}
+
+static inline vfloat vdvdtIzhikevich9(vfloat volt, vfloat recov, vfloat invCapac, vfloat izhK, vfloat voltRest,
+	vfloat voltInst, vfloat totalCurrent, vfloat timeStep)
+{
+	vfloat x = vmul(vmul(izhK, vsub(volt, voltRest)), vsub(volt, voltInst));
+	return vmul(vmul(vadd(vsub(x, recov), totalCurrent), invCapac), timeStep);
+}
+
+static inline vfloat vdudtIzhikevich9(vfloat volt, vfloat recov, vfloat voltRest, vfloat izhA, vfloat izhB,
+	vfloat timeStep)
+{
+	return vmul(vmul(izhA, vsub(vmul(izhB, vsub(volt, voltRest)), recov)), timeStep);
+}
+
+template<bool model9>
+static inline vfloat vdvdtIzhikevich(vfloat volt, vfloat recov, vfloat totalCurrent, vfloat invCapac, vfloat izhK,
+	vfloat voltRest, vfloat voltInst, vfloat timeStep)
+{
+	if (model9)
+		return vdvdtIzhikevich9(volt, recov, invCapac, izhK, voltRest, voltInst, totalCurrent, timeStep);
+	else
+		return vdvdtIzhikevich4(volt, recov, totalCurrent, timeStep);
+}
+
+template<bool model9>
+static inline vfloat vdudtIzhikevich(vfloat volt, vfloat recov, vfloat voltRest, vfloat izhA, vfloat izhB,
+	vfloat timeStep)
+{
+	if (model9)
+		return vdudtIzhikevich9(volt, recov, voltRest, izhA, izhB, timeStep);
+	else
+		return vdudtIzhikevich4(volt, recov, izhA, izhB, timeStep);
+}
+
+// sets curSpike[i + lane] of all lanes in the mask
+static inline void storeSpikes(vmask spike, bool* curSpike, int i) {
+	unsigned int bits = vmaskbits(spike);
+	while (bits) {
+		curSpike[i + __builtin_ctz(bits)] = true;
+		bits &= bits - 1;
+	}
+}
+
+static void conductanceCurrentSimd(int n, const float* volt, const float* gAMPA, const float* gNMDA,
+	const float* gNMDA_r, const float* gGABAa, const float* gGABAb, const float* gGABAb_r, float* I_sum)
+{
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vfloat v = vload(&volt[i]);
+		vfloat g_NMDA = (gNMDA_r != NULL) ? vsub(vload(&gNMDA[i]), vload(&gNMDA_r[i])) : vload(&gNMDA[i]);
+		vfloat g_GABAb = (gGABAb_r != NULL) ? vsub(vload(&gGABAb[i]), vload(&gGABAb_r[i])) : vload(&gGABAb[i]);
+
+		vfloat x = vadd(v, vset1(80.0f));
+		vfloat NMDAtmp = vdiv(vdiv(vmul(x, x), vset1(60.0f)), vset1(60.0f));
+		vfloat v0 = vsub(v, vset1(0.0f));
+		vfloat sum = vmul(vload(&gAMPA[i]), v0);
+		sum = vadd(sum, vmul(vdiv(vmul(g_NMDA, NMDAtmp), vadd(vset1(1.0f), NMDAtmp)), v0));
+		sum = vadd(sum, vmul(vload(&gGABAa[i]), vadd(v, vset1(70.0f))));
+		sum = vadd(sum, vmul(g_GABAb, vadd(v, vset1(90.0f))));
+		vstore(&I_sum[i], vsub(vset1(-0.0f), sum)); // -0.0f - x == -x, also for x == 0
+	}
+	conductanceCurrentScalar(n - i, &volt[i], &gAMPA[i], &gNMDA[i], gNMDA_r != NULL ? &gNMDA_r[i] : NULL,
+		&gGABAa[i], &gGABAb[i], gGABAb_r != NULL ? &gGABAb_r[i] : NULL, &I_sum[i]);
+}
+
+template<bool model9, bool rk4>
+static void updateIzhikevichSimd(int n, const IzhParams& p, float timeStep, const float* volt, float* nextVolt,
+	float* recov, const float* totalCurrent, bool* curSpike)
+{
+	vfloat a = vset1(p.a), b = vset1(p.b), c = vset1(p.c), d = vset1(p.d);
+	vfloat invC = vset1(p.inverse_C), k = vset1(p.k), vr = vset1(p.vr), vt = vset1(p.vt);
+	vfloat vpeak = vset1(model9 ? p.vpeak : 30.0f);
+	vfloat dt = vset1(timeStep);
+	vfloat two = vset1(2.0f), sixth = vset1(1.0f / 6.0f), vmin = vset1(-90.0f);
+
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vfloat v = vload(&volt[i]);
+		vfloat u = vload(&recov[i]);
+		vfloat I = vload(&totalCurrent[i]);
+		vfloat vNext, du;
+
+		if (!rk4) {
+			vNext = vadd(v, vdvdtIzhikevich<model9>(v, u, I, invC, k, vr, vt, dt));
+		} else {
+			vfloat k1 = vdvdtIzhikevich<model9>(v, u, I, invC, k, vr, vt, dt);
+			vfloat l1 = vdudtIzhikevich<model9>(v, u, vr, a, b, dt);
+
+			vfloat v2 = vadd(v, vdiv(k1, two)), u2 = vadd(u, vdiv(l1, two));
+			vfloat k2 = vdvdtIzhikevich<model9>(v2, u2, I, invC, k, vr, vt, dt);
+			vfloat l2 = vdudtIzhikevich<model9>(v2, u2, vr, a, b, dt);
+
+			vfloat v3 = vadd(v, vdiv(k2, two)), u3 = vadd(u, vdiv(l2, two));
+			vfloat k3 = vdvdtIzhikevich<model9>(v3, u3, I, invC, k, vr, vt, dt);
+			vfloat l3 = vdudtIzhikevich<model9>(v3, u3, vr, a, b, dt);
+
+			vfloat v4 = vadd(v, k3), u4 = vadd(u, l3);
+			vfloat k4 = vdvdtIzhikevich<model9>(v4, u4, I, invC, k, vr, vt, dt);
+			vfloat l4 = vdudtIzhikevich<model9>(v4, u4, vr, a, b, dt);
+
+			vNext = vadd(v, vmul(sixth, vadd(vadd(vadd(k1, vmul(two, k2)), vmul(two, k3)), k4)));
+			du = vmul(sixth, vadd(vadd(vadd(l1, vmul(two, l2)), vmul(two, l3)), l4));
+		}
+
+		// spike detection and reset
+		vmask spike = vcmpgt(vNext, vpeak);
+		vNext = vblend(spike, vNext, c);
+		u = vblend(spike, u, vadd(u, d));
+		vNext = vblend(vcmplt(vNext, vmin), vNext, vmin);
+
+		if (!rk4)
+			u = vadd(u, vdudtIzhikevich<model9>(vNext, u, vr, a, b, dt));
+		else
+			u = vadd(u, du);
+
+		vstore(&nextVolt[i], vNext);
+		vstore(&recov[i], u);
+		storeSpikes(spike, curSpike, i);
+	}
+	updateIzhikevichScalar<model9, rk4>(n - i, p, timeStep, &volt[i], &nextVolt[i], &recov[i], &totalCurrent[i],
+		&curSpike[i]);
+}
+
+static void updateLIFSimd(int n, const LIFParams& p, float timeStep, bool lastIter, const float* volt,
+	float* nextVolt, int* refCount, const float* totalCurrent, bool* curSpike)
+{
+	vfloat vTh = vset1(p.vTh), vReset = vset1(p.vReset), gain = vset1(p.gain), bias = vset1(p.bias);
+	vfloat tauM = vset1((float)p.tau_m), dt = vset1(timeStep);
+	vfloat tauRef = vset1((float)(lastIter ? p.tau_ref : p.tau_ref + 1));
+	vfloat zero = vset1(0.0f), one = vset1(1.0f);
+
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vfloat v = vload(&volt[i]);
+		vfloat vPrev = vload(&nextVolt[i]);
+		vfloat I = vload(&totalCurrent[i]);
+		vfloat refC = vloadint(&refCount[i]);
+
+		vmask refractory = vcmpgt(refC, zero);
+		vmask spike = vmaskandnot(refractory, vcmpgt(vPrev, vTh));
+
+		// dvdtLIF
+		vfloat dv = vadd(vsub(vReset, v), vadd(vmul(I, gain), bias));
+		vfloat vNext = vadd(v, vmul(vdiv(dv, tauM), dt));
+
+		// refractory neurons keep their potential, except in the last step of a ms
+		vNext = vblend(refractory, vNext, lastIter ? vReset : vPrev);
+		vNext = vblend(spike, vNext, vReset);
+		vNext = vblend(vcmplt(vNext, vReset), vNext, vReset);
+
+		if (lastIter)
+			refC = vblend(refractory, refC, vsub(refC, one));
+		refC = vblend(spike, refC, tauRef);
+
+		vstore(&nextVolt[i], vNext);
+		vstoreint(&refCount[i], refC);
+		storeSpikes(spike, curSpike, i);
+	}
+	updateLIFScalar(n - i, p, timeStep, lastIter, &volt[i], &nextVolt[i], &refCount[i], &totalCurrent[i],
+		&curSpike[i]);
+}
@@ -47,23 +47,298 @@
 */
 
 #include <snn.h>
+#include <algorithm>
 
 #include <spike_buffer.h>
+#include <thread_pool.h>
+#include <philox_rng.h>
+#include <neuron_simd.h>
+#include <weight_precision.h>
+
+// returns the neuron id of the synapse at position pos of a compact synapse array (see CompactSynInfo)
+static inline int getCompactNId(const CompactSynInfo& syn, unsigned int pos) {
+	int base = syn.blockBase[pos / COMPACT_SYN_BLOCK_SIZE];
+	if (base >= 0)
+		return base + syn.nIdOffset[pos];
+	else
+		return syn.wideNId[-1 - base + pos % COMPACT_SYN_BLOCK_SIZE];
+}
 
-// spikeGeneratorUpdate_CPU on CPUs
-#if defined(WIN32) || defined(WIN64)
-	void SNN::spikeGeneratorUpdate_CPU(int netId) {
-#else // POSIX
-	void* SNN::spikeGeneratorUpdate_CPU(int netId) {
+// returns the number of trailing zero bits of x, x must not be 0
+static inline int countTrailingZeros(unsigned long long x) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	for (; !(x & 1ULL); x >>= 1)
+		n++;
+	return n;
+#endif
+}
+
+// returns the number of set bits of x
+static inline int countSetBits(unsigned long long x) {
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	int n = 0;
+	for (; x; x &= x - 1)
+		n++;
+	return n;
 #endif
+}
+
+// returns the number of synapses before position pos that are stored in wt, if the precisions of the connections of the
+// runtime differ (see copySynapseState)
+static inline unsigned int getWtFp32Index(const RuntimeData& rtd, unsigned int pos) {
+	if (rtd.wtFp32Bits == NULL)
+		return 0;
+	unsigned long long below = rtd.wtFp32Bits[pos / 64] & ((1ULL << (pos % 64)) - 1);
+	return rtd.wtFp32Rank[pos / 64] + countSetBits(below);
+}
+
+// returns the weight of a synapse if the precisions of the connections of the runtime differ: WT_FP32 synapses are
+// stored in wt, the others in wtReduced, each in the format of its connection
+static inline float loadMixedSynWeight(const RuntimeData& rtd, unsigned int pos, short int connId) {
+	WeightPrecision precision = rtd.connWtPrecision[connId];
+	unsigned int fp32Index = getWtFp32Index(rtd, pos);
+	if (precision == WT_FP32)
+		return rtd.wt[fp32Index];
+
+	unsigned int i = pos - fp32Index;
+	if (rtd.wtReducedBytes == 1)
+		return int8ToFloat(((const int8_t*)rtd.wtReduced)[i], rtd.connWtScale[connId]);
+	uint16_t w = ((const uint16_t*)rtd.wtReduced)[i];
+	switch (precision) {
+	case WT_FP16:
+		return halfToFloat(w);
+	case WT_BF16:
+		return bFloat16ToFloat(w);
+	case WT_INT8:
+	default:
+		return int8ToFloat((int8_t)(int16_t)w, rtd.connWtScale[connId]);
+	}
+}
+
+// stores the weight of a synapse if the precisions of the connections of the runtime differ (see loadMixedSynWeight)
+static inline void storeMixedSynWeight(RuntimeData& rtd, unsigned int pos, short int connId, float wt) {
+	WeightPrecision precision = rtd.connWtPrecision[connId];
+	unsigned int fp32Index = getWtFp32Index(rtd, pos);
+	if (precision == WT_FP32) {
+		rtd.wt[fp32Index] = wt;
+		return;
+	}
+
+	unsigned int i = pos - fp32Index;
+	if (rtd.wtReducedBytes == 1) {
+		((int8_t*)rtd.wtReduced)[i] = floatToInt8(wt, rtd.connWtScale[connId]);
+		return;
+	}
+	uint16_t* w = &((uint16_t*)rtd.wtReduced)[i];
+	switch (precision) {
+	case WT_FP16:
+		*w = floatToHalf(wt);
+		break;
+	case WT_BF16:
+		*w = floatToBFloat16(wt);
+		break;
+	case WT_INT8:
+	default:
+		*w = (uint16_t)(int16_t)floatToInt8(wt, rtd.connWtScale[connId]);
+		break;
+	}
+}
+
+// returns the weight of the synapse at position pos of connection connId, stored in the precision of the runtime
+// (see WeightPrecision)
+static inline float loadSynWeight(const RuntimeData& rtd, WeightPrecision storage, unsigned int pos, short int connId) {
+	switch (storage) {
+	case WT_FP16:
+		return halfToFloat(((const uint16_t*)rtd.wtReduced)[pos]);
+	case WT_BF16:
+		return bFloat16ToFloat(((const uint16_t*)rtd.wtReduced)[pos]);
+	case WT_INT8:
+		return int8ToFloat(((const int8_t*)rtd.wtReduced)[pos], rtd.connWtScale[connId]);
+	case WT_FP32:
+	default:
+		if (rtd.connWtPrecision != NULL)
+			return loadMixedSynWeight(rtd, pos, connId);
+		return rtd.wt[pos];
+	}
+}
+
+// stores the weight of the synapse at position pos of connection connId, rounded to the precision of the connection
+static inline void storeSynWeight(RuntimeData& rtd, WeightPrecision storage, unsigned int pos, short int connId, float wt) {
+	switch (storage) {
+	case WT_FP16:
+		((uint16_t*)rtd.wtReduced)[pos] = floatToHalf(wt);
+		break;
+	case WT_BF16:
+		((uint16_t*)rtd.wtReduced)[pos] = floatToBFloat16(wt);
+		break;
+	case WT_INT8:
+		((int8_t*)rtd.wtReduced)[pos] = floatToInt8(wt, rtd.connWtScale[connId]);
+		break;
+	case WT_FP32:
+	default:
+		if (rtd.connWtPrecision != NULL)
+			storeMixedSynWeight(rtd, pos, connId, wt);
+		else
+			rtd.wt[pos] = wt;
+		break;
+	}
+}
+
+// returns the bytes per weight in wtReduced
+static inline int getWtReducedBytes(const RuntimeData& rtd, const NetworkConfigRT& config) {
+	return (rtd.connWtPrecision != NULL) ? rtd.wtReducedBytes : getWeightBytes(config.wtPrecision);
+}
+
+// records a spike at time t, which is later than all spikes recorded so far (see SpikeTrace)
+static inline void recordSpikeTrace(SpikeTrace& trace, int t) {
+	if (trace.lastSpike != MAX_SIMULATION_TIME) {
+		int shift = t - trace.lastSpike;
+		assert(shift > 0);
+
+		// the most recent of the spikes that drop out of the window becomes the older spike
+		unsigned long long dropped = (shift >= 64) ? trace.recent : trace.recent >> (64 - shift);
+		if (dropped)
+			trace.older = trace.lastSpike - countTrailingZeros(dropped) - ((shift >= 64) ? 0 : 64 - shift);
+		trace.recent = (shift >= 64) ? 0ULL : trace.recent << shift;
+	}
+	trace.recent |= 1ULL;
+	trace.lastSpike = t;
+}
+
+// returns the time of the last spike at or before time t, or MAX_SIMULATION_TIME if there is none (see SpikeTrace)
+static inline int getSpikeTraceTime(const SpikeTrace& trace, int t) {
+	if (trace.lastSpike == MAX_SIMULATION_TIME || trace.lastSpike <= t)
+		return trace.lastSpike;
+
+	int skip = trace.lastSpike - t; // the spikes in bits [0, skip) are too recent
+	assert(skip < 64);
+	unsigned long long bits = trace.recent >> skip;
+	if (bits)
+		return trace.lastSpike - skip - countTrailingZeros(bits);
+
+	return trace.older;
+}
+
+// packs the SynInfo src[0, length) into a compact synapse array (see CompactSynInfo)
+static void packSynInfo(CompactSynInfo* dest, const SynInfo* src, int length, const short int* grpIds) {
+	dest->numBlocks = (length + COMPACT_SYN_BLOCK_SIZE - 1) / COMPACT_SYN_BLOCK_SIZE;
+	dest->nIdOffset = new unsigned short[length];
+	dest->synId = new unsigned short[length];
+	dest->blockBase = new int[dest->numBlocks];
+
+	// the base of a block is its smallest neuron id, unless the ids of the block do not fit into 16-bit offsets
+	dest->numWideBlocks = 0;
+	for (int block = 0; block < dest->numBlocks; block++) {
+		int minNId = INT_MAX, maxNId = 0;
+		for (int i = block * COMPACT_SYN_BLOCK_SIZE; i < std::min((block + 1) * COMPACT_SYN_BLOCK_SIZE, length); i++) {
+			minNId = std::min(minNId, GET_CONN_NEURON_ID(src[i]));
+			maxNId = std::max(maxNId, GET_CONN_NEURON_ID(src[i]));
+		}
+
+		if (maxNId - minNId > COMPACT_SYN_MAX_OFFSET)
+			dest->blockBase[block] = -1 - COMPACT_SYN_BLOCK_SIZE * dest->numWideBlocks++;
+		else
+			dest->blockBase[block] = minNId;
+	}
+	dest->wideNId = new int[COMPACT_SYN_BLOCK_SIZE * dest->numWideBlocks];
+
+	for (int i = 0; i < length; i++) {
+		int base = dest->blockBase[i / COMPACT_SYN_BLOCK_SIZE];
+		int nId = GET_CONN_NEURON_ID(src[i]);
+		assert(GET_CONN_GRP_ID(src[i]) == grpIds[nId]); // the group id can be restored from the neuron id
+
+		if (base >= 0) {
+			dest->nIdOffset[i] = nId - base;
+		} else {
+			dest->nIdOffset[i] = 0;
+			dest->wideNId[-1 - base + i % COMPACT_SYN_BLOCK_SIZE] = nId;
+		}
+		dest->synId[i] = GET_CONN_SYN_ID(src[i]);
+	}
+}
+
+// restores the SynInfo dest[pos, pos + length) from a compact synapse array
+static void unpackSynInfo(SynInfo* dest, const CompactSynInfo& src, int pos, int length, const short int* grpIds) {
+	for (int i = pos; i < pos + length; i++) {
+		int nId = getCompactNId(src, i);
+		dest[i].nId = nId;
+		dest[i].gsId = (grpIds[nId] << NUM_SYNAPSE_BITS) | src.synId[i];
+	}
+}
+
+// frees a compact synapse array
+static void deleteSynInfo(CompactSynInfo* syn) {
+	delete [] syn->nIdOffset;
+	delete [] syn->synId;
+	delete [] syn->blockBase;
+	delete [] syn->wideNId;
+	memset(syn, 0, sizeof(CompactSynInfo));
+}
+
+// returns the memory used by a compact synapse array of length synapses
+static size_t getCompactSynInfoSize(const CompactSynInfo& syn, int length) {
+	return (sizeof(unsigned short) * 2) * length + sizeof(int) * (syn.numBlocks + COMPACT_SYN_BLOCK_SIZE * syn.numWideBlocks);
+}
+
+// returns true if all entries of array[start, end] are equal
+template<typename T>
+static bool isUniform(const T* array, int start, int end) {
+	for (int i = start + 1; i <= end; i++)
+		if (array[i] != array[start])
+			return false;
+	return true;
+}
+
+// copies the plastic synapses of the neurons [lNIdStart, lNIdEnd) of a CPU runtime between the full layout (indexed by
+// cumulativePre) and the plastic-only layout (indexed by cumulativePlasticPre)
+template<typename T>
+static void copyPlasticSynapses(T* full, T* plastic, const RuntimeData& rtd, int lNIdStart, int lNIdEnd, bool toPlastic) {
+	for (int lNId = lNIdStart; lNId < lNIdEnd; lNId++) {
+		if (toPlastic)
+			memcpy(&plastic[rtd.cumulativePlasticPre[lNId]], &full[rtd.cumulativePre[lNId]], sizeof(T) * rtd.Npre_plastic[lNId]);
+		else
+			memcpy(&full[rtd.cumulativePre[lNId]], &plastic[rtd.cumulativePlasticPre[lNId]], sizeof(T) * rtd.Npre_plastic[lNId]);
+	}
+}
+
+// spikeGeneratorUpdate_CPU on CPUs
+void SNN::spikeGeneratorUpdate_CPU(int netId) {
 	assert(runtimeData[netId].allocated);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	// FIXME: skip this step if all spike gen neuron are possion neuron (generated by rate)
-	// update the random number for poisson spike generator (spikes generated by rate)
-	for (int poisN = 0; poisN < networkConfigs[netId].numNPois; poisN++) {
-		// set CPU_MODE Random Gen, store random number to g(c)puRandNums
-		runtimeData[netId].randNum[poisN] = drand48();
+	// poisson spike generator (spikes generated by rate)
+	// instead of drawing a random number for every poisson neuron in every step, each neuron keeps the time of its
+	// next spike in a timing wheel, so that only the neurons that fire in this step are visited
+	int numNReg = networkConfigs[netId].numNReg;
+	runtimeData[netId].numPoissonFired = 0;
+	if (!poissonWheel[netId].empty()) {
+		std::vector<int>& slot = poissonWheel[netId][simTime % POISSON_WHEEL_SIZE];
+		int slotSize = slot.size();
+		int numKept = 0;
+		for (int i = 0; i < slotSize; i++) {
+			int lNId = slot[i];
+			if (runtimeData[netId].poissonNextSpikeTime[lNId - numNReg] != (unsigned int)simTime) { // due in a later round
+				slot[numKept++] = lNId;
+				continue;
+			}
+
+			runtimeData[netId].poissonFiredIds[runtimeData[netId].numPoissonFired++] = lNId;
+
+			// schedule the next spike, which may end up in this slot again (appended behind slotSize)
+			unsigned int nextSpikeTime = drawPoissonInterval(lNId, netId, 0);
+			runtimeData[netId].poissonNextSpikeTime[lNId - numNReg] = nextSpikeTime;
+			if (nextSpikeTime != POISSON_NO_SPIKE)
+				poissonWheel[netId][nextSpikeTime % POISSON_WHEEL_SIZE].push_back(lNId);
+		}
+		slot.erase(slot.begin() + numKept, slot.begin() + slotSize);
+
+		// detectFiring_CPU looks up the fired neurons of each group by binary search
+		std::sort(runtimeData[netId].poissonFiredIds, runtimeData[netId].poissonFiredIds + runtimeData[netId].numPoissonFired);
 	}
 
 	// Use spike generators (user-defined callback function)
@@ -87,15 +362,11 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> spikeGeneratorUpdate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::updateTimingTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateTimingTable_CPU(int netId) {
-#endif
+void SNN::updateTimingTable_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	runtimeData[netId].timeTableD2[simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
@@ -108,7 +379,7 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateTimingTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -227,11 +498,7 @@
 //
 //}
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
+void SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD2Sec += spikeCountExtRx;
@@ -240,8 +507,11 @@
 
 	// FIXME: if endIdx - startIdx > 64 * 128
 	//if (firingTableIdx < endIdx)
-	for (int extIdx = startIdx; extIdx < endIdx; extIdx++)
+	for (int extIdx = startIdx; extIdx < endIdx; extIdx++) {
 		runtimeData[netId].firingTableD2[extIdx] += GtoLOffset;
+		if (networkConfigs[netId].sim_with_stdp_traces)
+			recordSpikeTrace(runtimeData[netId].spikeTraces[runtimeData[netId].firingTableD2[extIdx]], simTime);
+	}
 }
 
 #if !defined(WIN32) && !defined(WIN64) // Linux or MAC
@@ -250,15 +520,11 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> convertExtSpikesD2_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
+void SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD1Sec += spikeCountExtRx;
@@ -266,8 +532,11 @@
 	runtimeData[netId].spikeCountExtRxD1Sec += spikeCountExtRx;
 
 	// FIXME: if endIdx - startIdx > 64 * 128
-	for (int extIdx = startIdx; extIdx < endIdx; extIdx++)
+	for (int extIdx = startIdx; extIdx < endIdx; extIdx++) {
 		runtimeData[netId].firingTableD1[extIdx] += GtoLOffset;
+		if (networkConfigs[netId].sim_with_stdp_traces)
+			recordSpikeTrace(runtimeData[netId].spikeTraces[runtimeData[netId].firingTableD1[extIdx]], simTime);
+	}
 }
 
 #if !defined(WIN32) && !defined(WIN64) // Linux or MAC
@@ -276,15 +545,11 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> convertExtSpikesD1_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::clearExtFiringTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::clearExtFiringTable_CPU(int netId) {
-#endif
+void SNN::clearExtFiringTable_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	memset(runtimeData[netId].extFiringTableEndIdxD1, 0, sizeof(int) * networkConfigs[netId].numGroups);
@@ -297,7 +562,7 @@
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> clearExtFiringTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -327,11 +592,7 @@ void SNN::copyExtFiringTable(int netId) {
 // used for management of manager runtime data
 // FIXME: make sure this is right when separating cpu_module to a standalone class
 // FIXME: currently this function clear nSpikeCnt of manager runtime data
-#if defined(WIN32) || defined(WIN64)
-	void SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#else // POSIX
-	void* SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#endif
+void SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	if (lGrpId == ALL) {
@@ -349,17 +610,50 @@ void SNN::copyExtFiringTable(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> resetSpikeCnt_CPU(args->netId, args->lGrpId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
+/*!
+ * \brief finds the first synapse of a pre-synaptic neuron (within one delay) that targets a neuron >= lNIdStart
+ *
+ * The synapses of a pre-synaptic neuron are sorted by local post-synaptic neuron id within each delay (see
+ * generateConnectionRuntime), so the synapses targeting a neuron range are contiguous and can be found by binary search.
+ *
+ * \param[in] offset cumulativePost of the pre-synaptic neuron
+ * \param[in] dPar delay information of the pre-synaptic neuron
+ * \param[in] lNIdStart the first post-synaptic neuron of the range
+ * \returns the index (relative to offset) of the first synapse targeting a neuron >= lNIdStart
+ * \since v4.0
+ */
+int SNN::findFirstPostSynapse_CPU(int netId, unsigned int offset, DelayInfo dPar, int lNIdStart) {
+	int idxLow = dPar.delay_index_start;
+	int idxHigh = dPar.delay_index_start + dPar.delay_length;
+
+	if (lNIdStart == 0)
+		return idxLow;
+
+	while (idxLow < idxHigh) {
+		int idxMid = idxLow + (idxHigh - idxLow) / 2;
+		if (getCompactNId(runtimeData[netId].postSynapticCompact, offset + idxMid) < lNIdStart)
+			idxLow = idxMid + 1;
+		else
+			idxHigh = idxMid;
+	}
+
+	return idxLow;
+}
+
 // This method loops through all spikes that are generated by neurons with a delay of 1ms
 // and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doCurrentUpdateD1_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD1_CPU(int netId) {
-#endif
+void SNN::doCurrentUpdateD1_CPU(int netId) {
+	doCurrentUpdateD1_CPU(netId, 0, networkConfigs[netId].numN);
+}
+
+// Delivers the spikes with a delay of 1ms to the post-synaptic neurons in [startIdx, endIdx) only. Every thread of a
+// runtime scans all spikes but writes to its own post-synaptic neurons, so the threads do not need to synchronize,
+// and each neuron receives its inputs in the same order as with a single thread.
+void SNN::doCurrentUpdateD1_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	int k     = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay + 1] - 1;
@@ -373,18 +667,19 @@ void SNN::copyExtFiringTable(int netId) {
 
 		unsigned int offset = runtimeData[netId].cumulativePost[lNId];
 
-		for(int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
+		// post-synaptic neurons are sorted, external neurons (if any) are the last ones
+		for(int idx_d = findFirstPostSynapse_CPU(netId, offset, dPar, startIdx); idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
 			// get synaptic info...
-			SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
-
-			int postNId = GET_CONN_NEURON_ID(postInfo);
+			int postNId = getCompactNId(runtimeData[netId].postSynapticCompact, offset + idx_d);
 			assert(postNId < networkConfigs[netId].numNAssigned);
 
-			int synId = GET_CONN_SYN_ID(postInfo);
+			if (postNId >= endIdx) // the remaining post-neurons belong to other threads or are external neurons
+				break;
+
+			int synId = runtimeData[netId].postSynapticCompact.synId[offset + idx_d];
 			assert(synId < (runtimeData[netId].Npre[postNId]));
 
-			if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-				generatePostSynapticSpike(lNId /* preNId */, postNId, synId, 0, netId);
+			generatePostSynapticSpike(lNId /* preNId */, postNId, synId, 0, netId);
 		}
 
 		k = k - 1;
@@ -396,18 +691,20 @@ void SNN::copyExtFiringTable(int netId) {
 	void* SNN::helperDoCurrentUpdateD1_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
 #endif
 
 // This method loops through all spikes that are generated by neurons with a delay of 2+ms
 // and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doCurrentUpdateD2_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD2_CPU(int netId) {
-#endif
+void SNN::doCurrentUpdateD2_CPU(int netId) {
+	doCurrentUpdateD2_CPU(netId, 0, networkConfigs[netId].numN);
+}
+
+// Delivers the spikes with a delay of 2+ms to the post-synaptic neurons in [startIdx, endIdx) only
+// (see doCurrentUpdateD1_CPU)
+void SNN::doCurrentUpdateD2_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	if (networkConfigs[netId].maxDelay > 1) {
@@ -437,18 +734,18 @@ void SNN::copyExtFiringTable(int netId) {
 			unsigned int offset = runtimeData[netId].cumulativePost[lNId];
 
 			// for each delay variables
-			for (int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
+			for (int idx_d = findFirstPostSynapse_CPU(netId, offset, dPar, startIdx); idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
 				// get synaptic info...
-				SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
-
-				int postNId = GET_CONN_NEURON_ID(postInfo);
+				int postNId = getCompactNId(runtimeData[netId].postSynapticCompact, offset + idx_d);
 				assert(postNId < networkConfigs[netId].numNAssigned);
 
-				int synId = GET_CONN_SYN_ID(postInfo);
+				if (postNId >= endIdx) // the remaining post-neurons belong to other threads or are external neurons
+					break;
+
+				int synId = runtimeData[netId].postSynapticCompact.synId[offset + idx_d];
 				assert(synId < (runtimeData[netId].Npre[postNId]));
 
-				if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-					generatePostSynapticSpike(lNId /* preNId */, postNId, synId, tD, netId);
+				generatePostSynapticSpike(lNId /* preNId */, postNId, synId, tD, netId);
 			}
 
 			k = k - 1;
@@ -461,16 +758,12 @@ void SNN::copyExtFiringTable(int netId) {
 	void* SNN::helperDoCurrentUpdateD2_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#else // POSIX
-	void* SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#endif
+void SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
 	//decay the STP variables before adding new spikes.
@@ -511,28 +804,50 @@ void SNN::copyExtFiringTable(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> doSTPUpdateAndDecayCond_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::findFiring_CPU(int netId) {
-#else // POSIX
-	void* SNN::findFiring_CPU(int netId) {
-#endif
+/*!
+ * \brief finds the neurons that fire in the neuron range [startIdx, endIdx) of a CPU runtime
+ *
+ * The ids of fired neurons are stored in firedNeuronIds[startIdx, endIdx) in ascending order, terminated by -1
+ * if fewer than endIdx - startIdx neurons fired. The neuron ranges of different threads do not overlap, so the
+ * threads of a runtime can detect firing concurrently.
+ *
+ * \sa updateFiringTable_CPU, updateFiredNeurons_CPU
+ * \since v4.0
+ */
+void SNN::detectFiring_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
-	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
+	int numFired = 0;
+
 	for(int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
-		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
+		if (groupConfigs[netId][lGrpId].lEndN < startIdx)
+			continue;
+		if (groupConfigs[netId][lGrpId].lStartN >= endIdx)
+			break;
+
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+
+		// spikes generated by poission rate, only visit the neurons scheduled by spikeGeneratorUpdate_CPU
+		if ((groupConfigs[netId][lGrpId].Type & POISSON_NEURON) && !groupConfigs[netId][lGrpId].isSpikeGenFunc) {
+			int* firedEnd = runtimeData[netId].poissonFiredIds + runtimeData[netId].numPoissonFired;
+			for (int* fired = std::lower_bound(runtimeData[netId].poissonFiredIds, firedEnd, lStartN);
+				fired != firedEnd && *fired <= lEndN; fired++) {
+				runtimeData[netId].lastSpikeTime[*fired] = simTime;
+				runtimeData[netId].firedNeuronIds[startIdx + numFired++] = *fired;
+			}
+			continue;
+		}
+
+		for (int lNId = lStartN; lNId <= lEndN; lNId++) {
 			bool needToWrite = false;
-			// given group of neurons belong to the poisson group....
+			// given group of neurons belong to the poisson group (spikes generated by user-defined callback function)
 			if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
-				if(groupConfigs[netId][lGrpId].isSpikeGenFunc) {
-					unsigned int offset = lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset;
-					needToWrite = getSpikeGenBit(offset, netId);
-				} else { // spikes generated by poission rate
-					needToWrite = getPoissonSpike(lNId, netId);
-				}
+				unsigned int offset = lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset;
+				needToWrite = getSpikeGenBit(offset, netId);
 				// Note: valid lastSpikeTime of spike gen neurons is required by userDefinedSpikeGenerator()
 				if (needToWrite)
 					runtimeData[netId].lastSpikeTime[lNId] = simTime;
@@ -550,132 +865,244 @@ void SNN::copyExtFiringTable(int netId) {
 				}
 			}
 
-			// his flag is set if with_stdp is set and also grpType is set to have GROUP_SYN_FIXED
-			if (needToWrite) {
-				bool hasSpace = false;
-				int fireId = -1;
-
-				// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W), spikeCountLastSecLeftD2(R)
-				if (groupConfigs[netId][lGrpId].MaxDelay == 1)
-				{
-					if (runtimeData[netId].spikeCountD1Sec + 1 < networkConfigs[netId].maxSpikesD1) {
-						fireId = runtimeData[netId].spikeCountD1Sec;
-						runtimeData[netId].spikeCountD1Sec++;
-					}
-				} else { // MaxDelay > 1
-					if (runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2 + 1 < networkConfigs[netId].maxSpikesD2) {
-						fireId = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
-						runtimeData[netId].spikeCountD2Sec++;
-					}
+			if (needToWrite)
+				runtimeData[netId].firedNeuronIds[startIdx + numFired++] = lNId;
+		}
+	}
+
+	if (startIdx + numFired < endIdx)
+		runtimeData[netId].firedNeuronIds[startIdx + numFired] = -1;
+}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperDetectFiring_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> detectFiring_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
+	}
+#endif
+
+/*!
+ * \brief appends the neurons found by detectFiring_CPU to the firing tables of a CPU runtime
+ *
+ * The neuron ranges of all threads are visited in the order of local neuron ids, which keeps the order of spikes in
+ * the firing tables independent of the number of threads. Spikes that do not fit into the firing tables are dropped
+ * and removed from firedNeuronIds, so that updateFiredNeurons_CPU only sees the spikes that were delivered.
+ *
+ * \since v4.0
+ */
+void SNN::updateFiringTable_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+		int startIdx, endIdx;
+		findThreadNeuronRange(networkConfigs[netId].numN, networkConfigs[netId].numThreads, threadId, startIdx, endIdx);
+
+		int lGrpId = 0;
+		int numDelivered = 0;
+		for (int idx = startIdx; idx < endIdx && runtimeData[netId].firedNeuronIds[idx] != -1; idx++) {
+			int lNId = runtimeData[netId].firedNeuronIds[idx];
+			while (lNId > groupConfigs[netId][lGrpId].lEndN)
+				lGrpId++;
+
+			int fireId = -1;
+
+			// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W), spikeCountLastSecLeftD2(R)
+			if (groupConfigs[netId][lGrpId].MaxDelay == 1)
+			{
+				if (runtimeData[netId].spikeCountD1Sec + 1 < networkConfigs[netId].maxSpikesD1) {
+					fireId = runtimeData[netId].spikeCountD1Sec;
+					runtimeData[netId].spikeCountD1Sec++;
 				}
+			} else { // MaxDelay > 1
+				if (runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2 + 1 < networkConfigs[netId].maxSpikesD2) {
+					fireId = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
+					runtimeData[netId].spikeCountD2Sec++;
+				}
+			}
 
-				if (fireId == -1) // no space availabe in firing table, drop the spike
-					continue;
+			if (fireId == -1) // no space availabe in firing table, drop the spike
+				continue;
+
+			// update firing table: firingTableD1(W), firingTableD2(W)
+			if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
+				runtimeData[netId].firingTableD1[fireId] = lNId;
+			} else { // MaxDelay > 1
+				runtimeData[netId].firingTableD2[fireId] = lNId;
+			}
 
-				// update firing table: firingTableD1(W), firingTableD2(W)
+			// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
+			if (groupConfigs[netId][lGrpId].hasExternalConnect)     {
+				int extFireId = -1;
 				if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-					runtimeData[netId].firingTableD1[fireId] = lNId;
+					extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
+					runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
 				} else { // MaxDelay > 1
-					runtimeData[netId].firingTableD2[fireId] = lNId;
+					extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
+					runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
 				}
+				assert(extFireId != -1);
+			}
 
-				// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
-				if (groupConfigs[netId][lGrpId].hasExternalConnect)     {
-					int extFireId = -1;
-					if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-						extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
-						runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					} else { // MaxDelay > 1
-						extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
-						runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					}
-					assert(extFireId != -1);
-				}
+			// only delivered spikes are recorded, like synSpikeTime
+			if (networkConfigs[netId].sim_with_stdp_traces)
+				recordSpikeTrace(runtimeData[netId].spikeTraces[lNId], simTime);
 
-				// update STP for neurons that fire
-				if (groupConfigs[netId][lGrpId].WithSTP) {
-					firingUpdateSTP(lNId, lGrpId, netId);
-				}
+			runtimeData[netId].firedNeuronIds[startIdx + numDelivered++] = lNId;
+		}
 
-				// keep track of number spikes per neuron
-				runtimeData[netId].nSpikeCnt[lNId]++;
+		if (startIdx + numDelivered < endIdx)
+			runtimeData[netId].firedNeuronIds[startIdx + numDelivered] = -1;
+	}
+}
 
-				if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
-					resetFiredNeuron(lNId, lGrpId, netId);
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperUpdateFiringTable_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> updateFiringTable_CPU(args->netId);
+		return NULL;
+	}
+#endif
 
-				// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
-				if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
-					updateLTP(lNId, lGrpId, netId);
-				}
-			}
+/*!
+ * \brief updates STP, spike counts, homeostasis and LTP of the neurons fired in [startIdx, endIdx)
+ *
+ * All the updates only touch per-neuron state (or the incoming synapses of a fired neuron), so the threads of a
+ * runtime can update their neuron ranges concurrently.
+ *
+ * \since v4.0
+ */
+void SNN::updateFiredNeurons_CPU(int netId, int startIdx, int endIdx) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	int lGrpId = 0;
+	for (int idx = startIdx; idx < endIdx && runtimeData[netId].firedNeuronIds[idx] != -1; idx++) {
+		int lNId = runtimeData[netId].firedNeuronIds[idx];
+		while (lNId > groupConfigs[netId][lGrpId].lEndN)
+			lGrpId++;
+
+		// update STP for neurons that fire
+		if (groupConfigs[netId][lGrpId].WithSTP) {
+			firingUpdateSTP(lNId, lGrpId, netId);
+		}
+
+		// keep track of number spikes per neuron
+		runtimeData[netId].nSpikeCnt[lNId]++;
+
+		if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
+			resetFiredNeuron(lNId, lGrpId, netId);
+
+		// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
+		if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
+			updateLTP(lNId, lGrpId, netId);
 		}
 	}
 }
 
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperUpdateFiredNeurons_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> updateFiredNeurons_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
+	}
+#endif
+
+void SNN::findFiring_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+	int startIdx, endIdx;
+
+	// the same three steps that SNN::findFiring() distributes among the threads of a runtime
+	for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+		findThreadNeuronRange(networkConfigs[netId].numN, networkConfigs[netId].numThreads, threadId, startIdx, endIdx);
+		detectFiring_CPU(netId, startIdx, endIdx);
+	}
+
+	updateFiringTable_CPU(netId);
+
+	for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+		findThreadNeuronRange(networkConfigs[netId].numN, networkConfigs[netId].numThreads, threadId, startIdx, endIdx);
+		updateFiredNeurons_CPU(netId, startIdx, endIdx);
+	}
+}
+
 #if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperFindFiring_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> findFiring_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
 
 void SNN::updateLTP(int lNId, int lGrpId, int netId) {
-	unsigned int pos_ij = runtimeData[netId].cumulativePre[lNId]; // the index of pre-synaptic neuron
-	for(int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; pos_ij++, j++) {
-		int stdp_tDiff = (simTime - runtimeData[netId].synSpikeTime[pos_ij]);
-		assert(!((stdp_tDiff < 0) && (runtimeData[netId].synSpikeTime[pos_ij] != MAX_SIMULATION_TIME)));
+	const GroupConfigRT& grp = groupConfigs[netId][lGrpId];
+	bool isMarked = false; // whether the neuron is marked for the next sparse weight update
+	unsigned int pos_ij = runtimeData[netId].cumulativePlasticPre[lNId]; // the index of the first plastic synapse
+	unsigned int connPos = runtimeData[netId].cumulativePre[lNId];
+	for(int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; pos_ij++, connPos++, j++) {
+		float maxSynWt = runtimeData[netId].maxSynWt != NULL ? runtimeData[netId].maxSynWt[pos_ij]
+			: runtimeData[netId].connMaxWt[runtimeData[netId].connIdsPreIdx[connPos]];
+		int synSpikeTime = networkConfigs[netId].sim_with_stdp_traces ? getSynSpikeTime_CPU(netId, connPos)
+			: runtimeData[netId].synSpikeTime[pos_ij];
+		int stdp_tDiff = (simTime - synSpikeTime);
+		assert(!((stdp_tDiff < 0) && (synSpikeTime != MAX_SIMULATION_TIME)));
 
 		if (stdp_tDiff > 0) {
-			// check this is an excitatory or inhibitory synapse
-			if (groupConfigs[netId][lGrpId].WithESTDP && runtimeData[netId].maxSynWt[pos_ij] >= 0) { // excitatory synapse
-				// Handle E-STDP curve
-				switch (groupConfigs[netId][lGrpId].WithESTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25)
-						runtimeData[netId].wtChange[pos_ij] += STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-					break;
-				case TIMING_BASED_CURVE: // sc curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25) {
-						if (stdp_tDiff <= groupConfigs[netId][lGrpId].GAMMA)
-							runtimeData[netId].wtChange[pos_ij] += groupConfigs[netId][lGrpId].OMEGA + groupConfigs[netId][lGrpId].KAPPA * STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-						else // stdp_tDiff > GAMMA
-							runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-					}
-					break;
-				default:
-					KERNEL_ERROR("Invalid E-STDP curve!");
-					break;
-				}
-			} else if (groupConfigs[netId][lGrpId].WithISTDP && runtimeData[netId].maxSynWt[pos_ij] < 0) { // inhibitory synapse
-				// Handle I-STDP curve																				 // Handle I-STDP curve
-				switch (groupConfigs[netId][lGrpId].WithISTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB < 25) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_INB, groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB);
-					}
-					break;
-				case PULSE_CURVE: // pulse curve
-					if (stdp_tDiff <= groupConfigs[netId][lGrpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTP;
-						//printf("I-STDP LTP\n");
-					} else if (stdp_tDiff <= groupConfigs[netId][lGrpId].DELTA) { // LTD of inhibitory syanpse, which increase sysnapse weight
-						runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTD;
-						//printf("I-STDP LTD\n");
-					} else { /*do nothing*/}
-					break;
-				default:
-					KERNEL_ERROR("Invalid I-STDP curve!");
-					break;
+			// check this is an excitatory or inhibitory synapse, the curve is looked up in the STDP tables of the group
+			int lut = STDP_LUT_NUM;
+			if (grp.WithESTDP && maxSynWt >= 0) // excitatory synapse
+				lut = STDP_LUT_LTP_EXC;
+			else if (grp.WithISTDP && maxSynWt < 0) // inhibitory synapse, LTP decreases synapse weight
+				lut = STDP_LUT_LTP_INB;
+
+			if (lut != STDP_LUT_NUM && stdp_tDiff < grp.stdpLUTLength[lut]) {
+				if (grp.withSparseWtUpdate && !isMarked) {
+					markWtChange_CPU(netId, lNId);
+					isMarked = true;
 				}
+				runtimeData[netId].wtChange[pos_ij] += runtimeData[netId].stdpLUT[grp.stdpLUTOffset[lut] + stdp_tDiff];
 			}
 		}
 	}
 }
 
+/*!
+ * \brief returns the time when the last pre-synaptic spike arrived at a synapse, derived from spike traces
+ *
+ * A spike of the pre-synaptic neuron fired at time t arrives at a synapse with delay d at time t + d - 1 (see
+ * doCurrentUpdateD1_CPU and doCurrentUpdateD2_CPU), which is the time generatePostSynapticSpike stores in
+ * synSpikeTime. The delay of the synapse is found in the delay information of the pre-synaptic neuron.
+ *
+ * \param[in] netId the id of a local network
+ * \param[in] pos position of the synapse in the pre-synaptic arrays (see cumulativePre)
+ * \returns the arrival time before simTime, or MAX_SIMULATION_TIME if no spike has arrived yet
+ * \since v4.0
+ */
+int SNN::getSynSpikeTime_CPU(int netId, unsigned int pos) {
+	int preNId = getCompactNId(runtimeData[netId].preSynapticCompact, pos);
+	int synId = runtimeData[netId].preSynapticCompact.synId[pos];
+
+	// the synapses of a neuron are sorted by delay
+	const DelayInfo* dPar = &runtimeData[netId].postDelayInfo[preNId * (networkConfigs[netId].maxDelay + 1)];
+	int delay = 1;
+	while (synId >= dPar[delay - 1].delay_index_start + dPar[delay - 1].delay_length || dPar[delay - 1].delay_length == 0) {
+		delay++;
+		assert(delay <= networkConfigs[netId].maxDelay);
+	}
+
+	// the spikes that arrive at simTime have not been delivered yet
+	int spikeTime = getSpikeTraceTime(runtimeData[netId].spikeTraces[preNId], simTime - delay);
+	return (spikeTime == MAX_SIMULATION_TIME) ? MAX_SIMULATION_TIME : spikeTime + delay - 1;
+}
+
 void SNN::firingUpdateSTP(int lNId, int lGrpId, int netId) {
 	// update the spike-dependent part of du/dt and dx/dt
 	// we need to retrieve the STP values from the right buffer position (right before vs. right after the spike)
@@ -699,12 +1126,38 @@ void SNN::resetFiredNeuron(int lNId, short int lGrpId, int netId) {
 	}
 }
 
-bool SNN::getPoissonSpike(int lNId, int netId) {
-	// Random number value is less than the poisson firing probability
-	// if poisson firing probability is say 1.0 then the random poisson ptr
-	// will always be less than 1.0 and hence it will continiously fire
-	return runtimeData[netId].randNum[lNId - networkConfigs[netId].numNReg] * 1000.0f
-			< runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg];
+/*!
+ * \brief draws the time of the next spike of a poisson neuron on CPU
+ *
+ * A poisson neuron fires in each 1 ms step with probability p = rate / 1000, so the number of steps until the next
+ * spike is geometrically distributed. The interval is drawn by inversion from a single random number, which only
+ * depends on the seed, the global neuron id, the simulation time, and the counter, so that the spike trains do not
+ * depend on the partitioning of the network.
+ *
+ * \param[in] lNId local id of the poisson neuron
+ * \param[in] netId the id of the local network
+ * \param[in] counter 0 if the interval starts at a spike, 1 if it starts at a rate change
+ * \returns the time of the next spike (> simTime), or POISSON_NO_SPIKE if the neuron does not fire
+ * \since v4.0
+ */
+unsigned int SNN::drawPoissonInterval(int lNId, int netId, unsigned int counter) {
+	float rate = runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg];
+	if (rate <= 0.0f)
+		return POISSON_NO_SPIKE;
+	if (rate >= 1000.0f) // fires in every step
+		return simTime + 1;
+
+	PhiloxRNG rng(randSeed_, RNG_STREAM_POISSON);
+	uint32_t rnd[4];
+	rng.generate(lNId + groupConfigs[netId][runtimeData[netId].grpIds[lNId]].LtoGOffset, simTime, counter, 0, rnd);
+
+	// u in (0,1], interval = 1 + floor(log(u) / log(1 - p))
+	double u = (rnd[0] + 0.5) / 4294967296.0;
+	double interval = 1.0 + floor(log(u) / log1p(-rate / 1000.0));
+	if (interval >= (double)(POISSON_NO_SPIKE - simTime))
+		return POISSON_NO_SPIKE;
+
+	return simTime + (unsigned int)interval;
 }
 
 bool SNN::getSpikeGenBit(unsigned int nIdPos, int netId) {
@@ -744,10 +1197,15 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 	short int mulIndex = runtimeData[netId].connIdsPreIdx[pos];
 	assert(mulIndex >= 0 && mulIndex < numConnections);
 
+	// the weights of neurons without recent STDP activity may lag behind (see applyPendingWtUpdates_CPU)
+	if (groupConfigs[netId][post_grpId].withSparseWtUpdate
+		&& runtimeData[netId].wtUpdateEpoch[postNId] != runtimeData[netId].numWtUpdates)
+		applyPendingWtUpdates_CPU(netId, postNId);
+
 	// P1
 	// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
 	// generally speaking, this amplitude is the weight; but it can be modulated by STP
-	float change = runtimeData[netId].wt[pos];
+	float change = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, pos, mulIndex);
 
 	// P2
 	if (groupConfigs[netId][pre_grpId].WithSTP) {
@@ -799,7 +1257,12 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 	}
 
 	// P4
-	runtimeData[netId].synSpikeTime[pos] = simTime;
+	// only plastic synapses keep their spike time and weight change (see cumulativePlasticPre)
+	// with STDP traces, the spike time is derived from the pre-synaptic neuron when needed (see getSynSpikeTime_CPU)
+	bool isPlastic = !sim_with_fixedwts && synId < runtimeData[netId].Npre_plastic[postNId];
+	unsigned int plasticPos = isPlastic ? runtimeData[netId].cumulativePlasticPre[postNId] + synId : 0;
+	if (isPlastic && !networkConfigs[netId].sim_with_stdp_traces)
+		runtimeData[netId].synSpikeTime[plasticPos] = simTime;
 
 	// P5
 	// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
@@ -809,79 +1272,27 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 
 	// P6
 	// STDP calculation: the post-synaptic neuron fires before the arrival of a pre-synaptic spike
-	if (!sim_in_testing && groupConfigs[netId][post_grpId].WithSTDP) {
+	if (!sim_in_testing && isPlastic && groupConfigs[netId][post_grpId].WithSTDP) {
 		int stdp_tDiff = (simTime - runtimeData[netId].lastSpikeTime[postNId]);
 
 		if (stdp_tDiff >= 0) {
-			if (groupConfigs[netId][post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
-				// Handle I-STDP curve
-				switch (groupConfigs[netId][post_grpId].WithISTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB < 25) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_INB, groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB);
-					}
-					break;
-				case PULSE_CURVE: // pulse curve
-					if (stdp_tDiff <= groupConfigs[netId][post_grpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTP;
-					} else if (stdp_tDiff <= groupConfigs[netId][post_grpId].DELTA) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTD;
-					} else { /*do nothing*/ }
-					break;
-				default:
-					KERNEL_ERROR("Invalid I-STDP curve");
-					break;
-				}
-			} else if (groupConfigs[netId][post_grpId].WithESTDP && ((pre_type & TARGET_AMPA) || (pre_type & TARGET_NMDA))) { // excitatory synapse
-				// Handle E-STDP curve
-				switch (groupConfigs[netId][post_grpId].WithESTDPcurve) {
-				case EXP_CURVE: // exponential curve
-				case TIMING_BASED_CURVE: // sc curve
-					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC < 25)
-						runtimeData[netId].wtChange[pos] += STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_EXC, groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC);
-					break;
-				default:
-					KERNEL_ERROR("Invalid E-STDP curve");
-					break;
-				}
-			} else { /*do nothing*/ }
+			const GroupConfigRT& grp = groupConfigs[netId][post_grpId];
+			int lut = STDP_LUT_NUM;
+			if (grp.WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) // inhibitory syanpse
+				lut = STDP_LUT_LTD_INB;
+			else if (grp.WithESTDP && ((pre_type & TARGET_AMPA) || (pre_type & TARGET_NMDA))) // excitatory synapse
+				lut = STDP_LUT_LTD_EXC;
+
+			if (lut != STDP_LUT_NUM && stdp_tDiff < grp.stdpLUTLength[lut]) {
+				if (grp.withSparseWtUpdate)
+					markWtChange_CPU(netId, postNId);
+				runtimeData[netId].wtChange[plasticPos] += runtimeData[netId].stdpLUT[grp.stdpLUTOffset[lut] + stdp_tDiff];
+			}
 		}
 		assert(!((stdp_tDiff < 0) && (runtimeData[netId].lastSpikeTime[postNId] != MAX_SIMULATION_TIME)));
 	}
 }
 
-// single integration step for voltage equation of 4-param Izhikevich
-inline
-float dvdtIzhikevich4(float volt, float recov, float totalCurrent, float timeStep = 1.0f) {
-	return (((0.04f * volt + 5.0f) * volt + 140.0f - recov + totalCurrent) * timeStep);
-}
-
-// single integration step for recovery equation of 4-param Izhikevich
-inline
-float dudtIzhikevich4(float volt, float recov, float izhA, float izhB, float timeStep = 1.0f) {
-	return (izhA * (izhB * volt - recov) * timeStep);
-}
-
-// single integration step for voltage equation of 9-param Izhikevich
-inline
-float dvdtIzhikevich9(float volt, float recov, float invCapac, float izhK, float voltRest,
-	float voltInst, float totalCurrent, float timeStep = 1.0f)
-{
-	return ((izhK * (volt - voltRest) * (volt - voltInst) - recov + totalCurrent) * invCapac * timeStep);
-}
-
-// single integration step for recovery equation of 9-param Izhikevich
-inline
-float dudtIzhikevich9(float volt, float recov, float voltRest, float izhA, float izhB, float timeStep = 1.0f) {
-	return (izhA * (izhB * (volt - voltRest) - recov) * timeStep);
-}
-
-// single integration step for voltage equation of LIF neurons
-inline
-float dvdtLIF(float volt, float lif_vReset, float lif_gain, float lif_bias, int lif_tau_m, float totalCurrent, float timeStep = 1.0f) {
-	return ((lif_vReset -volt + ((totalCurrent * lif_gain) + lif_bias))/ (float) lif_tau_m) * timeStep;
-}
-
 float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, float const1) {
 	float compCurrent = 0.0f;
 	for (int k = 0; k < groupConfigs[netid][lGrpId].numCompNeighbors; k++) {
@@ -896,264 +1307,50 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	return compCurrent;
 }
 
-#if defined(WIN32) || defined(WIN64)
-	void  SNN::globalStateUpdate_CPU(int netId) {
-#else // POSIX
-	void*  SNN::globalStateUpdate_CPU(int netId) {
-#endif
-	assert(runtimeData[netId].memType == CPU_MEM);
+void SNN::globalStateUpdate_CPU(int netId) {
+	globalStateUpdate_CPU(netId, 0, networkConfigs[netId].numN);
+}
 
-	float timeStep = networkConfigs[netId].timeStep;
+/*!
+ * \brief integrates the neurons in the range [startIdx, endIdx) of a CPU runtime
+ *
+ * Neurons are integrated independently of each other, so the threads of a runtime can update non-overlapping
+ * neuron ranges concurrently. Group-wide state (e.g., dopamine) is updated by the thread that owns the first neuron
+ * of the group. Compartmental neurons read the voltage of their neighbors in every integration step and must
+ * therefore be integrated in a single range.
+ *
+ * The neurons of a regular group are updated by the kernel chosen for the group by selectNeuronUpdateKernel_CPU.
+ *
+ * \since v4.0
+ */
+void SNN::globalStateUpdate_CPU(int netId, int startIdx, int endIdx) {
+	assert(runtimeData[netId].memType == CPU_MEM);
 
 	// loop that allows smaller integration time step for v's and u's
 	for (int j = 1; j <= networkConfigs[netId].simNumStepsPerMs; j++) {
 		bool lastIter = (j == networkConfigs[netId].simNumStepsPerMs);
 		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+			if (groupConfigs[netId][lGrpId].lEndN < startIdx)
+				continue;
+			if (groupConfigs[netId][lGrpId].lStartN >= endIdx)
+				break;
+
+			int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+			int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+
 			if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
 				if (groupConfigs[netId][lGrpId].WithHomeostasis & (lastIter)) {
-					for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
+					for (int lNId = lStartN; lNId <= lEndN; lNId++)
 						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
 				}
 				continue;
 			}
 
-			for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-				assert(lNId < networkConfigs[netId].numNReg);
-
-				// P7
-				// update conductances
-				float v = runtimeData[netId].voltage[lNId];
-				float v_next = runtimeData[netId].nextVoltage[lNId];
-				float u = runtimeData[netId].recovery[lNId];
-				float I_sum, NMDAtmp;
-				float gNMDA, gGABAb;
-
-				// pre-load izhikevich variables to avoid unnecessary memory accesses & unclutter the code.
-				float k = runtimeData[netId].Izh_k[lNId];
-				float vr = runtimeData[netId].Izh_vr[lNId];
-				float vt = runtimeData[netId].Izh_vt[lNId];
-				float inverse_C = 1.0f / runtimeData[netId].Izh_C[lNId];
-				float vpeak = runtimeData[netId].Izh_vpeak[lNId];
-				float a = runtimeData[netId].Izh_a[lNId];
-				float b = runtimeData[netId].Izh_b[lNId];
-
-				// pre-load LIF parameters
-				int lif_tau_m = runtimeData[netId].lif_tau_m[lNId];
-				int lif_tau_ref = runtimeData[netId].lif_tau_ref[lNId];
-				int lif_tau_ref_c = runtimeData[netId].lif_tau_ref_c[lNId];
-				float lif_vTh = runtimeData[netId].lif_vTh[lNId];
-				float lif_vReset = runtimeData[netId].lif_vReset[lNId];
-				float lif_gain = runtimeData[netId].lif_gain[lNId];
-				float lif_bias = runtimeData[netId].lif_bias[lNId];
-
-				float totalCurrent = runtimeData[netId].extCurrent[lNId];
-
-				if (networkConfigs[netId].sim_with_conductances) {
-					NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
-					gNMDA = (networkConfigs[netId].sim_with_NMDA_rise) ? (runtimeData[netId].gNMDA_d[lNId] - runtimeData[netId].gNMDA_r[lNId]) : runtimeData[netId].gNMDA[lNId];
-					gGABAb = (networkConfigs[netId].sim_with_GABAb_rise) ? (runtimeData[netId].gGABAb_d[lNId] - runtimeData[netId].gGABAb_r[lNId]) : runtimeData[netId].gGABAb[lNId];
-
-					I_sum = -(runtimeData[netId].gAMPA[lNId] * (v - 0.0f)
-						+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
-						+ runtimeData[netId].gGABAa[lNId] * (v + 70.0f)
-						+ gGABAb * (v + 90.0f));
-
-					totalCurrent += I_sum;
-				}
-				else {
-					totalCurrent += runtimeData[netId].current[lNId];
-				}
-				if (groupConfigs[netId][lGrpId].withCompartments) {
-					totalCurrent += getCompCurrent(netId, lGrpId, lNId);
-				}
-
-				switch (networkConfigs[netId].simIntegrationMethod) {
-				case FORWARD_EULER:
-					if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF)
-					{	
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						if (v_next > 30.0f) {
-							v_next = 30.0f; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
-					else if (!groupConfigs[netId][lGrpId].isLIF)
-					{	
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
-
-					else{
-						if (lif_tau_ref_c > 0){
-							if(lastIter){
-								runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
-								v_next = lif_vReset;
-							}
-						}
-						else{
-							if (v_next > lif_vTh) {
-								runtimeData[netId].curSpike[lNId] = true;
-								v_next = lif_vReset;
-								
-								if(lastIter){
-                                        				runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref;
-								}
-								else{
-									runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
-								}
-							}
-							else{
-								v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
-							}
-						}						
-					}
-
-					if (groupConfigs[netId][lGrpId].isLIF){
-						if (v_next < lif_vReset) v_next = lif_vReset;
-					}
-					else{
-						if (v_next < -90.0f) v_next = -90.0f;
-
-						if (!groupConfigs[netId][lGrpId].withParamModel_9)
-						{
-							u += dudtIzhikevich4(v_next, u, a, b, timeStep);
-						}
-						else
-						{
-							u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
-						}
-					}
-					break;
-				
-				case RUNGE_KUTTA4:
-
-					if (!groupConfigs[netId][lGrpId].withParamModel_9 && !groupConfigs[netId][lGrpId].isLIF) {
-						// 4-param Izhikevich
-						float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
-
-						float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
-							timeStep);
-						float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
-
-						float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
-							timeStep);
-						float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
-
-						float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
-						float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-						if (v_next > 30.0f) {
-							v_next = 30.0f;
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-						if (v_next < -90.0f) v_next = -90.0f;
-
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					}
-					else if(!groupConfigs[netId][lGrpId].isLIF){
-						// 9-param Izhikevich
-						float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
-							timeStep);
-						float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
-
-						float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
-
-						float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
-
-						float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
-
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-
-						if (v_next < -90.0f) v_next = -90.0f;
-
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					}
-					else{
-						//LIF integration is always FORWARD_EULER
-						if (lif_tau_ref_c > 0){
-							if(lastIter){
-								runtimeData[netId].lif_tau_ref_c[lNId] -= 1;
-								v_next = lif_vReset;
-							}
-						}
-						else{
-							if (v_next > lif_vTh) {
-								runtimeData[netId].curSpike[lNId] = true;
-								v_next = lif_vReset;
-								
-								if(lastIter){
-                                        				runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref;
-								}
-								else{
-									runtimeData[netId].lif_tau_ref_c[lNId] = lif_tau_ref + 1;
-								}
-							}
-							else{
-								v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
-							}
-						}
-						if (v_next < lif_vReset) v_next = lif_vReset;
-					}
-					break;
-				case UNKNOWN_INTEGRATION:
-				default:
-					exitSimulation(1);
-				}
-
-				runtimeData[netId].nextVoltage[lNId] = v_next;
-				runtimeData[netId].recovery[lNId] = u;
-
-				// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
-				if (lastIter)
-				{
-					if (networkConfigs[netId].sim_with_conductances) {
-						runtimeData[netId].current[lNId] = I_sum;
-					}
-					else {
-						// current must be reset here for CUBA and not STPUpdateAndDecayConductances
-						runtimeData[netId].current[lNId] = 0.0f;
-					}
-
-					// P8
-					// update average firing rate for homeostasis
-					if (groupConfigs[netId][lGrpId].WithHomeostasis)
-						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
-
-					// log i value if any active neuron monitor is presented
-					if (networkConfigs[netId].sim_with_nm && lNId - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-						int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
-						runtimeData[netId].nIBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = totalCurrent;
-					}
-				}
-			} // end StartN...EndN
+			// P7, P8
+			(this->*neuronUpdateKernels[netId][lGrpId])(netId, lGrpId, lStartN, lEndN, lastIter);
 
 			  // decay dopamine concentration once per globalStateUpdate_CPU call
-			if (lastIter)
+			if (lastIter && lStartN == groupConfigs[netId][lGrpId].lStartN)
 			{
 				// P9
 				// decay dopamine concentration
@@ -1167,127 +1364,613 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		  // Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
 		  // This is crucial for GPU (asynchronous kernel launch) and in the future for a multi-threaded CARLsim version.
 
-		memcpy(runtimeData[netId].voltage, runtimeData[netId].nextVoltage, sizeof(float)*networkConfigs[netId].numNReg);
+		int lEndNReg = std::min(endIdx, networkConfigs[netId].numNReg);
+		if (startIdx < lEndNReg)
+			memcpy(&runtimeData[netId].voltage[startIdx], &runtimeData[netId].nextVoltage[startIdx], sizeof(float) * (lEndNReg - startIdx));
 
 	} // end simNumStepsPerMs loop
 }
 
+/*!
+ * \brief integrates the neurons [lStartN, lEndN] of a regular group of a CPU runtime for one integration step
+ *
+ * The neuron model, the integration method, the conductance mode (see COND_FLAG_COBA), whether the group shares
+ * its neuron parameters and whether neuron monitors are present are template parameters, so that the per-neuron
+ * loop does not branch on any of them. The kernel of each group is chosen once by selectNeuronUpdateKernel_CPU.
+ *
+ * \tparam neuronModel NEURON_MODEL_IZH4, NEURON_MODEL_IZH9 or NEURON_MODEL_LIF
+ * \tparam method integration method, LIF neurons are always integrated with FORWARD_EULER
+ * \tparam condFlags 0 for CUBA, otherwise COND_FLAG_COBA combined with COND_FLAG_NMDA_RISE and COND_FLAG_GABAB_RISE
+ * \tparam withSharedParams whether the neuron parameters are stored in the group config (see copyNeuronParameters)
+ * \tparam withNM whether any neuron monitor is present
+ *
+ * \sa globalStateUpdate_CPU
+ * \since v4.0
+ */
+template<int neuronModel, integrationMethod_t method, int condFlags, bool withSharedParams, bool withNM>
+void SNN::updateNeuronGroup_CPU(int netId, int lGrpId, int lStartN, int lEndN, bool lastIter) {
+	const GroupConfigRT& grp = groupConfigs[netId][lGrpId];
+	RuntimeData& rtd = runtimeData[netId];
+	float timeStep = networkConfigs[netId].timeStep;
+
+	assert(lEndN < networkConfigs[netId].numNReg);
+
+	// pre-load izhikevich and LIF parameters to avoid unnecessary memory accesses & unclutter the code.
+	float k = grp.Izh_k;
+	float vr = grp.Izh_vr;
+	float vt = grp.Izh_vt;
+	float inverse_C = (neuronModel == NEURON_MODEL_IZH9) ? 1.0f / grp.Izh_C : 0.0f;
+	float vpeak = grp.Izh_vpeak;
+	float a = grp.Izh_a;
+	float b = grp.Izh_b;
+	float c = grp.Izh_c;
+	float d = grp.Izh_d;
+	int lif_tau_m = grp.lif_tau_m;
+	int lif_tau_ref = grp.lif_tau_ref;
+	float lif_vTh = grp.lif_vTh;
+	float lif_vReset = grp.lif_vReset;
+	float lif_gain = grp.lif_gain;
+	float lif_bias = grp.lif_bias;
+
+	// groups with shared parameters are integrated by the vectorized kernels, which give the same results as the
+	// per-neuron loop below
+	if (withSharedParams && !grp.withCompartments && simdLevel != SIMD_NONE) {
+		int n = lEndN - lStartN + 1;
+		float* totalCurrent = &rtd.totalCurrent[lStartN];
+
+		// P7
+		// update conductances
+		if (condFlags & COND_FLAG_COBA) {
+			NeuronSimd::conductanceCurrent(simdLevel, n, &rtd.voltage[lStartN], &rtd.gAMPA[lStartN],
+				(condFlags & COND_FLAG_NMDA_RISE) ? &rtd.gNMDA_d[lStartN] : &rtd.gNMDA[lStartN],
+				(condFlags & COND_FLAG_NMDA_RISE) ? &rtd.gNMDA_r[lStartN] : NULL, &rtd.gGABAa[lStartN],
+				(condFlags & COND_FLAG_GABAB_RISE) ? &rtd.gGABAb_d[lStartN] : &rtd.gGABAb[lStartN],
+				(condFlags & COND_FLAG_GABAB_RISE) ? &rtd.gGABAb_r[lStartN] : NULL, &rtd.current[lStartN]);
+		}
+		for (int i = 0; i < n; i++)
+			totalCurrent[i] = rtd.extCurrent[lStartN + i] + rtd.current[lStartN + i];
+
+		if (neuronModel == NEURON_MODEL_LIF) {
+			LIFParams p = {lif_tau_m, lif_tau_ref, lif_vTh, lif_vReset, lif_gain, lif_bias};
+			NeuronSimd::updateLIF(simdLevel, n, p, timeStep, lastIter, &rtd.voltage[lStartN],
+				&rtd.nextVoltage[lStartN], &rtd.lif_tau_ref_c[lStartN], totalCurrent, &rtd.curSpike[lStartN]);
+		}
+		else {
+			IzhParams p = {a, b, c, d, inverse_C, k, vr, vt, vpeak};
+			NeuronSimd::updateIzhikevich(simdLevel, neuronModel == NEURON_MODEL_IZH9, method, n, p, timeStep,
+				&rtd.voltage[lStartN], &rtd.nextVoltage[lStartN], &rtd.recovery[lStartN], totalCurrent,
+				&rtd.curSpike[lStartN]);
+		}
+
+		if (lastIter) {
+			for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+				// current must be reset here for CUBA and not STPUpdateAndDecayConductances
+				if (!(condFlags & COND_FLAG_COBA))
+					rtd.current[lNId] = 0.0f;
+
+				// P8
+				// update average firing rate for homeostasis
+				if (grp.WithHomeostasis)
+					rtd.avgFiring[lNId] *= grp.avgTimeScale_decay;
+
+				// log i value if any active neuron monitor is presented
+				if (withNM && lNId - grp.lStartN < MAX_NEURON_MON_GRP_SZIE) {
+					int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+					rtd.nIBuffer[idxBase + lNId - grp.lStartN] = rtd.totalCurrent[lNId];
+				}
+			}
+		}
+		return;
+	}
+
+	for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+		float v = rtd.voltage[lNId];
+		float v_next = rtd.nextVoltage[lNId];
+		float u = rtd.recovery[lNId];
+		float I_sum = 0.0f;
+
+		if (!withSharedParams) {
+			int pId = lNId + grp.paramOffset;
+			if (neuronModel != NEURON_MODEL_LIF) {
+				a = rtd.Izh_a[pId];
+				b = rtd.Izh_b[pId];
+				c = rtd.Izh_c[pId];
+				d = rtd.Izh_d[pId];
+			}
+			if (neuronModel == NEURON_MODEL_IZH9) {
+				k = rtd.Izh_k[pId];
+				vr = rtd.Izh_vr[pId];
+				vt = rtd.Izh_vt[pId];
+				inverse_C = 1.0f / rtd.Izh_C[pId];
+				vpeak = rtd.Izh_vpeak[pId];
+			}
+			if (neuronModel == NEURON_MODEL_LIF) {
+				lif_tau_m = rtd.lif_tau_m[pId];
+				lif_tau_ref = rtd.lif_tau_ref[pId];
+				lif_vTh = rtd.lif_vTh[pId];
+				lif_vReset = rtd.lif_vReset[pId];
+				lif_gain = rtd.lif_gain[pId];
+				lif_bias = rtd.lif_bias[pId];
+			}
+		}
+
+		// P7
+		// update conductances
+		float totalCurrent = rtd.extCurrent[lNId];
+		if (condFlags & COND_FLAG_COBA) {
+			float gNMDA = (condFlags & COND_FLAG_NMDA_RISE) ? (rtd.gNMDA_d[lNId] - rtd.gNMDA_r[lNId]) : rtd.gNMDA[lNId];
+			float gGABAb = (condFlags & COND_FLAG_GABAB_RISE) ? (rtd.gGABAb_d[lNId] - rtd.gGABAb_r[lNId]) : rtd.gGABAb[lNId];
+
+			I_sum = currentCOBA(v, rtd.gAMPA[lNId], gNMDA, rtd.gGABAa[lNId], gGABAb);
+
+			totalCurrent += I_sum;
+		}
+		else {
+			totalCurrent += rtd.current[lNId];
+		}
+		if (grp.withCompartments) {
+			totalCurrent += getCompCurrent(netId, lGrpId, lNId);
+		}
+
+		if (neuronModel == NEURON_MODEL_IZH4 && method == FORWARD_EULER) {
+			// update vpos and upos for the current neuron
+			v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+			if (v_next > 30.0f) {
+				v_next = 30.0f; // break the loop but evaluate u[i]
+				rtd.curSpike[lNId] = true;
+				v_next = c;
+				u += d;
+			}
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += dudtIzhikevich4(v_next, u, a, b, timeStep);
+		}
+		else if (neuronModel == NEURON_MODEL_IZH9 && method == FORWARD_EULER) {
+			// update vpos and upos for the current neuron
+			v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
+			if (v_next > vpeak) {
+				v_next = vpeak; // break the loop but evaluate u[i]
+				rtd.curSpike[lNId] = true;
+				v_next = c;
+				u += d;
+			}
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
+		}
+		else if (neuronModel == NEURON_MODEL_IZH4 && method == RUNGE_KUTTA4) {
+			float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+			float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
+
+			float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
+				timeStep);
+			float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
+
+			float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
+				timeStep);
+			float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
+
+			float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
+			float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			if (v_next > 30.0f) {
+				v_next = 30.0f;
+				rtd.curSpike[lNId] = true;
+				v_next = c;
+				u += d;
+			}
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+		else if (neuronModel == NEURON_MODEL_IZH9 && method == RUNGE_KUTTA4) {
+			float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
+				timeStep);
+			float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
+
+			float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
+
+			float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+
+			float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
+
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+
+			if (v_next > vpeak) {
+				v_next = vpeak; // break the loop but evaluate u[i]
+				rtd.curSpike[lNId] = true;
+				v_next = c;
+				u += d;
+			}
+
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+		else {
+			//LIF integration is always FORWARD_EULER
+			if (rtd.lif_tau_ref_c[lNId] > 0) {
+				if (lastIter) {
+					rtd.lif_tau_ref_c[lNId] -= 1;
+					v_next = lif_vReset;
+				}
+			}
+			else {
+				if (v_next > lif_vTh) {
+					rtd.curSpike[lNId] = true;
+					v_next = lif_vReset;
+					rtd.lif_tau_ref_c[lNId] = lastIter ? lif_tau_ref : lif_tau_ref + 1;
+				}
+				else {
+					v_next = v + dvdtLIF(v, lif_vReset, lif_gain, lif_bias, lif_tau_m, totalCurrent, timeStep);
+				}
+			}
+			if (v_next < lif_vReset) v_next = lif_vReset;
+		}
+
+		rtd.nextVoltage[lNId] = v_next;
+		rtd.recovery[lNId] = u;
+
+		// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
+		if (lastIter)
+		{
+			// current must be reset here for CUBA and not STPUpdateAndDecayConductances
+			rtd.current[lNId] = I_sum;
+
+			// P8
+			// update average firing rate for homeostasis
+			if (grp.WithHomeostasis)
+				rtd.avgFiring[lNId] *= grp.avgTimeScale_decay;
+
+			// log i value if any active neuron monitor is presented
+			if (withNM && lNId - grp.lStartN < MAX_NEURON_MON_GRP_SZIE) {
+				int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+				rtd.nIBuffer[idxBase + lNId - grp.lStartN] = totalCurrent;
+			}
+		}
+	}
+}
+
+// returns the update kernel for a group with the given conductance mode, neuron model and integration method
+template<int neuronModel, integrationMethod_t method, int condFlags>
+SNN::NeuronUpdateKernel SNN::getNeuronUpdateKernel_CPU(bool withSharedParams, bool withNM) {
+	if (withSharedParams)
+		return withNM ? &SNN::updateNeuronGroup_CPU<neuronModel, method, condFlags, true, true>
+			: &SNN::updateNeuronGroup_CPU<neuronModel, method, condFlags, true, false>;
+	else
+		return withNM ? &SNN::updateNeuronGroup_CPU<neuronModel, method, condFlags, false, true>
+			: &SNN::updateNeuronGroup_CPU<neuronModel, method, condFlags, false, false>;
+}
+
+// returns the update kernel for a group with the given conductance mode
+template<int condFlags>
+SNN::NeuronUpdateKernel SNN::getNeuronUpdateKernel_CPU(int neuronModel, integrationMethod_t method, bool withSharedParams, bool withNM) {
+	if (neuronModel == NEURON_MODEL_LIF)
+		return getNeuronUpdateKernel_CPU<NEURON_MODEL_LIF, FORWARD_EULER, condFlags>(withSharedParams, withNM);
+
+	if (neuronModel == NEURON_MODEL_IZH4)
+		return (method == FORWARD_EULER) ? getNeuronUpdateKernel_CPU<NEURON_MODEL_IZH4, FORWARD_EULER, condFlags>(withSharedParams, withNM)
+			: getNeuronUpdateKernel_CPU<NEURON_MODEL_IZH4, RUNGE_KUTTA4, condFlags>(withSharedParams, withNM);
+	else
+		return (method == FORWARD_EULER) ? getNeuronUpdateKernel_CPU<NEURON_MODEL_IZH9, FORWARD_EULER, condFlags>(withSharedParams, withNM)
+			: getNeuronUpdateKernel_CPU<NEURON_MODEL_IZH9, RUNGE_KUTTA4, condFlags>(withSharedParams, withNM);
+}
+
+/*!
+ * \brief chooses the update kernel of a regular group of a CPU runtime
+ *
+ * This function is called once per group by allocateSNN_CPU, after copyNeuronParameters has determined which groups
+ * share their neuron parameters.
+ *
+ * \sa updateNeuronGroup_CPU
+ * \since v4.0
+ */
+void SNN::selectNeuronUpdateKernel_CPU(int netId, int lGrpId) {
+	const GroupConfigRT& grp = groupConfigs[netId][lGrpId];
+	integrationMethod_t method = networkConfigs[netId].simIntegrationMethod;
+	if (method != FORWARD_EULER && method != RUNGE_KUTTA4) {
+		KERNEL_ERROR("Unknown integration method for group %d of CPU Runtime %d", lGrpId, netId);
+		exitSimulation(1);
+	}
+
+	int neuronModel = grp.isLIF ? NEURON_MODEL_LIF : (grp.withParamModel_9 ? NEURON_MODEL_IZH9 : NEURON_MODEL_IZH4);
+	bool withNM = networkConfigs[netId].sim_with_nm;
+
+	int condFlags = 0;
+	if (networkConfigs[netId].sim_with_conductances) {
+		condFlags = COND_FLAG_COBA;
+		if (networkConfigs[netId].sim_with_NMDA_rise)
+			condFlags |= COND_FLAG_NMDA_RISE;
+		if (networkConfigs[netId].sim_with_GABAb_rise)
+			condFlags |= COND_FLAG_GABAB_RISE;
+	}
+
+	NeuronUpdateKernel kernel = NULL;
+	switch (condFlags) {
+	case 0:
+		kernel = getNeuronUpdateKernel_CPU<0>(neuronModel, method, grp.withSharedParams, withNM);
+		break;
+	case COND_FLAG_COBA:
+		kernel = getNeuronUpdateKernel_CPU<COND_FLAG_COBA>(neuronModel, method, grp.withSharedParams, withNM);
+		break;
+	case COND_FLAG_COBA | COND_FLAG_NMDA_RISE:
+		kernel = getNeuronUpdateKernel_CPU<COND_FLAG_COBA | COND_FLAG_NMDA_RISE>(neuronModel, method, grp.withSharedParams, withNM);
+		break;
+	case COND_FLAG_COBA | COND_FLAG_GABAB_RISE:
+		kernel = getNeuronUpdateKernel_CPU<COND_FLAG_COBA | COND_FLAG_GABAB_RISE>(neuronModel, method, grp.withSharedParams, withNM);
+		break;
+	default:
+		kernel = getNeuronUpdateKernel_CPU<COND_FLAG_COBA | COND_FLAG_NMDA_RISE | COND_FLAG_GABAB_RISE>(neuronModel, method, grp.withSharedParams, withNM);
+		break;
+	}
+
+	neuronUpdateKernels[netId][lGrpId] = kernel;
+}
+
 #if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperGlobalStateUpdate_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
 #endif
 
+// limits the weight of an excitatory synapse to [0, maxSynWt] and of an inhibitory synapse to [maxSynWt, 0]
+static inline void clampSynWeight(float& wt, float maxSynWt) {
+	if (maxSynWt >= 0) {
+		if (wt >= maxSynWt)
+			wt = maxSynWt;
+		if (wt < 0)
+			wt = 0.0;
+	}
+	else {
+		if (wt <= maxSynWt)
+			wt = maxSynWt;
+		if (wt > 0)
+			wt = 0.0;
+	}
+}
+
+// applies the accumulated weight changes of a neuron to the weights of its plastic synapses
+void SNN::updateNeuronWeights_CPU(int netId, int lGrpId, int lNId) {
+	assert(lNId < networkConfigs[netId].numNReg);
+	unsigned int offset = runtimeData[netId].cumulativePre[lNId];
+	unsigned int plasticOffset = runtimeData[netId].cumulativePlasticPre[lNId];
+	float diff_firing = 0.0;
+	float homeostasisScale = 1.0;
+
+	if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+		assert(runtimeData[netId].baseFiring[lNId] > 0);
+		diff_firing = 1 - runtimeData[netId].avgFiring[lNId] / runtimeData[netId].baseFiring[lNId];
+		homeostasisScale = groupConfigs[netId][lGrpId].homeostasisScale;
+	}
+
+	if (lNId == groupConfigs[netId][lGrpId].lStartN)
+		KERNEL_DEBUG("Weights, Change at %d (diff_firing: %f)", simTimeSec, diff_firing);
+
+	// weights stored in reduced precision lose the part of a weight change that is below their resolution, it is
+	// carried over to the next update in wtChange (which is kept in fp32) if the weight change is a multiple of wtChange
+	const GroupConfigRT& grp = groupConfigs[netId][lGrpId];
+	int numTypes = (grp.WithESTDPtype == STANDARD ? 1 : 0) + (grp.WithISTDPtype == STANDARD ? 1 : 0);
+	bool carryRoundingError = (networkConfigs[netId].wtPrecision != WT_FP32 || runtimeData[netId].connWtPrecision != NULL)
+		&& !grp.WithHomeostasis && grp.WithESTDPtype != DA_MOD && grp.WithISTDPtype != DA_MOD && numTypes > 0
+		&& stdpScaleFactor_ > 0.0f;
+
+	for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; j++) {
+		//	if (i==groupConfigs[0][g].StartN)
+		//		KERNEL_DEBUG("%1.2f %1.2f \t", wt[offset+j]*10, wtChange[offset+j]*10);
+		short int connId = runtimeData[netId].connIdsPreIdx[offset + j];
+		float wt = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId);
+		float effectiveWtChange = stdpScaleFactor_ * runtimeData[netId].wtChange[plasticOffset + j];
+		//				if (wtChange[offset+j])
+		//					printf("connId=%d, wtChange[%d]=%f\n",connIdsPreIdx[offset+j],offset+j,wtChange[offset+j]);
+
+		// homeostatic weight update
+		// FIXME: check WithESTDPtype and WithISTDPtype first and then do weight change update
+		switch (groupConfigs[netId][lGrpId].WithESTDPtype) {
+		case STANDARD:
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				wt += (diff_firing*wt * homeostasisScale + runtimeData[netId].wtChange[plasticOffset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+			} else {
+				// just STDP weight update
+				wt += effectiveWtChange;
+			}
+			break;
+		case DA_MOD:
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				effectiveWtChange = runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
+				wt += (diff_firing*wt * homeostasisScale + effectiveWtChange)*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+			} else {
+				wt += runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
+			}
+			break;
+		case UNKNOWN_STDP:
+		default:
+			// we shouldn't even be in here if !WithSTDP
+			break;
+		}
+
+		switch (groupConfigs[netId][lGrpId].WithISTDPtype) {
+		case STANDARD:
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				wt += (diff_firing*wt * homeostasisScale + runtimeData[netId].wtChange[plasticOffset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+			} else {
+				// just STDP weight update
+				wt += effectiveWtChange;
+			}
+			break;
+		case DA_MOD:
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				effectiveWtChange = runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
+				wt += (diff_firing*wt * homeostasisScale + effectiveWtChange)*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+			} else {
+				wt += runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
+			}
+			break;
+		case UNKNOWN_STDP:
+		default:
+			// we shouldn't even be in here if !WithSTDP
+			break;
+		}
+
+		// It is users' choice to decay weight change or not
+		// see setWeightAndWeightChangeUpdate()
+		runtimeData[netId].wtChange[plasticOffset + j] *= wtChangeDecay_;
+
+		// if this is an excitatory or inhibitory synapse
+		float maxSynWt = runtimeData[netId].maxSynWt != NULL ? runtimeData[netId].maxSynWt[plasticOffset + j]
+			: runtimeData[netId].connMaxWt[connId];
+		clampSynWeight(wt, maxSynWt);
+		storeSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId, wt);
+
+		if (carryRoundingError) {
+			float storedWt = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId);
+			runtimeData[netId].wtChange[plasticOffset + j] += (wt - storedWt) / (numTypes * stdpScaleFactor_);
+		}
+	}
+}
+
 // This function updates the synaptic weights from its derivatives..
-#if defined(WIN32) || defined(WIN64)
-	void SNN::updateWeights_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateWeights_CPU(int netId) {
-#endif
+void SNN::updateWeights_CPU(int netId) {
 	// at this point we have already checked for sim_in_testing and sim_with_fixedwts
 	assert(sim_in_testing==false);
 	assert(sim_with_fixedwts==false);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	// update synaptic weights here for all the neurons..
-	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
-		// no changable weights so continue without changing..
-		if (groupConfigs[netId][lGrpId].FixedInputWts || !(groupConfigs[netId][lGrpId].WithSTDP))
+	bool sparseWtUpdate = networkConfigs[netId].sim_with_sparse_wt_update;
+	if (sparseWtUpdate && stdpScaleFactor_ != runtimeData[netId].wtUpdateScale) {
+		// the pending updates of inactive neurons were made with the previous scale factor (see startTesting)
+		flushWtUpdates_CPU(netId);
+		runtimeData[netId].wtUpdateScale = stdpScaleFactor_;
+	}
+
+	// update synaptic weights here for all the neurons..
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		// no changable weights so continue without changing..
+		if (groupConfigs[netId][lGrpId].FixedInputWts || !(groupConfigs[netId][lGrpId].WithSTDP))
+			continue;
+
+		int lStartN = groupConfigs[netId][lGrpId].lStartN;
+		int lEndN = groupConfigs[netId][lGrpId].lEndN;
+		if (sparseWtUpdate && groupConfigs[netId][lGrpId].withSparseWtUpdate) {
+			// only visit the neurons whose wtChange was modified since the last update, skipping 32 neurons at a time
+			unsigned int* wtDirty = runtimeData[netId].wtDirty;
+			for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+				unsigned int bits = wtDirty[lNId / 32] >> (lNId % 32);
+				if (bits == 0) {
+					lNId = (lNId / 32) * 32 + 31;
+					continue;
+				}
+				lNId += countTrailingZeros(bits);
+				if (lNId > lEndN)
+					break;
+
+				updateNeuronWeights_CPU(netId, lGrpId, lNId);
+				wtDirty[lNId / 32] &= ~(1u << (lNId % 32));
+				runtimeData[netId].wtUpdateEpoch[lNId] = runtimeData[netId].numWtUpdates + 1;
+			}
+		} else {
+			for (int lNId = lStartN; lNId <= lEndN; lNId++)
+				updateNeuronWeights_CPU(netId, lGrpId, lNId);
+		}
+	}
+
+	if (sparseWtUpdate)
+		runtimeData[netId].numWtUpdates++;
+}
+
+// marks a neuron for the next sparse weight update, must be called before its wtChange is modified
+void SNN::markWtChange_CPU(int netId, int lNId) {
+	unsigned int mask = 1u << (lNId % 32);
+	unsigned int* word = &runtimeData[netId].wtDirty[lNId / 32];
+	if (*word & mask)
+		return;
+
+	// new STDP activity is added to the up-to-date wtChange
+	applyPendingWtUpdates_CPU(netId, lNId);
+
+	// the neuron ranges of the threads of a runtime (see findThreadNeuronRange) may share a word
+	#if defined(WIN32) || defined(WIN64)
+		*word |= mask;
+	#else
+		__sync_fetch_and_or(word, mask);
+	#endif
+}
+
+/*!
+ * \brief applies the weight updates that a neuron missed while it had no STDP activity
+ *
+ * Sparse weight updates only visit the neurons marked in wtDirty. Without new STDP activity, the k missed updates
+ * would have added stdpScaleFactor * wtChange * (1 + d + ... + d^(k-1)) to a weight and decayed its wtChange by d^k,
+ * where d is the wtChange decay. All missed updates move a weight in the same direction, so clamping it once gives
+ * the same result as clamping it after every update. Without decay, the last update reset wtChange and there is
+ * nothing to apply.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] lNId the local id of a regular neuron of a group with sparse weight updates
+ *
+ * \sa markWtChange_CPU flushWtUpdates_CPU updateWeights_CPU
+ * \since v4.0
+ */
+void SNN::applyPendingWtUpdates_CPU(int netId, int lNId) {
+	int numMissed = runtimeData[netId].numWtUpdates - runtimeData[netId].wtUpdateEpoch[lNId];
+	runtimeData[netId].wtUpdateEpoch[lNId] = runtimeData[netId].numWtUpdates;
+	if (numMissed <= 0 || wtChangeDecay_ == 0.0f)
+		return;
+
+	const GroupConfigRT& grp = groupConfigs[netId][runtimeData[netId].grpIds[lNId]];
+	assert(grp.withSparseWtUpdate);
+
+	// a weight receives the weight change once for each STANDARD STDP type of the group (see updateNeuronWeights_CPU)
+	int numTypes = (grp.WithESTDPtype == STANDARD ? 1 : 0) + (grp.WithISTDPtype == STANDARD ? 1 : 0);
+	float decay = (float)pow(wtChangeDecay_, numMissed);
+	float scale = numTypes * runtimeData[netId].wtUpdateScale * (1.0f - decay) / (1.0f - wtChangeDecay_);
+	bool carryRoundingError = (networkConfigs[netId].wtPrecision != WT_FP32 || runtimeData[netId].connWtPrecision != NULL)
+		&& numTypes > 0 && runtimeData[netId].wtUpdateScale > 0.0f; // see updateNeuronWeights_CPU
+
+	unsigned int offset = runtimeData[netId].cumulativePre[lNId];
+	unsigned int plasticOffset = runtimeData[netId].cumulativePlasticPre[lNId];
+	for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; j++) {
+		float wtChange = runtimeData[netId].wtChange[plasticOffset + j];
+		if (wtChange == 0.0f)
 			continue;
 
-		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-			assert(lNId < networkConfigs[netId].numNReg);
-			unsigned int offset = runtimeData[netId].cumulativePre[lNId];
-			float diff_firing = 0.0;
-			float homeostasisScale = 1.0;
+		short int connId = runtimeData[netId].connIdsPreIdx[offset + j];
+		float wt = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId)
+			+ scale * wtChange;
+		runtimeData[netId].wtChange[plasticOffset + j] = wtChange * decay;
 
-			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-				assert(runtimeData[netId].baseFiring[lNId] > 0);
-				diff_firing = 1 - runtimeData[netId].avgFiring[lNId] / runtimeData[netId].baseFiring[lNId];
-				homeostasisScale = groupConfigs[netId][lGrpId].homeostasisScale;
-			}
+		float maxSynWt = runtimeData[netId].maxSynWt != NULL ? runtimeData[netId].maxSynWt[plasticOffset + j]
+			: runtimeData[netId].connMaxWt[connId];
+		clampSynWeight(wt, maxSynWt);
+		storeSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId, wt);
 
-			if (lNId == groupConfigs[netId][lGrpId].lStartN)
-				KERNEL_DEBUG("Weights, Change at %d (diff_firing: %f)", simTimeSec, diff_firing);
-
-			for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; j++) {
-				//	if (i==groupConfigs[0][g].StartN)
-				//		KERNEL_DEBUG("%1.2f %1.2f \t", wt[offset+j]*10, wtChange[offset+j]*10);
-				float effectiveWtChange = stdpScaleFactor_ * runtimeData[netId].wtChange[offset + j];
-				//				if (wtChange[offset+j])
-				//					printf("connId=%d, wtChange[%d]=%f\n",connIdsPreIdx[offset+j],offset+j,wtChange[offset+j]);
-
-								// homeostatic weight update
-								// FIXME: check WithESTDPtype and WithISTDPtype first and then do weight change update
-				switch (groupConfigs[netId][lGrpId].WithESTDPtype) {
-				case STANDARD:
-					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
-					} else {
-						// just STDP weight update
-						runtimeData[netId].wt[offset + j] += effectiveWtChange;
-					}
-					break;
-				case DA_MOD:
-					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						effectiveWtChange = runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + effectiveWtChange)*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
-					} else {
-						runtimeData[netId].wt[offset + j] += runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
-					}
-					break;
-				case UNKNOWN_STDP:
-				default:
-					// we shouldn't even be in here if !WithSTDP
-					break;
-				}
+		if (carryRoundingError) {
+			float storedWt = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, offset + j, connId);
+			runtimeData[netId].wtChange[plasticOffset + j] += (wt - storedWt) / (numTypes * runtimeData[netId].wtUpdateScale);
+		}
+	}
+}
 
-				switch (groupConfigs[netId][lGrpId].WithISTDPtype) {
-				case STANDARD:
-					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
-					} else {
-						// just STDP weight update
-						runtimeData[netId].wt[offset + j] += effectiveWtChange;
-					}
-					break;
-				case DA_MOD:
-					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						effectiveWtChange = runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + effectiveWtChange)*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
-					} else {
-						runtimeData[netId].wt[offset + j] += runtimeData[netId].grpDA[lGrpId] * effectiveWtChange;
-					}
-					break;
-				case UNKNOWN_STDP:
-				default:
-					// we shouldn't even be in here if !WithSTDP
-					break;
-				}
+// applies the pending weight updates of all neurons, so that wt and wtChange can be read or overwritten
+void SNN::flushWtUpdates_CPU(int netId) {
+	if (!networkConfigs[netId].sim_with_sparse_wt_update)
+		return;
 
-				// It is users' choice to decay weight change or not
-				// see setWeightAndWeightChangeUpdate()
-				runtimeData[netId].wtChange[offset + j] *= wtChangeDecay_;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (!groupConfigs[netId][lGrpId].withSparseWtUpdate)
+			continue;
 
-				// if this is an excitatory or inhibitory synapse
-				if (runtimeData[netId].maxSynWt[offset + j] >= 0) {
-					if (runtimeData[netId].wt[offset + j] >= runtimeData[netId].maxSynWt[offset + j])
-						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offset + j];
-					if (runtimeData[netId].wt[offset + j] < 0)
-						runtimeData[netId].wt[offset + j] = 0.0;
-				}
-				else {
-					if (runtimeData[netId].wt[offset + j] <= runtimeData[netId].maxSynWt[offset + j])
-						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offset + j];
-					if (runtimeData[netId].wt[offset + j] > 0)
-						runtimeData[netId].wt[offset + j] = 0.0;
-				}
-			}
-		}
+		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
+			applyPendingWtUpdates_CPU(netId, lNId);
 	}
 }
 
@@ -1297,7 +1980,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateWeights_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -1305,15 +1988,12 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
  * \brief This function is called every second by SNN::runNetwork(). It updates the firingTableD1(D2) and
  * timeTableD1(D2) by removing older firing information.
  */
- #if defined(WIN32) || defined(WIN64)
-	void SNN::shiftSpikeTables_CPU(int netId) {
-#else // POSIX
-	void* SNN::shiftSpikeTables_CPU(int netId) {
-#endif
+ void SNN::shiftSpikeTables_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// Read the neuron ids that fired in the last glbNetworkConfig.maxDelay seconds
 	// and put it to the beginning of the firing table...
-	for(int p = runtimeData[netId].timeTableD2[999], k = 0; p < runtimeData[netId].timeTableD2[999 + networkConfigs[netId].maxDelay + 1]; p++, k++) {
+	// these spikes start at timeTableD2[1000], which is subtracted from the shifted timeTableD2 below
+	for(int p = runtimeData[netId].timeTableD2[1000], k = 0; p < runtimeData[netId].timeTableD2[999 + networkConfigs[netId].maxDelay + 1]; p++, k++) {
 		runtimeData[netId].firingTableD2[k] = runtimeData[netId].firingTableD2[p];
 	}
 
@@ -1341,7 +2021,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> shiftSpikeTables_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -1357,8 +2037,16 @@ void SNN::allocateSNN_CPU(int netId) {
 	//KERNEL_INFO("Init:\t\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(total)/toMB,(float)((total-avail)/toMB), (float)(avail/toMB));
 	//previous=avail;
 
-	// allocate SNN::runtimeData[0].randNum for random number generators
-	runtimeData[netId].randNum = new float[networkConfigs[netId].numNPois];
+	// allocate SNN::runtimeData[0].poissonNextSpikeTime and poissonFiredIds for the poisson spike generator
+	// poisson neurons do not fire until a rate is assigned
+	runtimeData[netId].poissonNextSpikeTime = new unsigned int[networkConfigs[netId].numNPois];
+	std::fill(runtimeData[netId].poissonNextSpikeTime, runtimeData[netId].poissonNextSpikeTime + networkConfigs[netId].numNPois, POISSON_NO_SPIKE);
+	runtimeData[netId].poissonFiredIds = new int[networkConfigs[netId].numNPois];
+	runtimeData[netId].numPoissonFired = 0;
+	poissonWheel[netId].clear();
+
+	// allocate SNN::runtimeData[0].firedNeuronIds, which collects the fired neurons of each thread
+	runtimeData[netId].firedNeuronIds = new int[networkConfigs[netId].numN];
 	//KERNEL_INFO("Random Gen:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(previous-avail)/toMB, (float)((total-avail)/toMB),(float)(avail/toMB));
 	//previous=avail;
 
@@ -1384,11 +2072,30 @@ void SNN::allocateSNN_CPU(int netId) {
 	// initialize (copy from SNN) runtimeData[0].n(V,U,I)Buffer[]
 	copyNeuronState(netId, ALL, &runtimeData[netId], true);
 
+	// choose the update kernel of each regular group, which depends on the neuron parameters copied above
+	int numNSimd = 0;
+	neuronUpdateKernels[netId].assign(networkConfigs[netId].numGroups, NULL);
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (!(groupConfigs[netId][lGrpId].Type & POISSON_NEURON)) {
+			selectNeuronUpdateKernel_CPU(netId, lGrpId);
+			if (groupConfigs[netId][lGrpId].withSharedParams && !groupConfigs[netId][lGrpId].withCompartments)
+				numNSimd += groupConfigs[netId][lGrpId].numN;
+		}
+	}
+	if (simdLevel != SIMD_NONE)
+		KERNEL_INFO("CPU Runtime %d: %d of %d regular neurons are updated with %s (%d neurons per instruction)", netId,
+			numNSimd, networkConfigs[netId].numNReg, NeuronSimd::getLevelName(simdLevel), NeuronSimd::getWidth(simdLevel));
+
 	// copy STP state, considered as neuron state
 	if (sim_with_stp) {
 		// initialize (copy from SNN) stpu, stpx
 		copySTPState(netId, ALL, &runtimeData[netId], &managerRuntimeData, true);
 	}
+
+	// precompute the STDP curves of all plastic groups
+	// initialize runtimeData[0].stdpLUT, groupConfigs[0][].stdpLUTOffset, groupConfigs[0][].stdpLUTLength
+	if (sim_with_stdp)
+		generateSTDPLUT(netId, &runtimeData[netId]);
 	//KERNEL_INFO("Neuron State:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(previous-avail)/toMB,(float)((total-avail)/toMB), (float)(avail/toMB));
 	//previous=avail;
 
@@ -1407,6 +2114,22 @@ void SNN::allocateSNN_CPU(int netId) {
 	//KERNEL_INFO("Auxiliary Data:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB\n\n",(float)(previous-avail)/toMB,(float)((total-avail)/toMB), (float)(avail/toMB));
 	//previous=avail;
 
+	// report the memory used per synapse, compared to the layout with full SynInfo and per-synapse state (GPU runtime)
+	int numSyn = networkConfigs[netId].numPreSynNet;
+	int numPlastic = networkConfigs[netId].numPlasticPreSynNet;
+	size_t fullSynBytes = sizeof(SynInfo) * (networkConfigs[netId].numPostSynNet + numSyn)
+		+ (sizeof(float) + sizeof(short int) + sizeof(int) + (sim_with_fixedwts ? 0 : 2 * sizeof(float))) * numSyn;
+	size_t compactSynBytes = getCompactSynInfoSize(runtimeData[netId].postSynapticCompact, networkConfigs[netId].numPostSynNet)
+		+ getCompactSynInfoSize(runtimeData[netId].preSynapticCompact, numSyn)
+		+ sizeof(float) * networkConfigs[netId].numWtFp32
+		+ getWtReducedBytes(runtimeData[netId], networkConfigs[netId]) * (numSyn - networkConfigs[netId].numWtFp32)
+		+ (runtimeData[netId].wtFp32Bits != NULL ? (sizeof(unsigned long long) + sizeof(unsigned int)) * (numSyn / 64 + 1) : 0)
+		+ sizeof(short int) * numSyn
+		+ (sizeof(int) + sizeof(float) + (runtimeData[netId].maxSynWt != NULL ? sizeof(float) : 0)) * numPlastic
+		+ (sim_with_fixedwts ? 0 : sizeof(float) * numConnections);
+	KERNEL_INFO("CPU Runtime %d: %d synapses (%d plastic), %.1f bytes/synapse (%.1f bytes/synapse without compact layout)",
+		netId - CPU_RUNTIME_BASE, numSyn, numPlastic, (float)compactSynBytes / numSyn, (float)fullSynBytes / numSyn);
+
 	// TODO: move mulSynFast, mulSynSlow to ConnectConfig structure
 	// copy connection configs
 	//CUDA_CHECK_ERRORS(cudaMemcpyToSymbol(d_mulSynFast, mulSynFast, sizeof(float) * networkConfigs[netId].numConnections, 0, cudaMemcpyHostToDevice));
@@ -1451,6 +2174,18 @@ void SNN::allocateSNN_CPU(int netId) {
 
 	// allocation of CPU runtime data is done
 	runtimeData[netId].allocated = true;
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// spawn the persistent workers of this CPU runtime, each pinned to the next available core
+	// the workers are torn down in deleteRuntimeData
+	if (threadPool == NULL)
+		threadPool = new ThreadPool();
+
+	for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+		if (!threadPool->hasWorker(getWorkerId(netId, threadId)))
+			threadPool->startWorker(getWorkerId(netId, threadId), threadPool->getNumWorkers() % NUM_CPU_CORES);
+	}
+#endif
 }
 
 /*!
@@ -1460,7 +2195,10 @@ void SNN::allocateSNN_CPU(int netId) {
  * initialize Npre_plasticInv
  * (allocate and) copy Npre, Npre_plastic, Npre_plasticInv, cumulativePre, preSynapticIds
  * (allocate and) copy Npost, cumulativePost, postSynapticIds, postDelayInfo
+ * allocate and initialize cumulativePlasticPre
  *
+ * preSynapticIds are packed into preSynapticCompact when copying to the CPU runtime, and unpacked when copying
+ * back to the manager.
  *
  * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
  * \param[in] lGrpId the local group id in a local network, which specifiy the group(s) to be copied
@@ -1513,6 +2251,19 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 		dest->cumulativePre = new unsigned int[networkConfigs[netId].numNAssigned];
 	memcpy(&dest->cumulativePre[posN], &src->cumulativePre[posN], sizeof(int) * lengthN);
 
+	// beginning position of the plastic synapses, the CPU runtime only keeps wtChange, synSpikeTime, and maxSynWt
+	// of plastic synapses (the first Npre_plastic synapses of a neuron)
+	if (allocateMem) {
+		networkConfigs[netId].numPlasticPreSynNet = 0;
+		if (!sim_with_fixedwts) {
+			dest->cumulativePlasticPre = new unsigned int[networkConfigs[netId].numNAssigned];
+			for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+				dest->cumulativePlasticPre[lNId] = networkConfigs[netId].numPlasticPreSynNet;
+				networkConfigs[netId].numPlasticPreSynNet += dest->Npre_plastic[lNId];
+			}
+		}
+	}
+
 	// Npre, cumulativePre has been copied to destination
 	if (lGrpId == ALL) {
 		lengthSyn = networkConfigs[netId].numPreSynNet;
@@ -1525,9 +2276,13 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 		posSyn = dest->cumulativePre[groupConfigs[netId][lGrpId].lStartN];
 	}
 
-	if(allocateMem)
-		dest->preSynapticIds = new SynInfo[networkConfigs[netId].numPreSynNet];
-	memcpy(&dest->preSynapticIds[posSyn], &src->preSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
+	// the CPU runtime stores the pre-synaptic ids in compact form, which is restored when copying back to the manager
+	if(allocateMem) {
+		packSynInfo(&dest->preSynapticCompact, src->preSynapticIds, networkConfigs[netId].numPreSynNet, src->grpIds);
+	} else {
+		assert(dest == &managerRuntimeData);
+		unpackSynInfo(dest->preSynapticIds, src->preSynapticCompact, posSyn, lengthSyn, src->grpIds);
+	}
 }
 
 /*!
@@ -1536,6 +2291,8 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
  * This function:
  * (allocate and) copy Npost, cumulativePost, postSynapticIds, postDelayInfo
  *
+ * postSynapticIds are packed into postSynapticCompact when copying to the CPU runtime, and unpacked when copying
+ * back to the manager.
  *
  * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
  * \param[in] lGrpId the local group id in a local network, which specifiy the group(s) to be copied
@@ -1581,9 +2338,13 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 	}
 
 	// actual post synaptic connection information...
-	if(allocateMem)
-		dest->postSynapticIds = new SynInfo[networkConfigs[netId].numPostSynNet];
-	memcpy(&dest->postSynapticIds[posSyn], &src->postSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
+	// the CPU runtime stores the post-synaptic ids in compact form, which is restored when copying back to the manager
+	if(allocateMem) {
+		packSynInfo(&dest->postSynapticCompact, src->postSynapticIds, networkConfigs[netId].numPostSynNet, src->grpIds);
+	} else {
+		assert(dest == &managerRuntimeData);
+		unpackSynInfo(dest->postSynapticIds, src->postSynapticCompact, posSyn, lengthSyn, src->grpIds);
+	}
 
 	// static specific mapping and actual post-synaptic delay metric
 	if(allocateMem)
@@ -1596,7 +2357,18 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
  *
  * This function:
  * (allocate and) copy wt, wtChange, maxSynWt
+ * allocate and initialize connMaxWt, connWtPrecision, connWtScale
+ *
+ * The CPU runtime keeps wtChange and maxSynWt of plastic synapses only, and replaces maxSynWt by connMaxWt if the
+ * maximum weight is the same for all synapses of each connection.
  *
+ * The CPU runtime stores wt in the precision of its connections (see WeightPrecision). If all synapses belong to
+ * connections of the same reduced precision, wt is replaced by wtReduced. If the precisions differ, the weights of
+ * WT_FP32 connections are kept in wt, and the other weights in wtReduced, which is as wide as the widest reduced
+ * precision of the runtime. Each weight is stored in the format of its connection. The index of a synapse in either
+ * array is derived from its position with the bitmap wtFp32Bits and its prefix counts wtFp32Rank (1.5 bits per
+ * synapse). WT_INT8 connections are scaled such that the largest weight or maximum weight of the connection maps to
+ * 127.
  *
  * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
  * \param[in] dest pointer to runtime data desitnation
@@ -1609,27 +2381,328 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 void SNN::copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	assert(networkConfigs[netId].numPreSynNet > 0);
 
+	// the weights of neurons without recent STDP activity may lag behind (see applyPendingWtUpdates_CPU)
+	if (!allocateMem)
+		flushWtUpdates_CPU(netId);
+
 	// synaptic information based
-	if(allocateMem)
-		dest->wt = new float[networkConfigs[netId].numPreSynNet];
-	memcpy(dest->wt, src->wt, sizeof(float) * networkConfigs[netId].numPreSynNet);
+	int numSyn = networkConfigs[netId].numPreSynNet;
+	if (allocateMem) {
+		// find the precision of the connections of the synapses, and the scale of the int8 connections
+		dest->connWtScale = new float[numConnections];
+		std::vector<float> maxAbsWt(numConnections, 0.0f);
+		std::vector<bool> isUsed(numConnections, false);
+		bool isMixed = false;
+		networkConfigs[netId].wtPrecision = WT_FP32;
+		for (int pos = 0; pos < numSyn; pos++) {
+			short int connId = src->connIdsPreIdx[pos];
+			WeightPrecision precision = connectConfigMap[connId].wtPrecision;
+			if (pos == 0)
+				networkConfigs[netId].wtPrecision = precision;
+			isMixed = isMixed || precision != networkConfigs[netId].wtPrecision;
+			isUsed[connId] = true;
+			maxAbsWt[connId] = std::max(maxAbsWt[connId], std::max(fabs(src->wt[pos]), fabs(src->maxSynWt[pos])));
+		}
+		for (int connId = 0; connId < numConnections; connId++)
+			dest->connWtScale[connId] = getInt8WeightScale(maxAbsWt[connId]);
+
+		dest->connWtPrecision = NULL;
+		dest->wtFp32Bits = NULL;
+		dest->wtFp32Rank = NULL;
+		dest->wtReducedBytes = 0;
+		if (isMixed) {
+			networkConfigs[netId].wtPrecision = WT_FP32;
+			dest->connWtPrecision = new WeightPrecision[numConnections];
+			for (int connId = 0; connId < numConnections; connId++)
+				dest->connWtPrecision[connId] = isUsed[connId] ? connectConfigMap[connId].wtPrecision : WT_FP32;
+
+			// mark the synapses that are stored in wt, the others go to wtReduced
+			int numWords = numSyn / 64 + 1;
+			std::vector<unsigned long long> fp32Bits(numWords, 0ULL);
+			networkConfigs[netId].numWtFp32 = 0;
+			dest->wtReducedBytes = 1;
+			for (int pos = 0; pos < numSyn; pos++) {
+				WeightPrecision precision = dest->connWtPrecision[src->connIdsPreIdx[pos]];
+				if (precision == WT_FP32) {
+					fp32Bits[pos / 64] |= 1ULL << (pos % 64);
+					networkConfigs[netId].numWtFp32++;
+				} else {
+					dest->wtReducedBytes = std::max(dest->wtReducedBytes, getWeightBytes(precision));
+				}
+			}
+
+			if (networkConfigs[netId].numWtFp32 > 0) {
+				dest->wtFp32Bits = new unsigned long long[numWords];
+				dest->wtFp32Rank = new unsigned int[numWords];
+				unsigned int rank = 0;
+				for (int i = 0; i < numWords; i++) {
+					dest->wtFp32Bits[i] = fp32Bits[i];
+					dest->wtFp32Rank[i] = rank;
+					rank += countSetBits(fp32Bits[i]);
+				}
+			}
+		} else {
+			networkConfigs[netId].numWtFp32 = (networkConfigs[netId].wtPrecision == WT_FP32) ? numSyn : 0;
+		}
+
+		int numWtFp32 = networkConfigs[netId].numWtFp32;
+		int numWtReduced = numSyn - numWtFp32;
+		dest->wt = (numWtFp32 > 0) ? new float[numWtFp32] : NULL;
+		dest->wtReduced = NULL;
+		if (numWtReduced > 0) {
+			if (getWtReducedBytes(*dest, networkConfigs[netId]) == 2)
+				dest->wtReduced = new uint16_t[numWtReduced];
+			else
+				dest->wtReduced = new int8_t[numWtReduced];
+		}
+
+		if (isMixed) {
+			KERNEL_INFO("CPU Runtime %d: weights stored in mixed precision, %d in fp32 and %d in %d bytes",
+				netId - CPU_RUNTIME_BASE, numWtFp32, numWtReduced, dest->wtReducedBytes);
+		} else if (networkConfigs[netId].wtPrecision != WT_FP32) {
+			KERNEL_INFO("CPU Runtime %d: weights stored in %s", netId - CPU_RUNTIME_BASE,
+				weightPrecision_string[networkConfigs[netId].wtPrecision]);
+		}
+	}
+
+	if (dest == &managerRuntimeData) {
+		for (int pos = 0; pos < numSyn; pos++)
+			dest->wt[pos] = loadSynWeight(*src, networkConfigs[netId].wtPrecision, pos, src->connIdsPreIdx[pos]);
+	} else {
+		for (int pos = 0; pos < numSyn; pos++)
+			storeSynWeight(*dest, networkConfigs[netId].wtPrecision, pos, src->connIdsPreIdx[pos], src->wt[pos]);
+	}
 
 	// we don't need these data structures if the network doesn't have any plastic synapses at all
 	// they show up in updateLTP() and updateSynapticWeights(), two functions that do not get called if
 	// sim_with_fixedwts is set
+	// the CPU runtime only keeps them for plastic synapses (see cumulativePlasticPre)
 	if (!sim_with_fixedwts) {
-		// synaptic weight derivative
-		if(allocateMem)
-			dest->wtChange = new float[networkConfigs[netId].numPreSynNet];
-		memcpy(dest->wtChange, src->wtChange, sizeof(float) * networkConfigs[netId].numPreSynNet);
+		if (allocateMem) {
+			int numPlastic = networkConfigs[netId].numPlasticPreSynNet;
+
+			// synaptic weight derivative
+			dest->wtChange = new float[numPlastic];
+			copyPlasticSynapses(src->wtChange, dest->wtChange, *dest, 0, networkConfigs[netId].numNAssigned, true);
+
+			// synaptic weight maximum value, stored per connection if it is the same for all synapses of a connection
+			dest->connMaxWt = new float[numConnections];
+			std::vector<bool> isSet(numConnections, false);
+			bool isUniform = true;
+			for (int pos = 0; pos < networkConfigs[netId].numPreSynNet; pos++) {
+				short int connId = src->connIdsPreIdx[pos];
+				if (!isSet[connId]) {
+					dest->connMaxWt[connId] = src->maxSynWt[pos];
+					isSet[connId] = true;
+				}
+				isUniform = isUniform && src->maxSynWt[pos] == dest->connMaxWt[connId];
+			}
 
-		// synaptic weight maximum value
-		if(allocateMem)
-			dest->maxSynWt = new float[networkConfigs[netId].numPreSynNet];
-		memcpy(dest->maxSynWt, src->maxSynWt, sizeof(float) * networkConfigs[netId].numPreSynNet);
+			if (isUniform) {
+				dest->maxSynWt = NULL;
+			} else {
+				dest->maxSynWt = new float[numPlastic];
+				copyPlasticSynapses(src->maxSynWt, dest->maxSynWt, *dest, 0, networkConfigs[netId].numNAssigned, true);
+			}
+		} else {
+			assert(dest == &managerRuntimeData);
+
+			// fixed synapses do not change, restore them from the connection
+			for (int pos = 0; pos < networkConfigs[netId].numPreSynNet; pos++) {
+				dest->wtChange[pos] = 0.0f;
+				dest->maxSynWt[pos] = src->connMaxWt[src->connIdsPreIdx[pos]];
+			}
+
+			copyPlasticSynapses(dest->wtChange, src->wtChange, *src, 0, networkConfigs[netId].numNAssigned, false);
+			if (src->maxSynWt != NULL)
+				copyPlasticSynapses(dest->maxSynWt, src->maxSynWt, *src, 0, networkConfigs[netId].numNAssigned, false);
+		}
+	}
+}
+
+/*!
+ * \brief switches a CPU runtime from storing the maximum weights per connection to storing them per synapse
+ *
+ * The maximum weight of each plastic synapse is initialized from connMaxWt. Does nothing if the runtime already
+ * stores maxSynWt.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ *
+ * \sa copyMaxSynWt, collectCheckpointArrays
+ * \since v4.0
+ */
+void SNN::allocateMaxSynWt_CPU(int netId) {
+	assert(!sim_with_fixedwts);
+
+	if (runtimeData[netId].maxSynWt != NULL)
+		return;
+
+	runtimeData[netId].maxSynWt = new float[networkConfigs[netId].numPlasticPreSynNet];
+	for (int nId = 0; nId < networkConfigs[netId].numNAssigned; nId++) {
+		for (int j = 0; j < runtimeData[netId].Npre_plastic[nId]; j++) {
+			short int connId = runtimeData[netId].connIdsPreIdx[runtimeData[netId].cumulativePre[nId] + j];
+			runtimeData[netId].maxSynWt[runtimeData[netId].cumulativePlasticPre[nId] + j] = runtimeData[netId].connMaxWt[connId];
+		}
+	}
+}
+
+/*!
+ * \brief copies the maximum weights of the plastic synapses of a neuron from the manager to a CPU runtime
+ *
+ * If the runtime stores the maximum weight per connection (connMaxWt), it switches to storing it per synapse, because
+ * the manager may have changed the maximum weight of individual synapses.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] lNId the local id of the post-synaptic neuron
+ *
+ * \sa setWeight, scaleWeights, biasWeights
+ * \since v4.0
+ */
+void SNN::copyMaxSynWt(int netId, int lNId) {
+	assert(!sim_with_fixedwts);
+
+	allocateMaxSynWt_CPU(netId);
+	copyPlasticSynapses(managerRuntimeData.maxSynWt, runtimeData[netId].maxSynWt, runtimeData[netId], lNId, lNId + 1, true);
+}
+
+/*!
+ * \brief copies the weights of consecutive synapses from the manager to a CPU runtime
+ *
+ * The weights are rounded to the precision of their connections. If a weight or maximum weight of a WT_INT8
+ * connection exceeds the range of its scale, the connection is rescaled first.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] pos the position of the first synapse
+ * \param[in] length the number of synapses
+ *
+ * \sa setWeight, scaleWeights, biasWeights
+ * \since v4.0
+ */
+void SNN::copySynWt(int netId, int pos, int length) {
+	for (int i = pos; i < pos + length; i++) {
+		short int connId = runtimeData[netId].connIdsPreIdx[i];
+		bool isInt8 = (runtimeData[netId].connWtPrecision != NULL) ? runtimeData[netId].connWtPrecision[connId] == WT_INT8
+			: networkConfigs[netId].wtPrecision == WT_INT8;
+		float maxAbsWt = std::max(fabs(managerRuntimeData.wt[i]), fabs(managerRuntimeData.maxSynWt[i]));
+		if (isInt8 && maxAbsWt > 127.0f * runtimeData[netId].connWtScale[connId])
+			setConnWtScale_CPU(netId, connId, getInt8WeightScale(maxAbsWt));
+
+		storeSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, i, connId, managerRuntimeData.wt[i]);
+	}
+}
+
+/*!
+ * \brief changes the scale of a WT_INT8 connection of a CPU runtime and requantises the weights of its synapses
+ *
+ * The weights are requantised from the manager, which must hold the current weights (see fetchSynapseState), so
+ * that every weight is only rounded once.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] connId the id of the connection
+ * \param[in] scale the new scale
+ *
+ * \sa copySynWt
+ * \since v4.0
+ */
+void SNN::setConnWtScale_CPU(int netId, short int connId, float scale) {
+	KERNEL_DEBUG("CPU Runtime %d: connection %d rescaled from %f to %f", netId - CPU_RUNTIME_BASE, connId,
+		runtimeData[netId].connWtScale[connId], scale);
+
+	runtimeData[netId].connWtScale[connId] = scale;
+	for (int pos = 0; pos < networkConfigs[netId].numPreSynNet; pos++) {
+		if (runtimeData[netId].connIdsPreIdx[pos] == connId)
+			storeSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, pos, connId, managerRuntimeData.wt[pos]);
 	}
 }
 
+/*!
+ * \brief lists the mutable state of a CPU runtime that is stored in a checkpoint
+ *
+ * The state consists of the neuron state (voltage, recovery, currents, conductances, refractory periods), the STP
+ * buffers, the synaptic state (wt, wtChange, maxSynWt, spike times or traces, sparse update bookkeeping), the firing
+ * and time tables, the Poisson spike schedule and the neuromodulator concentrations. Arrays that are not allocated
+ * (NULL) are skipped by SNN::collectCheckpointArrays, which allocates maxSynWt of plastic networks beforehand. The random numbers of a CPU runtime are derived from the seed
+ * and the simulation time, so restoring simTime restores the RNG state.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[out] arrays the arrays are appended to this list
+ *
+ * \sa saveCheckpoint loadCheckpoint
+ * \since v4.0
+ */
+void SNN::collectCheckpointArrays_CPU(int netId, std::vector<CheckpointArray>& arrays) {
+	RuntimeData* rtd = &runtimeData[netId];
+	const NetworkConfigRT& config = networkConfigs[netId];
+	size_t numNReg = config.numNReg;
+	size_t numPlastic = config.numPlasticPreSynNet;
+	size_t numSyn = config.numPreSynNet;
+	size_t stpLength = config.numN * (config.maxDelay + 1);
+
+	// spike counters
+	arrays.push_back(CheckpointArray("spikeCountSec", netId, &rtd->spikeCountSec, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountD1Sec", netId, &rtd->spikeCountD1Sec, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountD2Sec", netId, &rtd->spikeCountD2Sec, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountExtRxD1Sec", netId, &rtd->spikeCountExtRxD1Sec, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountExtRxD2Sec", netId, &rtd->spikeCountExtRxD2Sec, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCount", netId, &rtd->spikeCount, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountD1", netId, &rtd->spikeCountD1, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountD2", netId, &rtd->spikeCountD2, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("nPoissonSpikes", netId, &rtd->nPoissonSpikes, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountLastSecLeftD2", netId, &rtd->spikeCountLastSecLeftD2, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountExtRxD2", netId, &rtd->spikeCountExtRxD2, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("spikeCountExtRxD1", netId, &rtd->spikeCountExtRxD1, sizeof(unsigned int)));
+	arrays.push_back(CheckpointArray("nSpikeCnt", netId, rtd->nSpikeCnt, sizeof(int) * config.numN));
+
+	// neuron state
+	arrays.push_back(CheckpointArray("voltage", netId, rtd->voltage, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("nextVoltage", netId, rtd->nextVoltage, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("recovery", netId, rtd->recovery, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("current", netId, rtd->current, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("extCurrent", netId, rtd->extCurrent, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("curSpike", netId, rtd->curSpike, sizeof(bool) * numNReg));
+	arrays.push_back(CheckpointArray("lif_tau_ref_c", netId, rtd->lif_tau_ref_c, sizeof(int) * numNReg));
+	arrays.push_back(CheckpointArray("avgFiring", netId, rtd->avgFiring, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gAMPA", netId, rtd->gAMPA, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gNMDA", netId, rtd->gNMDA, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gNMDA_r", netId, rtd->gNMDA_r, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gNMDA_d", netId, rtd->gNMDA_d, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gGABAa", netId, rtd->gGABAa, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gGABAb", netId, rtd->gGABAb, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gGABAb_r", netId, rtd->gGABAb_r, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("gGABAb_d", netId, rtd->gGABAb_d, sizeof(float) * numNReg));
+	arrays.push_back(CheckpointArray("stpu", netId, rtd->stpu, sizeof(float) * stpLength));
+	arrays.push_back(CheckpointArray("stpx", netId, rtd->stpx, sizeof(float) * stpLength));
+	arrays.push_back(CheckpointArray("lastSpikeTime", netId, rtd->lastSpikeTime, sizeof(int) * config.numNAssigned));
+	arrays.push_back(CheckpointArray("spikeTraces", netId, rtd->spikeTraces, sizeof(SpikeTrace) * config.numNAssigned));
+
+	// synaptic state, the weights are stored in the precision of the runtime
+	arrays.push_back(CheckpointArray("wt", netId, rtd->wt, sizeof(float) * config.numWtFp32));
+	arrays.push_back(CheckpointArray("wtReduced", netId, rtd->wtReduced,
+		getWtReducedBytes(*rtd, config) * (numSyn - config.numWtFp32)));
+	arrays.push_back(CheckpointArray("connWtScale", netId, rtd->connWtScale, sizeof(float) * numConnections));
+	arrays.push_back(CheckpointArray("wtChange", netId, rtd->wtChange, sizeof(float) * numPlastic));
+	arrays.push_back(CheckpointArray("maxSynWt", netId, rtd->maxSynWt, sizeof(float) * numPlastic));
+	arrays.push_back(CheckpointArray("synSpikeTime", netId, rtd->synSpikeTime, sizeof(int) * numPlastic));
+	arrays.push_back(CheckpointArray("wtDirty", netId, rtd->wtDirty, sizeof(unsigned int) * (numNReg / 32 + 1)));
+	arrays.push_back(CheckpointArray("wtUpdateEpoch", netId, rtd->wtUpdateEpoch, sizeof(int) * (numNReg + 1)));
+	arrays.push_back(CheckpointArray("numWtUpdates", netId, &rtd->numWtUpdates, sizeof(int)));
+	arrays.push_back(CheckpointArray("wtUpdateScale", netId, &rtd->wtUpdateScale, sizeof(float)));
+
+	// firing and time tables
+	arrays.push_back(CheckpointArray("timeTableD1", netId, rtd->timeTableD1, sizeof(unsigned int) * TIMING_COUNT));
+	arrays.push_back(CheckpointArray("timeTableD2", netId, rtd->timeTableD2, sizeof(unsigned int) * TIMING_COUNT));
+	arrays.push_back(CheckpointArray("firingTableD1", netId, rtd->firingTableD1, sizeof(int) * config.maxSpikesD1));
+	arrays.push_back(CheckpointArray("firingTableD2", netId, rtd->firingTableD2, sizeof(int) * config.maxSpikesD2));
+
+	// poisson spike schedule and neuromodulators
+	arrays.push_back(CheckpointArray("poissonNextSpikeTime", netId, rtd->poissonNextSpikeTime, sizeof(unsigned int) * config.numNPois));
+	arrays.push_back(CheckpointArray("poissonFireRate", netId, rtd->poissonFireRate, sizeof(float) * config.numNPois));
+	arrays.push_back(CheckpointArray("grpDA", netId, rtd->grpDA, sizeof(float) * config.numGroups));
+	arrays.push_back(CheckpointArray("grp5HT", netId, rtd->grp5HT, sizeof(float) * config.numGroups));
+	arrays.push_back(CheckpointArray("grpACh", netId, rtd->grpACh, sizeof(float) * config.numGroups));
+	arrays.push_back(CheckpointArray("grpNE", netId, rtd->grpNE, sizeof(float) * config.numGroups));
+}
+
 /*!
  * \brief this function allocates memory sapce and copies variables related to nueron state to it
  *
@@ -1700,6 +2773,10 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 		dest->curSpike = new bool[length];
 	memcpy(&dest->curSpike[ptrPos], &managerRuntimeData.curSpike[ptrPos], sizeof(bool) * length);
 
+	// scratch buffer of the vectorized neuron update, holds the total input current of each neuron
+	if (allocateMem)
+		dest->totalCurrent = new float[length];
+
 	copyNeuronParameters(netId, lGrpId, dest, allocateMem);
 
 	if (networkConfigs[netId].sim_with_nm)
@@ -1981,7 +3058,8 @@ void SNN::copyExternalCurrent(int netId, int lGrpId, RuntimeData* dest, bool all
  * \brief this function allocates memory sapce and copies neural parameters to it
  *
  * This function:
- * (allocate and) copy Izh_a, Izh_b, Izh_c, Izh_d
+ * detect groups with shared neuron parameters and store their parameters in the group config
+ * (allocate and) copy Izh_a, Izh_b, Izh_c, Izh_d, etc. of all other groups
  * initialize baseFiringInv
  * (allocate and) copy baseFiring, baseFiringInv
  *
@@ -2028,71 +3106,120 @@ void SNN::copyNeuronParameters(int netId, int lGrpId, RuntimeData* dest, bool al
 		length = groupConfigs[netId][lGrpId].numN;
 	}
 
-	if(allocateMem)
-		dest->Izh_a = new float[length];
-	memcpy(&dest->Izh_a[ptrPos], &(managerRuntimeData.Izh_a[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->Izh_b = new float[length];
-	memcpy(&dest->Izh_b[ptrPos], &(managerRuntimeData.Izh_b[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->Izh_c = new float[length];
-	memcpy(&dest->Izh_c[ptrPos], &(managerRuntimeData.Izh_c[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->Izh_d = new float[length];
-	memcpy(&dest->Izh_d[ptrPos], &(managerRuntimeData.Izh_d[ptrPos]), sizeof(float) * length);
-
-	if (allocateMem)
-		dest->Izh_C = new float[length];
-	memcpy(&dest->Izh_C[ptrPos], &(managerRuntimeData.Izh_C[ptrPos]), sizeof(float) * length);
-
-	if (allocateMem)
-		dest->Izh_k = new float[length];
-	memcpy(&dest->Izh_k[ptrPos], &(managerRuntimeData.Izh_k[ptrPos]), sizeof(float) * length);
+	// groups whose neurons all have the same parameters (e.g., setNeuronParameters was called with zero standard
+	// deviations) keep their parameters in the group config, only heterogeneous groups get per-neuron arrays
+	if (allocateMem) {
+		networkConfigs[netId].numNParamReg = 0;
+		for (int lGrpIdx = 0; lGrpIdx < networkConfigs[netId].numGroups; lGrpIdx++) {
+			GroupConfigRT* grp = &groupConfigs[netId][lGrpIdx];
+			grp->paramOffset = 0;
+			grp->withSharedParams = false;
+			if (grp->Type & POISSON_NEURON)
+				continue;
 
-	if (allocateMem)
-		dest->Izh_vr = new float[length];
-	memcpy(&dest->Izh_vr[ptrPos], &(managerRuntimeData.Izh_vr[ptrPos]), sizeof(float) * length);
+			int lStartN = grp->lStartN, lEndN = grp->lEndN;
+			// only the parameters used by the neuron model of the group are compared
+			if (grp->isLIF) {
+				grp->withSharedParams = isUniform(managerRuntimeData.lif_tau_m, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.lif_tau_ref, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.lif_vTh, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.lif_vReset, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.lif_gain, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.lif_bias, lStartN, lEndN);
+			} else {
+				grp->withSharedParams = isUniform(managerRuntimeData.Izh_a, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.Izh_b, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.Izh_c, lStartN, lEndN)
+					&& isUniform(managerRuntimeData.Izh_d, lStartN, lEndN);
+				if (grp->withParamModel_9) {
+					grp->withSharedParams = grp->withSharedParams
+						&& isUniform(managerRuntimeData.Izh_C, lStartN, lEndN)
+						&& isUniform(managerRuntimeData.Izh_k, lStartN, lEndN)
+						&& isUniform(managerRuntimeData.Izh_vr, lStartN, lEndN)
+						&& isUniform(managerRuntimeData.Izh_vt, lStartN, lEndN)
+						&& isUniform(managerRuntimeData.Izh_vpeak, lStartN, lEndN);
+				}
+			}
 
-	if (allocateMem)
-		dest->Izh_vt = new float[length];
-	memcpy(&dest->Izh_vt[ptrPos], &(managerRuntimeData.Izh_vt[ptrPos]), sizeof(float) * length);
+			if (!grp->withSharedParams) {
+				grp->paramOffset = networkConfigs[netId].numNParamReg - lStartN;
+				networkConfigs[netId].numNParamReg += grp->numN;
+			}
+		}
 
-	if (allocateMem)
-		dest->Izh_vpeak = new float[length];
-	memcpy(&dest->Izh_vpeak[ptrPos], &(managerRuntimeData.Izh_vpeak[ptrPos]), sizeof(float) * length);
+		KERNEL_DEBUG("CPU Runtime %d: %d of %d regular neurons with per-neuron parameters", netId,
+			networkConfigs[netId].numNParamReg, networkConfigs[netId].numNReg);
+
+		int numNParam = networkConfigs[netId].numNParamReg;
+		if (numNParam > 0) {
+			dest->Izh_a = new float[numNParam];
+			dest->Izh_b = new float[numNParam];
+			dest->Izh_c = new float[numNParam];
+			dest->Izh_d = new float[numNParam];
+			dest->Izh_C = new float[numNParam];
+			dest->Izh_k = new float[numNParam];
+			dest->Izh_vr = new float[numNParam];
+			dest->Izh_vt = new float[numNParam];
+			dest->Izh_vpeak = new float[numNParam];
+			dest->lif_tau_m = new int[numNParam];
+			dest->lif_tau_ref = new int[numNParam];
+			dest->lif_vTh = new float[numNParam];
+			dest->lif_vReset = new float[numNParam];
+			dest->lif_gain = new float[numNParam];
+			dest->lif_bias = new float[numNParam];
+		}
+	}
 
-	//LIF neuron
-	if(allocateMem)
-		dest->lif_tau_m = new int[length];
-	memcpy(&dest->lif_tau_m[ptrPos], &(managerRuntimeData.lif_tau_m[ptrPos]), sizeof(int) * length);
+	int lGrpIdStart = (lGrpId == ALL) ? 0 : lGrpId;
+	int lGrpIdEnd = (lGrpId == ALL) ? networkConfigs[netId].numGroups : lGrpId + 1;
+	for (int lGrpIdx = lGrpIdStart; lGrpIdx < lGrpIdEnd; lGrpIdx++) {
+		GroupConfigRT* grp = &groupConfigs[netId][lGrpIdx];
+		if (grp->Type & POISSON_NEURON)
+			continue;
 
-	if(allocateMem)
-		dest->lif_tau_ref = new int[length];
-	memcpy(&dest->lif_tau_ref[ptrPos], &(managerRuntimeData.lif_tau_ref[ptrPos]), sizeof(int) * length);
+		int lStartN = grp->lStartN;
+		if (grp->withSharedParams) {
+			grp->Izh_a = managerRuntimeData.Izh_a[lStartN];
+			grp->Izh_b = managerRuntimeData.Izh_b[lStartN];
+			grp->Izh_c = managerRuntimeData.Izh_c[lStartN];
+			grp->Izh_d = managerRuntimeData.Izh_d[lStartN];
+			grp->Izh_C = managerRuntimeData.Izh_C[lStartN];
+			grp->Izh_k = managerRuntimeData.Izh_k[lStartN];
+			grp->Izh_vr = managerRuntimeData.Izh_vr[lStartN];
+			grp->Izh_vt = managerRuntimeData.Izh_vt[lStartN];
+			grp->Izh_vpeak = managerRuntimeData.Izh_vpeak[lStartN];
+			grp->lif_tau_m = managerRuntimeData.lif_tau_m[lStartN];
+			grp->lif_tau_ref = managerRuntimeData.lif_tau_ref[lStartN];
+			grp->lif_vTh = managerRuntimeData.lif_vTh[lStartN];
+			grp->lif_vReset = managerRuntimeData.lif_vReset[lStartN];
+			grp->lif_gain = managerRuntimeData.lif_gain[lStartN];
+			grp->lif_bias = managerRuntimeData.lif_bias[lStartN];
+		} else {
+			int pos = lStartN + grp->paramOffset;
+			int numN = grp->numN;
+			memcpy(&dest->Izh_a[pos], &(managerRuntimeData.Izh_a[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_b[pos], &(managerRuntimeData.Izh_b[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_c[pos], &(managerRuntimeData.Izh_c[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_d[pos], &(managerRuntimeData.Izh_d[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_C[pos], &(managerRuntimeData.Izh_C[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_k[pos], &(managerRuntimeData.Izh_k[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_vr[pos], &(managerRuntimeData.Izh_vr[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_vt[pos], &(managerRuntimeData.Izh_vt[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->Izh_vpeak[pos], &(managerRuntimeData.Izh_vpeak[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->lif_tau_m[pos], &(managerRuntimeData.lif_tau_m[lStartN]), sizeof(int) * numN);
+			memcpy(&dest->lif_tau_ref[pos], &(managerRuntimeData.lif_tau_ref[lStartN]), sizeof(int) * numN);
+			memcpy(&dest->lif_vTh[pos], &(managerRuntimeData.lif_vTh[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->lif_vReset[pos], &(managerRuntimeData.lif_vReset[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->lif_gain[pos], &(managerRuntimeData.lif_gain[lStartN]), sizeof(float) * numN);
+			memcpy(&dest->lif_bias[pos], &(managerRuntimeData.lif_bias[lStartN]), sizeof(float) * numN);
+		}
+	}
 
+	// the refractory counter is neuron state, not a parameter
 	if(allocateMem)
 		dest->lif_tau_ref_c = new int[length];
 	memcpy(&dest->lif_tau_ref_c[ptrPos], &(managerRuntimeData.lif_tau_ref_c[ptrPos]), sizeof(int) * length);
 
-	if(allocateMem)
-		dest->lif_vTh = new float[length];
-	memcpy(&dest->lif_vTh[ptrPos], &(managerRuntimeData.lif_vTh[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->lif_vReset = new float[length];
-	memcpy(&dest->lif_vReset[ptrPos], &(managerRuntimeData.lif_vReset[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->lif_gain = new float[length];
-	memcpy(&dest->lif_gain[ptrPos], &(managerRuntimeData.lif_gain[ptrPos]), sizeof(float) * length);
-
-	if(allocateMem)
-		dest->lif_bias = new float[length];
-	memcpy(&dest->lif_bias[ptrPos], &(managerRuntimeData.lif_bias[ptrPos]), sizeof(float) * length);
-
 	// pre-compute baseFiringInv for fast computation on CPU cores
 	if (sim_with_homeostasis) {
 		float* baseFiringInv = new float[length];
@@ -2153,6 +3280,101 @@ void SNN::copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* sr
 	memcpy(dest->stpx, src->stpx, sizeof(float) * networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1));
 }
 
+// returns the number of integer spike time differences t (ms) with t * tauInv < 25, beyond which the kernels
+// ignore an exponential STDP curve
+static int getSTDPCurveLength(float tauInv) {
+	assert(tauInv > 0.0f);
+	int length = 0;
+	while (length * tauInv < 25)
+		length++;
+	return length;
+}
+
+/*!
+ * \brief this function allocates memory space and precomputes the STDP curves of all plastic groups
+ *
+ * Spike time differences are integer numbers of milliseconds and every curve is cut off after a few time
+ * constants, so the weight change of each curve is tabulated once instead of evaluating exp() for every pairing of
+ * a pre-synaptic spike and a post-synaptic spike. Entry t of a table holds the signed change of wtChange for a
+ * spike time difference of t ms, the change is zero for t >= stdpLUTLength.
+ *
+ * This function:
+ * initialize stdpLUTOffset, stdpLUTLength of every group
+ * allocate and compute stdpLUT
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] dest pointer to runtime data desitnation
+ *
+ * \sa allocateSNN_CPU updateLTP generatePostSynapticSpike
+ * \since v4.0
+ */
+void SNN::generateSTDPLUT(int netId, RuntimeData* dest) {
+	assert(dest->stdpLUT == NULL);
+
+	int numEntries = 0;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		GroupConfigRT* grp = &groupConfigs[netId][lGrpId];
+		for (int lut = 0; lut < STDP_LUT_NUM; lut++)
+			grp->stdpLUTLength[lut] = 0;
+
+		if (grp->WithSTDP && grp->WithESTDP) {
+			grp->stdpLUTLength[STDP_LUT_LTP_EXC] = getSTDPCurveLength(grp->TAU_PLUS_INV_EXC);
+			grp->stdpLUTLength[STDP_LUT_LTD_EXC] = getSTDPCurveLength(grp->TAU_MINUS_INV_EXC);
+		}
+
+		if (grp->WithSTDP && grp->WithISTDP) {
+			if (grp->WithISTDPcurve == PULSE_CURVE) {
+				int length = (int)floor(std::max(grp->LAMBDA, grp->DELTA)) + 1;
+				grp->stdpLUTLength[STDP_LUT_LTP_INB] = length;
+				grp->stdpLUTLength[STDP_LUT_LTD_INB] = length;
+			} else {
+				grp->stdpLUTLength[STDP_LUT_LTP_INB] = getSTDPCurveLength(grp->TAU_PLUS_INV_INB);
+				grp->stdpLUTLength[STDP_LUT_LTD_INB] = getSTDPCurveLength(grp->TAU_MINUS_INV_INB);
+			}
+		}
+
+		for (int lut = 0; lut < STDP_LUT_NUM; lut++) {
+			grp->stdpLUTOffset[lut] = numEntries;
+			numEntries += grp->stdpLUTLength[lut];
+		}
+	}
+
+	KERNEL_DEBUG("CPU Runtime %d: %d entries in STDP lookup tables", netId, numEntries);
+
+	dest->stdpLUT = new float[std::max(numEntries, 1)];
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		GroupConfigRT* grp = &groupConfigs[netId][lGrpId];
+
+		float* lut = &dest->stdpLUT[grp->stdpLUTOffset[STDP_LUT_LTP_EXC]];
+		for (int t = 0; t < grp->stdpLUTLength[STDP_LUT_LTP_EXC]; t++) {
+			if (grp->WithESTDPcurve == TIMING_BASED_CURVE)
+				lut[t] = t <= grp->GAMMA ? grp->OMEGA + grp->KAPPA * STDP(t, grp->ALPHA_PLUS_EXC, grp->TAU_PLUS_INV_EXC)
+					: -STDP(t, grp->ALPHA_PLUS_EXC, grp->TAU_PLUS_INV_EXC);
+			else
+				lut[t] = STDP(t, grp->ALPHA_PLUS_EXC, grp->TAU_PLUS_INV_EXC);
+		}
+
+		// both E-STDP curves share the exponential LTD
+		lut = &dest->stdpLUT[grp->stdpLUTOffset[STDP_LUT_LTD_EXC]];
+		for (int t = 0; t < grp->stdpLUTLength[STDP_LUT_LTD_EXC]; t++)
+			lut[t] = STDP(t, grp->ALPHA_MINUS_EXC, grp->TAU_MINUS_INV_EXC);
+
+		// LTP of inhibitory synapses decreases the synapse weight, LTD increases it
+		// the pulse curve applies to both spike orders
+		for (int type = STDP_LUT_LTP_INB; type <= STDP_LUT_LTD_INB; type++) {
+			lut = &dest->stdpLUT[grp->stdpLUTOffset[type]];
+			for (int t = 0; t < grp->stdpLUTLength[type]; t++) {
+				if (grp->WithISTDPcurve == PULSE_CURVE)
+					lut[t] = t <= grp->LAMBDA ? -grp->BETA_LTP : (t <= grp->DELTA ? -grp->BETA_LTD : 0.0f);
+				else if (type == STDP_LUT_LTP_INB)
+					lut[t] = -STDP(t, grp->ALPHA_PLUS_INB, grp->TAU_PLUS_INV_INB);
+				else
+					lut[t] = -STDP(t, grp->ALPHA_MINUS_INB, grp->TAU_MINUS_INV_INB);
+			}
+		}
+	}
+}
+
 // ToDo: move grpDA(5HT, ACh, NE)Buffer to copyAuxiliaryData
 /*!
  * \brief this function allocates memory sapce and copies variables related to group state to it
@@ -2246,10 +3468,42 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 	assert(networkConfigs[netId].maxNumPreSynN >= 0);
 	memset(dest->I_set, 0, sizeof(int) * networkConfigs[netId].numNReg * networkConfigs[netId].I_setLength);
 
-	// synSpikeTime: an array indicates the last time when a synapse got a spike
-	if(allocateMem)
-		dest->synSpikeTime = new int[networkConfigs[netId].numPreSynNet];
-	memcpy(dest->synSpikeTime, managerRuntimeData.synSpikeTime, sizeof(int) * networkConfigs[netId].numPreSynNet);
+	// synSpikeTime: an array indicates the last time when a plastic synapse got a spike
+	if (!sim_with_fixedwts && !networkConfigs[netId].sim_with_stdp_traces) {
+		if(allocateMem)
+			dest->synSpikeTime = new int[networkConfigs[netId].numPlasticPreSynNet];
+		copyPlasticSynapses(managerRuntimeData.synSpikeTime, dest->synSpikeTime, *dest, 0, networkConfigs[netId].numNAssigned, true);
+	}
+
+	// spikeTraces: the recent spikes of each neuron, which replace synSpikeTime
+	if (networkConfigs[netId].sim_with_stdp_traces) {
+		if (allocateMem)
+			dest->spikeTraces = new SpikeTrace[networkConfigs[netId].numNAssigned];
+		for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+			dest->spikeTraces[lNId].recent = 0ULL;
+			dest->spikeTraces[lNId].lastSpike = MAX_SIMULATION_TIME;
+			dest->spikeTraces[lNId].older = MAX_SIMULATION_TIME;
+		}
+	}
+
+	// wtDirty, wtUpdateEpoch: the neurons visited by sparse weight updates
+	// groups with homeostasis or DA-modulated STDP change their weights in every update and are updated in full
+	for (int lGrpIdx = 0; lGrpIdx < networkConfigs[netId].numGroups; lGrpIdx++) {
+		GroupConfigRT* grp = &groupConfigs[netId][lGrpIdx];
+		grp->withSparseWtUpdate = networkConfigs[netId].sim_with_sparse_wt_update && grp->WithSTDP && !grp->FixedInputWts
+			&& !grp->WithHomeostasis && grp->WithESTDPtype != DA_MOD && grp->WithISTDPtype != DA_MOD;
+	}
+
+	if (networkConfigs[netId].sim_with_sparse_wt_update) {
+		if (allocateMem) {
+			dest->wtDirty = new unsigned int[networkConfigs[netId].numNReg / 32 + 1];
+			dest->wtUpdateEpoch = new int[networkConfigs[netId].numNReg + 1];
+		}
+		memset(dest->wtDirty, 0, sizeof(int) * (networkConfigs[netId].numNReg / 32 + 1));
+		memset(dest->wtUpdateEpoch, 0, sizeof(int) * (networkConfigs[netId].numNReg + 1));
+		dest->numWtUpdates = 0;
+		dest->wtUpdateScale = stdpScaleFactor_;
+	}
 
 	// neural auxiliary data
 	// lastSpikeTime: an array indicates the last time of a neuron emitting a spike
@@ -2392,11 +3646,7 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 }
 
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::assignPoissonFiringRate_CPU(int netId) {
-#else // POSIX
-	void* SNN::assignPoissonFiringRate_CPU(int netId) {
-#endif
+void SNN::assignPoissonFiringRate_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
@@ -2415,6 +3665,38 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 			// rates allocated on CPU
 			memcpy(&runtimeData[netId].poissonFireRate[lNId - networkConfigs[netId].numNReg], rate->getRatePtrCPU(),
 					sizeof(float) * rate->getNumNeurons());
+
+			// the new rates take effect in the current step, the intervals are memoryless so they can be redrawn
+			for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
+				unsigned int nextSpikeTime = drawPoissonInterval(lNId, netId, 1);
+				if (nextSpikeTime != POISSON_NO_SPIKE) // a neuron that does not fire stays off the timing wheel
+					nextSpikeTime--;
+				runtimeData[netId].poissonNextSpikeTime[lNId - networkConfigs[netId].numNReg] = nextSpikeTime;
+			}
+		}
+	}
+
+	schedulePoissonSpikes_CPU(netId);
+}
+
+/*!
+ * \brief rebuilds the timing wheel of the poisson neurons of a CPU runtime from their next spike times
+ *
+ * \sa spikeGeneratorUpdate_CPU, assignPoissonFiringRate_CPU
+ * \since v4.0
+ */
+void SNN::schedulePoissonSpikes_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	poissonWheel[netId].assign(POISSON_WHEEL_SIZE, std::vector<int>());
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (!(groupConfigs[netId][lGrpId].Type & POISSON_NEURON) || groupConfigs[netId][lGrpId].isSpikeGenFunc)
+			continue;
+
+		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
+			unsigned int nextSpikeTime = runtimeData[netId].poissonNextSpikeTime[lNId - networkConfigs[netId].numNReg];
+			if (nextSpikeTime != POISSON_NO_SPIKE)
+				poissonWheel[netId][nextSpikeTime % POISSON_WHEEL_SIZE].push_back(lNId);
 		}
 	}
 }
@@ -2425,7 +3707,7 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> assignPoissonFiringRate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
@@ -2446,6 +3728,9 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 void SNN::copyWeightState(int netId, int lGrpId) {
 	int lengthSyn, posSyn;
 
+	// the weights of neurons without recent STDP activity may lag behind (see applyPendingWtUpdates_CPU)
+	flushWtUpdates_CPU(netId);
+
 	// first copy pre-connections info
 	copyPreConnectionInfo(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], false);
 
@@ -2464,14 +3749,18 @@ void SNN::copyWeightState(int netId, int lGrpId) {
 	assert(posSyn < networkConfigs[netId].numPreSynNet || networkConfigs[netId].numPreSynNet == 0);
 	assert(lengthSyn <= networkConfigs[netId].numPreSynNet);
 
-	memcpy(&managerRuntimeData.wt[posSyn], &runtimeData[netId].wt[posSyn], sizeof(float) * lengthSyn);
+	for (int pos = posSyn; pos < posSyn + lengthSyn; pos++)
+		managerRuntimeData.wt[pos] = loadSynWeight(runtimeData[netId], networkConfigs[netId].wtPrecision, pos,
+			runtimeData[netId].connIdsPreIdx[pos]);
 
 	// copy firing time for individual synapses
 	//CUDA_CHECK_ERRORS(cudaMemcpy(&managerRuntimeData.synSpikeTime[cumPos_syn], &runtimeData[netId].synSpikeTime[cumPos_syn], sizeof(int) * length_wt, cudaMemcpyDeviceToHost));
 
 	if ((!sim_with_fixedwts) || sim_with_stdp) {
-		// copy synaptic weight derivative
-		memcpy(&managerRuntimeData.wtChange[posSyn], &runtimeData[netId].wtChange[posSyn], sizeof(float) * lengthSyn);
+		// copy synaptic weight derivative of plastic synapses
+		int lNIdStart = (lGrpId == ALL) ? 0 : groupConfigs[netId][lGrpId].lStartN;
+		int lNIdEnd = (lGrpId == ALL) ? networkConfigs[netId].numNAssigned : groupConfigs[netId][lGrpId].lEndN + 1;
+		copyPlasticSynapses(managerRuntimeData.wtChange, runtimeData[netId].wtChange, runtimeData[netId], lNIdStart, lNIdEnd, false);
 	}
 }
 
@@ -2491,6 +3780,11 @@ void SNN::copyLastSpikeTime(int netId) {
 	memcpy(managerRuntimeData.lastSpikeTime, runtimeData[netId].lastSpikeTime, sizeof(int) *  networkConfigs[netId].numN);
 }
 
+void SNN::copyNeuronVariables(int netId) {
+	memcpy(managerRuntimeData.voltage, runtimeData[netId].voltage, sizeof(float) * networkConfigs[netId].numNReg);
+	memcpy(managerRuntimeData.recovery, runtimeData[netId].recovery, sizeof(float) * networkConfigs[netId].numNReg);
+}
+
 /*!
 * \brief This function fetch the spike count in all local networks and sum the up
 */
@@ -2521,17 +3815,14 @@ void SNN::copySpikeTables(int netId) {
 	memcpy(managerRuntimeData.timeTableD1, runtimeData[netId].timeTableD1, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
 }
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::deleteRuntimeData_CPU(int netId) {
-#else // POSIX
-	void* SNN::deleteRuntimeData_CPU(int netId) {
-#endif
+void SNN::deleteRuntimeData_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// free all pointers
 	delete [] runtimeData[netId].voltage;
 	delete [] runtimeData[netId].nextVoltage;
 	delete [] runtimeData[netId].recovery;
 	delete [] runtimeData[netId].current;
+	delete [] runtimeData[netId].totalCurrent;
 	delete [] runtimeData[netId].extCurrent;
 	delete [] runtimeData[netId].curSpike;
 	delete [] runtimeData[netId].Npre;
@@ -2540,10 +3831,24 @@ void SNN::copySpikeTables(int netId) {
 	delete [] runtimeData[netId].Npost;
 	delete [] runtimeData[netId].cumulativePost;
 	delete [] runtimeData[netId].cumulativePre;
+	delete [] runtimeData[netId].cumulativePlasticPre;
 	delete [] runtimeData[netId].synSpikeTime;
+	delete [] runtimeData[netId].spikeTraces;
+	delete [] runtimeData[netId].stdpLUT;
+	delete [] runtimeData[netId].wtDirty;
+	delete [] runtimeData[netId].wtUpdateEpoch;
 	delete [] runtimeData[netId].wt;
+	if (getWtReducedBytes(runtimeData[netId], networkConfigs[netId]) == 2)
+		delete [] (uint16_t*)runtimeData[netId].wtReduced;
+	else
+		delete [] (int8_t*)runtimeData[netId].wtReduced;
+	delete [] runtimeData[netId].connWtPrecision;
+	delete [] runtimeData[netId].wtFp32Bits;
+	delete [] runtimeData[netId].wtFp32Rank;
+	delete [] runtimeData[netId].connWtScale;
 	delete [] runtimeData[netId].wtChange;
 	delete [] runtimeData[netId].maxSynWt;
+	delete [] runtimeData[netId].connMaxWt;
 	delete [] runtimeData[netId].nSpikeCnt;
 	delete [] runtimeData[netId].avgFiring;
 	delete [] runtimeData[netId].baseFiring;
@@ -2608,8 +3913,8 @@ void SNN::copySpikeTables(int netId) {
 	delete [] runtimeData[netId].connIdsPreIdx;
 
 	delete [] runtimeData[netId].postDelayInfo;
-	delete [] runtimeData[netId].postSynapticIds;
-	delete [] runtimeData[netId].preSynapticIds;
+	deleteSynInfo(&runtimeData[netId].postSynapticCompact);
+	deleteSynInfo(&runtimeData[netId].preSynapticCompact);
 	delete [] runtimeData[netId].I_set;
 	delete [] runtimeData[netId].poissonFireRate;
 	delete [] runtimeData[netId].lastSpikeTime;
@@ -2641,8 +3946,14 @@ void SNN::copySpikeTables(int netId) {
 	delete [] runtimeData[netId].extFiringTableEndIdxD2;
 	delete [] runtimeData[netId].extFiringTableEndIdxD1;
 
-	if (runtimeData[netId].randNum != NULL) delete [] runtimeData[netId].randNum;
-	runtimeData[netId].randNum = NULL;
+	if (runtimeData[netId].poissonNextSpikeTime != NULL) delete [] runtimeData[netId].poissonNextSpikeTime;
+	runtimeData[netId].poissonNextSpikeTime = NULL;
+	if (runtimeData[netId].poissonFiredIds != NULL) delete [] runtimeData[netId].poissonFiredIds;
+	runtimeData[netId].poissonFiredIds = NULL;
+	poissonWheel[netId].clear();
+	neuronUpdateKernels[netId].clear();
+	if (runtimeData[netId].firedNeuronIds != NULL) delete [] runtimeData[netId].firedNeuronIds;
+	runtimeData[netId].firedNeuronIds = NULL;
 }
 
 #if !defined(WIN32) && !defined(WIN64) // Linux or MAC
@@ -2651,7 +3962,7 @@ void SNN::copySpikeTables(int netId) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> deleteRuntimeData_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
 #endif
 
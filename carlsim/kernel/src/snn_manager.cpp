@@ -60,8 +60,18 @@
 #include <neuron_monitor_core.h>
 
 #include <spike_buffer.h>
+#include <thread_pool.h>
+#include <checkpoint_writer.h>
+#include <monitor_file_writer.h>
+#include <philox_rng.h>
 #include <error_code.h>
 
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // \FIXME what are the following for? why were they all the way at the bottom of this file?
 
 #define COMPACTION_ALIGNMENT_PRE  16
@@ -94,7 +104,7 @@ SNN::~SNN() {
 // make from each neuron in grpId1 to 'numPostSynapses' neurons in grpId2
 short int SNN::connect(int grpId1, int grpId2, const std::string& _type, float initWt, float maxWt, float prob,
 						uint8_t minDelay, uint8_t maxDelay, RadiusRF radius,
-						float _mulSynFast, float _mulSynSlow, bool synWtType) {
+						float _mulSynFast, float _mulSynSlow, bool synWtType, WeightPrecision wtPrecision) {
 						//const std::string& wtType
 	int retId=-1;
 	assert(grpId1 < numGroups);
@@ -133,6 +143,7 @@ short int SNN::connect(int grpId1, int grpId2, const std::string& _type, float i
 	connConfig.mulSynSlow      = _mulSynSlow;
 	connConfig.connProp        = connProp;
 	connConfig.connProbability = prob;
+	connConfig.wtPrecision     = wtPrecision;
 	connConfig.type            = CONN_UNKNOWN;
 	connConfig.connectionMonitorId = -1;
 	connConfig.connId = -1;
@@ -175,7 +186,7 @@ short int SNN::connect(int grpId1, int grpId2, const std::string& _type, float i
 
 // make custom connections from grpId1 to grpId2
 short int SNN::connect(int grpId1, int grpId2, ConnectionGeneratorCore* conn, float _mulSynFast, float _mulSynSlow,
-						bool synWtType) {
+						bool synWtType, WeightPrecision wtPrecision) {
 	int retId=-1;
 
 	assert(grpId1 < numGroups);
@@ -193,6 +204,7 @@ short int SNN::connect(int grpId1, int grpId2, ConnectionGeneratorCore* conn, fl
 	connConfig.mulSynFast = _mulSynFast;
 	connConfig.mulSynSlow = _mulSynSlow;
 	connConfig.connProp = SET_CONN_PRESENT(1) | SET_FIXED_PLASTIC(synWtType);
+	connConfig.wtPrecision = wtPrecision;
 	connConfig.type = CONN_USER_DEFINED;
 	connConfig.conn = conn;
 	connConfig.connectionMonitorId = -1;
@@ -500,6 +512,29 @@ void SNN::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs) {
 	glbNetworkConfig.timeStep = 1.0f / numStepsPerMs;
 }
 
+void SNN::setNumThreadsPerPartition(int numThreads) {
+	assert(numThreads >= 0);
+	glbNetworkConfig.numThreadsPerPartition = numThreads;
+}
+
+void SNN::setNumCPUPartitions(int numPartitions) {
+	assert(numPartitions >= 0 && numPartitions <= MAX_NET_PER_SNN - CPU_RUNTIME_BASE);
+	glbNetworkConfig.numCPUPartitions = numPartitions;
+}
+
+void SNN::setNumConnectionThreads(int numThreads) {
+	assert(numThreads >= 0);
+	glbNetworkConfig.numConnectionThreads = numThreads;
+}
+
+void SNN::setSTDPTraces(bool isSet) {
+	glbNetworkConfig.stdpTraces = isSet;
+}
+
+void SNN::setSparseWeightUpdate(bool isSet) {
+	glbNetworkConfig.sparseWtUpdate = isSet;
+}
+
 // set Izhikevich parameters for group
 void SNN::setNeuronParameters(int gGrpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 								float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -867,6 +902,10 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 			}
 			
 			shiftSpikeTables();
+
+			// the state at the boundary of a second is consistent, take a checkpoint here
+			if (checkpointWriter_ != NULL && simTimeSec % checkpointIntervalSec_ == 0)
+				saveCheckpoint();
 		}
 
 		fetchNeuronSpikeCount(ALL);
@@ -896,6 +935,9 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 	updateSpikeMonitor();
 	updateGroupMonitor();
 
+	// the monitor files are complete when runNetwork returns
+	syncMonitorFiles();
+
 	// keep track of simulation time...
 #ifndef __NO_CUDA__
 	CUDA_STOP_TIMER(timer);
@@ -979,12 +1021,12 @@ void SNN::biasWeights(short int connId, float bias, bool updateWeightRange) {
 			assert(false);
 #endif
 		} else {
-			memcpy(&runtimeData[netId].wt[cumIdx], &managerRuntimeData.wt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+			// the CPU runtime may store the weights in reduced precision
+			copySynWt(netId, cumIdx, managerRuntimeData.Npre[lNId]);
 
-			if (runtimeData[netId].maxSynWt != NULL) {
+			if (!sim_with_fixedwts) {
 				// only copy maxSynWt if datastructure actually exists on the CPU runtime
-				// (that logic should be done elsewhere though)
-				memcpy(&runtimeData[netId].maxSynWt[cumIdx], &managerRuntimeData.maxSynWt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+				copyMaxSynWt(netId, lNId);
 			}
 		}
 	}
@@ -1071,12 +1113,12 @@ void SNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 			assert(false);
 #endif
 		} else {
-			memcpy(&runtimeData[netId].wt[cumIdx], &managerRuntimeData.wt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+			// the CPU runtime may store the weights in reduced precision
+			copySynWt(netId, cumIdx, managerRuntimeData.Npre[lNId]);
 
-			if (runtimeData[netId].maxSynWt != NULL) {
+			if (!sim_with_fixedwts) {
 				// only copy maxSynWt if datastructure actually exists on the CPU runtime
-				// (that logic should be done elsewhere though)
-				memcpy(&runtimeData[netId].maxSynWt[cumIdx], &managerRuntimeData.maxSynWt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+				copyMaxSynWt(netId, lNId);
 			}
 		}
 	}
@@ -1353,11 +1395,10 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 #endif
 			} else {
 				// need to update datastructures on CPU runtime
-				memcpy(&runtimeData[netId].wt[pos_ij], &managerRuntimeData.wt[pos_ij], sizeof(float));
-				if (runtimeData[netId].maxSynWt != NULL) {
+				copySynWt(netId, pos_ij, 1);
+				if (!sim_with_fixedwts) {
 					// only copy maxSynWt if datastructure actually exists on the CPU runtime
-					// (that logic should be done elsewhere though)
-					memcpy(&runtimeData[netId].maxSynWt[pos_ij], &managerRuntimeData.maxSynWt[pos_ij], sizeof(float));
+					copyMaxSynWt(netId, neurIdPostReal);
 				}
 			}
 
@@ -1403,113 +1444,260 @@ void SNN::setExternalCurrent(int grpId, const std::vector<float>& current) {
 	}
 }
 
-// writes network state to file
+// writes zeros to file up to the byte offset target (see saveSimulation)
+static void writeImagePadding(FILE* fid, uint64_t& pos, uint64_t target) {
+	static const char zeros[NETWORK_IMAGE_ALIGNMENT] = {0};
+	assert(target >= pos);
+	while (pos < target) {
+		size_t length = (size_t)std::min(target - pos, (uint64_t)NETWORK_IMAGE_ALIGNMENT);
+		if (fwrite(zeros, 1, length, fid) != length)
+			return;
+		pos += length;
+	}
+}
+
+// writes a block of the network image to file at the byte offset offset (see saveSimulation)
+static bool writeImageBlock(FILE* fid, uint64_t& pos, uint64_t offset, const void* data, size_t size) {
+	writeImagePadding(fid, pos, offset);
+	if (pos != offset || (size > 0 && fwrite(data, 1, size, fid) != size))
+		return false;
+	pos += size;
+	return true;
+}
+
+// writes the compiled network to file as a network image (see network_image.h)
 // handling of file pointer should be handled externally: as far as this function is concerned, it is simply
 // trying to write to file
 void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
-	//int tmpInt;
-	//float tmpFloat;
-
-	//// +++++ WRITE HEADER SECTION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-
-	//// write file signature
-	//tmpInt = 294338571; // some int used to identify saveSimulation files
-	//if (!fwrite(&tmpInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write version number
-	//tmpFloat = 0.2f;
-	//if (!fwrite(&tmpFloat,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write simulation time so far (in seconds)
-	//tmpFloat = ((float)simTimeSec) + ((float)simTimeMs)/1000.0f;
-	//if (!fwrite(&tmpFloat,sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write execution time so far (in seconds)
-	//if(simMode_ == GPU_MODE) {
-	//	stopGPUTiming();
-	//	tmpFloat = gpuExecutionTime/1000.0f;
-	//} else {
-	//	stopCPUTiming();
-	//	tmpFloat = cpuExecutionTime/1000.0f;
-	//}
-	//if (!fwrite(&tmpFloat,sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	assert(snnState == EXECUTABLE_SNN);
+
+	// +++++ PREPARE HEADER AND TABLES ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+	NetworkImageHeader header;
+	memset(&header, 0, sizeof(NetworkImageHeader));
+	header.signature = NETWORK_IMAGE_SIGNATURE;
+	header.version = NETWORK_IMAGE_VERSION;
+	header.headerSize = sizeof(NetworkImageHeader);
+	header.hasSynapseInfo = saveSynapseInfo ? 1 : 0;
+	header.simTimeSec = ((float)simTimeSec) + ((float)simTimeMs) / 1000.0f;
+	header.executionTimeSec = cumExecutionTime / 1000.0f;
+	header.numN = glbNetworkConfig.numN;
+	header.numGroups = numGroups;
+	header.numConnections = numConnections;
+	header.maxDelay = glbNetworkConfig.maxDelay;
+	header.randSeed = randSeed_;
+
+	std::vector<NetworkImageGroup> groups(numGroups);
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		NetworkImageGroup& grp = groups[gGrpId];
+		memset(&grp, 0, sizeof(NetworkImageGroup));
+		grp.gGrpId = gGrpId;
+		grp.netId = groupConfigMDMap[gGrpId].netId;
+		grp.gStartN = groupConfigMDMap[gGrpId].gStartN;
+		grp.gEndN = groupConfigMDMap[gGrpId].gEndN;
+		grp.sizeX = groupConfigMap[gGrpId].grid.numX;
+		grp.sizeY = groupConfigMap[gGrpId].grid.numY;
+		grp.sizeZ = groupConfigMap[gGrpId].grid.numZ;
+		grp.type = groupConfigMap[gGrpId].type;
+		strncpy(grp.name, groupConfigMap[gGrpId].grpName.c_str(), NETWORK_IMAGE_NAME_LENGTH - 1);
+	}
+
+	std::vector<NetworkImageConnection> connections(numConnections);
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		NetworkImageConnection& conn = connections[connIt->second.connId];
+		memset(&conn, 0, sizeof(NetworkImageConnection));
+		conn.connId = connIt->second.connId;
+		conn.grpSrc = connIt->second.grpSrc;
+		conn.grpDest = connIt->second.grpDest;
+		conn.type = connIt->second.type;
+		conn.connProp = connIt->second.connProp;
+		conn.minDelay = connIt->second.minDelay;
+		conn.maxDelay = connIt->second.maxDelay;
+		conn.numberOfConnections = connIt->second.numberOfConnections;
+		conn.maxWt = connIt->second.maxWt;
+	}
+
+	std::vector<NetworkImageNetwork> networks;
+	std::vector<std::vector<NetworkImagePartition> > partitions;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		NetworkImageNetwork net;
+		memset(&net, 0, sizeof(NetworkImageNetwork));
+		net.netId = netId;
+		net.numGroupsAssigned = networkConfigs[netId].numGroupsAssigned;
+		net.numNAssigned = networkConfigs[netId].numNAssigned;
+		net.numNReg = networkConfigs[netId].numNReg;
+		net.numPreSynNet = networkConfigs[netId].numPreSynNet;
+		net.numPostSynNet = networkConfigs[netId].numPostSynNet;
+		net.maxNumPreSynN = networkConfigs[netId].maxNumPreSynN;
+		net.maxNumPostSynN = networkConfigs[netId].maxNumPostSynN;
+		if (saveSynapseInfo) {
+			net.arraySize[IMG_NPRE] = sizeof(short) * net.numNAssigned;
+			net.arraySize[IMG_NPRE_PLASTIC] = sizeof(short) * net.numNAssigned;
+			net.arraySize[IMG_NPOST] = sizeof(short) * net.numNAssigned;
+			net.arraySize[IMG_CUMULATIVE_PRE] = sizeof(int) * net.numNAssigned;
+			net.arraySize[IMG_CUMULATIVE_POST] = sizeof(int) * net.numNAssigned;
+			net.arraySize[IMG_PRE_SYNAPTIC_IDS] = sizeof(SynInfo) * net.numPreSynNet;
+			net.arraySize[IMG_POST_SYNAPTIC_IDS] = sizeof(SynInfo) * net.numPostSynNet;
+			net.arraySize[IMG_POST_DELAY_INFO] = sizeof(DelayInfo) * net.numNAssigned * (glbNetworkConfig.maxDelay + 1);
+			net.arraySize[IMG_WT] = sizeof(float) * net.numPreSynNet;
+			net.arraySize[IMG_MAX_SYN_WT] = sizeof(float) * net.numPreSynNet;
+			net.arraySize[IMG_CONN_IDS_PRE_IDX] = sizeof(short int) * net.numPreSynNet;
+		}
+		net.arraySize[IMG_VOLTAGE] = sizeof(float) * net.numNReg;
+		net.arraySize[IMG_RECOVERY] = sizeof(float) * net.numNReg;
+		networks.push_back(net);
 
-	//// TODO: add more params of interest
+		std::vector<NetworkImagePartition> partition;
+		for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+			NetworkImagePartition grp;
+			grp.gGrpId = grpIt->gGrpId;
+			grp.lGrpId = grpIt->lGrpId;
+			grp.numPostSynapses = grpIt->numPostSynapses;
+			grp.numPreSynapses = grpIt->numPreSynapses;
+			partition.push_back(grp);
+		}
+		partitions.push_back(partition);
+	}
+	header.numNetworks = networks.size();
+
+	// lay out the tables and arrays, every one of them starts at a multiple of NETWORK_IMAGE_ALIGNMENT
+	uint64_t offset = alignImageOffset(sizeof(NetworkImageHeader));
+	header.groupOffset = offset;
+	offset = alignImageOffset(offset + sizeof(NetworkImageGroup) * groups.size());
+	header.connectOffset = offset;
+	offset = alignImageOffset(offset + sizeof(NetworkImageConnection) * connections.size());
+	header.networkOffset = offset;
+	offset = alignImageOffset(offset + sizeof(NetworkImageNetwork) * networks.size());
+	for (size_t i = 0; i < networks.size(); i++) {
+		networks[i].groupOffset = offset;
+		offset = alignImageOffset(offset + sizeof(NetworkImagePartition) * partitions[i].size());
+		for (int array = 0; array < IMG_NUM_ARRAYS; array++) {
+			if (networks[i].arraySize[array] > 0) {
+				networks[i].arrayOffset[array] = offset;
+				offset = alignImageOffset(offset + networks[i].arraySize[array]);
+			}
+		}
+	}
+	header.fileSize = offset;
+
+	// +++++ WRITE HEADER AND TABLES +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+	uint64_t pos = 0;
+	bool writeOk = writeImageBlock(fid, pos, 0, &header, sizeof(NetworkImageHeader));
+	if (numGroups > 0)
+		writeOk = writeOk && writeImageBlock(fid, pos, header.groupOffset, &groups[0], sizeof(NetworkImageGroup) * groups.size());
+	if (numConnections > 0)
+		writeOk = writeOk && writeImageBlock(fid, pos, header.connectOffset, &connections[0], sizeof(NetworkImageConnection) * connections.size());
+	if (!networks.empty())
+		writeOk = writeOk && writeImageBlock(fid, pos, header.networkOffset, &networks[0], sizeof(NetworkImageNetwork) * networks.size());
+
+	// +++++ WRITE LOCAL NETWORKS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+	for (size_t i = 0; i < networks.size() && writeOk; i++) {
+		int netId = networks[i].netId;
+		writeOk = writeImageBlock(fid, pos, networks[i].groupOffset, &partitions[i][0], sizeof(NetworkImagePartition) * partitions[i].size());
+
+		// the runtime data of the local network is fetched into the manager runtime data one network at a time
+		const void* arrays[IMG_NUM_ARRAYS];
+		memset(arrays, 0, sizeof(arrays));
+		if (saveSynapseInfo) {
+			fetchPreConnectionInfo(netId);
+			fetchPostConnectionInfo(netId);
+			fetchConnIdsLookupArray(netId);
+			fetchSynapseState(netId);
+
+			arrays[IMG_NPRE] = managerRuntimeData.Npre;
+			arrays[IMG_NPRE_PLASTIC] = managerRuntimeData.Npre_plastic;
+			arrays[IMG_NPOST] = managerRuntimeData.Npost;
+			arrays[IMG_CUMULATIVE_PRE] = managerRuntimeData.cumulativePre;
+			arrays[IMG_CUMULATIVE_POST] = managerRuntimeData.cumulativePost;
+			arrays[IMG_PRE_SYNAPTIC_IDS] = managerRuntimeData.preSynapticIds;
+			arrays[IMG_POST_SYNAPTIC_IDS] = managerRuntimeData.postSynapticIds;
+			arrays[IMG_POST_DELAY_INFO] = managerRuntimeData.postDelayInfo;
+			arrays[IMG_WT] = managerRuntimeData.wt;
+			// the maximum weight of fixed synapses is not kept by the runtimes, it is the same as the weight
+			arrays[IMG_MAX_SYN_WT] = sim_with_fixedwts ? managerRuntimeData.wt : managerRuntimeData.maxSynWt;
+			arrays[IMG_CONN_IDS_PRE_IDX] = managerRuntimeData.connIdsPreIdx;
+		}
+		if (networks[i].numNReg > 0) {
+			fetchNeuronVariables(netId);
+			arrays[IMG_VOLTAGE] = managerRuntimeData.voltage;
+			arrays[IMG_RECOVERY] = managerRuntimeData.recovery;
+		}
 
-	//// write network info
-	//if (!fwrite(&numN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numPreSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numPostSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numGroups,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+		for (int array = 0; array < IMG_NUM_ARRAYS && writeOk; array++) {
+			if (networks[i].arraySize[array] > 0)
+				writeOk = writeImageBlock(fid, pos, networks[i].arrayOffset[array], arrays[array], networks[i].arraySize[array]);
+		}
+	}
+	writeImagePadding(fid, pos, header.fileSize);
 
-	//// write group info
-	//char name[100];
-	//for (int g=0;g<numGroups;g++) {
-	//	if (!fwrite(&groupConfigs[0][g].StartN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].EndN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	if (!writeOk || pos != header.fileSize) {
+		KERNEL_ERROR("saveSimulation fwrite error");
+		exitSimulation(-1);
+	}
 
-	//	if (!fwrite(&groupConfigs[0][g].SizeX,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].SizeY,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].SizeZ,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	KERNEL_INFO("Network image saved at t=%.3f s: %d networks, %d synapses, %llu bytes", header.simTimeSec,
+		header.numNetworks, glbNetworkConfig.numSynNet, (unsigned long long)header.fileSize);
+}
 
-	//	strncpy(name,groupInfo[g].Name.c_str(),100);
-	//	if (!fwrite(name,1,100,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//}
+void SNN::setCheckpoint(int intervalSec, const std::string& dirName) {
+	assert(intervalSec > 0);
 
-	//// +++++ Fetch WEIGHT DATA (GPU Mode only) ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-	//if (simMode_ == GPU_MODE)
-	//	copyWeightState(&managerRuntimeData, &runtimeData[0], cudaMemcpyDeviceToHost, false);
-	//// +++++ WRITE SYNAPSE INFO +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-
-	//// \FIXME: replace with faster version
-	//if (saveSynapseInfo) {
-	//	for (int i = 0; i < numN; i++) {
-	//		unsigned int offset = managerRuntimeData.cumulativePost[i];
-
-	//		unsigned int count = 0;
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++)
-	//				count++;
-	//		}
-
-	//		if (!fwrite(&count,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++) {
-	//				// get synaptic info...
-	//				SynInfo post_info = managerRuntimeData.postSynapticIds[offset + idx_d];
-
-	//				// get neuron id
-	//				//int p_i = (post_info&POST_SYN_NEURON_MASK);
-	//				unsigned int p_i = GET_CONN_NEURON_ID(post_info);
-	//				assert(p_i<numN);
-
-	//				// get syn id
-	//				unsigned int s_i = GET_CONN_SYN_ID(post_info);
-	//				//>>POST_SYN_NEURON_BITS)&POST_SYN_CONN_MASK;
-	//				assert(s_i<(managerRuntimeData.Npre[p_i]));
-
-	//				// get the cumulative position for quick access...
-	//				unsigned int pos_i = managerRuntimeData.cumulativePre[p_i] + s_i;
-
-	//				uint8_t delay = t+1;
-	//				uint8_t plastic = s_i < managerRuntimeData.Npre_plastic[p_i]; // plastic or fixed.
-
-	//				if (!fwrite(&i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&p_i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.wt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.maxSynWt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&delay,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&plastic,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.connIdsPreIdx[pos_i]),sizeof(short int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//			}
-	//		}
-	//	}
-	//}
+	// the previous writer completes its pending checkpoint
+	if (checkpointWriter_ != NULL)
+		delete checkpointWriter_;
+
+	checkpointWriter_ = new CheckpointWriter(dirName);
+	checkpointIntervalSec_ = intervalSec;
+
+	KERNEL_INFO("Checkpoints are written to %s every %d s", dirName.c_str(), intervalSec);
+}
+
+void SNN::loadCheckpoint(const std::string& dirName) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	// make sure a checkpoint of this simulation is complete before reading it
+	if (checkpointWriter_ != NULL)
+		checkpointWriter_->wait();
+
+	CheckpointHeader header;
+	std::vector<CheckpointArrayInfo> infos;
+	std::vector<char> data;
+	if (!CheckpointWriter::read(dirName, header, infos, data)) {
+		KERNEL_ERROR("loadCheckpoint: no valid checkpoint found in %s", dirName.c_str());
+		exitSimulation(-1);
+	}
+
+	// the checkpoint must have been written by the same network, on the same runtimes
+	std::vector<CheckpointArray> arrays;
+	collectCheckpointArrays(arrays);
+	if (infos.size() != arrays.size()) {
+		KERNEL_ERROR("loadCheckpoint: the checkpoint in %s has %d arrays, the network has %d", dirName.c_str(),
+			(int)infos.size(), (int)arrays.size());
+		exitSimulation(-1);
+	}
+	for (size_t i = 0; i < arrays.size(); i++) {
+		if (strncmp(infos[i].name, arrays[i].name, CHECKPOINT_NAME_LENGTH) || infos[i].netId != arrays[i].netId
+			|| infos[i].size != arrays[i].size) {
+			KERNEL_ERROR("loadCheckpoint: array %s (netId %d, %llu bytes) of the checkpoint in %s does not match the "
+				"network (%s, netId %d, %llu bytes)", infos[i].name, infos[i].netId, (unsigned long long)infos[i].size,
+				dirName.c_str(), arrays[i].name, arrays[i].netId, (unsigned long long)arrays[i].size);
+			exitSimulation(-1);
+		}
+	}
+
+	for (size_t i = 0; i < arrays.size(); i++)
+		memcpy(arrays[i].ptr, &data[infos[i].offset], arrays[i].size);
+
+	// the spike schedule of the poisson neurons is restored as part of the checkpoint, don't redraw it
+	spikeRateUpdated = false;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (runtimeData[netId].allocated && networkConfigs[netId].numNPois > 0)
+			schedulePoissonSpikes_CPU(netId);
+	}
+
+	KERNEL_INFO("Checkpoint %d loaded from %s: resuming at t=%.3f s", header.sequence, dirName.c_str(), simTime / 1000.0f);
 }
 
 // writes population weights from gIDpre to gIDpost to file fname in binary
@@ -1850,10 +2038,15 @@ Point3D SNN::getNeuronLocation3D(int gNId) {
 }
 
 Point3D SNN::getNeuronLocation3D(int gGrpId, int relNeurId) {
-	Grid3D grid = groupConfigMap[gGrpId].grid;
 	assert(gGrpId >= 0 && gGrpId < numGroups);
 	assert(relNeurId >= 0 && relNeurId < getGroupNumNeurons(gGrpId));
 
+	return getNeuronLocation3D(groupConfigMap[gGrpId].grid, relNeurId);
+}
+
+Point3D SNN::getNeuronLocation3D(const Grid3D& grid, int relNeurId) {
+	assert(relNeurId >= 0 && relNeurId < grid.N);
+
 	int intX = relNeurId % grid.numX;
 	int intY = (relNeurId / grid.numX) % grid.numY;
 	int intZ = relNeurId / (grid.numX * grid.numY);
@@ -2065,6 +2258,14 @@ void SNN::SNNinit() {
 	sim_in_testing = false;
 
 	loadSimFID = NULL;
+	loadSimImage = NULL;
+	loadSimImageSize = 0;
+	loadSimImageMapped = false;
+
+	checkpointWriter_ = NULL;
+	checkpointIntervalSec_ = 0;
+
+	monitorFileWriter_ = new MonitorFileWriter();
 
 	// conductance info struct for simulation
 	sim_with_NMDA_rise = false;
@@ -2094,6 +2295,12 @@ void SNN::SNNinit() {
 	// initialize spike buffer
 	spikeBuf = new SpikeBuffer(0, MAX_TIME_SLICE);
 
+	// worker threads of the CPU runtimes are spawned in allocateSNN_CPU
+	threadPool = NULL;
+
+	// widest instruction set of the vectorized neuron update kernels that is supported by this CPU
+	simdLevel = NeuronSimd::getSupportedLevel();
+
 	memset(networkConfigs, 0, sizeof(NetworkConfigRT) * MAX_NET_PER_SNN);
 	
 	// reset all runtime data
@@ -2149,9 +2356,7 @@ void SNN::advSimStep() {
 
 void SNN::doSTPUpdateAndDecayCond() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2164,12 +2369,6 @@ void SNN::doSTPUpdateAndDecayCond() {
 				#if defined(WIN32) || defined(WIN64)
 					doSTPUpdateAndDecayCond_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2177,8 +2376,7 @@ void SNN::doSTPUpdateAndDecayCond() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoSTPUpdateAndDecayCond_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperDoSTPUpdateAndDecayCond_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -2186,10 +2384,9 @@ void SNN::doSTPUpdateAndDecayCond() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 }
 
@@ -2197,9 +2394,7 @@ void SNN::spikeGeneratorUpdate() {
 	// If poisson rate has been updated, assign new poisson rate
 	if (spikeRateUpdated) {
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+			ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 			int threadCount = 0;
 		#endif
 
@@ -2211,12 +2406,6 @@ void SNN::spikeGeneratorUpdate() {
 					#if defined(WIN32) || defined(WIN64)
 						assignPoissonFiringRate_CPU(netId);
 					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 						argsThreadRoutine[threadCount].snn_pointer = this;
 						argsThreadRoutine[threadCount].netId = netId;
 						argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2224,8 +2413,7 @@ void SNN::spikeGeneratorUpdate() {
 						argsThreadRoutine[threadCount].endIdx = 0;
 						argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-						pthread_create(&threads[threadCount], &attr, &SNN::helperAssignPoissonFiringRate_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
+						threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperAssignPoissonFiringRate_CPU, (void*)&argsThreadRoutine[threadCount]);
 						threadCount++;
 					#endif
 				}
@@ -2233,10 +2421,9 @@ void SNN::spikeGeneratorUpdate() {
 		}
 
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
+			// wait for all the workers
+			if (threadCount > 0)
+				threadPool->barrier();
 		#endif
 
 		spikeRateUpdated = false;
@@ -2246,9 +2433,7 @@ void SNN::spikeGeneratorUpdate() {
 	generateUserDefinedSpikes();
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2260,12 +2445,6 @@ void SNN::spikeGeneratorUpdate() {
 				#if defined(WIN32) || defined(WIN64)
 					spikeGeneratorUpdate_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2273,8 +2452,7 @@ void SNN::spikeGeneratorUpdate() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperSpikeGeneratorUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperSpikeGeneratorUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -2282,10 +2460,9 @@ void SNN::spikeGeneratorUpdate() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 
 	// tell the spike buffer to advance to the next time step
@@ -2294,10 +2471,64 @@ void SNN::spikeGeneratorUpdate() {
 
 void SNN::findFiring() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCPUThreads + 1]; // 1 additional array size if numCPUThreads == 0, it may work though bad practice
 		int threadCount = 0;
+
+	// runtimes split across several threads find firing in three steps: each thread detects the fired neurons in its
+	// neuron range, then the ranges are appended to the firing tables in order of neuron ids (one thread per runtime),
+	// and finally each thread updates the state of its fired neurons. This keeps the firing tables deterministic.
+	if (numCPUThreads > numCores) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty()) {
+				if (netId < CPU_RUNTIME_BASE) // GPU runtime
+					findFiring_GPU(netId);
+				else { // CPU runtime
+					for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+						argsThreadRoutine[threadCount].snn_pointer = this;
+						argsThreadRoutine[threadCount].netId = netId;
+						argsThreadRoutine[threadCount].lGrpId = 0;
+						findThreadNeuronRange(networkConfigs[netId].numN, networkConfigs[netId].numThreads, threadId,
+							argsThreadRoutine[threadCount].startIdx, argsThreadRoutine[threadCount].endIdx);
+						argsThreadRoutine[threadCount].GtoLOffset = 0;
+
+						threadPool->dispatch(getWorkerId(netId, threadId), &SNN::helperDetectFiring_CPU, (void*)&argsThreadRoutine[threadCount]);
+						threadCount++;
+					}
+				}
+			}
+		}
+
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
+
+		// the arguments of the first step are still valid: one entry per thread, in the same order
+		threadCount = 0;
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty()) {
+				threadPool->dispatch(getWorkerId(netId, 0), &SNN::helperUpdateFiringTable_CPU, (void*)&argsThreadRoutine[threadCount]);
+				threadCount += networkConfigs[netId].numThreads;
+			}
+		}
+
+		if (threadCount > 0)
+			threadPool->barrier();
+
+		threadCount = 0;
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty()) {
+				for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++) {
+					threadPool->dispatch(getWorkerId(netId, threadId), &SNN::helperUpdateFiredNeurons_CPU, (void*)&argsThreadRoutine[threadCount]);
+					threadCount++;
+				}
+			}
+		}
+
+		if (threadCount > 0)
+			threadPool->barrier();
+
+		return;
+	}
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -2308,12 +2539,6 @@ void SNN::findFiring() {
 				#if defined(WIN32) || defined(WIN64)
 					findFiring_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2321,8 +2546,7 @@ void SNN::findFiring() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperFindFiring_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperFindFiring_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -2330,18 +2554,15 @@ void SNN::findFiring() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 }
 
 void SNN::doCurrentUpdate() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCPUThreads + 1]; // 1 additional array size if numCPUThreads == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2353,32 +2574,29 @@ void SNN::doCurrentUpdate() {
 				#if defined(WIN32) || defined(WIN64)
 					doCurrentUpdateD2_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
+					// each thread delivers the spikes to its own range of post-synaptic neurons. dopamine release
+					// accumulates into a per-group variable and is therefore delivered by a single thread
+					int numThreads = networkConfigs[netId].sim_with_DA_release ? 1 : networkConfigs[netId].numThreads;
+					for (int threadId = 0; threadId < numThreads; threadId++) {
+						argsThreadRoutine[threadCount].snn_pointer = this;
+						argsThreadRoutine[threadCount].netId = netId;
+						argsThreadRoutine[threadCount].lGrpId = 0;
+						findThreadNeuronRange(networkConfigs[netId].numN, numThreads, threadId,
+							argsThreadRoutine[threadCount].startIdx, argsThreadRoutine[threadCount].endIdx);
+						argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
+						threadPool->dispatch(getWorkerId(netId, threadId), &SNN::helperDoCurrentUpdateD2_CPU, (void*)&argsThreadRoutine[threadCount]);
+						threadCount++;
+					}
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 		threadCount = 0;
 	#endif
 
@@ -2390,40 +2608,34 @@ void SNN::doCurrentUpdate() {
 				#if defined(WIN32) || defined(WIN64)
 					doCurrentUpdateD1_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
+					// see above
+					int numThreads = networkConfigs[netId].sim_with_DA_release ? 1 : networkConfigs[netId].numThreads;
+					for (int threadId = 0; threadId < numThreads; threadId++) {
+						argsThreadRoutine[threadCount].snn_pointer = this;
+						argsThreadRoutine[threadCount].netId = netId;
+						argsThreadRoutine[threadCount].lGrpId = 0;
+						findThreadNeuronRange(networkConfigs[netId].numN, numThreads, threadId,
+							argsThreadRoutine[threadCount].startIdx, argsThreadRoutine[threadCount].endIdx);
+						argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
+						threadPool->dispatch(getWorkerId(netId, threadId), &SNN::helperDoCurrentUpdateD1_CPU, (void*)&argsThreadRoutine[threadCount]);
+						threadCount++;
+					}
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 }
 
 void SNN::updateTimingTable() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCPUThreads + 1]; // 1 additional array size if numCPUThreads == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2435,12 +2647,6 @@ void SNN::updateTimingTable() {
 				#if defined(WIN32) || defined(WIN64)
 					updateTimingTable_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2448,26 +2654,22 @@ void SNN::updateTimingTable() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateTimingTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperUpdateTimingTable_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
 		}
 	}
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 }
 
 void SNN::globalStateUpdate() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCPUThreads + 1]; // 1 additional array size if numCPUThreads == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2479,32 +2681,31 @@ void SNN::globalStateUpdate() {
 				#if defined(WIN32) || defined(WIN64)
 					globalStateUpdate_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
+					// split the regular neurons among the threads of the runtime, the last thread also decays the
+					// poisson neurons. compartmental neurons are coupled in every integration step and are not split
+					int numThreads = networkConfigs[netId].sim_with_compartments ? 1 : networkConfigs[netId].numThreads;
+					for (int threadId = 0; threadId < numThreads; threadId++) {
+						argsThreadRoutine[threadCount].snn_pointer = this;
+						argsThreadRoutine[threadCount].netId = netId;
+						argsThreadRoutine[threadCount].lGrpId = 0;
+						findThreadNeuronRange(networkConfigs[netId].numNReg, numThreads, threadId,
+							argsThreadRoutine[threadCount].startIdx, argsThreadRoutine[threadCount].endIdx);
+						if (threadId == numThreads - 1)
+							argsThreadRoutine[threadCount].endIdx = networkConfigs[netId].numN;
+						argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperGlobalStateUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
+						threadPool->dispatch(getWorkerId(netId, threadId), &SNN::helperGlobalStateUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
+						threadCount++;
+					}
 				#endif
 			}
 		}
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -2524,9 +2725,7 @@ void SNN::globalStateUpdate() {
 
 void SNN::clearExtFiringTable() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2538,12 +2737,6 @@ void SNN::clearExtFiringTable() {
 				#if defined(WIN32) || defined(WIN64)
 					clearExtFiringTable_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2551,8 +2744,7 @@ void SNN::clearExtFiringTable() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperClearExtFiringTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperClearExtFiringTable_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -2560,18 +2752,15 @@ void SNN::clearExtFiringTable() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 }
 
 void SNN::updateWeights() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2583,12 +2772,6 @@ void SNN::updateWeights() {
 				#if defined(WIN32) || defined(WIN64)
 					updateWeights_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2596,18 +2779,16 @@ void SNN::updateWeights() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateWeights_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperUpdateWeights_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
 		}
 	}
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 
 }
@@ -2623,9 +2804,7 @@ void SNN::updateNetworkConfig(int netId) {
 
 void SNN::shiftSpikeTables() {
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -2637,12 +2816,6 @@ void SNN::shiftSpikeTables() {
 				#if defined(WIN32) || defined(WIN64)
 					shiftSpikeTables_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
 					argsThreadRoutine[threadCount].lGrpId = 0;
@@ -2650,8 +2823,7 @@ void SNN::shiftSpikeTables() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperShiftSpikeTables_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperShiftSpikeTables_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -2659,10 +2831,9 @@ void SNN::shiftSpikeTables() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
 	#endif
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -3023,6 +3194,13 @@ void SNN::generateRuntimeConnectConfigs() {
 }
 
 void SNN::generateRuntimeNetworkConfigs() {
+	// the cores of the machine are shared among all CPU runtimes
+	int numCPURuntimes = 0;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty())
+			numCPURuntimes++;
+	}
+
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			// copy the global network config to local network configs
@@ -3034,7 +3212,19 @@ void SNN::generateRuntimeNetworkConfigs() {
 			networkConfigs[netId].sim_with_conductances = sim_with_conductances;
 			networkConfigs[netId].sim_with_homeostasis = sim_with_homeostasis;
 			networkConfigs[netId].sim_with_stdp = sim_with_stdp;
+			// only CPU runtimes keep spike traces, GPU runtimes always use synSpikeTime
+			networkConfigs[netId].sim_with_stdp_traces = glbNetworkConfig.stdpTraces && sim_with_stdp && netId >= CPU_RUNTIME_BASE;
+			networkConfigs[netId].sim_with_sparse_wt_update = glbNetworkConfig.sparseWtUpdate && sim_with_stdp && netId >= CPU_RUNTIME_BASE;
+			// CPU runtimes choose the storage precision from the connections of their synapses (see copySynapseState)
+			networkConfigs[netId].wtPrecision = WT_FP32;
 			networkConfigs[netId].sim_with_stp = sim_with_stp;
+
+			// search for dopaminergic groups, whose spikes increase the dopamine concentration of post-synaptic groups
+			networkConfigs[netId].sim_with_DA_release = false;
+			for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+				if (isDopaminergicGroup(grpIt->gGrpId))
+					networkConfigs[netId].sim_with_DA_release = true;
+			}
 			networkConfigs[netId].sim_in_testing = sim_in_testing;
 
 			// search for active neuron monitor
@@ -3083,7 +3273,14 @@ void SNN::generateRuntimeNetworkConfigs() {
 
 			// find the maximum number of pre- and post-connections among neurons
 			// SNN::maxNumPreSynN and SNN::maxNumPostSynN are updated
-			findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
+			if (loadSimImage != NULL) {
+				const NetworkImageNetwork* net = findImageNetwork(netId);
+				assert(net != NULL);
+				networkConfigs[netId].maxNumPostSynN = net->maxNumPostSynN;
+				networkConfigs[netId].maxNumPreSynN = net->maxNumPreSynN;
+			} else {
+				findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
+			}
 
 			// find the maximum number of spikes in D1 (i.e., maxDelay == 1) and D2 (i.e., maxDelay >= 2) sets
 			findMaxSpikesD1D2(netId, networkConfigs[netId].maxSpikesD1, networkConfigs[netId].maxSpikesD2);
@@ -3094,6 +3291,9 @@ void SNN::generateRuntimeNetworkConfigs() {
 			// find out number of user-defined spike gen and update Noffset of each group config
 			// Note: groupConfigs[][].Noffset is valid at this time 
 			findNumNSpikeGenAndOffset(netId);
+
+			// find the number of worker threads that share the neuron loops of this runtime
+			findNumThreads(netId, numCPURuntimes, networkConfigs[netId].numThreads);
 		}
 	}
 
@@ -3133,15 +3333,19 @@ void SNN::generateRuntimeNetworkConfigs() {
 	}
 }
 
-bool compareSrcNeuron(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.nSrc + first.srcGLoffset < second.nSrc + second.srcGLoffset);
+// stable counting sort of the synapse indices in order by key[synapse index], keys are in [0, numKeys)
+static void countingSortSynapses(const std::vector<int>& key, int numKeys, std::vector<unsigned int>& order, std::vector<unsigned int>& sorted) {
+	std::vector<unsigned int> start(numKeys + 1, 0);
+	for (size_t i = 0; i < order.size(); i++)
+		start[key[order[i]] + 1]++;
+	for (int k = 0; k < numKeys; k++)
+		start[k + 1] += start[k];
+	for (size_t i = 0; i < order.size(); i++)
+		sorted[start[key[order[i]]]++] = order[i];
+	order.swap(sorted);
 }
 
-bool compareDelay(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.delay < second.delay);
-}
-
-// Note: ConnectInfo stored in connectionList use global ids
+// Note: the synapses stored in connectionBuffers use global neuron ids
 void SNN::generateConnectionRuntime(int netId) {
 	std::map<int, int> GLoffset; // global nId to local nId offset
 	std::map<int, int> GLgrpId; // global grpId to local grpId offset
@@ -3160,175 +3364,152 @@ void SNN::generateConnectionRuntime(int netId) {
 		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
 	}
 
-	// parse ConnectionInfo stored in connectionLists[0]
-	// note: ConnectInfo stored in connectionList use global ids
+	// look up the local offsets and group ids of the groups of every connection once, the synapses in
+	// connectionBuffers[netId] only store global neuron ids and their connection id
+	std::vector<int> srcOffset(numConnections, 0), destOffset(numConnections, 0);
+	std::vector<int> lGrpSrc(numConnections, -1), lGrpDest(numConnections, -1);
+	std::vector<bool> isPlastic(numConnections, false), withHomeostasis(numConnections, false);
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		int connId = connIt->second.connId;
+		int grpSrc = connIt->second.grpSrc;
+		int grpDest = connIt->second.grpDest;
+		if (GLoffset.count(grpSrc) == 0 || GLoffset.count(grpDest) == 0)
+			continue; // the connection has no synapses in this local network
+		srcOffset[connId] = GLoffset[grpSrc];
+		destOffset[connId] = GLoffset[grpDest];
+		lGrpSrc[connId] = GLgrpId[grpSrc];
+		lGrpDest[connId] = GLgrpId[grpDest];
+		isPlastic[connId] = GET_FIXED_PLASTIC(connIt->second.connProp) == SYN_PLASTIC;
+		withHomeostasis[connId] = groupConfigMap[grpDest].homeoConfig.WithHomeostasis;
+	}
+
+	// parse the synapses stored in connectionBuffers[netId]
 	// generate Npost, Npre, Npre_plastic
-	int parsedConnections = 0;
-	memset(managerRuntimeData.Npost, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		connIt->srcGLoffset = GLoffset[connIt->grpSrc];
-		if (managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] == SYNAPSE_ID_MASK) {
-			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nSrc, connIt->grpSrc);
+	ConnectionBuffer& connBuf = connectionBuffers[netId];
+	size_t numSynapses = connBuf.size();
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	memset(managerRuntimeData.Npost, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre, 0, sizeof(short) * numNAssigned);
+	for (size_t i = 0; i < numSynapses; i++) {
+		short int connId = connBuf.getConnId(i);
+		int lSrc = connBuf.getSrc(i) + srcOffset[connId];
+		int lDest = connBuf.getDest(i) + destOffset[connId];
+		if (managerRuntimeData.Npost[lSrc] == SYNAPSE_ID_MASK) {
+			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connBuf.getSrc(i), connectConfigMap[connId].grpSrc);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		if (managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]] == SYNAPSE_ID_MASK) {
-			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nDest, connIt->grpDest);
+		if (managerRuntimeData.Npre[lDest] == SYNAPSE_ID_MASK) {
+			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connBuf.getDest(i), connectConfigMap[connId].grpDest);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-		managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
+		managerRuntimeData.Npost[lSrc]++;
+		managerRuntimeData.Npre[lDest]++;
 
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
+		if (isPlastic[connId]) {
 			sim_with_fixedwts = false; // if network has any plastic synapses at all, this will be set to true
-			managerRuntimeData.Npre_plastic[connIt->nDest + GLoffset[connIt->grpDest]]++;
+			managerRuntimeData.Npre_plastic[lDest]++;
 
 			// homeostasis
-			if (groupConfigMap[connIt->grpDest].homeoConfig.WithHomeostasis && groupConfigMDMap[connIt->grpDest].homeoId == -1)
-				groupConfigMDMap[connIt->grpDest].homeoId = connIt->nDest + GLoffset[connIt->grpDest]; // this neuron info will be printed
-
-			// old access to homeostasis
-			//if (groupConfigs[netId][GLgrpId[it->grpDest]].WithHomeostasis && groupConfigs[netId][GLgrpId[it->grpDest]].homeoId == -1)
-			//	groupConfigs[netId][GLgrpId[it->grpDest]].homeoId = it->nDest + GLoffset[it->grpDest]; // this neuron info will be printed
+			if (withHomeostasis[connId]) {
+				int grpDest = connectConfigMap[connId].grpDest;
+				if (groupConfigMDMap[grpDest].homeoId == -1)
+					groupConfigMDMap[grpDest].homeoId = lDest; // this neuron info will be printed
+				withHomeostasis[connId] = false; // homeoId is set once per group
+			}
 		}
-
-		// generate the delay vaule
-		//it->delay = connectConfigMap[it->connId].minDelay + rand() % (connectConfigMap[it->connId].maxDelay - connectConfigMap[it->connId].minDelay + 1);
-		//assert((it->delay >= connectConfigMap[it->connId].minDelay) && (it->delay <= connectConfigMap[it->connId].maxDelay));
-		// generate the max weight and initial weight
-		//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-		//float initWt = connectConfigMap[it->connId].initWt;
-		//float maxWt = connectConfigMap[it->connId].maxWt;
-		// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-		// this access is fine, isExcitatoryGroup() use global grpId
-		//it->maxWt = isExcitatoryGroup(it->grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-		//it->initWt = isExcitatoryGroup(it->grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
-
-		parsedConnections++;
 	}
-	assert(parsedConnections == networkConfigs[netId].numPostSynNet && parsedConnections == networkConfigs[netId].numPreSynNet);
+	assert(numSynapses == (size_t)networkConfigs[netId].numPostSynNet
+		&& numSynapses == (size_t)networkConfigs[netId].numPreSynNet);
 
 	// generate cumulativePost and cumulativePre
 	managerRuntimeData.cumulativePost[0] = 0;
 	managerRuntimeData.cumulativePre[0] = 0;
-	for (int lNId = 1; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+	for (int lNId = 1; lNId < numNAssigned; lNId++) {
 		managerRuntimeData.cumulativePost[lNId] = managerRuntimeData.cumulativePost[lNId - 1] + managerRuntimeData.Npost[lNId - 1];
 		managerRuntimeData.cumulativePre[lNId] = managerRuntimeData.cumulativePre[lNId - 1] + managerRuntimeData.Npre[lNId - 1];
 	}
 
-	// generate preSynapticIds, parse plastic connections first
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned); // reset managerRuntimeData.Npre to zero, so that it can be used as synId
-	parsedConnections = 0;
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
+	// generate preSynapticIds, parse plastic connections first, then fixed connections
+	// the pre-synaptic id (synId) of every synapse is saved in preSynIds
+	std::vector<unsigned short> preSynIds(numSynapses);
+	memset(managerRuntimeData.Npre, 0, sizeof(short) * numNAssigned); // reset managerRuntimeData.Npre to zero, so that it can be used as synId
+	for (int parsePlastic = 1; parsePlastic >= 0; parsePlastic--) {
+		for (size_t i = 0; i < numSynapses; i++) {
+			short int connId = connBuf.getConnId(i);
+			if (isPlastic[connId] != (parsePlastic == 1))
+				continue;
 
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
+			int lSrc = connBuf.getSrc(i) + srcOffset[connId];
+			int lDest = connBuf.getDest(i) + destOffset[connId];
+			int pre_pos = managerRuntimeData.cumulativePre[lDest] + managerRuntimeData.Npre[lDest];
+			assert(pre_pos < networkConfigs[netId].numPreSynNet);
 
-			managerRuntimeData.Npre[connIt->nDest+ GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
+			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID(lSrc, 0, lGrpSrc[connId]); // managerRuntimeData.Npost[lSrc] is not availabe at this parse
+			preSynIds[i] = managerRuntimeData.Npre[lDest]; // save managerRuntimeData.Npre[lDest] as synId
 
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
+			managerRuntimeData.Npre[lDest]++;
 		}
 	}
-	// parse fixed connections
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_FIXED) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
 
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
+	// order the synapses by local pre-synaptic neuron id, then by delay, then by local post-synaptic neuron id (so that
+	// the synapses of a pre-synaptic neuron targeting a range of post-synaptic neurons can be found by binary search),
+	// synapses with equal keys keep the order in which they were generated
+	// the order is built by stable counting sorts, least significant key first
+	std::vector<unsigned int> order(numSynapses), sorted(numSynapses);
+	std::vector<int> key(numSynapses);
+	for (size_t i = 0; i < numSynapses; i++) {
+		order[i] = i;
+		key[i] = connBuf.getDest(i) + destOffset[connBuf.getConnId(i)];
+	}
+	countingSortSynapses(key, numNAssigned, order, sorted);
+	for (size_t i = 0; i < numSynapses; i++)
+		key[i] = connBuf.getDelay(i);
+	countingSortSynapses(key, glbNetworkConfig.maxDelay + 1, order, sorted);
+	for (size_t i = 0; i < numSynapses; i++)
+		key[i] = connBuf.getSrc(i) + srcOffset[connBuf.getConnId(i)];
+	countingSortSynapses(key, numNAssigned, order, sorted);
+	std::vector<int>().swap(key);
+	std::vector<unsigned int>().swap(sorted);
+
+	// generate postSynapticIds and postDelayInfo
+	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (numNAssigned * (glbNetworkConfig.maxDelay + 1)));
+	memset(managerRuntimeData.Npost, 0, sizeof(short) * numNAssigned); // reset managerRuntimeData.Npost to zero, so that it can be used as synId
+	int lastSrc = -1, lastDelay = 0;
+	for (size_t k = 0; k < numSynapses; k++) {
+		size_t i = order[k];
+		short int connId = connBuf.getConnId(i);
+		int lSrc = connBuf.getSrc(i) + srcOffset[connId];
+		int lDest = connBuf.getDest(i) + destOffset[connId];
+		int delay = connBuf.getDelay(i);
+		if (lSrc != lastSrc) {
+			lastSrc = lSrc;
+			lastDelay = 0;
+		}
 
-			managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
+		int post_pos = managerRuntimeData.cumulativePost[lSrc] + managerRuntimeData.Npost[lSrc];
+		int pre_pos  = managerRuntimeData.cumulativePre[lDest] + preSynIds[i];
+		assert(post_pos < networkConfigs[netId].numPostSynNet);
 
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
-		}
-	}
-	assert(parsedConnections == networkConfigs[netId].numPreSynNet);
-	//printf("parsed pre connections %d\n", parsedConnections);
+		// generate a post synaptic id for the current connection
+		managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID(lDest, preSynIds[i], lGrpDest[connId]); // used stored managerRuntimeData.Npre[lDest] in preSynIds[i]
+		// generate a delay look up table by the way
+		assert(delay > 0 && delay >= lastDelay);
+		DelayInfo& delayInfo = managerRuntimeData.postDelayInfo[lSrc * (glbNetworkConfig.maxDelay + 1) + delay - 1];
+		if (delay > lastDelay)
+			delayInfo.delay_index_start = managerRuntimeData.Npost[lSrc];
+		delayInfo.delay_length++;
+		lastDelay = delay;
 
-	// generate postSynapticIds
-	connectionLists[netId].sort(compareSrcNeuron); // sort by local nSrc id
-	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1)));
-	for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) { // pre-neuron order, local nId
-		if (managerRuntimeData.Npost[lNId] > 0) {
-			std::list<ConnectionInfo> postConnectionList;
-			ConnectionInfo targetConn;
-			targetConn.nSrc = lNId ; // the other fields does not matter, use local nid to search
-			
-			std::list<ConnectionInfo>::iterator firstPostConn = std::find(connectionLists[netId].begin(), connectionLists[netId].end(), targetConn);
-			std::list<ConnectionInfo>::iterator lastPostConn = firstPostConn;
-			std::advance(lastPostConn, managerRuntimeData.Npost[lNId]);
-			managerRuntimeData.Npost[lNId] = 0; // reset managerRuntimeData.Npost[lNId] to zero, so that it can be used as synId
-
-			postConnectionList.splice(postConnectionList.begin(), connectionLists[netId], firstPostConn, lastPostConn);
-			postConnectionList.sort(compareDelay);
-
-			int post_pos, pre_pos, lastDelay = 0;
-			parsedConnections = 0;
-			//memset(&managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1)], 0, sizeof(DelayInfo) * (glbNetworkConfig.maxDelay + 1));
-			for (std::list<ConnectionInfo>::iterator connIt = postConnectionList.begin(); connIt != postConnectionList.end(); connIt++) {
-				assert(connIt->nSrc + GLoffset[connIt->grpSrc] == lNId);
-				post_pos = managerRuntimeData.cumulativePost[connIt->nSrc + GLoffset[connIt->grpSrc]] + managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-				pre_pos  = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + connIt->preSynId;
-
-				assert(post_pos < networkConfigs[netId].numPostSynNet);
-				//assert(pre_pos  < numPreSynNet);
-
-				// generate a post synaptic id for the current connection
-				managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID((connIt->nDest + GLoffset[connIt->grpDest]), connIt->preSynId, (GLgrpId[connIt->grpDest]));// used stored managerRuntimeData.Npre[it->nDest] in it->preSynId
-				// generate a delay look up table by the way
-				assert(connIt->delay > 0);
-				if (connIt->delay > lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_index_start = managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else if (connIt->delay == lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else {
-					KERNEL_ERROR("Post-synaptic delays not sorted correctly... pre_id=%d, delay[%d]=%d, delay[%d]=%d",
-						lNId, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], connIt->delay, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] - 1, lastDelay);
-				}
-				lastDelay = connIt->delay;
-
-				// update the corresponding pre synaptic id
-				SynInfo preId = managerRuntimeData.preSynapticIds[pre_pos];
-				assert(GET_CONN_NEURON_ID(preId) == connIt->nSrc + GLoffset[connIt->grpSrc]);
-				//assert(GET_CONN_GRP_ID(preId) == it->grpSrc);
-				managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], (GLgrpId[connIt->grpSrc]));
-				managerRuntimeData.wt[pre_pos] = connIt->initWt;
-				managerRuntimeData.maxSynWt[pre_pos] = connIt->maxWt;
-				managerRuntimeData.connIdsPreIdx[pre_pos] = connIt->connId;
-
-				managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-				parsedConnections++;
-
-				// update the maximum number of and post-connections of a neuron in a group
-				//if (managerRuntimeData.Npost[it->nSrc] > groupInfo[it->grpSrc].maxPostConn)
-				//	groupInfo[it->grpSrc].maxPostConn = managerRuntimeData.Npost[it->nSrc];
-			}
-			assert(parsedConnections == managerRuntimeData.Npost[lNId]);
-			//printf("parsed post connections %d\n", parsedConnections);
-			// note: elements in postConnectionList are deallocated automatically with postConnectionList
-			/* for postDelayInfo debugging
-			printf("%d ", lNId);
-			for (int t = 0; t < maxDelay_ + 1; t ++) {
-				printf("[%d,%d]",
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_index_start,
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_length);
-			}
-			printf("\n");
-			*/
-		}
+		// update the corresponding pre synaptic id
+		assert(GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pre_pos]) == lSrc);
+		managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID(lSrc, managerRuntimeData.Npost[lSrc], lGrpSrc[connId]);
+		managerRuntimeData.wt[pre_pos] = connBuf.getInitWt(i);
+		managerRuntimeData.maxSynWt[pre_pos] = connBuf.getMaxWt(i);
+		managerRuntimeData.connIdsPreIdx[pre_pos] = connId;
+
+		managerRuntimeData.Npost[lSrc]++;
 	}
-	assert(connectionLists[netId].empty());
+	connBuf.clear();
 
 	//int p = managerRuntimeData.Npost[src];
 
@@ -3374,6 +3555,79 @@ void SNN::generateConnectionRuntime(int netId) {
 	//	groupInfo[destGrp].maxPreConn = managerRuntimeData.Npre[src];
 }
 
+// copies the connections of local network netId from the network image read by loadSimulation_internal
+// The image holds the arrays as created by generateConnectionRuntime (and updated by the simulation), so that the
+// generation of the connections can be skipped. The voltage and recovery variables are restored as well.
+void SNN::loadConnectionRuntime(int netId) {
+	const NetworkImageNetwork* net = findImageNetwork(netId);
+	assert(net != NULL);
+
+	if (net->numNAssigned != networkConfigs[netId].numNAssigned || net->numNReg != networkConfigs[netId].numNReg
+			|| net->numPreSynNet != networkConfigs[netId].numPreSynNet || net->numPostSynNet != networkConfigs[netId].numPostSynNet) {
+		KERNEL_ERROR("loadSimulation: Size of local network %d in file and simulation don't match.", netId);
+		exitSimulation(-1);
+	}
+
+	// expected size of each array of the local network (see saveSimulation)
+	size_t arraySize[IMG_NUM_ARRAYS];
+	arraySize[IMG_NPRE] = sizeof(short) * net->numNAssigned;
+	arraySize[IMG_NPRE_PLASTIC] = sizeof(short) * net->numNAssigned;
+	arraySize[IMG_NPOST] = sizeof(short) * net->numNAssigned;
+	arraySize[IMG_CUMULATIVE_PRE] = sizeof(int) * net->numNAssigned;
+	arraySize[IMG_CUMULATIVE_POST] = sizeof(int) * net->numNAssigned;
+	arraySize[IMG_PRE_SYNAPTIC_IDS] = sizeof(SynInfo) * net->numPreSynNet;
+	arraySize[IMG_POST_SYNAPTIC_IDS] = sizeof(SynInfo) * net->numPostSynNet;
+	arraySize[IMG_POST_DELAY_INFO] = sizeof(DelayInfo) * net->numNAssigned * (glbNetworkConfig.maxDelay + 1);
+	arraySize[IMG_WT] = sizeof(float) * net->numPreSynNet;
+	arraySize[IMG_MAX_SYN_WT] = sizeof(float) * net->numPreSynNet;
+	arraySize[IMG_CONN_IDS_PRE_IDX] = sizeof(short int) * net->numPreSynNet;
+	arraySize[IMG_VOLTAGE] = sizeof(float) * net->numNReg;
+	arraySize[IMG_RECOVERY] = sizeof(float) * net->numNReg;
+
+	void* arrays[IMG_NUM_ARRAYS];
+	arrays[IMG_NPRE] = managerRuntimeData.Npre;
+	arrays[IMG_NPRE_PLASTIC] = managerRuntimeData.Npre_plastic;
+	arrays[IMG_NPOST] = managerRuntimeData.Npost;
+	arrays[IMG_CUMULATIVE_PRE] = managerRuntimeData.cumulativePre;
+	arrays[IMG_CUMULATIVE_POST] = managerRuntimeData.cumulativePost;
+	arrays[IMG_PRE_SYNAPTIC_IDS] = managerRuntimeData.preSynapticIds;
+	arrays[IMG_POST_SYNAPTIC_IDS] = managerRuntimeData.postSynapticIds;
+	arrays[IMG_POST_DELAY_INFO] = managerRuntimeData.postDelayInfo;
+	arrays[IMG_WT] = managerRuntimeData.wt;
+	arrays[IMG_MAX_SYN_WT] = managerRuntimeData.maxSynWt;
+	arrays[IMG_CONN_IDS_PRE_IDX] = managerRuntimeData.connIdsPreIdx;
+	arrays[IMG_VOLTAGE] = managerRuntimeData.voltage;
+	arrays[IMG_RECOVERY] = managerRuntimeData.recovery;
+
+	for (int array = 0; array < IMG_NUM_ARRAYS; array++) {
+		if (net->arraySize[array] != arraySize[array]) {
+			KERNEL_ERROR("loadSimulation: Error while reading local network %d", netId);
+			exitSimulation(-1);
+		}
+		if (arraySize[array] > 0)
+			memcpy(arrays[array], loadSimImage + net->arrayOffset[array], arraySize[array]);
+	}
+
+	// generate mulSynFast, mulSynSlow in connection-centric array
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		mulSynFast[connIt->second.connId] = connIt->second.mulSynFast;
+		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
+	}
+
+	// same side effects as generateConnectionRuntime for plastic synapses
+	for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+		if (managerRuntimeData.Npre_plastic[lNId] == 0)
+			continue;
+
+		sim_with_fixedwts = false; // if network has any plastic synapses at all, this will be set to true
+
+		// homeostasis
+		int gGrpId = groupConfigs[netId][managerRuntimeData.grpIds[lNId]].gGrpId;
+		if (groupConfigMap[gGrpId].homeoConfig.WithHomeostasis && groupConfigMDMap[gGrpId].homeoId == -1)
+			groupConfigMDMap[gGrpId].homeoId = lNId; // this neuron info will be printed
+	}
+}
+
 void SNN::generateCompConnectionRuntime(int netId)
 {
 	std::map<int, int> GLgrpId; // global grpId to local grpId offset
@@ -3553,377 +3807,449 @@ void SNN::compileGroupConfig() {
 }
 
 void SNN::connectNetwork() {
-	// this parse generates local connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, false);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, false);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, false);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, false);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
-			}
-		}
-	}
+	// split every connection into tasks of pre-synaptic neuron ranges, in the order the connections are generated:
+	// first the local connections of all networks, then the external connections
+	// random, full and gaussian connections are split so that their ranges can be generated in parallel, one-to-one
+	// connections are cheap, and the callbacks of user-defined connections are not required to be thread-safe
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	int numThreads = (glbNetworkConfig.numConnectionThreads > 0) ? glbNetworkConfig.numConnectionThreads : NUM_CPU_CORES;
+#else
+	int numThreads = 1;
+#endif
+	numThreads = std::max(numThreads, 1);
 
-	// this parse generates external connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, true);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, true);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, true);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, true);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
+	std::vector<ConnectionTask> tasks;
+	std::map<int, std::vector<Point3D> > groupLocations; // neuron locations of the groups, cached for RF tests
+	size_t expectedNumSynapses[MAX_NET_PER_SNN] = {0};
+	for (int i = 0; i < 2; i++) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = (i == 0) ? localConnectLists[netId] : externalConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				ConnectionTask task;
+				task.snn_pointer = this;
+				task.connConfig = &(*connIt);
+				task.netId = netId;
+				task.externalNetId = -1;
+				if (i == 1) {
+					task.externalNetId = groupConfigMDMap[connIt->grpDest].netId;
+					assert(netId != task.externalNetId);
+				}
+				task.gSrcStartN = groupConfigMDMap[connIt->grpSrc].gStartN;
+				task.gDestStartN = groupConfigMDMap[connIt->grpDest].gStartN;
+				task.gDestEndN = groupConfigMDMap[connIt->grpDest].gEndN;
+				task.srcGrid = groupConfigMap[connIt->grpSrc].grid;
+				task.destGrid = groupConfigMap[connIt->grpDest].grid;
+				task.isExcitatorySrc = isExcitatoryGroup(connIt->grpSrc);
+				task.srcLocations = NULL;
+				task.destLocations = NULL;
+				task.connBuf = NULL;
+				task.numberOfConnections = 0;
+
+				bool isSplit = false;
+				switch(connIt->type) {
+					case CONN_RANDOM:
+					case CONN_FULL:
+					case CONN_FULL_NO_DIRECT:
+					case CONN_GAUSSIAN:
+						isSplit = true;
+						break;
+					case CONN_ONE_TO_ONE:
+					case CONN_USER_DEFINED:
+						break;
+					default:
+						KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
+						exitSimulation(-1);
+				}
+
+				// full, gaussian, and random connections with a RF test the locations of the neurons
+				const RadiusRF& radius = connIt->connRadius;
+				bool hasRF = radius.radX >= 0 || radius.radY >= 0 || radius.radZ >= 0;
+				if (isSplit && (connIt->type != CONN_RANDOM || hasRF)) {
+					task.srcLocations = &getGroupLocations(connIt->grpSrc, groupLocations)[0];
+					task.destLocations = &getGroupLocations(connIt->grpDest, groupLocations)[0];
+				}
+
+				// equal ranges, 4 per thread to balance the load
+				int numPre = groupConfigMap[connIt->grpSrc].numN;
+				int numRanges = isSplit ? std::min(numPre, 4 * numThreads) : 1;
+				for (int range = 0; range < numRanges; range++) {
+					task.gPreStartN = task.gSrcStartN + (int)((long long)numPre * range / numRanges);
+					task.gPreEndN = task.gSrcStartN + (int)((long long)numPre * (range + 1) / numRanges) - 1;
+					tasks.push_back(task);
+				}
+
+				// the synapses of external connections are stored in the buffers of both networks
+				expectedNumSynapses[netId] += estimateNumSynapses(*connIt);
+				if (task.externalNetId >= 0)
+					expectedNumSynapses[task.externalNetId] += estimateNumSynapses(*connIt);
 			}
 		}
 	}
-}
 
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	connInfo.initWt = 0.0f;
-	connInfo.maxWt = 0.0f;
-	connInfo.delay = 0;
-
-	// generate the delay vaule
-	connInfo.delay = connectConfigMap[_connId].minDelay + rand() % (connectConfigMap[_connId].maxDelay - connectConfigMap[_connId].minDelay + 1);
-	assert((connInfo.delay >= connectConfigMap[_connId].minDelay) && (connInfo.delay <= connectConfigMap[_connId].maxDelay));
-	// generate the max weight and initial weight
-	//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-	float initWt = connectConfigMap[_connId].initWt;
-	float maxWt = connectConfigMap[_connId].maxWt;
-	// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-	// this access is fine, isExcitatoryGroup() use global grpId
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
+	// reserve the connection buffers from the expected number of synapses
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		connectionBuffers[netId].reserve(expectedNumSynapses[netId]);
 
-	connectionLists[netId].push_back(connInfo);
+	for (size_t t = 0; t < tasks.size(); t++)
+		tasks[t].connBuf = new ConnectionBuffer();
 
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
-}
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	if (numThreads > 1) {
+		// the workers generate the split connections, the other connections are generated by this thread meanwhile
+		// the synapses of a task only depend on its range (see connectRandom), so the network is the same for any
+		// number of threads
+		ThreadPool pool;
+		for (int threadId = 0; threadId < numThreads; threadId++)
+			pool.startWorker(threadId, -1);
 
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	// adjust the sign of the weight based on inh/exc connection
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0*fabs(initWt);
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0*fabs(maxWt);
-	connInfo.delay = delay;
+		int numDispatched = 0;
+		for (size_t t = 0; t < tasks.size(); t++) {
+			if (tasks[t].connConfig->type != CONN_ONE_TO_ONE && tasks[t].connConfig->type != CONN_USER_DEFINED)
+				pool.dispatch(numDispatched++ % numThreads, &SNN::helperGenerateConnections, (void*)&tasks[t]);
+		}
+		for (size_t t = 0; t < tasks.size(); t++) {
+			if (tasks[t].connConfig->type == CONN_ONE_TO_ONE || tasks[t].connConfig->type == CONN_USER_DEFINED)
+				generateConnections(&tasks[t]);
+		}
+		pool.barrier();
+	} else
+#endif
+	{
+		for (size_t t = 0; t < tasks.size(); t++)
+			generateConnections(&tasks[t]);
+	}
 
-	connectionLists[netId].push_back(connInfo);
+	// collect the synapses of the tasks in their order
+	// update ConnectConfig::numberOfConnections, GroupConfigMD::numPostSynapses and GroupConfigMD::numPreSynapses
+	for (size_t t = 0; t < tasks.size(); t++) {
+		ConnectionTask& task = tasks[t];
+		connectionBuffers[task.netId].append(*task.connBuf);
+		updateGroupNumSynapses(task.netId, task.connConfig->grpSrc, task.connConfig->grpDest, task.numberOfConnections);
 
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
-}
-
-// make 'C' full connections from grpSrc to grpDest
-void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	bool noDirect = (connIt->type == CONN_FULL_NO_DIRECT);
-	int externalNetId = -1;
+		// If the connection is external, copy the synapses to the external network
+		if (task.externalNetId >= 0) {
+			connectionBuffers[task.externalNetId].append(*task.connBuf);
+			updateGroupNumSynapses(task.externalNetId, task.connConfig->grpSrc, task.connConfig->grpDest, task.numberOfConnections);
+		}
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+		task.connConfig->numberOfConnections += task.numberOfConnections;
+		delete task.connBuf;
+		task.connBuf = NULL;
+	}
+}
+
+// returns the expected number of synapses of a connection, or 0 if it cannot be known before the connection is made
+// (receptive fields, gaussian and user-defined connections)
+size_t SNN::estimateNumSynapses(const ConnectConfig& connConfig) {
+	const RadiusRF& radius = connConfig.connRadius;
+	if (radius.radX >= 0 || radius.radY >= 0 || radius.radZ >= 0)
+		return 0;
+
+	size_t numPre = groupConfigMap[connConfig.grpSrc].numN;
+	size_t numPost = groupConfigMap[connConfig.grpDest].numN;
+	switch (connConfig.type) {
+	case CONN_RANDOM:
+		return (size_t)ceil(numPre * numPost * connConfig.connProbability);
+	case CONN_FULL:
+	case CONN_FULL_NO_DIRECT:
+		return numPre * numPost;
+	case CONN_ONE_TO_ONE:
+		return numPre;
+	default:
+		return 0;
 	}
+}
 
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++)  {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) { // j: the temp neuron id
-			// if flag is set, don't connect direct connections
-			if(noDirect && gPreN == gPostN)
-				continue;
-
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
-				continue;
+// returns the locations of the neurons of a group, computed once and stored in groupLocations
+std::vector<Point3D>& SNN::getGroupLocations(int gGrpId, std::map<int, std::vector<Point3D> >& groupLocations) {
+	std::vector<Point3D>& locations = groupLocations[gGrpId];
+	if (locations.empty()) {
+		const Grid3D& grid = groupConfigMap[gGrpId].grid;
+		locations.reserve(grid.N);
+		for (int relNeurId = 0; relNeurId < grid.N; relNeurId++)
+			locations.push_back(getNeuronLocation3D(grid, relNeurId));
+	}
+	return locations;
+}
 
-			connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-			connIt->numberOfConnections++;
-		}
+// generates the synapses of a task
+void SNN::generateConnections(ConnectionTask* task) {
+	switch(task->connConfig->type) {
+		case CONN_RANDOM:
+			connectRandom(task);
+			break;
+		case CONN_FULL:
+		case CONN_FULL_NO_DIRECT:
+			connectFull(task);
+			break;
+		case CONN_ONE_TO_ONE:
+			connectOneToOne(task);
+			break;
+		case CONN_GAUSSIAN:
+			connectGaussian(task);
+			break;
+		case CONN_USER_DEFINED:
+			connectUserDefined(task);
+			break;
+		default:
+			assert(false);
 	}
+}
 
+void* SNN::helperGenerateConnections(void* arguments) {
+	ConnectionTask* task = (ConnectionTask*) arguments;
+	((SNN *)task->snn_pointer)->generateConnections(task);
+	return NULL;
+}
+
+// update numPostSynapses and numPreSynapses of groups in a local network
+void SNN::updateGroupNumSynapses(int netId, int grpSrc, int grpDest, int numSynapses) {
 	std::list<GroupConfigMD>::iterator grpIt;
 	GroupConfigMD targetGrp;
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
 	targetGrp.gGrpId = grpSrc; // the other fields does not matter
 	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
 	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+	grpIt->numPostSynapses += numSynapses;
 
 	targetGrp.gGrpId = grpDest; // the other fields does not matter
 	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
 	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+	grpIt->numPreSynapses += numSynapses;
+}
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
+//! set one specific connection from neuron id 'src' to neuron id 'dest'
+inline void SNN::connectNeurons(ConnectionTask* task, int _nSrc, int _nDest) {
+	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
+	const ConnectConfig& connConfig = *task->connConfig;
+
+	// generate the delay vaule, from lane 1 of the random numbers of the pre/post pair (see connectRandom)
+	uint32_t rnd[4];
+	PhiloxRNG(randSeed_, RNG_STREAM_CONNECT).generate(_nSrc, _nDest, connConfig.connId, 0, rnd);
+	uint8_t delay = connConfig.minDelay + rnd[1] % (connConfig.maxDelay - connConfig.minDelay + 1);
+	assert((delay >= connConfig.minDelay) && (delay <= connConfig.maxDelay));
+	// generate the max weight and initial weight
+	//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
+	float initWt = connConfig.initWt;
+	float maxWt = connConfig.maxWt;
+	// adjust sign of weight based on pre-group (negative if pre is inhibitory)
+	maxWt = task->isExcitatorySrc ? fabs(maxWt) : -1.0 * fabs(maxWt);
+	initWt = task->isExcitatorySrc ? fabs(initWt) : -1.0 * fabs(initWt);
+
+	task->connBuf->push_back(_nSrc, _nDest, connConfig.connId, initWt, maxWt, delay);
+	task->numberOfConnections++;
 }
 
-void SNN::connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	Grid3D grid_i = getGroupGrid3D(grpSrc);
-	Grid3D grid_j = getGroupGrid3D(grpDest);
-	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
-	int externalNetId = -1;
+//! set one specific connection from neuron id 'src' to neuron id 'dest'
+inline void SNN::connectNeurons(ConnectionTask* task, int _nSrc, int _nDest, float initWt, float maxWt, uint8_t delay) {
+	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
+	// adjust the sign of the weight based on inh/exc connection
+	initWt = task->isExcitatorySrc ? fabs(initWt) : -1.0*fabs(initWt);
+	maxWt = task->isExcitatorySrc ? fabs(maxWt) : -1.0*fabs(maxWt);
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
+	task->connBuf->push_back(_nSrc, _nDest, task->connConfig->connId, initWt, maxWt, delay);
+	task->numberOfConnections++;
+}
 
-	for(int i = groupConfigMDMap[grpSrc].gStartN; i <= groupConfigMDMap[grpSrc].gEndN; i++)  {
-		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
+// returns the range [first, last] of grid indices along one dimension whose coordinates can be within radius of the
+// coordinate pre (the RF of a neuron at pre), all indices if the dimension is not restricted (radius < 0)
+// the range is one index wider on both sides to absorb rounding, the exact RF test is done for every neuron in the box
+static void getRFIndexRange(double pre, double radius, int num, float dist, float offset, int& first, int& last) {
+	first = 0;
+	last = num - 1;
+	if (radius < 0 || dist <= 0.0f)
+		return;
 
-		for(int j = groupConfigMDMap[grpDest].gStartN; j <= groupConfigMDMap[grpDest].gEndN; j++) { // j: the temp neuron id
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+	double lo = floor((pre - radius - offset) / dist) - 1;
+	double hi = ceil((pre + radius - offset) / dist) + 1;
+	if (lo > first)
+		first = (lo > num) ? num : (int)lo;
+	if (hi < last)
+		last = (hi < -1) ? -1 : (int)hi;
+}
 
-			// make sure point is in RF
-			double rfDist = getRFDist3D(connIt->connRadius,loc_i,loc_j);
-			if (rfDist < 0.0 || rfDist > 1.0)
-				continue;
+// returns the bounding box (in grid indices of the post-synaptic group) of the RF of a pre-synaptic neuron at locPre
+static void getRFBoundingBox(const RadiusRF& radius, const Grid3D& grid, const Point3D& locPre, int first[3], int last[3]) {
+	getRFIndexRange(locPre.x, radius.radX, grid.numX, grid.distX, grid.offsetX, first[0], last[0]);
+	getRFIndexRange(locPre.y, radius.radY, grid.numY, grid.distY, grid.offsetY, first[1], last[1]);
+	getRFIndexRange(locPre.z, radius.radZ, grid.numZ, grid.distZ, grid.offsetZ, first[2], last[2]);
+}
 
-			// if rfDist is valid, it returns a number between 0 and 1
-			// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
-			// and rfDist=1 corresponds to 0.1 times max Gaussian weight
-			// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
-			// solving for a, we find that a = 2.3026
-			double gauss = exp(-2.3026*rfDist);
-			if (gauss < 0.1)
-				continue;
+// make 'C' full connections from grpSrc to grpDest
+void SNN::connectFull(ConnectionTask* task) {
+	const ConnectConfig& connConfig = *task->connConfig;
+	const Grid3D& destGrid = task->destGrid;
+	bool noDirect = (connConfig.type == CONN_FULL_NO_DIRECT);
+
+	for(int gPreN = task->gPreStartN; gPreN <= task->gPreEndN; gPreN++)  {
+		const Point3D& locPre = task->srcLocations[gPreN - task->gSrcStartN]; // 3D coordinates of i
+
+		// only visit the post-synaptic neurons in the bounding box of the RF, in the order of their ids
+		int first[3], last[3];
+		getRFBoundingBox(connConfig.connRadius, destGrid, locPre, first, last);
+		for (int z = first[2]; z <= last[2]; z++) {
+			for (int y = first[1]; y <= last[1]; y++) {
+				for (int x = first[0]; x <= last[0]; x++) {
+					int relPostN = x + destGrid.numX * (y + destGrid.numY * z);
+					int gPostN = task->gDestStartN + relPostN; // j: the temp neuron id
+
+					// if flag is set, don't connect direct connections
+					if(noDirect && gPreN == gPostN)
+						continue;
 
-			if (drand48() < connIt->connProbability) {
-				float initWt = gauss * connIt->initWt; // scale weight according to gauss distance
-				float maxWt = connIt->maxWt;
-				uint8_t delay = connIt->minDelay + rand() % (connIt->maxDelay - connIt->minDelay + 1);
-				assert((delay >= connIt->minDelay) && (delay <= connIt->maxDelay));
+					// check whether pre-neuron location is in RF of post-neuron
+					if (!isPoint3DinRF(connConfig.connRadius, locPre, task->destLocations[relPostN]))
+						continue;
 
-				connectNeurons(netId, grpSrc, grpDest, i, j, connIt->connId, initWt, maxWt, delay, externalNetId);
-				connIt->numberOfConnections++;
+					connectNeurons(task, gPreN, gPostN);
+				}
 			}
 		}
 	}
+}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
+void SNN::connectGaussian(ConnectionTask* task) {
+	const ConnectConfig& connConfig = *task->connConfig;
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
+	Grid3D grid_i = task->srcGrid;
+	Grid3D grid_j = task->destGrid;
+	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
 
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+	// the random numbers of a synapse only depend on the seed, the connection, and the pre- and post-neuron
+	PhiloxRNG rng(randSeed_, RNG_STREAM_CONNECT);
+
+	for(int i = task->gPreStartN; i <= task->gPreEndN; i++)  {
+		Point3D loc_i = task->srcLocations[i - task->gSrcStartN]*scalePre; // i: adjusted 3D coordinates
+
+		// only visit the post-synaptic neurons in the bounding box of the RF, in the order of their ids
+		int first[3], last[3];
+		getRFBoundingBox(connConfig.connRadius, grid_j, loc_i, first, last);
+		for (int z = first[2]; z <= last[2]; z++) {
+			for (int y = first[1]; y <= last[1]; y++) {
+				for (int x = first[0]; x <= last[0]; x++) {
+					int relPostN = x + grid_j.numX * (y + grid_j.numY * z);
+					int j = task->gDestStartN + relPostN; // j: the temp neuron id
+					const Point3D& loc_j = task->destLocations[relPostN]; // 3D coordinates of j
+
+					// make sure point is in RF
+					double rfDist = getRFDist3D(connConfig.connRadius,loc_i,loc_j);
+					if (rfDist < 0.0 || rfDist > 1.0)
+						continue;
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
-}
+					// if rfDist is valid, it returns a number between 0 and 1
+					// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
+					// and rfDist=1 corresponds to 0.1 times max Gaussian weight
+					// so we're looking at gauss = exp(-a*rfDist), where a such that exp(-a)=0.1
+					// solving for a, we find that a = 2.3026
+					double gauss = exp(-2.3026*rfDist);
+					if (gauss < 0.1)
+						continue;
 
-void SNN::connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
+					uint32_t rnd[4];
+					rng.generate(i, j, connConfig.connId, 0, rnd);
+					if (PhiloxRNG::toFloat(rnd[0]) < connConfig.connProbability) {
+						float initWt = gauss * connConfig.initWt; // scale weight according to gauss distance
+						float maxWt = connConfig.maxWt;
+						uint8_t delay = connConfig.minDelay + rnd[1] % (connConfig.maxDelay - connConfig.minDelay + 1);
+						assert((delay >= connConfig.minDelay) && (delay <= connConfig.maxDelay));
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+						connectNeurons(task, i, j, initWt, maxWt, delay);
+					}
+				}
+			}
+		}
 	}
+}
 
-	assert( groupConfigMap[grpDest].numN == groupConfigMap[grpSrc].numN);
+void SNN::connectOneToOne(ConnectionTask* task) {
+	assert(task->gDestEndN - task->gDestStartN + 1 == task->srcGrid.N);
 
 	// NOTE: RadiusRF does not make a difference here: ignore
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN, gPostN = groupConfigMDMap[grpDest].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++, gPostN++)  {
-		connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-		connIt->numberOfConnections++;
-	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+	for(int gPreN = task->gPreStartN; gPreN <= task->gPreEndN; gPreN++)  {
+		connectNeurons(task, gPreN, task->gDestStartN + gPreN - task->gSrcStartN);
 	}
 }
 
 // make 'C' random connections from grpSrc to grpDest
-void SNN::connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
-
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
-
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++) {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) {
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
-				continue;
+void SNN::connectRandom(ConnectionTask* task) {
+	const ConnectConfig& connConfig = *task->connConfig;
+	const RadiusRF& radius = connConfig.connRadius;
+
+	// the random numbers of a synapse only depend on the seed, the connection, and the pre- and post-neuron, so that
+	// the connectivity does not depend on the partitioning of the network or on how the pre-synaptic neurons are
+	// split into tasks. the delay of a synapse is lane 1 of the counter of its pre/post pair (see connectNeurons)
+	PhiloxRNG rng(randSeed_, RNG_STREAM_CONNECT);
+
+	if (radius.radX < 0 && radius.radY < 0 && radius.radZ < 0) {
+		// every post-synaptic neuron is in the RF: instead of testing every pair, draw the number of post-synaptic
+		// neurons skipped until the next synapse of a pre-synaptic neuron from a geometric distribution, so that the
+		// work is proportional to the number of synapses. the draws of a pre-synaptic neuron use the counters
+		// (gPreN, draw / 4, connId, 1), which are disjoint from the counters of the pairs
+		if (connConfig.connProbability <= 0.0f)
+			return;
+		double logNoConnection = log1p(-(double)connConfig.connProbability); // -inf for a probability of 1
+		int numPost = task->gDestEndN - task->gDestStartN + 1;
+
+		for(int gPreN = task->gPreStartN; gPreN <= task->gPreEndN; gPreN++) {
+			uint32_t rnd[4];
+			int relPostN = -1;
+			for (uint32_t draw = 0; ; draw++) {
+				if ((draw & 3) == 0)
+					rng.generate(gPreN, draw >> 2, connConfig.connId, 1, rnd);
+				double u = (rnd[draw & 3] + 1.0) / 4294967296.0; // (0,1]
+				double skip = floor(log(u) / logNoConnection);
+				if (skip >= numPost - 1 - relPostN)
+					break;
 
-			if (drand48() < connIt->connProbability) {
-				connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-				connIt->numberOfConnections++;
+				relPostN += (int)skip + 1;
+				connectNeurons(task, gPreN, task->gDestStartN + relPostN);
 			}
 		}
+		return;
 	}
 
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
+	// lane 0 of the counter of a pre/post pair decides whether the synapse exists
+	const Grid3D& destGrid = task->destGrid;
+	for(int gPreN = task->gPreStartN; gPreN <= task->gPreEndN; gPreN++) {
+		const Point3D& locPre = task->srcLocations[gPreN - task->gSrcStartN]; // 3D coordinates of i
 
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
+		// only visit the post-synaptic neurons in the bounding box of the RF, in the order of their ids
+		int first[3], last[3];
+		getRFBoundingBox(radius, destGrid, locPre, first, last);
+		for (int z = first[2]; z <= last[2]; z++) {
+			for (int y = first[1]; y <= last[1]; y++) {
+				for (int x = first[0]; x <= last[0]; x++) {
+					int relPostN = x + destGrid.numX * (y + destGrid.numY * z);
+					int gPostN = task->gDestStartN + relPostN;
 
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
+					// check whether pre-neuron location is in RF of post-neuron
+					if (!isPoint3DinRF(radius, locPre, task->destLocations[relPostN]))
+						continue;
 
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+					if (rng.uniform(gPreN, gPostN, connConfig.connId, 0) < connConfig.connProbability) {
+						connectNeurons(task, gPreN, gPostN);
+					}
+				}
+			}
+		}
 	}
 }
 
 // FIXME: rewrite user-define call-back function
 // user-defined functions called here...
 // This is where we define our user-defined call-back function.  -- KDC
-void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+void SNN::connectUserDefined(ConnectionTask* task) {
+	ConnectConfig* connIt = task->connConfig;
 	int grpSrc = connIt->grpSrc;
 	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
-
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
 
 	connIt->maxDelay = 0;
-	int preStartN = groupConfigMDMap[grpSrc].gStartN;
-	int postStartN = groupConfigMDMap[grpDest].gStartN;
-	for (int pre_nid = groupConfigMDMap[grpSrc].gStartN; pre_nid <= groupConfigMDMap[grpSrc].gEndN; pre_nid++) {
+	int preStartN = task->gSrcStartN;
+	int postStartN = task->gDestStartN;
+	for (int pre_nid = task->gPreStartN; pre_nid <= task->gPreEndN; pre_nid++) {
 		//Point3D loc_pre = getNeuronLocation3D(pre_nid); // 3D coordinates of i
-		for (int post_nid = groupConfigMDMap[grpDest].gStartN; post_nid <= groupConfigMDMap[grpDest].gEndN; post_nid++) {
+		for (int post_nid = task->gDestStartN; post_nid <= task->gDestEndN; post_nid++) {
 			float weight, maxWt, delay;
 			bool connected;
 
@@ -3942,38 +4268,10 @@ void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connI
 				if (delay > connIt->maxDelay)
 					connIt->maxDelay = delay;
 
-				connectNeurons(netId, grpSrc, grpDest, pre_nid, post_nid, connIt->connId, weight, maxWt, delay, externalNetId);
-				connIt->numberOfConnections++;
+				connectNeurons(task, pre_nid, post_nid, weight, maxWt, delay);
 			}
 		}
 	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
 }
 
 //// make 'C' full connections from grpSrc to grpDest
@@ -4156,9 +4454,7 @@ void SNN::deleteRuntimeData() {
 #endif
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+		ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 		int threadCount = 0;
 	#endif
 
@@ -4170,11 +4466,11 @@ void SNN::deleteRuntimeData() {
 				#if defined(WIN32) || defined(WIN64)
 					deleteRuntimeData_CPU(netId);
 				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					// the runtime might not have a worker if the network was never fully set up
+					if (threadPool == NULL || !threadPool->hasWorker(netId - CPU_RUNTIME_BASE)) {
+						deleteRuntimeData_CPU(netId);
+						continue;
+					}
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -4183,8 +4479,7 @@ void SNN::deleteRuntimeData() {
 					argsThreadRoutine[threadCount].endIdx = 0;
 					argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDeleteRuntimeData_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
+					threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperDeleteRuntimeData_CPU, (void*)&argsThreadRoutine[threadCount]);
 					threadCount++;
 				#endif
 			}
@@ -4192,9 +4487,14 @@ void SNN::deleteRuntimeData() {
 	}
 
 	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
+		// wait for all the workers
+		if (threadCount > 0)
+			threadPool->barrier();
+
+		// tear down the persistent worker threads of the CPU runtimes
+		if (threadPool != NULL) {
+			delete threadPool;
+			threadPool = NULL;
 		}
 	#endif
 
@@ -4210,6 +4510,14 @@ void SNN::deleteObjects() {
 
 	printSimSummary();
 
+	// the monitor cores fclose their files, write the pending blocks first
+	if (monitorFileWriter_ != NULL) {
+		if (!monitorFileWriter_->sync())
+			KERNEL_WARN("Could not write all spike, neuron state and group status files");
+		delete monitorFileWriter_;
+		monitorFileWriter_ = NULL;
+	}
+
 	// deallocate objects
 	resetMonitors(true);
 	resetConnectionConfigs(true);
@@ -4219,6 +4527,15 @@ void SNN::deleteObjects() {
 
 	deleteRuntimeData();
 
+	// unmap the network image, if setupNetwork did not finish
+	releaseSimImage();
+
+	// completes the pending checkpoint
+	if (checkpointWriter_ != NULL) {
+		delete checkpointWriter_;
+		checkpointWriter_ = NULL;
+	}
+
 	// fclose file streams, unless in custom mode
 	if (loggerMode_ != CUSTOM) {
 		// don't fclose if it's stdout or stderr, otherwise they're gonna stay closed for the rest of the process
@@ -4266,10 +4583,20 @@ void SNN::findMaxNumSynapsesNeurons(int _netId, int& _maxNumPostSynN, int& _maxN
 		globalToLocalOffset[grpIt->gGrpId] = grpIt->GtoLOffset;
 	}
 
+	// offsets of the source and destination group of every connection of the local network
+	std::vector<int> srcOffset(numConnections, 0), destOffset(numConnections, 0);
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		if (globalToLocalOffset.count(connIt->second.grpSrc) && globalToLocalOffset.count(connIt->second.grpDest)) {
+			srcOffset[connIt->second.connId] = globalToLocalOffset[connIt->second.grpSrc];
+			destOffset[connIt->second.connId] = globalToLocalOffset[connIt->second.grpDest];
+		}
+	}
+
 	// calculate number of pre- and post- connections of each neuron
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[_netId].begin(); connIt != connectionLists[_netId].end(); connIt++) {
-		nSrc = connIt->nSrc + globalToLocalOffset[connIt->grpSrc];
-		nDest = connIt->nDest + globalToLocalOffset[connIt->grpDest];
+	const ConnectionBuffer& connBuf = connectionBuffers[_netId];
+	for (size_t i = 0; i < connBuf.size(); i++) {
+		nSrc = connBuf.getSrc(i) + srcOffset[connBuf.getConnId(i)];
+		nDest = connBuf.getDest(i) + destOffset[connBuf.getConnId(i)];
 		assert(nSrc < numNeurons); assert(nDest < numNeurons);
 		tempNpost[nSrc]++;
 		tempNpre[nDest]++;
@@ -4342,6 +4669,36 @@ void SNN::findNumNSpikeGenAndOffset(int _netId) {
 	assert(networkConfigs[_netId].numNSpikeGen <= networkConfigs[_netId].numNPois);
 }
 
+void SNN::findNumThreads(int _netId, int _numCPURuntimes, int& _numThreads) {
+	_numThreads = 1;
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	if (_netId < CPU_RUNTIME_BASE) // GPU runtime
+		return;
+
+	if (glbNetworkConfig.numThreadsPerPartition > 0) {
+		// user-defined number of threads, but at least one neuron per thread
+		_numThreads = std::min(glbNetworkConfig.numThreadsPerPartition, networkConfigs[_netId].numN);
+	} else {
+		// share the cores among CPU runtimes, but do not split small networks, where the cost of
+		// synchronizing the threads would outweigh the gain
+		int numCoresPerRuntime = (int)NUM_CPU_CORES / std::max(_numCPURuntimes, 1);
+		_numThreads = std::min(numCoresPerRuntime, networkConfigs[_netId].numN / MIN_NEURONS_PER_CPU_THREAD);
+	}
+	_numThreads = std::max(_numThreads, 1);
+#endif
+
+	KERNEL_DEBUG("Local network %d is simulated with %d thread(s)", _netId, _numThreads);
+}
+
+void SNN::findThreadNeuronRange(int _numN, int _numThreads, int _threadId, int& _startIdx, int& _endIdx) {
+	assert(_threadId >= 0 && _threadId < _numThreads);
+
+	// contiguous neuron ranges [_startIdx, _endIdx) of (almost) equal size, in the order of local neuron ids
+	_startIdx = (int)((long long)_numN * _threadId / _numThreads);
+	_endIdx = (int)((long long)_numN * (_threadId + 1) / _numThreads);
+}
+
 void SNN::findNumSynapsesNetwork(int _netId, int& _numPostSynNet, int& _numPreSynNet) {
 	_numPostSynNet = 0;
 	_numPreSynNet  = 0;
@@ -4505,6 +4862,13 @@ void SNN::fetchLastSpikeTime(int netId) {
 		copyLastSpikeTime(netId);
 }
 
+void SNN::fetchNeuronVariables(int netId) {
+	if (netId < CPU_RUNTIME_BASE)
+		copyNeuronVariables(netId, cudaMemcpyDeviceToHost);
+	else
+		copyNeuronVariables(netId);
+}
+
 void SNN::fetchPreConnectionInfo(int netId) {
 	if (netId < CPU_RUNTIME_BASE)
 		copyPreConnectionInfo(netId, ALL, &managerRuntimeData, &runtimeData[netId], cudaMemcpyDeviceToHost, false);
@@ -4653,9 +5017,7 @@ void SNN::routeSpikes() {
 		//KERNEL_DEBUG("GPU1 D1:%d/D2:%d", firingTableIdxD1, firingTableIdxD2);
 
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[(2 * networkConfigs[srcNetId].numGroups) + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[(2 * networkConfigs[srcNetId].numGroups) + 1]; // same as above, +1 array size
+			ThreadStruct argsThreadRoutine[(2 * networkConfigs[srcNetId].numGroups) + 1]; // 1 additional array size if numGroups == 0
 			int threadCount = 0;
 		#endif
 
@@ -4687,12 +5049,6 @@ void SNN::routeSpikes() {
 									firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId],
 									GtoLOffset); // [StartIdx, EndIdx)
 							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 								argsThreadRoutine[threadCount].snn_pointer = this;
 								argsThreadRoutine[threadCount].netId = destNetId;
 								argsThreadRoutine[threadCount].lGrpId = 0;
@@ -4700,8 +5056,7 @@ void SNN::routeSpikes() {
 								argsThreadRoutine[threadCount].endIdx = firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
 								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
 
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
+								threadPool->dispatch(destNetId - CPU_RUNTIME_BASE, &SNN::helperConvertExtSpikesD2_CPU, (void*)&argsThreadRoutine[threadCount]);
 								threadCount++;
 							#endif
 					}
@@ -4736,12 +5091,6 @@ void SNN::routeSpikes() {
 									firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
 									GtoLOffset); // [StartIdx, EndIdx)
 							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 								argsThreadRoutine[threadCount].snn_pointer = this;
 								argsThreadRoutine[threadCount].netId = destNetId;
 								argsThreadRoutine[threadCount].lGrpId = 0;
@@ -4749,8 +5098,7 @@ void SNN::routeSpikes() {
 								argsThreadRoutine[threadCount].endIdx = firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
 								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
 
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
+								threadPool->dispatch(destNetId - CPU_RUNTIME_BASE, &SNN::helperConvertExtSpikesD1_CPU, (void*)&argsThreadRoutine[threadCount]);
 								threadCount++;
 							#endif
 					}
@@ -4761,10 +5109,9 @@ void SNN::routeSpikes() {
 		}
 
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
+			// wait for all the workers
+			if (threadCount > 0)
+				threadPool->barrier();
 		#endif
 
 		managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD2;
@@ -5015,6 +5362,10 @@ void SNN::partitionSNN() {
 	// get number of available GPU card(s) in the present machine
 	numAvailableGPUs = configGPUDevice();
 
+	// distribute the groups without preferred partition among the CPU runtimes
+	if (preferredSimMode_ == CPU_MODE || preferredSimMode_ == HYBRID_MODE)
+		partitionAnyGroups();
+
 	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
 		// assign a group to the GPU specified by users
 		int gGrpId = grpIt->second.gGrpId;
@@ -5028,19 +5379,16 @@ void SNN::partitionSNN() {
 			// TODO: add callback function that allow user to partition network by theirself
 			// FIXME: make sure GPU(s) is available first
 			// this parse separates groups into each local network and assign each group a netId
-			if (preferredSimMode_ == CPU_MODE) {
-				grpIt->second.netId = CPU_RUNTIME_BASE; // CPU 0
-				numAssignedNeurons[CPU_RUNTIME_BASE] += groupConfigMap[gGrpId].numN;
-				groupPartitionLists[CPU_RUNTIME_BASE].push_back(grpIt->second); // Copy by value, create a copy
+			if (preferredSimMode_ == CPU_MODE || preferredSimMode_ == HYBRID_MODE) {
+				// the CPU runtime has been chosen by partitionAnyGroups()
+				netId = grpIt->second.netId;
+				assert(netId > ANY && netId < MAX_NET_PER_SNN);
+				numAssignedNeurons[netId] += groupConfigMap[gGrpId].numN;
+				groupPartitionLists[netId].push_back(grpIt->second); // Copy by value, create a copy
 			} else if (preferredSimMode_ == GPU_MODE) {
 				grpIt->second.netId = GPU_RUNTIME_BASE; // GPU 0
 				numAssignedNeurons[GPU_RUNTIME_BASE] += groupConfigMap[gGrpId].numN;
 				groupPartitionLists[GPU_RUNTIME_BASE].push_back(grpIt->second); // Copy by value, create a copy
-			} else  if (preferredSimMode_ == HYBRID_MODE) {
-				// TODO: implement partition algorithm, use naive partition for now (allocate to CPU 0)
-				grpIt->second.netId = CPU_RUNTIME_BASE; // CPU 0
-				numAssignedNeurons[CPU_RUNTIME_BASE] += groupConfigMap[gGrpId].numN;
-				groupPartitionLists[CPU_RUNTIME_BASE].push_back(grpIt->second); // Copy by value, create a copy
 			} else {
 				KERNEL_ERROR("Unkown simulation mode");
 				exitSimulation(-1);
@@ -5053,6 +5401,12 @@ void SNN::partitionSNN() {
 		}
 	}
 
+	// predict the load of every local network, to be compared with the measured load in printPartitionLoad()
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		predictedLoad[netId] = 0.0f;
+	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++)
+		predictedLoad[grpIt->second.netId] += estimateGroupCost(grpIt->second.gGrpId);
+
 	// this parse finds local connections (i.e., connection configs that conect local groups)
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
@@ -5154,7 +5508,11 @@ void SNN::partitionSNN() {
 	// generation connections among groups according to group and connect configs
 	// update ConnectConfig::numberOfConnections
 	// update GroupConfig::numPostSynapses, GroupConfig::numPreSynapses
-	connectNetwork();
+	// a loaded network image already contains the connections, which are copied in loadConnectionRuntime
+	if (loadSimFID != NULL)
+		loadSimulation_internal();
+	else
+		connectNetwork();
 
 	collectGlobalNetworkConfigP();
 
@@ -5183,232 +5541,551 @@ void SNN::partitionSNN() {
 	snnState = PARTITIONED_SNN;
 }
 
-int SNN::loadSimulation_internal(bool onlyPlastic) {
-	//// TSC: so that we can restore the file position later...
-	//// MB: not sure why though...
-	//long file_position = ftell(loadSimFID);
-	//
-	//int tmpInt;
-	//float tmpFloat;
+void SNN::partitionAnyGroups() {
+	// groups that are compartmentally connected must be placed on the same partition, find these units of groups
+	std::vector<int> unitId(numGroups);
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++)
+		unitId[gGrpId] = gGrpId;
+	for (std::map<int, compConnectConfig>::iterator connIt = compConnectConfigMap.begin(); connIt != compConnectConfigMap.end(); connIt++) {
+		int oldUnitId = std::max(unitId[connIt->second.grpSrc], unitId[connIt->second.grpDest]);
+		int newUnitId = std::min(unitId[connIt->second.grpSrc], unitId[connIt->second.grpDest]);
+		for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+			if (unitId[gGrpId] == oldUnitId)
+				unitId[gGrpId] = newUnitId;
+		}
+	}
 
-	//bool readErr = false; // keep track of reading errors
-	//size_t result;
+	// a unit is pinned if any of its groups has a preferred partition
+	std::vector<int> unitNetId(numGroups, ANY);
+	std::vector<float> unitCost(numGroups, 0.0f);
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		if (groupConfigMap[gGrpId].preferredNetId != ANY)
+			unitNetId[unitId[gGrpId]] = groupConfigMap[gGrpId].preferredNetId;
+		unitCost[unitId[gGrpId]] += estimateGroupCost(gGrpId);
+	}
 
+	// spike traffic between two groups if they were placed on different partitions: every spike of a pre-synaptic
+	// neuron is routed once (see spikeRoutingTable), regardless of its number of synapses
+	std::vector<std::vector<float> > traffic(numGroups, std::vector<float>(numGroups, 0.0f));
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		int srcUnitId = unitId[connIt->second.grpSrc];
+		int destUnitId = unitId[connIt->second.grpDest];
+		if (srcUnitId != destUnitId) {
+			float spikesPerMs = groupConfigMap[connIt->second.grpSrc].numN * PARTITION_EXPECTED_FIRING_RATE / 1000.0f;
+			traffic[srcUnitId][destUnitId] += spikesPerMs;
+			traffic[destUnitId][srcUnitId] += spikesPerMs;
+		}
+	}
 
-	//// ------- read header ----------------
+	// collect the units to be placed, the most expensive ones first
+	std::vector<std::pair<float, int> > anyUnits;
+	float totalCost = 0.0f;
+	for (int uId = 0; uId < numGroups; uId++) {
+		if (unitId[uId] != uId)
+			continue;
+		if (unitNetId[uId] == ANY) {
+			anyUnits.push_back(std::make_pair(-unitCost[uId], uId));
+			totalCost += unitCost[uId];
+		}
+	}
+	std::sort(anyUnits.begin(), anyUnits.end());
 
-	//fseek(loadSimFID, 0, SEEK_SET);
+	if (anyUnits.empty())
+		return;
 
-	//// read file signature
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != 294338571) {
-	//	KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
-	//		"simulation file created with CARLsim::saveSimulation.");
-	//	exitSimulation(-1);
-	//}
+	int numPartitions = findNumCPUPartitions(totalCost);
 
-	//// read file version number
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpFloat > 0.2f) {
-	//	KERNEL_ERROR("loadSimulation: Unsupported version number (%f)",tmpFloat);
-	//	exitSimulation(-1);
-	//}
+	// the load of the CPU runtimes includes the groups that users have assigned to them
+	std::vector<float> load(numPartitions, 0.0f);
+	for (int uId = 0; uId < numGroups; uId++) {
+		int netId = unitNetId[uId];
+		if (unitId[uId] == uId && netId >= CPU_RUNTIME_BASE && netId < CPU_RUNTIME_BASE + numPartitions) {
+			load[netId - CPU_RUNTIME_BASE] += unitCost[uId];
+			totalCost += unitCost[uId];
+		}
+	}
+	float capacity = totalCost / numPartitions * (1.0f + PARTITION_IMBALANCE_TOLERANCE);
+
+	// greedy placement: choose the partition that receives the most spikes from / sends the most spikes to the unit
+	// among those that can take the unit, otherwise the least loaded partition
+	for (size_t i = 0; i < anyUnits.size(); i++) {
+		int uId = anyUnits[i].second;
+		int bestPart = -1, leastLoadedPart = 0;
+		float bestTraffic = -1.0f;
+		for (int part = 0; part < numPartitions; part++) {
+			if (load[part] < load[leastLoadedPart])
+				leastLoadedPart = part;
+			if (load[part] + unitCost[uId] > capacity)
+				continue;
 
-	//// read simulation time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read execution time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read number of neurons
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numN) {
-	//	KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numN);
-	//	exitSimulation(-1);
-	//}
+			float localTraffic = 0.0f;
+			for (int otherUId = 0; otherUId < numGroups; otherUId++) {
+				if (unitNetId[otherUId] == CPU_RUNTIME_BASE + part)
+					localTraffic += traffic[uId][otherUId];
+			}
+			if (localTraffic > bestTraffic || (localTraffic == bestTraffic && load[part] < load[bestPart])) {
+				bestPart = part;
+				bestTraffic = localTraffic;
+			}
+		}
+		if (bestPart == -1)
+			bestPart = leastLoadedPart;
 
-	//// read number of pre-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPreSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPreSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPreSynNet);
-	//	exitSimulation(-1);
-	//}
+		unitNetId[uId] = CPU_RUNTIME_BASE + bestPart;
+		load[bestPart] += unitCost[uId];
+	}
 
-	//// read number of post-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPostSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPostSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPostSynNet);
-	//	exitSimulation(-1);
-	//}
+	// refinement: move single units if this reduces the traffic between partitions without violating the capacity
+	for (int pass = 0; pass < 4; pass++) {
+		bool moved = false;
+		for (size_t i = 0; i < anyUnits.size(); i++) {
+			int uId = anyUnits[i].second;
+			int currPart = unitNetId[uId] - CPU_RUNTIME_BASE;
 
-	//// read number of groups
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numGroups) {
-	//	KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numGroups);
-	//	exitSimulation(-1);
-	//}
+			std::vector<float> partTraffic(numPartitions, 0.0f);
+			for (int otherUId = 0; otherUId < numGroups; otherUId++) {
+				int otherNetId = unitNetId[otherUId];
+				if (otherUId != uId && otherNetId >= CPU_RUNTIME_BASE && otherNetId < CPU_RUNTIME_BASE + numPartitions)
+					partTraffic[otherNetId - CPU_RUNTIME_BASE] += traffic[uId][otherUId];
+			}
 
-	//// throw reading error instead of proceeding
-	//if (readErr) {
-	//	fprintf(stderr,"loadSimulation: Error while reading file header");
-	//	exitSimulation(-1);
-	//}
+			int bestPart = currPart;
+			for (int part = 0; part < numPartitions; part++) {
+				if (part != currPart && partTraffic[part] > partTraffic[bestPart] && load[part] + unitCost[uId] <= capacity)
+					bestPart = part;
+			}
 
+			if (bestPart != currPart) {
+				load[currPart] -= unitCost[uId];
+				load[bestPart] += unitCost[uId];
+				unitNetId[uId] = CPU_RUNTIME_BASE + bestPart;
+				moved = true;
+			}
+		}
+		if (!moved)
+			break;
+	}
 
-	//// ------- read group information ----------------
+	// assign every group the partition of its unit
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		if (groupConfigMap[gGrpId].preferredNetId == ANY) {
+			groupConfigMDMap[gGrpId].netId = unitNetId[unitId[gGrpId]];
+			KERNEL_DEBUG("Group %s(%d) is assigned to CPU %d (estimated cost %.1f)", groupConfigMap[gGrpId].grpName.c_str(),
+				gGrpId, groupConfigMDMap[gGrpId].netId - CPU_RUNTIME_BASE, estimateGroupCost(gGrpId));
+		}
+	}
 
-	//for (int g=0; g<numGroups; g++) {
-	//	// read StartN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].StartN) {
-	//		KERNEL_ERROR("loadSimulation: StartN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].StartN, g);
-	//		exitSimulation(-1);
-	//	}
+	if (numPartitions > 1) {
+		KERNEL_INFO("Distributed %d group(s) without preferred partition among %d CPU partitions", (int)anyUnits.size(), numPartitions);
+		for (int part = 0; part < numPartitions; part++)
+			KERNEL_INFO("  CPU %d: estimated cost = %.1f", part, load[part]);
+	}
+}
 
-	//	// read EndN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].EndN) {
-	//		KERNEL_ERROR("loadSimulation: EndN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].EndN, g);
-	//		exitSimulation(-1);
-	//	}
+float SNN::estimateGroupCost(int gGrpId) {
+	// relative costs, calibrated against the update of a 4-parameter Izhikevich neuron (= 1.0) per ms
+	const float costSpikeGenerator = 0.1f; // Poisson draw or callback per neuron
+	const float costLIF = 0.5f;
+	const float costIzh9 = 1.5f;
+	const float costCompartment = 0.5f;    // coupling currents
+	const float factorCOBA = 1.5f;         // conductance decay
+	const float costSynEvent = 0.5f;       // delivery of a spike to one synapse
+	const float costSTDPEvent = 0.5f;      // LTP/LTD of one plastic synapse
 
-	//	// read SizeX
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeY
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeZ
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read group name
-	//	char name[100];
-	//	result = fread(name, sizeof(char), 100, loadSimFID);
-	//	readErr |= (result!=100);
-	//	if (strcmp(name,groupInfo[g].Name.c_str()) != 0) {
-	//		KERNEL_ERROR("loadSimulation: Group names in file (%s) and grpInfo (%s) don't match.", name,
-	//			groupInfo[g].Name.c_str());
-	//		exitSimulation(-1);
-	//	}
-	//}
+	GroupConfig& grpConfig = groupConfigMap[gGrpId];
+	float cost;
+	if (grpConfig.isSpikeGenerator || (grpConfig.type & POISSON_NEURON)) {
+		cost = costSpikeGenerator;
+	} else {
+		if (grpConfig.isLIF) {
+			cost = costLIF;
+		} else {
+			cost = grpConfig.withParamModel_9 ? costIzh9 : 1.0f;
+			if (grpConfig.withCompartments)
+				cost += costCompartment;
+		}
+		if (sim_with_conductances)
+			cost *= factorCOBA;
+	}
+	cost *= grpConfig.numN;
 
-	//if (readErr) {
-	//	KERNEL_ERROR("loadSimulation: Error while reading group info");
-	//	exitSimulation(-1);
-	//}
+	// spikes are delivered by the partition of the post-synaptic group
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		if (connIt->second.grpDest != gGrpId)
+			continue;
 
+		float synEventsPerMs = estimateNumSynapses(connIt->first) * PARTITION_EXPECTED_FIRING_RATE / 1000.0f;
+		cost += synEventsPerMs * costSynEvent;
+		if (GET_FIXED_PLASTIC(connIt->second.connProp) == SYN_PLASTIC && grpConfig.stdpConfig.WithSTDP)
+			cost += synEventsPerMs * costSTDPEvent;
+	}
 
-	//// ------- read synapse information ----------------
-
-	//for (int i = 0; i < numN; i++) {
-	//	int nrSynapses = 0;
-
-	//	// read number of synapses
-	//	result = fread(&nrSynapses, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	for (int j=0; j<nrSynapses; j++) {
-	//		int nIDpre;
-	//		int nIDpost;
-	//		float weight, maxWeight;
-	//		uint8_t delay;
-	//		uint8_t plastic;
-	//		short int connId;
-
-	//		// read nIDpre
-	//		result = fread(&nIDpre, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpre != i) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) and simulation (%u) don't match.", nIDpre, i);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read nIDpost
-	//		result = fread(&nIDpost, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpost >= numN) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) is larger than in simulation (%u).", nIDpost, numN);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read weight
-	//		result = fread(&weight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		short int gIDpre = managerRuntimeData.grpIds[nIDpre];
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight>0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight<0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of weight value (%s) does not match neuron type (%s)",
-	//				((weight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read max weight
-	//		result = fread(&maxWeight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight>=0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight<=0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of maxWeight value (%s) does not match neuron type (%s)",
-	//				((maxWeight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read delay
-	//		result = fread(&delay, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (delay > MAX_SYN_DELAY) {
-	//			KERNEL_ERROR("loadSimulation: delay in file (%d) is larger than MAX_SYN_DELAY (%d)",
-	//				(int)delay, (int)MAX_SYN_DELAY);
-	//			exitSimulation(-1);
-	//		}
-
-	//		assert(!isnan(weight));
-	//		// read plastic/fixed
-	//		result = fread(&plastic, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		// read connection ID
-	//		result = fread(&connId, sizeof(short int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		if ((plastic && onlyPlastic) || (!plastic && !onlyPlastic)) {
-	//			int gIDpost = managerRuntimeData.grpIds[nIDpost];
-	//			int connProp = SET_FIXED_PLASTIC(plastic?SYN_PLASTIC:SYN_FIXED);
-
-	//			//setConnection(gIDpre, gIDpost, nIDpre, nIDpost, weight, maxWeight, delay, connProp, connId);
-	//			groupInfo[gIDpre].sumPostConn++;
-	//			groupInfo[gIDpost].sumPreConn++;
-
-	//			if (delay > groupConfigs[0][gIDpre].MaxDelay)
-	//				groupConfigs[0][gIDpre].MaxDelay = delay;
-	//		}
-	//	}
-	//}
+	return cost;
+}
 
-	//fseek(loadSimFID,file_position,SEEK_SET);
+float SNN::estimateNumSynapses(int connId) {
+	ConnectConfig& connConfig = connectConfigMap[connId];
+	Grid3D gridPre = getGroupGrid3D(connConfig.grpSrc);
+	float numPre = gridPre.N;
+	float numPost = getGroupNumNeurons(connConfig.grpDest);
 
-	return 0;
+	// fraction of the pre-synaptic group within the receptive field (a negative radius means the full dimension)
+	RadiusRF rf = connConfig.connRadius;
+	float fractionRF = 1.0f;
+	if (rf.radX >= 0) fractionRF *= std::min(1.0f, (float)(2 * rf.radX + 1) / gridPre.numX);
+	if (rf.radY >= 0) fractionRF *= std::min(1.0f, (float)(2 * rf.radY + 1) / gridPre.numY);
+	if (rf.radZ >= 0) fractionRF *= std::min(1.0f, (float)(2 * rf.radZ + 1) / gridPre.numZ);
+
+	switch (connConfig.type) {
+	case CONN_ONE_TO_ONE:
+		return numPost;
+	case CONN_FULL:
+		return numPre * numPost * fractionRF;
+	case CONN_FULL_NO_DIRECT:
+		return std::max(numPre * numPost * fractionRF - numPost, 0.0f);
+	case CONN_RANDOM:
+	case CONN_GAUSSIAN:
+		return numPre * numPost * fractionRF * connConfig.connProbability;
+	default: // the connectivity of user-defined connections is not known before they are generated, assume 10%
+		return numPre * numPost * 0.1f;
+	}
+}
+
+int SNN::findNumCPUPartitions(float _totalCost) {
+	int numPartitions = 1;
+
+	if (glbNetworkConfig.numCPUPartitions > 0) {
+		numPartitions = glbNetworkConfig.numCPUPartitions;
+	} else {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		// one partition per core (or per group of cores if the threads per partition are fixed), but do not split
+		// small networks, where the spike routing between partitions would outweigh the gain
+		int numCoresPerPartition = std::max(glbNetworkConfig.numThreadsPerPartition, 1);
+		numPartitions = (int)NUM_CPU_CORES / numCoresPerPartition;
+		numPartitions = std::min(numPartitions, (int)(_totalCost / MIN_NEURONS_PER_CPU_THREAD));
+#endif
+	}
+
+	numPartitions = std::max(numPartitions, 1);
+	numPartitions = std::min(numPartitions, MAX_NET_PER_SNN - CPU_RUNTIME_BASE);
+
+	return numPartitions;
+}
+
+// checks that a table or array of size bytes at the byte offset offset lies within the network image
+static bool isImageRangeValid(uint64_t offset, uint64_t size, uint64_t imageSize) {
+	return offset <= imageSize && size <= imageSize - offset;
+}
+
+// reads the network image of loadSimFID instead of generating the connections (see partitionSNN)
+// The image is mapped into memory (POSIX) or read into a buffer, and checked against the configured and partitioned
+// network. The number of synapses of each connection and group is restored from the image, the arrays of the local
+// networks are copied from the image by loadConnectionRuntime.
+void SNN::loadSimulation_internal() {
+	assert(loadSimFID != NULL);
+	assert(loadSimImage == NULL);
+
+	// ------- map the image into memory ----------------
+
+	// the image starts at the beginning of the file
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	struct stat fileStat;
+	if (fstat(fileno(loadSimFID), &fileStat) == 0 && fileStat.st_size > 0) {
+		void* image = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(loadSimFID), 0);
+		if (image != MAP_FAILED) {
+			loadSimImage = (const char*)image;
+			loadSimImageSize = (size_t)fileStat.st_size;
+			loadSimImageMapped = true;
+		}
+	}
+#endif
+
+	// fall back to reading the image into a buffer (e.g., on Windows)
+	if (loadSimImage == NULL) {
+		long filePosition = ftell(loadSimFID);
+		fseek(loadSimFID, 0, SEEK_END);
+		long fileSize = ftell(loadSimFID);
+		fseek(loadSimFID, 0, SEEK_SET);
+		if (fileSize > 0) {
+			char* buffer = new char[fileSize];
+			if (fread(buffer, 1, fileSize, loadSimFID) == (size_t)fileSize) {
+				loadSimImage = buffer;
+				loadSimImageSize = fileSize;
+				loadSimImageMapped = false;
+			} else {
+				delete[] buffer;
+			}
+		}
+		fseek(loadSimFID, filePosition, SEEK_SET);
+	}
+
+	// ------- check the header ----------------
+
+	const NetworkImageHeader* header = (const NetworkImageHeader*)loadSimImage;
+	if (loadSimImage == NULL || loadSimImageSize < sizeof(NetworkImageHeader)
+			|| header->signature != NETWORK_IMAGE_SIGNATURE) {
+		KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
+			"simulation file created with CARLsim::saveSimulation.");
+		exitSimulation(-1);
+	}
+
+	if (header->version != NETWORK_IMAGE_VERSION || header->headerSize != sizeof(NetworkImageHeader)) {
+		KERNEL_ERROR("loadSimulation: Unsupported version number (%f)", header->version);
+		exitSimulation(-1);
+	}
+
+	if (header->fileSize != loadSimImageSize) {
+		KERNEL_ERROR("loadSimulation: Size of file (%llu bytes) does not match the size of the image (%llu bytes)",
+			(unsigned long long)loadSimImageSize, (unsigned long long)header->fileSize);
+		exitSimulation(-1);
+	}
+
+	if (!header->hasSynapseInfo) {
+		KERNEL_ERROR("loadSimulation: The file does not contain any synapses. CARLsim::saveSimulation must have been "
+			"called with saveSynapseInfo set to true.");
+		exitSimulation(-1);
+	}
+
+	if (header->numN != glbNetworkConfig.numN) {
+		KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
+			header->numN, glbNetworkConfig.numN);
+		exitSimulation(-1);
+	}
+
+	if (header->numGroups != numGroups) {
+		KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
+			header->numGroups, numGroups);
+		exitSimulation(-1);
+	}
+
+	if (header->numConnections != numConnections) {
+		KERNEL_ERROR("loadSimulation: Number of connections in file (%d) and simulation (%d) don't match.",
+			header->numConnections, numConnections);
+		exitSimulation(-1);
+	}
+
+	if (header->maxDelay != glbNetworkConfig.maxDelay) {
+		KERNEL_ERROR("loadSimulation: Maximum delay in file (%d) and simulation (%d) don't match.",
+			header->maxDelay, glbNetworkConfig.maxDelay);
+		exitSimulation(-1);
+	}
+
+	if (!isImageRangeValid(header->groupOffset, sizeof(NetworkImageGroup) * (uint64_t)header->numGroups, loadSimImageSize)
+			|| !isImageRangeValid(header->connectOffset, sizeof(NetworkImageConnection) * (uint64_t)header->numConnections, loadSimImageSize)
+			|| !isImageRangeValid(header->networkOffset, sizeof(NetworkImageNetwork) * (uint64_t)header->numNetworks, loadSimImageSize)) {
+		KERNEL_ERROR("loadSimulation: Error while reading file header");
+		exitSimulation(-1);
+	}
+
+	// ------- check the groups ----------------
+
+	const NetworkImageGroup* groups = (const NetworkImageGroup*)(loadSimImage + header->groupOffset);
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		const NetworkImageGroup& grp = groups[gGrpId];
+		if (grp.gStartN != groupConfigMDMap[gGrpId].gStartN || grp.gEndN != groupConfigMDMap[gGrpId].gEndN) {
+			KERNEL_ERROR("loadSimulation: Neurons in file (%d-%d) and simulation (%d-%d) for group %d don't match.",
+				grp.gStartN, grp.gEndN, groupConfigMDMap[gGrpId].gStartN, groupConfigMDMap[gGrpId].gEndN, gGrpId);
+			exitSimulation(-1);
+		}
+
+		if (grp.sizeX != groupConfigMap[gGrpId].grid.numX || grp.sizeY != groupConfigMap[gGrpId].grid.numY
+				|| grp.sizeZ != groupConfigMap[gGrpId].grid.numZ || grp.type != groupConfigMap[gGrpId].type) {
+			KERNEL_ERROR("loadSimulation: Grid or type in file and simulation for group %d don't match.", gGrpId);
+			exitSimulation(-1);
+		}
+
+		if (strncmp(grp.name, groupConfigMap[gGrpId].grpName.c_str(), NETWORK_IMAGE_NAME_LENGTH - 1) != 0) {
+			KERNEL_ERROR("loadSimulation: Group names in file (%.*s) and simulation (%s) don't match.",
+				NETWORK_IMAGE_NAME_LENGTH, grp.name, groupConfigMap[gGrpId].grpName.c_str());
+			exitSimulation(-1);
+		}
+
+		// the synapses of a local network refer to local neuron ids, so the partitioning must be the same
+		if (grp.netId != groupConfigMDMap[gGrpId].netId) {
+			KERNEL_ERROR("loadSimulation: Group %d is assigned to local network %d in file but to %d in simulation.",
+				gGrpId, grp.netId, groupConfigMDMap[gGrpId].netId);
+			exitSimulation(-1);
+		}
+	}
+
+	// ------- check the connections ----------------
+
+	const NetworkImageConnection* connections = (const NetworkImageConnection*)(loadSimImage + header->connectOffset);
+	for (short int connId = 0; connId < numConnections; connId++) {
+		const NetworkImageConnection& conn = connections[connId];
+		const ConnectConfig& connConfig = connectConfigMap[connId];
+		// the maximum delay of user-defined connections is only known after their generation
+		if (conn.connId != connId || conn.grpSrc != connConfig.grpSrc || conn.grpDest != connConfig.grpDest
+				|| conn.type != connConfig.type || conn.connProp != connConfig.connProp || conn.minDelay != connConfig.minDelay
+				|| (conn.maxDelay != connConfig.maxDelay && connConfig.type != CONN_USER_DEFINED)) {
+			KERNEL_ERROR("loadSimulation: Connection %d in file (%d->%d) and simulation (%d->%d) don't match.",
+				connId, conn.grpSrc, conn.grpDest, connConfig.grpSrc, connConfig.grpDest);
+			exitSimulation(-1);
+		}
+	}
+
+	// restore what the generation of the connections updates in ConnectConfig (connectConfigMap is synced in
+	// generateRuntimeConnectConfigs): numberOfConnections, and maxWt, maxDelay of user-defined connections
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		for (int i = 0; i < 2; i++) {
+			std::list<ConnectConfig>& connectList = (i == 0) ? localConnectLists[netId] : externalConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				connIt->numberOfConnections = connections[connIt->connId].numberOfConnections;
+				if (connIt->type == CONN_USER_DEFINED) {
+					connIt->maxWt = connections[connIt->connId].maxWt;
+					connIt->maxDelay = connections[connIt->connId].maxDelay;
+				}
+			}
+		}
+	}
+
+	// ------- check the local networks ----------------
+
+	int numNetworks = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty())
+			numNetworks++;
+	}
+
+	if (header->numNetworks != numNetworks) {
+		KERNEL_ERROR("loadSimulation: Number of local networks in file (%d) and simulation (%d) don't match.",
+			header->numNetworks, numNetworks);
+		exitSimulation(-1);
+	}
+
+	const NetworkImageNetwork* networks = (const NetworkImageNetwork*)(loadSimImage + header->networkOffset);
+	for (int i = 0; i < header->numNetworks; i++) {
+		const NetworkImageNetwork& net = networks[i];
+		if (net.netId < 0 || net.netId >= MAX_NET_PER_SNN || groupPartitionLists[net.netId].empty()
+				|| (size_t)net.numGroupsAssigned != groupPartitionLists[net.netId].size()
+				|| !isImageRangeValid(net.groupOffset, sizeof(NetworkImagePartition) * (uint64_t)net.numGroupsAssigned, loadSimImageSize)) {
+			KERNEL_ERROR("loadSimulation: Local network %d in file does not match the simulation.", net.netId);
+			exitSimulation(-1);
+		}
+
+		for (int array = 0; array < IMG_NUM_ARRAYS; array++) {
+			if (!isImageRangeValid(net.arrayOffset[array], net.arraySize[array], loadSimImageSize)) {
+				KERNEL_ERROR("loadSimulation: Error while reading local network %d", net.netId);
+				exitSimulation(-1);
+			}
+		}
+
+		// restore GroupConfigMD::numPostSynapses and numPreSynapses of the groups of the local network
+		const NetworkImagePartition* partition = (const NetworkImagePartition*)(loadSimImage + net.groupOffset);
+		for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[net.netId].begin(); grpIt != groupPartitionLists[net.netId].end(); grpIt++, partition++) {
+			if (partition->gGrpId != grpIt->gGrpId || partition->lGrpId != grpIt->lGrpId) {
+				KERNEL_ERROR("loadSimulation: Groups of local network %d in file and simulation don't match.", net.netId);
+				exitSimulation(-1);
+			}
+			grpIt->numPostSynapses = partition->numPostSynapses;
+			grpIt->numPreSynapses = partition->numPreSynapses;
+		}
+	}
+
+	KERNEL_INFO("Network image loaded (%s): saved at t=%.3f s, %llu bytes", loadSimImageMapped ? "memory-mapped" : "read",
+		header->simTimeSec, (unsigned long long)loadSimImageSize);
+}
+
+// returns the local network netId of the network image, or NULL if the image does not contain it
+const NetworkImageNetwork* SNN::findImageNetwork(int netId) {
+	assert(loadSimImage != NULL);
+
+	const NetworkImageHeader* header = (const NetworkImageHeader*)loadSimImage;
+	const NetworkImageNetwork* networks = (const NetworkImageNetwork*)(loadSimImage + header->networkOffset);
+	for (int i = 0; i < header->numNetworks; i++) {
+		if (networks[i].netId == netId)
+			return &networks[i];
+	}
+
+	return NULL;
+}
+
+// unmaps (or deallocates) the network image read by loadSimulation_internal
+void SNN::releaseSimImage() {
+	if (loadSimImage == NULL)
+		return;
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	if (loadSimImageMapped)
+		munmap((void*)loadSimImage, loadSimImageSize);
+	else
+		delete[] loadSimImage;
+#else
+	delete[] loadSimImage;
+#endif
+
+	loadSimImage = NULL;
+	loadSimImageSize = 0;
+	loadSimImageMapped = false;
+}
+
+// lists the state of the manager and of all runtimes that is stored in a checkpoint, see collectCheckpointArrays_CPU
+void SNN::collectCheckpointArrays(std::vector<CheckpointArray>& arrays) {
+	arrays.push_back(CheckpointArray("simTime", -1, &simTime, sizeof(int)));
+	arrays.push_back(CheckpointArray("simTimeMs", -1, &simTimeMs, sizeof(int)));
+	arrays.push_back(CheckpointArray("simTimeSec", -1, &simTimeSec, sizeof(int)));
+	arrays.push_back(CheckpointArray("wtUpdateIntervalCnt", -1, &wtANDwtChangeUpdateIntervalCnt_, sizeof(int)));
+
+	std::vector<CheckpointArray> runtimeArrays;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (!runtimeData[netId].allocated)
+			continue;
+
+		if (netId < CPU_RUNTIME_BASE) {
+			KERNEL_ERROR("Checkpoints are only supported on CPU runtimes");
+			exitSimulation(-1);
+		}
+
+		// maxSynWt is otherwise only allocated by the first setWeight, scaleWeights or biasWeights, which would change
+		// the layout of the checkpoints
+		if (!sim_with_fixedwts)
+			allocateMaxSynWt_CPU(netId);
+		collectCheckpointArrays_CPU(netId, runtimeArrays);
+	}
+
+	// skip the arrays that are not used by this network
+	for (size_t i = 0; i < runtimeArrays.size(); i++) {
+		if (runtimeArrays[i].ptr != NULL && runtimeArrays[i].size > 0)
+			arrays.push_back(runtimeArrays[i]);
+	}
+}
+
+// copies the current state into the staging buffer of the checkpoint writer, which writes it in the background
+void SNN::saveCheckpoint() {
+	assert(checkpointWriter_ != NULL);
+
+	// the arrays are listed for every checkpoint, because a runtime may have replaced an array since the last one
+	std::vector<CheckpointArray> arrays;
+	collectCheckpointArrays(arrays);
+	if (checkpointWriter_->getArrays().empty()) {
+		// the layout is defined by the first checkpoint
+		for (size_t i = 0; i < arrays.size(); i++)
+			checkpointWriter_->addArray(arrays[i].name, arrays[i].netId, arrays[i].size);
+	}
+
+	// waits for the previous checkpoint
+	if (!checkpointWriter_->beginCheckpoint()) {
+		KERNEL_ERROR("Checkpoint could not be written, check the checkpoint directory");
+		exitSimulation(-1);
+	}
+
+	const std::vector<CheckpointArrayInfo>& infos = checkpointWriter_->getArrays();
+	assert(infos.size() == arrays.size());
+	for (size_t i = 0; i < arrays.size(); i++) {
+		assert(!strncmp(infos[i].name, arrays[i].name, CHECKPOINT_NAME_LENGTH) && infos[i].size == arrays[i].size);
+		checkpointWriter_->setArray(i, arrays[i].ptr);
+	}
+
+	checkpointWriter_->commitCheckpoint(simTime);
+	KERNEL_DEBUG("Checkpoint at t=%d ms committed", simTime);
+}
+
+// blocks until the background thread has written the spike, neuron state and group status files
+void SNN::syncMonitorFiles() {
+	if (!monitorFileWriter_->sync()) {
+		KERNEL_ERROR("Could not write the spike, neuron state or group status files");
+		exitSimulation(1);
+	}
 }
 
 void SNN::generateRuntimeSNN() {
@@ -5480,7 +6157,10 @@ void SNN::generateRuntimeSNN() {
 			// - init mulSynFast, mulSynSlow
 			// - init Npre, Npre_plastic, Npost, cumulativePre, cumulativePost, preSynapticIds, postSynapticIds, postDelayInfo
 			// - init wt, maxSynWt
-			generateConnectionRuntime(netId);
+			if (loadSimImage != NULL)
+				loadConnectionRuntime(netId); // also restores voltage, recovery
+			else
+				generateConnectionRuntime(netId);
 
 			generateCompConnectionRuntime(netId);
 
@@ -5497,15 +6177,26 @@ void SNN::generateRuntimeSNN() {
 		}
 	}
 
+	// the network image is not needed once the runtimes are allocated
+	releaseSimImage();
+
 	// count allocated CPU/GPU runtime
-	numGPUs = 0; numCores = 0;
+	numGPUs = 0; numCores = 0; numCPUThreads = 0;
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (netId < CPU_RUNTIME_BASE && runtimeData[netId].allocated)
 			numGPUs++;
-		if (netId >= CPU_RUNTIME_BASE && runtimeData[netId].allocated)
+		if (netId >= CPU_RUNTIME_BASE && runtimeData[netId].allocated) {
 			numCores++;
+			numCPUThreads += networkConfigs[netId].numThreads;
+		}
 	}
 
+	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		// measure the load of the CPU runtimes from now on (see printPartitionLoad)
+		if (threadPool != NULL)
+			threadPool->resetBusyTime();
+	#endif
+
 	// 5. declare the spiking neural network is excutable
 	snnState = EXECUTABLE_SNN;
 }
@@ -5869,9 +6560,7 @@ void SNN::resetSpikeCnt(int gGrpId) {
 
 	if (gGrpId == ALL) {
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
+			ThreadStruct argsThreadRoutine[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
 			int threadCount = 0;
 		#endif
 		
@@ -5883,12 +6572,6 @@ void SNN::resetSpikeCnt(int gGrpId) {
 					#if defined(WIN32) || defined(WIN64)
 						resetSpikeCnt_CPU(netId, ALL);
 					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
 						argsThreadRoutine[threadCount].snn_pointer = this;
 						argsThreadRoutine[threadCount].netId = netId;
 						argsThreadRoutine[threadCount].lGrpId = ALL;
@@ -5896,8 +6579,7 @@ void SNN::resetSpikeCnt(int gGrpId) {
 						argsThreadRoutine[threadCount].endIdx = 0;
 						argsThreadRoutine[threadCount].GtoLOffset = 0;
 
-						pthread_create(&threads[threadCount], &attr, &SNN::helperResetSpikeCnt_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
+						threadPool->dispatch(netId - CPU_RUNTIME_BASE, &SNN::helperResetSpikeCnt_CPU, (void*)&argsThreadRoutine[threadCount]);
 						threadCount++;
 					#endif
 				}
@@ -5905,10 +6587,9 @@ void SNN::resetSpikeCnt(int gGrpId) {
 		}
 
 		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
+			// wait for all the workers
+			if (threadCount > 0)
+				threadPool->barrier();
 		#endif
 	} 
 	else {
@@ -6042,17 +6723,24 @@ void SNN::updateConnectionMonitor(short int connId) {
 			int timeInterval = connMonCoreList[monId]->getUpdateTimeIntervalSec();
 			if (timeInterval==1 || timeInterval>1 && (getSimTime()%timeInterval)==0) {
 				// this ConnectionMonitor wants periodic recording
-				connMonCoreList[monId]->writeConnectFileSnapshot(simTime,
-					getWeightMatrix2D(connMonCoreList[monId]->getConnectId()));
+				SparseWeightMatrix wts;
+				getWeightMatrixSparse(connMonCoreList[monId]->getConnectId(), wts);
+				connMonCoreList[monId]->writeConnectFileSnapshot(simTime, wts);
 			}
 		}
 	}
 }
 
-// FIXME: modify this for multi-GPUs
+// returns a dense weight matrix (pre x post), non-existent synapses are NAN
 std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
+	SparseWeightMatrix wtConnId;
+	getWeightMatrixSparse(connId, wtConnId);
+	return wtConnId.toDense();
+}
+
+// FIXME: modify this for multi-GPUs
+void SNN::getWeightMatrixSparse(short int connId, SparseWeightMatrix& wtConnId) {
 	assert(connId > ALL); // ALL == -1
-	std::vector< std::vector<float> > wtConnId;
 
 	int grpIdPre = connectConfigMap[connId].grpSrc;
 	int grpIdPost = connectConfigMap[connId].grpDest;
@@ -6060,15 +6748,6 @@ std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 	int netIdPost = groupConfigMDMap[grpIdPost].netId;
 	int lGrpIdPost = groupConfigMDMap[grpIdPost].lGrpId;
 
-	// init weight matrix with right dimensions
-	for (int i = 0; i < groupConfigMap[grpIdPre].numN; i++) {
-		std::vector<float> wtSlice;
-		for (int j = 0; j < groupConfigMap[grpIdPost].numN; j++) {
-			wtSlice.push_back(NAN);
-		}
-		wtConnId.push_back(wtSlice);
-	}
-
 	// copy the weights for a given post-group from device
 	// \TODO: check if the weights for this grpIdPost have already been copied
 	// \TODO: even better, but tricky because of ordering, make copyWeightState connection-based
@@ -6079,22 +6758,46 @@ std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 	fetchWeightState(netIdPost, lGrpIdPost);
 	fetchConnIdsLookupArray(netIdPost);
 
-	for (int lNIdPost = groupConfigs[netIdPost][lGrpIdPost].lStartN; lNIdPost <= groupConfigs[netIdPost][lGrpIdPost].lEndN; lNIdPost++) {
-		unsigned int pos_ij = managerRuntimeData.cumulativePre[lNIdPost];
-		for (int i = 0; i < managerRuntimeData.Npre[lNIdPost]; i++, pos_ij++) {
-			// skip synapses that belong to a different connection ID
-			if (managerRuntimeData.connIdsPreIdx[pos_ij] != connId) //connInfo->connId)
-				continue;
+	// the synapses are stored by post-synaptic neuron, so rows (pre-synaptic neurons) are filled in two passes:
+	// first count the synapses of every pre-synaptic neuron, then place them in the order of the post-synaptic neurons
+	wtConnId.numPre = groupConfigMap[grpIdPre].numN;
+	wtConnId.numPost = groupConfigMap[grpIdPost].numN;
+	wtConnId.rowPtr.assign(wtConnId.numPre + 1, 0);
+
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			// rowPtr[i+1] is the fill position of row i, which becomes the start of row i+1 once the row is filled
+			for (int i = 0; i < wtConnId.numPre; i++)
+				wtConnId.rowPtr[i + 1] += wtConnId.rowPtr[i];
+			wtConnId.postIds.resize(wtConnId.rowPtr[wtConnId.numPre]);
+			wtConnId.weights.resize(wtConnId.rowPtr[wtConnId.numPre]);
+			for (int i = wtConnId.numPre; i > 0; i--)
+				wtConnId.rowPtr[i] = wtConnId.rowPtr[i - 1];
+			wtConnId.rowPtr[0] = 0;
+		}
 
-			// find pre-neuron ID and update ConnectionMonitor container
-			int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos_ij]);
-			int lGrpIdPre = GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos_ij]);
-			wtConnId[lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN][lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN] =
-				fabs(managerRuntimeData.wt[pos_ij]);
+		for (int lNIdPost = groupConfigs[netIdPost][lGrpIdPost].lStartN; lNIdPost <= groupConfigs[netIdPost][lGrpIdPost].lEndN; lNIdPost++) {
+			unsigned int pos_ij = managerRuntimeData.cumulativePre[lNIdPost];
+			for (int i = 0; i < managerRuntimeData.Npre[lNIdPost]; i++, pos_ij++) {
+				// skip synapses that belong to a different connection ID
+				if (managerRuntimeData.connIdsPreIdx[pos_ij] != connId) //connInfo->connId)
+					continue;
+
+				// find pre-neuron ID and count or store the synapse
+				int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos_ij]);
+				int lGrpIdPre = GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos_ij]);
+				int row = lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN;
+				if (pass == 0) {
+					wtConnId.rowPtr[row + 1]++;
+				} else {
+					int pos = wtConnId.rowPtr[row + 1]++;
+					wtConnId.postIds[pos] = lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN;
+					wtConnId.weights[pos] = fabs(managerRuntimeData.wt[pos_ij]);
+				}
+			}
 		}
 	}
-
-	return wtConnId;
+	assert(wtConnId.rowPtr[wtConnId.numPre] == (int)wtConnId.postIds.size());
 }
 
 void SNN::updateGroupMonitor(int gGrpId) {
@@ -6173,7 +6876,7 @@ void SNN::updateGroupMonitor(int gGrpId) {
 		}
 
 		if (grpFileId!=NULL) // flush group status file
-			fflush(grpFileId);
+			monitorFileWriter_->flush(grpFileId);
 	}
 }
 
@@ -6333,7 +7036,7 @@ void SNN::updateSpikeMonitor(int gGrpId) {
                 && spkMonObj->isBufferBig()){
             // change this warning message to correct message
             KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%lu MB)",gGrpId,(long int) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
-            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(gGrpId));
+            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d), or use SpikeMonitor::setMode(COUNT) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(gGrpId));
 		}
 
 		// copy the neuron firing information to the manager runtime
@@ -6362,7 +7065,11 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 		// prepare fast access
 		FILE* spkFileId = spikeMonCoreList[monitorId]->getSpikeFileId();
 		bool writeSpikesToFile = spkFileId != NULL;
-		bool writeSpikesToArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
+		bool writeSpikesToArray = spkMonObj->isRecording(); // spike times (AER mode) and/or on-line statistics
+
+		// spikes of a compact spike file are sorted and encoded once all of them have been collected
+		bool writeCompactFile = writeSpikesToFile && spkMonObj->isCompactFile();
+		std::vector<int> compactAER;
 
 		// Read one spike at a time from the buffer and put the spikes to an appopriate monitor buffer. Later the user
 		// may need need to dump these spikes to an output file
@@ -6370,7 +7077,7 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 			unsigned int* timeTablePtr = (k == 0) ? managerRuntimeData.timeTableD2 : managerRuntimeData.timeTableD1;
 			int* fireTablePtr = (k == 0) ? managerRuntimeData.firingTableD2 : managerRuntimeData.firingTableD1;
 			for(int t = numMsMin; t < numMsMax; t++) {
-				for(int i = timeTablePtr[t + glbNetworkConfig.maxDelay]; i < timeTablePtr[t + glbNetworkConfig.maxDelay + 1]; i++) {
+				for(unsigned int i = timeTablePtr[t + glbNetworkConfig.maxDelay]; i < timeTablePtr[t + glbNetworkConfig.maxDelay + 1]; i++) {
 					// retrieve the neuron id
 					int lNId = fireTablePtr[i];
 
@@ -6388,10 +7095,13 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 					// current time is last completed second plus whatever is leftover in t
 					int time = currentTimeSec * 1000 + t;
 
-					if (writeSpikesToFile) {
-						int cnt;
-						cnt = fwrite(&time, sizeof(int), 1, spkFileId); assert(cnt==1);
-						cnt = fwrite(&nId,  sizeof(int), 1, spkFileId); assert(cnt==1);
+					if (writeCompactFile) {
+						compactAER.push_back(time);
+						compactAER.push_back(nId);
+					} else if (writeSpikesToFile) {
+						// written by the background thread, see syncMonitorFiles
+						int aer[2] = {time, nId};
+						monitorFileWriter_->write(spkFileId, aer, sizeof(aer));
 					}
 
 					if (writeSpikesToArray) {
@@ -6401,8 +7111,14 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 			}
 		}
 
+		if (writeCompactFile && !compactAER.empty()) {
+			std::vector<char> blocks;
+			spkMonObj->encodeCompactSpikes(compactAER, blocks);
+			monitorFileWriter_->write(spkFileId, &blocks[0], blocks.size());
+		}
+
 		if (spkFileId!=NULL) // flush spike file
-			fflush(spkFileId);
+			monitorFileWriter_->flush(spkFileId);
 	}
 }
 
@@ -6510,12 +7226,14 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 
 				// WRITE TO A TEXT FILE INSTEAD OF BINARY
 				if (writeNeuronStateToFile) {
-					int cnt;
-					cnt = fwrite(&nId, sizeof(int), 1, nrnFileId); assert(cnt == 1);
-					cnt = fwrite(&time, sizeof(int), 1, nrnFileId); assert(cnt == 1);
-					cnt = fwrite(&v, sizeof(float), 1, nrnFileId); assert(cnt == 1);
-					cnt = fwrite(&u, sizeof(float), 1, nrnFileId); assert(cnt == 1);
-					cnt = fwrite(&I, sizeof(float), 1, nrnFileId); assert(cnt == 1);
+					// written by the background thread, see syncMonitorFiles
+					char record[2*sizeof(int) + 3*sizeof(float)];
+					memcpy(record, &nId, sizeof(int));
+					memcpy(record + sizeof(int), &time, sizeof(int));
+					memcpy(record + 2*sizeof(int), &v, sizeof(float));
+					memcpy(record + 2*sizeof(int) + sizeof(float), &u, sizeof(float));
+					memcpy(record + 2*sizeof(int) + 2*sizeof(float), &I, sizeof(float));
+					monitorFileWriter_->write(nrnFileId, record, sizeof(record));
 				}
 
 				if (writeNeuronStateToArray) {
@@ -6525,7 +7243,7 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 		}
 
 		if (nrnFileId != NULL) // flush spike file
-			fflush(nrnFileId);
+			monitorFileWriter_->flush(nrnFileId);
 	}
 }
 
@@ -6561,9 +7279,46 @@ void SNN::printSimSummary() {
 	KERNEL_INFO("Overall Spike Count:\t2+ms delay = %d", managerRuntimeData.spikeCountD2);
 	KERNEL_INFO("\t\t\t1ms delay = %d", managerRuntimeData.spikeCountD1);
 	KERNEL_INFO("\t\t\tTotal = %d", managerRuntimeData.spikeCount);
+	printPartitionLoad();
 	KERNEL_INFO("*********************************************************************************\n");
 }
 
+void SNN::printPartitionLoad() {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	if (threadPool == NULL || numCores == 0 || simTime == 0)
+		return;
+
+	// the CPU time of a runtime is the sum of the busy times of its worker threads
+	double measuredLoad[MAX_NET_PER_SNN] = {0.0};
+	double totalMeasuredLoad = 0.0;
+	float totalPredictedLoad = 0.0f;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (runtimeData[netId].allocated) {
+			for (int threadId = 0; threadId < networkConfigs[netId].numThreads; threadId++)
+				measuredLoad[netId] += threadPool->getBusyTime(getWorkerId(netId, threadId));
+			totalMeasuredLoad += measuredLoad[netId];
+			totalPredictedLoad += predictedLoad[netId];
+		}
+	}
+
+	if (totalMeasuredLoad <= 0.0 || totalPredictedLoad <= 0.0f)
+		return;
+
+	// predicted step times are obtained by scaling the estimated costs to the total measured CPU time
+	KERNEL_INFO("Partition Load:\t\tpredicted vs. measured CPU time per step");
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (runtimeData[netId].allocated) {
+			float predictedShare = predictedLoad[netId] / totalPredictedLoad;
+			double measuredShare = measuredLoad[netId] / totalMeasuredLoad;
+			KERNEL_INFO("\t\t\tCPU %d: numN = %d, numSyn = %d, predicted = %.3f ms (%4.1f%%), measured = %.3f ms (%4.1f%%)",
+				netId - CPU_RUNTIME_BASE, networkConfigs[netId].numN, networkConfigs[netId].numPreSynNet,
+				predictedShare * totalMeasuredLoad / simTime, 100.0 * predictedShare,
+				measuredLoad[netId] / simTime, 100.0 * measuredShare);
+		}
+	}
+#endif
+}
+
 //------------------------------ legacy code --------------------------------//
 
 // We parallelly cleanup the postSynapticIds array to minimize any other wastage in that array by compacting the store
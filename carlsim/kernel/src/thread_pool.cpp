@@ -0,0 +1,256 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <thread_pool.h>
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+
+class ThreadPool::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl() : _numPending(0), _numWorkers(0), _shutdown(false) {
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_allDone, NULL);
+	}
+
+	~Impl() {
+		// let the workers drain their queues, then wake them up for good
+		barrier();
+
+		pthread_mutex_lock(&_mutex);
+		_shutdown = true;
+		for (size_t i = 0; i < _workers.size(); i++) {
+			if (_workers[i] != NULL)
+				pthread_cond_signal(&_workers[i]->wakeUp);
+		}
+		pthread_mutex_unlock(&_mutex);
+
+		for (size_t i = 0; i < _workers.size(); i++) {
+			if (_workers[i] != NULL) {
+				pthread_join(_workers[i]->thread, NULL);
+				pthread_cond_destroy(&_workers[i]->wakeUp);
+				delete _workers[i];
+			}
+		}
+
+		pthread_cond_destroy(&_allDone);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	void startWorker(int workerId, int cpuId) {
+		assert(workerId >= 0);
+		assert(!hasWorker(workerId));
+
+		if (workerId >= (int)_workers.size())
+			_workers.resize(workerId + 1, NULL);
+
+		Worker* w = new Worker;
+		w->pool = this;
+		w->busyTimeMs = 0.0;
+		pthread_cond_init(&w->wakeUp, NULL);
+		_workers[workerId] = w;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if (cpuId >= 0) {
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(cpuId, &cpus);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+		}
+
+		if (pthread_create(&w->thread, &attr, &Impl::workerRoutine, (void*)w) != 0) {
+			fprintf(stderr, "ThreadPool: could not create worker thread %d\n", workerId);
+			exit(EXIT_FAILURE);
+		}
+		pthread_attr_destroy(&attr);
+
+		_numWorkers++;
+	}
+
+	bool hasWorker(int workerId) {
+		return workerId >= 0 && workerId < (int)_workers.size() && _workers[workerId] != NULL;
+	}
+
+	int getNumWorkers() {
+		return _numWorkers;
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	void dispatch(int workerId, TaskRoutine routine, void* args) {
+		assert(hasWorker(workerId));
+
+		Task t;
+		t.routine = routine;
+		t.args = args;
+
+		pthread_mutex_lock(&_mutex);
+		_workers[workerId]->tasks.push_back(t);
+		_numPending++;
+		pthread_cond_signal(&_workers[workerId]->wakeUp);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	void barrier() {
+		pthread_mutex_lock(&_mutex);
+		while (_numPending > 0)
+			pthread_cond_wait(&_allDone, &_mutex);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	double getBusyTime(int workerId) {
+		if (!hasWorker(workerId))
+			return 0.0;
+
+		pthread_mutex_lock(&_mutex);
+		double busyTimeMs = _workers[workerId]->busyTimeMs;
+		pthread_mutex_unlock(&_mutex);
+
+		return busyTimeMs;
+	}
+
+	void resetBusyTime() {
+		pthread_mutex_lock(&_mutex);
+		for (size_t i = 0; i < _workers.size(); i++) {
+			if (_workers[i] != NULL)
+				_workers[i]->busyTimeMs = 0.0;
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+private:
+	struct Task {
+		TaskRoutine routine;
+		void* args;
+	};
+
+	struct Worker {
+		Impl* pool;
+		pthread_t thread;
+		pthread_cond_t wakeUp; //!< signaled when a task is queued or the pool shuts down
+		std::deque<Task> tasks;
+		double busyTimeMs; //!< accumulated execution time of all tasks (protected by the pool mutex)
+	};
+
+	static double getTimeMs() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+	}
+
+	// main loop of a worker: sleep until there is work, run it, report back
+	static void* workerRoutine(void* arguments) {
+		Worker* w = (Worker*)arguments;
+		Impl* pool = w->pool;
+
+		pthread_mutex_lock(&pool->_mutex);
+		while (true) {
+			while (w->tasks.empty() && !pool->_shutdown)
+				pthread_cond_wait(&w->wakeUp, &pool->_mutex);
+
+			if (w->tasks.empty()) // shutdown and nothing left to do
+				break;
+
+			Task t = w->tasks.front();
+			w->tasks.pop_front();
+
+			pthread_mutex_unlock(&pool->_mutex);
+			double startTimeMs = getTimeMs();
+			t.routine(t.args);
+			double elapsedTimeMs = getTimeMs() - startTimeMs;
+			pthread_mutex_lock(&pool->_mutex);
+
+			w->busyTimeMs += elapsedTimeMs;
+
+			if (--pool->_numPending == 0)
+				pthread_cond_broadcast(&pool->_allDone);
+		}
+		pthread_mutex_unlock(&pool->_mutex);
+
+		return NULL;
+	}
+
+	pthread_mutex_t _mutex;   //!< protects the task queues and the pending counter
+	pthread_cond_t _allDone;  //!< signaled when the pending counter drops to zero
+	std::vector<Worker*> _workers; //!< workers indexed by their slot, NULL if slot is unused
+	int _numPending;          //!< number of dispatched tasks that have not completed yet
+	int _numWorkers;
+	bool _shutdown;
+};
+
+
+// ****************************************************************************************************************** //
+// THREADPOOL API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+// constructor / destructor
+ThreadPool::ThreadPool() : _impl( new Impl() ) {}
+ThreadPool::~ThreadPool() { delete _impl; }
+
+// public methods
+void ThreadPool::startWorker(int workerId, int cpuId) { _impl->startWorker(workerId, cpuId); }
+bool ThreadPool::hasWorker(int workerId) { return _impl->hasWorker(workerId); }
+int ThreadPool::getNumWorkers() { return _impl->getNumWorkers(); }
+void ThreadPool::dispatch(int workerId, TaskRoutine routine, void* args) { _impl->dispatch(workerId, routine, args); }
+void ThreadPool::barrier() { _impl->barrier(); }
+double ThreadPool::getBusyTime(int workerId) { return _impl->getBusyTime(workerId); }
+void ThreadPool::resetBusyTime() { _impl->resetBusyTime(); }
+
+#endif
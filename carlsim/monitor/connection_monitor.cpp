@@ -50,6 +50,18 @@
 
 #include <user_errors.h>				// fancy user error messages
 #include <sstream>						// std::stringstream
+#include <math.h>						// NAN
+
+
+std::vector< std::vector<float> > SparseWeightMatrix::toDense() const {
+	std::vector< std::vector<float> > wt(numPre, std::vector<float>(numPost, NAN));
+	for (int i = 0; i < numPre; i++) {
+		for (int pos = rowPtr[i]; pos < rowPtr[i + 1]; pos++) {
+			wt[i][postIds[pos]] = weights[pos];
+		}
+	}
+	return wt;
+}
 
 
 ConnectionMonitor::ConnectionMonitor(ConnectionMonitorCore* connMonCorePtr){
@@ -67,6 +79,10 @@ std::vector< std::vector<float> > ConnectionMonitor::calcWeightChanges() {
 	return connMonCorePtr_->calcWeightChanges();
 }
 
+SparseWeightMatrix ConnectionMonitor::calcWeightChangesSparse() {
+	return connMonCorePtr_->calcWeightChangesSparse();
+}
+
 short int ConnectionMonitor::getConnectId() {
 	return connMonCorePtr_->getConnectId();
 }
@@ -163,6 +179,15 @@ void ConnectionMonitor::printSparse(int neurPostId, int maxConn, int connPerLine
 	connMonCorePtr_->printSparse(neurPostId,maxConn,connPerLine);
 }
 
+void ConnectionMonitor::setDeltaSnapshots(int keyframeInterval, double minAbsChange) {
+	std::string funcName = "setDeltaSnapshots()";
+	UserErrors::assertTrue(keyframeInterval>=1, UserErrors::MUST_BE_POSITIVE, funcName, "keyframeInterval");
+	UserErrors::assertTrue(minAbsChange>=0.0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "minAbsChange");
+	UserErrors::assertTrue(!connMonCorePtr_->hasWrittenSnapshot(), UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+		funcName, "SETUP_STATE (before the first snapshot is written to file).");
+	connMonCorePtr_->setDeltaSnapshots(keyframeInterval, minAbsChange);
+}
+
 void ConnectionMonitor::setUpdateTimeIntervalSec(int intervalSec) {
 	std::string funcName = "setUpdateTimeIntervalSec()";
 	UserErrors::assertTrue(intervalSec==-1 || intervalSec>=1, UserErrors::MUST_BE_SET_TO, funcName, "intervalSec",
@@ -172,4 +197,8 @@ void ConnectionMonitor::setUpdateTimeIntervalSec(int intervalSec) {
 
 std::vector< std::vector<float> > ConnectionMonitor::takeSnapshot() {
 	return connMonCorePtr_->takeSnapshot();
-}
\ No newline at end of file
+}
+
+SparseWeightMatrix ConnectionMonitor::takeSnapshotSparse() {
+	return connMonCorePtr_->takeSnapshotSparse();
+}
@@ -50,10 +50,52 @@
 #define _CONN_MON_H_
 
 #include <vector>					// std::vector
+#include <algorithm>				// std::swap
 #include <carlsim_definitions.h>	// ALL
 
 class ConnectionMonitorCore; // forward declaration of implementation
 
+/*!
+ * \brief A snapshot of the weights of a connection in compressed sparse row (CSR) format
+ *
+ * Only existing synapses are stored. The synapses of pre-synaptic neuron i are stored at positions
+ * rowPtr[i], ..., rowPtr[i+1]-1 of postIds and weights, in the order of their post-synaptic neuron IDs.
+ * Neuron IDs are relative to the group (0, ..., numPre-1 and 0, ..., numPost-1).
+ *
+ * Two snapshots of the same connection have the same structure (rowPtr and postIds), so that the weights of two
+ * snapshots can be compared element-wise.
+ * \since v4.0
+ */
+struct SparseWeightMatrix {
+	SparseWeightMatrix() : numPre(0), numPost(0) {}
+
+	//! returns the number of (existing) synapses
+	int getNumSynapses() const { return (int)weights.size(); }
+
+	/*!
+	 * \brief converts the snapshot to a dense 2D matrix (pre x post)
+	 *
+	 * Synapses that do not exist are marked as float value NAN.
+	 * \note The dense matrix has numPre x numPost elements, which might not fit in memory for large groups.
+	 */
+	std::vector< std::vector<float> > toDense() const;
+
+	//! exchanges the contents of two snapshots (without copying them)
+	void swap(SparseWeightMatrix& other) {
+		std::swap(numPre, other.numPre);
+		std::swap(numPost, other.numPost);
+		rowPtr.swap(other.rowPtr);
+		postIds.swap(other.postIds);
+		weights.swap(other.weights);
+	}
+
+	int numPre;                 //!< number of neurons in the pre-synaptic group (number of rows)
+	int numPost;                //!< number of neurons in the post-synaptic group (number of columns)
+	std::vector<int> rowPtr;    //!< start of the synapses of every pre-synaptic neuron (numPre+1 entries)
+	std::vector<int> postIds;   //!< post-synaptic neuron ID of every synapse
+	std::vector<float> weights; //!< weight of every synapse
+};
+
 /*!
  * \brief Class ConnectionMonitor
  *
@@ -85,6 +127,9 @@ class ConnectionMonitorCore; // forward declaration of implementation
  *
  * Weights can also be visualized in C++ using ConnectionMonitor::print and ConnectionMonitor::printSparse.
  *
+ * Internally, only existing synapses are stored. For connections between large groups, whose dense weight matrix
+ * would not fit in memory, use ConnectionMonitor::takeSnapshotSparse and ConnectionMonitor::calcWeightChangesSparse.
+ *
  * Example to store weights in binary every second:
  * \code
  * // configure a network, etc. ...
@@ -185,6 +230,21 @@ class ConnectionMonitor {
 	 */
 	std::vector< std::vector<float> > calcWeightChanges();
 
+	/*!
+	 * \brief Reports the weight changes since the last snapshot in sparse format
+	 *
+	 * This function is the sparse equivalent of ConnectionMonitor::calcWeightChanges: the weight change of every
+	 * existing synapse is reported in a SparseWeightMatrix, whose memory is proportional to the number of synapses
+	 * instead of getNumNeuronsPre() x getNumNeuronsPost().
+	 *
+	 * In order to get the current state of the weight matrix, this function will take a snapshot itself, but will
+	 * not write it to file.
+	 *
+	 * \returns a SparseWeightMatrix whose weights are the signed weight changes of the synapses
+	 * \since v4.0
+	 */
+	SparseWeightMatrix calcWeightChangesSparse();
+
 	/*!
 	 * \brief Returns the connection ID that this ConnectionMonitor is managing
 	 *
@@ -470,6 +530,30 @@ class ConnectionMonitor {
 	 */
 	void printSparse(int neurPostId=ALL, int maxConn=100, int connPerLine=4);
 
+	/*!
+	 * \brief Stores the snapshots in the file as keyframes followed by deltas of the changed weights
+	 *
+	 * By default, every snapshot in the binary stores the weights of all synapses. For plastic connections where
+	 * only a few weights change between snapshots, this function reduces the size of the binary (and the time spent
+	 * writing it): every keyframeInterval-th snapshot is a keyframe that stores all weights, the snapshots in between
+	 * only store the synapses whose weight differs by more than minAbsChange from the value stored last. The weights
+	 * read back from the binary thus differ by at most minAbsChange from the actual weights. A delta in which more
+	 * than half of the weights changed is stored as a keyframe instead, so that the binary is never larger than
+	 * without deltas.
+	 * Keyframes allow to read a snapshot without reading the whole file.
+	 *
+	 * The binary can be read with ConnectionReader of the Offline Analysis Toolbox, which reconstructs every
+	 * snapshot from the last keyframe and the deltas.
+	 *
+	 * \param[in] keyframeInterval  Every keyframeInterval-th snapshot is a keyframe (1: all snapshots are keyframes).
+	 * \param[in] minAbsChange      The minimum weight change of a synapse to be stored in a delta. Default: 0 (all
+	 *                              changes are stored, the binary is lossless).
+	 * \note This function has to be called before the first snapshot is written to file (the first snapshot is
+	 * written at the beginning of the first CARLsim::runNetwork, or by ConnectionMonitor::takeSnapshot).
+	 * \since v4.0
+	 */
+	void setDeltaSnapshots(int keyframeInterval, double minAbsChange=0.0);
+
 	/*!
 	 * \brief Sets the time interval (seconds) for writing snapshots to file
 	 *
@@ -504,6 +588,19 @@ class ConnectionMonitor {
 	 */
 	std::vector< std::vector<float> > takeSnapshot();
 
+	/*!
+	 * \brief Takes a snapshot of the current weight state in sparse format
+	 *
+	 * This function is the sparse equivalent of ConnectionMonitor::takeSnapshot: it stores the snapshot in the binary
+	 * and returns the existing synapses only, so that it can be used for connections between large groups, whose
+	 * dense weight matrix would not fit in memory.
+	 *
+	 * \returns a SparseWeightMatrix with the weights of all existing synapses
+	 * \note Every snapshot taken will also be stored in the binary file.
+	 * \since v4.0
+	 */
+	SparseWeightMatrix takeSnapshotSparse();
+
 private:
 	//! This is a pointer to the actual implementation of the class. The user should never directly instantiate it.
 	ConnectionMonitorCore* connMonCorePtr_;
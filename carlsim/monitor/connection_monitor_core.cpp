@@ -73,7 +73,11 @@ ConnectionMonitorCore::ConnectionMonitorCore(SNN* snn,int monitorId,short int co
 	needToWriteFileHeader_ = true;
 	needToInit_ = true;
 	connFileSignature_ = 202029319;
-	connFileVersion_ = 0.3f;
+	connFileVersion_ = 0.4f;
+
+	keyframeInterval_ = 0;
+	deltaMinAbsChange_ = 0.0;
+	numSnapshotsSinceKeyframe_ = 0;
 
 	minWt_ = -1.0f;
 	maxWt_ = -1.0f;
@@ -103,17 +107,7 @@ void ConnectionMonitorCore::init() {
 	fpDeb_ = snn_->getLogFpDeb();
 	fpLog_ = snn_->getLogFpLog();
 
-	// init weight matrix with right dimensions
-	for (int i = 0; i < nNeurPre_; i++) {
-		std::vector<float> wt;
-		for (int j = 0; j < nNeurPost_; j++) {
-			wt.push_back(NAN);
-		}
-		wtMat_.push_back(wt);
-		wtMatLast_.push_back(wt);
-	}
-
-	// then load current weigths from SNN into weight matrix
+	// load current weigths from SNN, only existing synapses are stored
 	updateStoredWeights();
 }
 
@@ -123,7 +117,9 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 		if (connFileTimeIntervalSec_ > 0) {
 			// make sure SNN is not already deallocated!
 			assert(snn_!=NULL);
-			writeConnectFileSnapshot(snn_->getSimTime(), snn_->getWeightMatrix2D(connId_));
+			SparseWeightMatrix wts;
+			snn_->getWeightMatrixSparse(connId_, wts);
+			writeConnectFileSnapshot(snn_->getSimTime(), wts);
 		}
 
 		// then close file and clean up
@@ -138,36 +134,37 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 
 // calculate weight changes since last update (element-wise )
 std::vector< std::vector<float> > ConnectionMonitorCore::calcWeightChanges() {
+	return calcWeightChangesSparse().toDense();
+}
+
+// calculate weight changes since last update, the snapshots have the same structure
+SparseWeightMatrix ConnectionMonitorCore::calcWeightChangesSparse() {
 	updateStoredWeights();
-	std::vector< std::vector<float> > wtChange(nNeurPre_, std::vector<float>(nNeurPost_));
+	SparseWeightMatrix wtChange = wtSparse_;
 
-	// take the naive approach for now
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtChange[i][j] = wtMat_[i][j] - wtMatLast_[i][j];
-		}
+	// there is no change if there is no last snapshot
+	bool hasLastSnapshot = (wtTimeLast_ >= 0);
+	assert(!hasLastSnapshot || wtSparseLast_.getNumSynapses() == wtSparse_.getNumSynapses());
+	for (int pos = 0; pos < wtChange.getNumSynapses(); pos++) {
+		wtChange.weights[pos] = hasLastSnapshot ? wtSparse_.weights[pos] - wtSparseLast_.weights[pos] : NAN;
 	}
 
 	return wtChange;
 }
 
 
-// reset weight matrix
+// reset weight snapshots
 void ConnectionMonitorCore::clear() {
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtMat_[i][j] = NAN;
-			wtMatLast_[i][j] = NAN;
-		}
-	}
+	wtSparse_ = SparseWeightMatrix();
+	wtSparseLast_ = SparseWeightMatrix();
 }
 
 // find number of incoming synapses for a specific post neuron
 int ConnectionMonitorCore::getFanIn(int neurPostId) {
 	assert(neurPostId<nNeurPost_);
 	int nSyn = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		if (!isnan(wtMat_[i][neurPostId])) {
+	for (int pos = 0; pos < wtSparse_.getNumSynapses(); pos++) {
+		if (wtSparse_.postIds[pos] == neurPostId) {
 			nSyn++;
 		}
 	}
@@ -177,13 +174,7 @@ int ConnectionMonitorCore::getFanIn(int neurPostId) {
 // find number of outgoing synapses of a specific pre neuron
 int ConnectionMonitorCore::getFanOut(int neurPreId) {
 	assert(neurPreId<nNeurPre_);
-	int nSyn = 0;
-	for (int j=0; j<nNeurPost_; j++) {
-		if (!isnan(wtMat_[neurPreId][j])) {
-			nSyn++;
-		}
-	}
-	return nSyn;
+	return wtSparse_.rowPtr[neurPreId + 1] - wtSparse_.rowPtr[neurPreId];
 }
 
 float ConnectionMonitorCore::getMaxWeight(bool getCurrent) {
@@ -192,15 +183,9 @@ float ConnectionMonitorCore::getMaxWeight(bool getCurrent) {
 		updateStoredWeights();
 
 		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] > maxVal) {
-					maxVal = wtMat_[i][j];
-				}
+		for (int pos = 0; pos < wtSparse_.getNumSynapses(); pos++) {
+			if (wtSparse_.weights[pos] > maxVal) {
+				maxVal = wtSparse_.weights[pos];
 			}
 		}
 	} else {
@@ -217,15 +202,9 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 		updateStoredWeights();
 
 		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] < minVal) {
-					minVal = wtMat_[i][j];
-				}
+		for (int pos = 0; pos < wtSparse_.getNumSynapses(); pos++) {
+			if (wtSparse_.weights[pos] < minVal) {
+				minVal = wtSparse_.weights[pos];
 			}
 		}
 	} else {
@@ -239,18 +218,12 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 // find number of synapses whose weights changed
 int ConnectionMonitorCore::getNumWeightsChanged(double minAbsChange) {
 	assert(minAbsChange>=0.0);
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	SparseWeightMatrix wtChange = calcWeightChangesSparse();
 
 	int nChanged = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-
-			if (fabs(wtChange[i][j]) >= minAbsChange) {
-				nChanged++;
-			}
+	for (int pos = 0; pos < wtChange.getNumSynapses(); pos++) {
+		if (fabs(wtChange.weights[pos]) >= minAbsChange) {
+			nChanged++;
 		}
 	}
 	return nChanged;
@@ -268,15 +241,9 @@ int ConnectionMonitorCore::getNumWeightsInRange(double minVal, double maxVal) {
 	}
 
 	int cnt = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-
-			if (wtMat_[i][j]>=minVal && wtMat_[i][j]<=maxVal) {
-				cnt++;
-			}
+	for (int pos = 0; pos < wtSparse_.getNumSynapses(); pos++) {
+		if (wtSparse_.weights[pos]>=minVal && wtSparse_.weights[pos]<=maxVal) {
+			cnt++;
 		}
 	}
 
@@ -295,21 +262,17 @@ int ConnectionMonitorCore::getNumWeightsWithValue(double value) {
 
 // calculate total absolute amount of weight change
 double ConnectionMonitorCore::getTotalAbsWeightChange() {
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	SparseWeightMatrix wtChange = calcWeightChangesSparse();
 	double wtTotalChange = 0.0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-			wtTotalChange += fabs(wtChange[i][j]);
-		}
+	for (int pos = 0; pos < wtChange.getNumSynapses(); pos++) {
+		wtTotalChange += fabs(wtChange.weights[pos]);
 	}
 	return wtTotalChange;
 }
 
 void ConnectionMonitorCore::print() {
 	updateStoredWeights();
+	std::vector< std::vector<float> > wtMat = wtSparse_.toDense();
 
 	KERNEL_INFO("(t=%.3fs) ConnectionMonitor ID=%d: %d(%s) => %d(%s)",
 		(getTimeMsCurrentSnapshot()/1000.0f), connId_,
@@ -331,8 +294,8 @@ void ConnectionMonitorCore::print() {
 		std::stringstream line;
 		line << std::setw(9) << std::setfill(' ') << i << " |";
 		for (int j=0; j<nNeurPost_; j++) {
-			line << std::fixed << std::setprecision(4) << (isnan(wtMat_[i][j])?"      ":(wtMat_[i][j]>=0?"   ":"  "))
-				<< wtMat_[i][j]  << "  ";
+			line << std::fixed << std::setprecision(4) << (isnan(wtMat[i][j])?"      ":(wtMat[i][j]>=0?"   ":"  "))
+				<< wtMat[i][j]  << "  ";
 		}
 		KERNEL_INFO("%s",line.str().c_str());
 	}
@@ -344,14 +307,13 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 	assert(connPerLine>0);
 
 	// give the option of not storing the new snapshot
-	std::vector< std::vector<float> > wtNew, wtOld;
-	long int timeNew, timeOld;
+	SparseWeightMatrix wtNew, wtOld;
+	long int timeNew = wtTime_;
+	long int timeOld = wtTimeLast_;
 	if (!storeNewSnapshot) {
 		// make a copy of current snapshots so that we can restore them later
-		wtNew = wtMat_;
-		wtOld = wtMatLast_;
-		timeNew = wtTime_;
-		timeOld = wtTimeLast_;
+		wtNew = wtSparse_;
+		wtOld = wtSparseLast_;
 	}
 
 	updateStoredWeights();
@@ -369,26 +331,27 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		postZ = neurPostId;
 	}
 
-	std::vector< std::vector<float> > wtChange;
+	SparseWeightMatrix wtChange;
 	if (isPlastic_) {
-		wtChange = calcWeightChanges();
+		wtChange = calcWeightChangesSparse();
 	}
 
 	std::stringstream line;
 	int nConn = 0;
 	int maxIntDigits = ceil(log10((double)std::max(nNeurPre_,nNeurPost_)));
 	for (int i=0; i<nNeurPre_; i++) {
-		for (int j = postA; j <= postZ; j++) {
+		for (int pos = wtSparse_.rowPtr[i]; pos < wtSparse_.rowPtr[i + 1]; pos++) {
 			// display only so many connections
 			if (nConn>=maxConn)
 				break;
 
-			if (!isnan(wtMat_[i][j])) {
+			int j = wtSparse_.postIds[pos];
+			if (j >= postA && j <= postZ) {
 				line << "[" << std::setw(maxIntDigits) << i << "," << std::setw(maxIntDigits) << j << "] "
-					<< std::fixed << std::setprecision(4) << wtMat_[i][j];
+					<< std::fixed << std::setprecision(4) << wtSparse_.weights[pos];
 				if (isPlastic_) {
-					line << " (" << ((wtChange[i][j]<0)?"":"+");
-					line << std::setprecision(4) << wtChange[i][j] << ")";
+					line << " (" << ((wtChange.weights[pos]<0)?"":"+");
+					line << std::setprecision(4) << wtChange.weights[pos] << ")";
 				}
 				line << "   ";
 				if (!(++nConn % connPerLine)) {
@@ -403,8 +366,8 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		KERNEL_INFO("%s",line.str().c_str());
 
 	if (!storeNewSnapshot) {
-		wtMat_ = wtNew;
-		wtMatLast_ = wtOld;
+		wtSparse_.swap(wtNew);
+		wtSparseLast_.swap(wtOld);
 		wtTime_ = timeNew;
 		wtTimeLast_ = timeOld;
 	}
@@ -428,6 +391,23 @@ void ConnectionMonitorCore::setConnectFileId(FILE* connFileId) {
 	}
 }
 
+void ConnectionMonitorCore::setDeltaSnapshots(int keyframeInterval, double minAbsChange) {
+	assert(keyframeInterval>=1);
+	assert(minAbsChange>=0.0);
+	assert(!hasWrittenSnapshot());
+
+	keyframeInterval_ = keyframeInterval;
+	deltaMinAbsChange_ = minAbsChange;
+	connFileVersion_ = 0.5f;
+
+	// the header announces the encoding of the snapshots, so rewrite it (no snapshot has been written yet)
+	if (connFileId_!=NULL) {
+		fseek(connFileId_, 0, SEEK_SET);
+		needToWriteFileHeader_ = true;
+		writeConnectFileHeader();
+	}
+}
+
 void ConnectionMonitorCore::setUpdateTimeIntervalSec(int intervalSec) {
 	assert(intervalSec==-1 || intervalSec>=1);
 	connFileTimeIntervalSec_ = intervalSec;
@@ -436,20 +416,25 @@ void ConnectionMonitorCore::setUpdateTimeIntervalSec(int intervalSec) {
 // updates the internally stored last two snapshots (current one and last one)
 void ConnectionMonitorCore::updateStoredWeights() {
 	if (snn_->getSimTime() > wtTime_) {
-		// time has advanced: get new weights
-		wtMatLast_ = wtMat_;
+		// time has advanced: get new weights (reusing the memory of the last snapshot)
+		wtSparseLast_.swap(wtSparse_);
 		wtTimeLast_ = wtTime_;
 
-		wtMat_ = snn_->getWeightMatrix2D(connId_);
+		snn_->getWeightMatrixSparse(connId_, wtSparse_);
 		wtTime_ = snn_->getSimTime();
 	}
 }
 
 // returns a current snapshot
 std::vector< std::vector<float> > ConnectionMonitorCore::takeSnapshot() {
+	return takeSnapshotSparse().toDense();
+}
+
+// returns a current snapshot of the existing synapses
+SparseWeightMatrix ConnectionMonitorCore::takeSnapshotSparse() {
 	updateStoredWeights();
-	writeConnectFileSnapshot(wtTime_, wtMat_);
-	return wtMat_;
+	writeConnectFileSnapshot(wtTime_, wtSparse_);
+	return wtSparse_;
 }
 
 // write the header section of the spike file
@@ -509,12 +494,33 @@ void ConnectionMonitorCore::writeConnectFileHeader() {
 		KERNEL_ERROR("ConnectionMonitorCore: writeConnectFileHeader has fwrite error");
 
 
+	// write the synapses that exist (CSR structure of the snapshots): number of synapses, start of the synapses of
+	// every pre-synaptic neuron, post-synaptic neuron ID of every synapse
+	// the snapshots only store the weights of these synapses, in the same order
+	int nSynapsesStored = wtSparse_.getNumSynapses();
+	if (!fwrite(&nSynapsesStored,sizeof(int),1,connFileId_))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+	if (fwrite(&wtSparse_.rowPtr[0],sizeof(int),nNeurPre_+1,connFileId_) != (size_t)(nNeurPre_+1))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+	if (nSynapsesStored > 0 && fwrite(&wtSparse_.postIds[0],sizeof(int),nSynapsesStored,connFileId_) != (size_t)nSynapsesStored)
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+
+	// write the encoding of the snapshots: every keyframeInterval-th snapshot is a keyframe, the others only store
+	// the synapses whose weight changed by more than minAbsChange
+	if (keyframeInterval_ > 0) {
+		float minAbsChange = (float)deltaMinAbsChange_;
+		if (!fwrite(&keyframeInterval_,sizeof(int),1,connFileId_))
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+		if (!fwrite(&minAbsChange,sizeof(float),1,connFileId_))
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileHeader has fwrite error");
+	}
+
 	// \TODO: write delays
 
 	needToWriteFileHeader_ = false;
 }
 
-void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts) {
+void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, const SparseWeightMatrix& wts) {
 	// don't write if we have already written this timestamp to file (or file doesn't exist)
 	if ((long long)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
 		return;
@@ -526,12 +532,53 @@ void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector<
 	if (!fwrite(&wtTimeWrite_,sizeof(long long),1,connFileId_))
 		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
 
-	// write all weights
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			if (!fwrite(&wts[i][j],sizeof(float),1,connFileId_)) {
-				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+	// write the weights of all existing synapses, in the order of the header
+	int nSynapsesStored = wts.getNumSynapses();
+	if (keyframeInterval_ == 0) {
+		if (nSynapsesStored > 0 && fwrite(&wts.weights[0],sizeof(float),nSynapsesStored,connFileId_) != (size_t)nSynapsesStored)
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+		return;
+	}
+
+	// delta snapshots: a keyframe stores all weights, a delta the synapses whose weight differs by more than
+	// minAbsChange from the value stored last (so that the error of the stored weights never exceeds minAbsChange)
+	deltaIdx_.clear();
+	deltaWt_.clear();
+	bool isKeyframe = (numSnapshotsSinceKeyframe_ == 0);
+	if (!isKeyframe) {
+		assert(wtWritten_.size() == wts.weights.size());
+		for (int pos = 0; pos < nSynapsesStored; pos++) {
+			if (fabs(wts.weights[pos] - wtWritten_[pos]) > deltaMinAbsChange_) {
+				deltaIdx_.push_back(pos);
+				deltaWt_.push_back(wts.weights[pos]);
 			}
 		}
+
+		// a delta stores an index and a weight per synapse: store a keyframe instead if that is smaller
+		isKeyframe = (2 * deltaIdx_.size() >= (size_t)nSynapsesStored);
 	}
+	numSnapshotsSinceKeyframe_ = isKeyframe ? 1 : numSnapshotsSinceKeyframe_ + 1;
+	if (numSnapshotsSinceKeyframe_ == keyframeInterval_)
+		numSnapshotsSinceKeyframe_ = 0;
+
+	int isDelta = isKeyframe ? 0 : 1;
+	if (!fwrite(&isDelta,sizeof(int),1,connFileId_))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+
+	if (isKeyframe) {
+		wtWritten_ = wts.weights;
+		if (nSynapsesStored > 0 && fwrite(&wts.weights[0],sizeof(float),nSynapsesStored,connFileId_) != (size_t)nSynapsesStored)
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+		return;
+	}
+
+	// number of changed synapses, their indices (in the order of the header), and their new weights
+	int nChanged = (int)deltaIdx_.size();
+	for (int k = 0; k < nChanged; k++)
+		wtWritten_[deltaIdx_[k]] = deltaWt_[k];
+	if (!fwrite(&nChanged,sizeof(int),1,connFileId_))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+	if (nChanged > 0 && (fwrite(&deltaIdx_[0],sizeof(int),nChanged,connFileId_) != (size_t)nChanged
+			|| fwrite(&deltaWt_[0],sizeof(float),nChanged,connFileId_) != (size_t)nChanged))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
 }
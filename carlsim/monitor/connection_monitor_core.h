@@ -51,6 +51,7 @@
 #include <stdio.h>					// FILE
 #include <vector>					// std::vector
 #include <carlsim_definitions.h>	// ALL
+#include <connection_monitor.h>		// SparseWeightMatrix
 
 class SNN; // forward declaration of SNN class
 
@@ -78,6 +79,9 @@ public:
 	//! calculates weight changes since last snapshot and reports them in 2D weight change matrix
 	std::vector< std::vector<float> > calcWeightChanges();
 
+	//! calculates weight changes since last snapshot and reports them in sparse format (NAN if there is no last one)
+	SparseWeightMatrix calcWeightChangesSparse();
+
 	//! returns connection ID
 	short int getConnectId() { return connId_; }
 
@@ -144,30 +148,36 @@ public:
 	//! weight: 0.0f).
 	std::vector< std::vector<float> > takeSnapshot();
 
+	//! takes snapshot of current weight state and returns the existing synapses in sparse format
+	SparseWeightMatrix takeSnapshotSparse();
+
 
 	// +++++ PUBLIC METHODS THAT SHOULD NOT BE EXPOSED TO INTERFACE +++++++++//
 
-	//! deletes data from the 2D weight matrix
+	//! deletes data from the weight snapshots
 	void clear();
 
 	//! initialization method
 	//! depends on several SNN data structures, so it has be to called at the end of setConnectionMonitor (or later)
 	void init();
 
-	//! updates an entry in the current weight matrix (called by CARLsim::updateConnectionMonitor)
-	void updateWeight(int preId, int postId, float wt);
-
 	//! updates timestamp of the snapshots, returns true if update was needed
 	bool updateTime(int simTimeMs);
 
 	//! sets pointer to connection file
 	void setConnectFileId(FILE* connFileId);
 
+	//! stores snapshots as keyframes (every keyframeInterval-th one) followed by deltas of the changed weights
+	void setDeltaSnapshots(int keyframeInterval, double minAbsChange);
+
+	//! returns whether a snapshot has been written to the conn file
+	bool hasWrittenSnapshot() { return wtTimeWrite_ >= 0; }
+
 	//! sets time update interval (seconds) for periodically storing weights to file
 	void setUpdateTimeIntervalSec(int intervalSec);
 
 	//! writes each snapshot to connect file
-	void writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts);
+	void writeConnectFileSnapshot(int simTimeMs, const SparseWeightMatrix& wts);
 	
 private:
 	//! indicates whether writing the current snapshot is necessary (false it has already been written)
@@ -192,8 +202,8 @@ private:
 
 	bool isPlastic_; //!< whether this connection has plastic synapses
 
-	std::vector< std::vector<float> > wtMat_;      //!< current snapshot of weight matrix
-	std::vector< std::vector<float> > wtMatLast_;  //!< last snapshot of weight matrix
+	SparseWeightMatrix wtSparse_;     //!< current snapshot of the weights (existing synapses only)
+	SparseWeightMatrix wtSparseLast_; //!< last snapshot of the weights
 	long long wtTime_;
 	long long wtTimeLast_;
 	long long wtTimeWrite_;
@@ -206,6 +216,13 @@ private:
 	float connFileVersion_;         //!< version number of conn file
 	int connFileTimeIntervalSec_;   //!< time update interval (seconds) for storing weights to file
 
+	int keyframeInterval_;          //!< every keyframeInterval_-th snapshot in the file is a keyframe, 0: no deltas
+	double deltaMinAbsChange_;      //!< minimum weight change of a synapse to be stored in a delta
+	int numSnapshotsSinceKeyframe_; //!< number of snapshots written since the last keyframe (0: next is a keyframe)
+	std::vector<float> wtWritten_;  //!< weights as stored in the conn file so far (reference of the deltas)
+	std::vector<int> deltaIdx_;     //!< indices of the synapses stored in the current delta
+	std::vector<float> deltaWt_;    //!< weights of the synapses stored in the current delta
+
 	const FILE* fpInf_;             //!< file pointer for info logging
 	const FILE* fpErr_;             //!< file pointer for error logging
 	const FILE* fpDeb_;             //!< file pointer for debug logging
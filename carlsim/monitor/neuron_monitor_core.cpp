@@ -177,8 +177,9 @@ long int NeuronMonitorCore::getAccumTime(){
 void NeuronMonitorCore::setNeuronFileId(FILE* neuronFileId) {
 	assert(!isRecording());
 
-	// close previous file pointer if exists
+	// close previous file pointer if exists, after the pending records have been written
 	if (neuronFileId_!=NULL) {
+		snn_->syncMonitorFiles();
 		fclose(neuronFileId_);
 		neuronFileId_ = NULL;
 	}
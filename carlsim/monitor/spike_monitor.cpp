@@ -91,10 +91,6 @@ int SpikeMonitor::getPopNumSpikes() {
 	std::string funcName = "getPopNumSpikes()";
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
 
-	// \TODO
-	UserErrors::assertTrue(getMode()==AER, UserErrors::UNKNOWN, funcName, "",
-		"This function is not yet supported in this mode.");
-
 	return spikeMonitorCorePtr_->getPopNumSpikes();	
 }
 
@@ -131,13 +127,27 @@ int SpikeMonitor::getNeuronNumSpikes(int neurId) {
 	std::string funcName = "getNeuronNumSpikes()";
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
 
-	// \TODO
-	UserErrors::assertTrue(getMode()==AER, UserErrors::UNKNOWN, funcName, "",
-		"This function is not yet supported in this mode.");
-
 	return spikeMonitorCorePtr_->getNeuronNumSpikes(neurId);
 }
 
+float SpikeMonitor::getNeuronMeanISI(int neurId) {
+	std::string funcName = "getNeuronMeanISI()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(neurId>=0 && neurId<spikeMonitorCorePtr_->getGrpNumNeurons(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "neurId", "[0, number of neurons in the group)");
+
+	return spikeMonitorCorePtr_->getNeuronMeanISI(neurId);
+}
+
+float SpikeMonitor::getNeuronISICV(int neurId) {
+	std::string funcName = "getNeuronISICV()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(neurId>=0 && neurId<spikeMonitorCorePtr_->getGrpNumNeurons(), UserErrors::MUST_BE_IN_RANGE,
+		funcName, "neurId", "[0, number of neurons in the group)");
+
+	return spikeMonitorCorePtr_->getNeuronISICV(neurId);
+}
+
 // need to do error check here and maybe throw CARLsim errors.
 int SpikeMonitor::getNumNeuronsWithFiringRate(float min, float max){
 	std::string funcName = "getNumNeuronsWithFiringRate()";
@@ -179,6 +189,13 @@ std::vector<std::vector<int> > SpikeMonitor::getSpikeVector2D() {
 	return spikeMonitorCorePtr_->getSpikeVector2D();
 }
 
+std::vector<float> SpikeMonitor::getPSTH() {
+	std::string funcName = "getPSTH()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+
+	return spikeMonitorCorePtr_->getPSTH();
+}
+
 std::vector<float> SpikeMonitor::getAllFiringRatesSorted(){
 	std::string funcName = "getAllFiringRatesSorted()";
 	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
@@ -252,13 +269,29 @@ SpikeMonMode SpikeMonitor::getMode() {
 }
 
 void SpikeMonitor::setMode(SpikeMonMode mode) {
-	// \TODO
-	UserErrors::assertTrue(false, UserErrors::UNKNOWN, "setMode()", "",
-		"This function call is not yet supported.");
+	std::string funcName = "setMode()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
 
 	spikeMonitorCorePtr_->setMode(mode);
 }
 
+void SpikeMonitor::setPSTH(int binSizeMs, int numBins) {
+	std::string funcName = "setPSTH()";
+	UserErrors::assertTrue(!isRecording(), UserErrors::CANNOT_BE_ON, funcName, "Recording");
+	UserErrors::assertTrue(binSizeMs>0, UserErrors::MUST_BE_POSITIVE, funcName, "binSizeMs");
+	UserErrors::assertTrue(numBins>0, UserErrors::MUST_BE_POSITIVE, funcName, "numBins");
+
+	spikeMonitorCorePtr_->setPSTH(binSizeMs, numBins);
+}
+
+void SpikeMonitor::setCompactFile(bool compact) {
+	std::string funcName = "setCompactFile()";
+	UserErrors::assertTrue(spikeMonitorCorePtr_->isSpikeFileNew(), UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+		funcName, "SETUP_STATE (before spikes are written to the current spike file).");
+
+	spikeMonitorCorePtr_->setCompactFile(compact);
+}
+
 void SpikeMonitor::setLogFile(const std::string& fileName) {
 	std::string funcName = "setLogFile";
 
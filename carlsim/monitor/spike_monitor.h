@@ -224,6 +224,31 @@ class SpikeMonitor {
 	 */
 	int getNeuronNumSpikes(int neurId);
 
+	/*!
+	 * \brief returns the mean inter-spike interval (ms) of a specific neuron in the group
+	 *
+	 * This function returns the mean of the intervals between consecutive spikes of a specific neuron. It is
+	 * computed on-line while recording, and is available in both AER and COUNT mode.
+	 * If PersistentMode is on, the interval between the last spike of a recording period and the first spike of
+	 * the next one is included.
+	 * \param[in] neurId the neuron ID (0-indexed, must be smaller than getNumNeurons)
+	 * \returns the mean inter-spike interval (ms), or NaN if the neuron spiked less than twice
+	 * \since v4.0
+	 */
+	float getNeuronMeanISI(int neurId);
+
+	/*!
+	 * \brief returns the coefficient of variation of the inter-spike intervals of a specific neuron in the group
+	 *
+	 * This function returns the standard deviation of the inter-spike intervals of a specific neuron divided by their
+	 * mean (1 for a Poisson process, 0 for a periodic spike train). It is computed on-line while recording, and is
+	 * available in both AER and COUNT mode.
+	 * \param[in] neurId the neuron ID (0-indexed, must be smaller than getNumNeurons)
+	 * \returns the coefficient of variation, or NaN if the neuron spiked less than twice
+	 * \since v4.0
+	 */
+	float getNeuronISICV(int neurId);
+
 	/*!
 	 * \brief Returns the number of neurons that fall within this particular min/max range (inclusive).
 	 *
@@ -324,6 +349,19 @@ class SpikeMonitor {
 	 */
 	std::vector<std::vector<int> > getSpikeVector2D();
 
+	/*!
+	 * \brief returns the peri-stimulus time histogram (PSTH) of the group
+	 *
+	 * This function returns the population firing rate (Hz) in the last numBins bins of binSizeMs ms (see
+	 * SpikeMonitor::setPSTH), oldest bin first. Bins are aligned to multiples of binSizeMs of simulation time, the
+	 * last bin is the one holding the last recorded millisecond (getRecordingStopTime()-1). The histogram is a ring
+	 * buffer updated while recording, so its memory does not grow with the recording time, and it is available in
+	 * both AER and COUNT mode.
+	 * \returns vector of numBins firing rates (Hz), or an empty vector if SpikeMonitor::setPSTH has not been called
+	 * \since v4.0
+	 */
+	std::vector<float> getPSTH();
+
 	/*!
 	 * \brief Recording status (true=recording, false=not recording)
 	 *
@@ -444,15 +482,53 @@ class SpikeMonitor {
 	/*!
 	 * \brief Sets the current SpikeMonitor mode
 	 *
-	 * This function returns the current SpikeMonitor mode.
+	 * This function sets the current SpikeMonitor mode.
 	 * COUNT:	Will collect only spike count information (such as number of spikes per neuron),
 	 *          not the explicit spike times. COUNT mode cannot retrieve exact spike times per
 	 *          neuron, and is thus not capable of computing spike train correlation etc.
+	 *          Its memory does not grow with the recording time: per neuron, it keeps the number of
+	 *          spikes and the inter-spike interval statistics, plus the PSTH (see setPSTH). All
+	 *          firing rate metrics (e.g., getPopMeanFiringRate, getAllFiringRates,
+	 *          getNumSilentNeurons) are available, but not getSpikeVector2D.
 	 * AER:     Will collect spike information in AER format (will collect both neuron IDs and
 	 *          spike times).
+	 * Changing the mode deletes all recorded data. The spike file is written in both modes.
+	 * \note This function cannot be called while recording.
 	 */
 	void setMode(SpikeMonMode mode=AER);
 
+	/*!
+	 * \brief Sets the bins of the PSTH
+	 *
+	 * This function enables the peri-stimulus time histogram (PSTH) of the group, which holds the population firing
+	 * rate in the last numBins bins of binSizeMs ms (see getPSTH). Calling it again changes the bins and deletes the
+	 * histogram. By default, there is no PSTH.
+	 * \param[in] binSizeMs the size of a bin (ms)
+	 * \param[in] numBins   the number of bins
+	 * \note This function cannot be called while recording.
+	 * \since v4.0
+	 */
+	void setPSTH(int binSizeMs, int numBins);
+
+	/*!
+	 * \brief Writes the spike file binary in the compact format (version 0.3)
+	 *
+	 * By default, the spike file stores every spike as two ints (spike time and neuron ID), in AER format (version
+	 * 0.2). In the compact format, the spikes of every millisecond form a block that stores the time difference to
+	 * the previous block and the sorted neuron IDs as differences to the previous ID, as variable-length integers.
+	 * Most spikes then take one or two bytes instead of eight. An index at the end of the file stores where every
+	 * second starts, so that readers can seek to a given second.
+	 *
+	 * The compact format can be read by SpikeGeneratorFromFile and by SpikeReader of the Offline Analysis Toolbox.
+	 * The setting also applies to files set later with SpikeMonitor::setLogFile.
+	 *
+	 * \param[in] compact whether to use the compact format (true) or the AER format (false). Default: true.
+	 * \note This function has to be called before spikes are written to the current spike file, i.e., after
+	 * CARLsim::setSpikeMonitor or SpikeMonitor::setLogFile, but before the next CARLsim::runNetwork.
+	 * \since v4.0
+	 */
+	void setCompactFile(bool compact=true);
+
 	/*!
 	 * \brief Sets the name of the spike file binary
 	 *
@@ -50,8 +50,17 @@
 #include <snn.h>				// CARLsim private implementation
 #include <snn_definitions.h>	// KERNEL_ERROR, KERNEL_INFO, ...
 
-#include <algorithm>			// std::sort
-
+#include <algorithm>			// std::sort, std::max
+#include <math.h>				// NAN, sqrt
+
+// appends an unsigned LEB128 varint to a compact spike file block
+static void appendVarint(std::vector<char>& bytes, unsigned int value) {
+	while (value>=0x80) {
+		bytes.push_back((char)((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back((char)value);
+}
 
 
 // we aren't using namespace std so pay attention!
@@ -66,10 +75,17 @@ SpikeMonitorCore::SpikeMonitorCore(SNN* snn, int monitorId, int grpId) {
 
 	mode_ = AER;
 	persistentData_ = false;
+	psthBinSize_ = 0;
+	psthNumBins_ = 0;
     userHasBeenWarned_ = false;
 	needToWriteFileHeader_ = true;
 	spikeFileSignature_ = 206661989;
 	spikeFileVersion_ = 0.2f;
+	spikeFileSetTime_ = 0;
+
+	compactFile_ = false;
+	compactIndexSignature_ = 206661990;
+	resetCompactEncoding();
 
 	// defer all unsafe operations to init function
 	init();
@@ -95,6 +111,7 @@ void SpikeMonitorCore::init() {
 
 SpikeMonitorCore::~SpikeMonitorCore() {
 	if (spikeFileId_!=NULL) {
+		writeCompactIndex();
 		fclose(spikeFileId_);
 		spikeFileId_ = NULL;
 	}
@@ -115,6 +132,13 @@ void SpikeMonitorCore::clear() {
 	for (int i=0; i<nNeurons_; i++)
 		spkVector_[i].clear();
 
+	spkCount_.assign(nNeurons_,0);
+	lastSpkTime_.assign(nNeurons_,-1);
+	isiMean_.assign(nNeurons_,0.0);
+	isiM2_.assign(nNeurons_,0.0);
+	psthCounts_.assign(psthNumBins_,0);
+	psthLastBin_ = -1;
+
 	needToCalculateFiringRates_ = true;
 	needToSortFiringRates_ = true;
 	firingRates_.clear();
@@ -195,9 +219,28 @@ float SpikeMonitorCore::getNeuronMeanFiringRate(int neurId) {
 int SpikeMonitorCore::getNeuronNumSpikes(int neurId) {
 	assert(!isRecording());
 	assert(neurId>=0 && neurId<nNeurons_);
-	assert(getMode()==AER);
 
-	return spkVector_[neurId].size();
+	return spkCount_[neurId];
+}
+
+float SpikeMonitorCore::getNeuronMeanISI(int neurId) {
+	assert(!isRecording());
+	assert(neurId>=0 && neurId<nNeurons_);
+
+	if (spkCount_[neurId]<2)
+		return NAN;
+
+	return isiMean_[neurId];
+}
+
+float SpikeMonitorCore::getNeuronISICV(int neurId) {
+	assert(!isRecording());
+	assert(neurId>=0 && neurId<nNeurons_);
+
+	if (spkCount_[neurId]<2 || isiMean_[neurId]<=0.0)
+		return NAN;
+
+	return sqrt(isiM2_[neurId]/(spkCount_[neurId]-1))/isiMean_[neurId];
 }
 
 std::vector<float> SpikeMonitorCore::getAllFiringRatesSorted() {
@@ -254,6 +297,20 @@ std::vector<std::vector<int> > SpikeMonitorCore::getSpikeVector2D(){
 	return spkVector_;
 }
 
+std::vector<float> SpikeMonitorCore::getPSTH() {
+	assert(!isRecording());
+
+	// oldest bin first, bins before the first recorded bin are empty
+	std::vector<float> rates(psthNumBins_,0.0f);
+	for (int i=0; i<psthNumBins_; i++) {
+		long int bin = psthLastBin_ - psthNumBins_ + 1 + i;
+		if (bin>=0)
+			rates[i] = psthCounts_[bin%psthNumBins_]*1000.0/(psthBinSize_*nNeurons_);
+	}
+
+	return rates;
+}
+
 void SpikeMonitorCore::print(bool printSpikeTimes) {
 	assert(!isRecording());
 
@@ -302,9 +359,47 @@ void SpikeMonitorCore::print(bool printSpikeTimes) {
 
 void SpikeMonitorCore::pushAER(int time, int neurId) {
 	assert(isRecording());
-	assert(getMode()==AER);
 
-	spkVector_[neurId].push_back(time);
+	// spike times are only stored in AER mode
+	if (mode_==AER)
+		spkVector_[neurId].push_back(time);
+
+	// inter-spike interval statistics via Welford's algorithm (the spikes of a neuron arrive in temporal order)
+	spkCount_[neurId]++;
+	if (lastSpkTime_[neurId]>=0) {
+		double isi = time - lastSpkTime_[neurId];
+		double delta = isi - isiMean_[neurId];
+		isiMean_[neurId] += delta/(spkCount_[neurId]-1);
+		isiM2_[neurId] += delta*(isi - isiMean_[neurId]);
+	}
+	lastSpkTime_[neurId] = time;
+
+	if (psthNumBins_>0) {
+		long int bin = time/psthBinSize_;
+		advancePSTH(bin);
+		if (bin>psthLastBin_-psthNumBins_) // spikes older than the ring buffer are dropped
+			psthCounts_[bin%psthNumBins_]++;
+	}
+}
+
+void SpikeMonitorCore::setMode(SpikeMonMode mode) {
+	assert(!isRecording());
+
+	// the spike vector and the on-line statistics would no longer agree
+	if (mode!=mode_) {
+		mode_ = mode;
+		clear();
+	}
+}
+
+void SpikeMonitorCore::setPSTH(int binSizeMs, int numBins) {
+	assert(!isRecording());
+	assert(binSizeMs>0 && numBins>0);
+
+	psthBinSize_ = binSizeMs;
+	psthNumBins_ = numBins;
+	psthCounts_.assign(psthNumBins_,0);
+	psthLastBin_ = -1;
 }
 
 void SpikeMonitorCore::startRecording() {
@@ -354,19 +449,27 @@ void SpikeMonitorCore::stopRecording() {
 	// total time is the amount of time of the last probe plus all accumulated time from previous probes
 	totalTime_ = stopTime_-startTimeLast_ + accumTime_;
 	assert(totalTime_>=0);
+
+	// the PSTH ends with the last recorded millisecond, even if nobody spiked
+	if (psthNumBins_>0 && stopTime_>0)
+		advancePSTH((stopTime_-1)/psthBinSize_);
 }
 
 void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 	assert(!isRecording());
 
-	// close previous file pointer if exists
+	// close previous file pointer if exists, after the pending spikes have been written
 	if (spikeFileId_!=NULL) {
+		snn_->syncMonitorFiles();
+		writeCompactIndex();
 		fclose(spikeFileId_);
 		spikeFileId_ = NULL;
 	}
 
 	// set it to new file id
 	spikeFileId_=spikeFileId;
+	spikeFileSetTime_ = snn_->getSimTime();
+	resetCompactEncoding();
 
 	if (spikeFileId_==NULL)
 		needToWriteFileHeader_ = false;
@@ -377,14 +480,81 @@ void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 	}
 }
 
+bool SpikeMonitorCore::isSpikeFileNew() {
+	// spikes are written to file at the earliest after the simulation time advanced
+	return spikeFileId_==NULL || snn_->getSimTime()==spikeFileSetTime_;
+}
+
+void SpikeMonitorCore::setCompactFile(bool compact) {
+	assert(isSpikeFileNew());
+
+	compactFile_ = compact;
+	spikeFileVersion_ = compact ? 0.3f : 0.2f;
+	resetCompactEncoding();
+
+	// the header has already been written, update its version number
+	if (spikeFileId_!=NULL) {
+		snn_->syncMonitorFiles();
+		if (fseek(spikeFileId_, sizeof(int), SEEK_SET) || !fwrite(&spikeFileVersion_,sizeof(float),1,spikeFileId_)
+				|| fseek(spikeFileId_, 0, SEEK_END))
+			KERNEL_ERROR("SpikeMonitorCore: setCompactFile could not update the spike file header");
+	}
+}
+
+// Compact spike file (version 0.3): after the header, there is one block per millisecond with spikes, in ascending
+// order of time. A block holds the time difference to the previous block (the first block to -1), the number of
+// spikes, and the neuron IDs in ascending order, the first one as is and every other one as the difference to the
+// previous ID. All numbers are unsigned LEB128 varints (7 bits per byte, the highest bit set in all but the last byte).
+void SpikeMonitorCore::encodeCompactSpikes(const std::vector<int>& aer, std::vector<char>& bytes) {
+	assert(compactFile_);
+	assert(aer.size()%2==0);
+
+	// sort the spikes by time, then by neuron ID
+	int numSpikes = aer.size()/2;
+	std::vector<std::pair<int,int> > spikes(numSpikes);
+	for (int i=0; i<numSpikes; i++)
+		spikes[i] = std::make_pair(aer[2*i], aer[2*i+1]);
+	std::sort(spikes.begin(), spikes.end());
+
+	bytes.clear();
+	int i = 0;
+	while (i<numSpikes) {
+		int time = spikes[i].first;
+		int end = i;
+		while (end<numSpikes && spikes[end].first==time)
+			end++;
+		assert(time>compactLastTime_); // updateSpikeMonitor never returns a millisecond twice
+
+		// the index points to the first block of every second, seconds without spikes point to the next block
+		int64_t offset = 4*sizeof(int)+sizeof(float) + compactBytes_ + bytes.size();
+		if (compactIndexOffsets_.empty())
+			compactFirstSec_ = time/1000;
+		while (compactFirstSec_ + (int)compactIndexOffsets_.size() <= time/1000) {
+			compactIndexOffsets_.push_back(offset);
+			compactIndexTimes_.push_back(compactLastTime_);
+		}
+
+		appendVarint(bytes, time-compactLastTime_);
+		appendVarint(bytes, end-i);
+		int lastNeurId = 0;
+		for (int j=i; j<end; j++) {
+			appendVarint(bytes, spikes[j].second-lastNeurId);
+			lastNeurId = spikes[j].second;
+		}
+
+		compactLastTime_ = time;
+		i = end;
+	}
+
+	compactBytes_ += bytes.size();
+}
+
 // calculate average firing rate for every neuron if we haven't done so already
 void SpikeMonitorCore::calculateFiringRates() {
 	// only update if we have to
 	if (!needToCalculateFiringRates_)
 		return;
 
-	assert(getMode()==AER);
-
 	// clear, so we get the same answer every time.
 	firingRates_.assign(nNeurons_,0);
 	firingRatesSorted_.assign(nNeurons_,0);
@@ -398,7 +568,7 @@ void SpikeMonitorCore::calculateFiringRates() {
 	// compute firing rate
 	assert(totalTime_>0); // avoid division by zero
 	for(int i=0;i<nNeurons_;i++) {
-		firingRates_[i]=spkVector_[i].size()*1000.0/totalTime_;
+		firingRates_[i]=spkCount_[i]*1000.0/totalTime_;
 	}
 
 	needToCalculateFiringRates_ = false;
@@ -451,6 +621,46 @@ void SpikeMonitorCore::writeSpikeFileHeader() {
 	needToWriteFileHeader_ = false;
 }
 
+void SpikeMonitorCore::advancePSTH(long int bin) {
+	if (bin<=psthLastBin_)
+		return;
+
+	// empty the bins that are reused for the new ones
+	long int firstNewBin = std::max(psthLastBin_+1, bin-psthNumBins_+1);
+	for (long int b=firstNewBin; b<=bin; b++)
+		psthCounts_[b%psthNumBins_] = 0;
+	psthLastBin_ = bin;
+}
+
+// The index section of a compact spike file: for every second from the first one with spikes to the last one, the
+// file offset (int64) of its first block and the time (int32) of the block before it, so that a reader can start
+// decoding at any second. It is followed by the first second, the number of seconds, the time of the last block
+// (-1 if there are no spikes), and the index signature (all int32).
+// A compact spike file without index (e.g., if the simulation crashed) can still be read from the beginning.
+void SpikeMonitorCore::writeCompactIndex() {
+	if (!compactFile_ || spikeFileId_==NULL)
+		return;
+
+	bool writeErr = false;
+	for (size_t i=0; i<compactIndexOffsets_.size(); i++) {
+		writeErr |= !fwrite(&compactIndexOffsets_[i],sizeof(int64_t),1,spikeFileId_);
+		writeErr |= !fwrite(&compactIndexTimes_[i],sizeof(int),1,spikeFileId_);
+	}
+
+	int trailer[4] = {compactFirstSec_, (int)compactIndexOffsets_.size(), compactLastTime_, compactIndexSignature_};
+	writeErr |= fwrite(trailer,sizeof(int),4,spikeFileId_)!=4;
+	if (writeErr)
+		KERNEL_ERROR("SpikeMonitorCore: writeCompactIndex has fwrite error");
+}
+
+void SpikeMonitorCore::resetCompactEncoding() {
+	compactBytes_ = 0;
+	compactLastTime_ = -1;
+	compactFirstSec_ = 0;
+	compactIndexOffsets_.clear();
+	compactIndexTimes_.clear();
+}
+
 // Iterate through 2D spike vector and approximate size in memory.
 // This is not exact, we are not counting the buffer overhead, only
 // the size each subvector is memory.
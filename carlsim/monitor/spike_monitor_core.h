@@ -51,6 +51,7 @@
 
 #include <carlsim_datastructures.h>	// SpikeMonMode
 #include <stdio.h>					// FILE
+#include <stdint.h>					// int64_t
 #include <vector>					// std::vector
 
 class SNN; // forward declaration of SNN class
@@ -108,6 +109,13 @@ public:
 	//! returns the number of recorded spikes of a specific neuron
 	int getNeuronNumSpikes(int neurId);
 
+	//! returns the mean inter-spike interval (ms) of a specific neuron, NaN if it has less than two spikes
+	float getNeuronMeanISI(int neurId);
+
+	//! returns the coefficient of variation of the inter-spike intervals of a specific neuron, NaN if it has less than
+	//! two spikes
+	float getNeuronISICV(int neurId);
+
 	//! returns number of neurons whose firing rate was in [min,max] during recording
 	int getNumNeuronsWithFiringRate(float min, float max);
 
@@ -147,17 +155,29 @@ public:
 	//! returns the 2D AER vector
 	std::vector<std::vector<int> > getSpikeVector2D();
 
+	//! returns the population firing rate (Hz) in the bins of the PSTH, oldest bin first
+	std::vector<float> getPSTH();
+
 	//! returns recording status
 	bool isRecording() { return recordSet_; }
 
+	//! returns whether the spike file is written in the compact format (version 0.3)
+	bool isCompactFile() { return compactFile_; }
+
+	//! returns true if no spikes can have been written to the current spike file yet
+	bool isSpikeFileNew();
+
 	//! prints the AER vector in human-readable format
 	void print(bool printSpikeTimes);
 
 	//! inserts a (time,neurId) tupel into the 2D spike vector
 	void pushAER(int time, int neurId);
 
-	//! sets recording mode
-	void setMode(SpikeMonMode mode) { mode_ = mode; }
+	//! sets recording mode, deletes the recorded data if the mode changes
+	void setMode(SpikeMonMode mode);
+
+	//! sets the bin size (ms) and the number of bins of the PSTH, deletes the PSTH
+	void setPSTH(int binSizeMs, int numBins);
 
 	//! sets status of PersistentData mode
 	void setPersistentData(bool persistentData) { persistentData_ = persistentData; }
@@ -180,6 +200,17 @@ public:
 	//! sets pointer to spike file
 	void setSpikeFileId(FILE* spikeFileId);
 
+	//! switches the spike file between the AER format (version 0.2) and the compact format (version 0.3)
+	void setCompactFile(bool compact);
+
+	/*!
+	 * \brief encodes spikes as blocks of the compact spike file
+	 *
+	 * \param[in] aer the (time,neurId) pairs recorded since the last call, in any order, in AER format
+	 * \param[out] bytes the blocks to append to the spike file, one per millisecond with spikes
+	 */
+	void encodeCompactSpikes(const std::vector<int>& aer, std::vector<char>& bytes);
+
 	//! returns timestamp of last SpikeMonitor update
 	long int getLastUpdated() { return spkMonLastUpdated_; }
 
@@ -199,15 +230,24 @@ private:
 	//! initialization method
 	void init();
 
-	//! reads AER vector and updates firing rate member var
+	//! reads spike counts and updates firing rate member var
 	void calculateFiringRates();
 
+	//! moves the end of the PSTH ring buffer to a bin, emptying the bins in between
+	void advancePSTH(long int bin);
+
 	//! reads AER vector and updates sorted firing rate member var
 	void sortFiringRates();
 
 	//! writes the header section (file signature, version number) of a spike file
 	void writeSpikeFileHeader();
 
+	//! writes the index section at the end of a compact spike file, before it is closed
+	void writeCompactIndex();
+
+	//! resets the state of the compact encoding for a new spike file
+	void resetCompactEncoding();
+
 	//! whether we have to perform calculateFiringRates()
 	bool needToCalculateFiringRates_;
 
@@ -225,10 +265,30 @@ private:
 	FILE* spikeFileId_;	//!< file pointer to the spike file or NULL
 	int spikeFileSignature_; //!< int signature of spike file
 	float spikeFileVersion_; //!< version number of spike file
+	long int spikeFileSetTime_; //!< simulation time (ms) at which the spike file was set
+
+	bool compactFile_;                 //!< whether the spike file is written in the compact format
+	int compactIndexSignature_;        //!< int signature of the index section of a compact spike file
+	int64_t compactBytes_;             //!< number of bytes of blocks encoded into the current file
+	int compactLastTime_;              //!< time (ms) of the last encoded block, -1 if none
+	int compactFirstSec_;              //!< first second in the index
+	std::vector<int64_t> compactIndexOffsets_; //!< file offset of the first block of every second
+	std::vector<int> compactIndexTimes_;       //!< time of the last block before compactIndexOffsets_
 
 	//! Used to analyzed the spike information
 	std::vector<std::vector<int> > spkVector_;
 
+	// on-line statistics, updated in pushAER in constant memory per neuron (the only data in COUNT mode)
+	std::vector<int> spkCount_;      //!< number of recorded spikes of every neuron
+	std::vector<int> lastSpkTime_;   //!< time (ms) of the last recorded spike of every neuron, -1 if none
+	std::vector<double> isiMean_;    //!< running mean of the inter-spike intervals (ms) of every neuron
+	std::vector<double> isiM2_;      //!< running sum of squared deviations from isiMean_ (Welford's algorithm)
+
+	int psthBinSize_;               //!< bin size of the PSTH (ms)
+	int psthNumBins_;               //!< number of bins of the PSTH, 0 if disabled
+	long int psthLastBin_;          //!< index (time/psthBinSize_) of the newest bin of the PSTH, -1 if none
+	std::vector<int> psthCounts_;   //!< PSTH ring buffer, spike counts of bin b at b%psthNumBins_
+
 	std::vector<float> firingRates_;
 	std::vector<float> firingRatesSorted_;
 
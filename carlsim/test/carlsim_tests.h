@@ -98,4 +98,11 @@
 void readAndReturnSpikeFile(const std::string fileName, int*& AERArray, long &arraySize);
 void readAndPrintSpikeFile(const std::string fileName);
 
+// creates a directory with the given name in the temp directory of the system and returns its path (e.g., for
+// checkpoint files). The path does not depend on the process, so that the child processes of death tests use the
+// same directory as the test itself.
+std::string createTempDir(const std::string& name);
+// removes a directory created by createTempDir, together with all files in it
+void removeTempDir(const std::string& dirName);
+
 #endif // _CARLSIM_TEST_H_
@@ -50,6 +50,17 @@
 #include <stdio.h>			// fopen, fseek, fclose, etc.
 #include <cassert>			// assert
 #include <string.h>			// std::string
+#include <stdlib.h>			// getenv
+#include <errno.h>			// errno, EEXIST
+
+#if defined(WIN32) || defined(WIN64)
+#include <direct.h>			// _mkdir, _rmdir
+#include <io.h>				// _findfirst
+#else
+#include <sys/stat.h>		// mkdir
+#include <dirent.h>			// opendir, readdir
+#include <unistd.h>			// rmdir
+#endif
 
 
 /// ****************************************************************************
@@ -113,4 +124,46 @@ void readAndPrintSpikeFile(const std::string fileName){
 
 	for (int i=0; i<arraySize; i+=2)
 		printf("time = %d, nid = %d\n",arrayAER[i],arrayAER[i+1]);
-}
\ No newline at end of file
+}
+/// ****************************************************************************
+/// Functions for creating and removing temporary directories
+/// ****************************************************************************
+std::string createTempDir(const std::string& name) {
+#if defined(WIN32) || defined(WIN64)
+	const char* tmpDir = getenv("TEMP");
+	std::string dirName = std::string(tmpDir != NULL ? tmpDir : ".") + "\\carlsim_" + name;
+	if (_mkdir(dirName.c_str()) != 0 && errno != EEXIST) {fputs("Temp dir error",stderr); exit(1);}
+#else
+	const char* tmpDir = getenv("TMPDIR");
+	std::string dirName = std::string(tmpDir != NULL ? tmpDir : "/tmp") + "/carlsim_" + name;
+	if (mkdir(dirName.c_str(), 0777) != 0 && errno != EEXIST) {fputs("Temp dir error",stderr); exit(1);}
+#endif
+	return dirName;
+}
+
+// the directory is expected to contain regular files only
+void removeTempDir(const std::string& dirName) {
+#if defined(WIN32) || defined(WIN64)
+	struct _finddata_t fileInfo;
+	intptr_t handle = _findfirst((dirName + "\\*").c_str(), &fileInfo);
+	if (handle != -1) {
+		do {
+			if (!(fileInfo.attrib & _A_SUBDIR))
+				remove((dirName + "\\" + fileInfo.name).c_str());
+		} while (_findnext(handle, &fileInfo) == 0);
+		_findclose(handle);
+	}
+	_rmdir(dirName.c_str());
+#else
+	DIR* dir = opendir(dirName.c_str());
+	if (dir != NULL) {
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+				remove((dirName + "/" + entry->d_name).c_str());
+		}
+		closedir(dir);
+	}
+	rmdir(dirName.c_str());
+#endif
+}
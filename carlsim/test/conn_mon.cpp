@@ -424,3 +424,177 @@ TEST(ConnMon, weightChange) {
 		delete sim;
 	}
 }
+
+//! A sparse snapshot holds the existing synapses only, in the order of the pre- and post-synaptic neuron IDs. It must
+//! agree with the dense snapshot, the getters, and the weights stored in the conn file.
+TEST(ConnMon, sparseSnapshot) {
+	CARLsim* sim;
+	const int GRP_SIZE_PRE = 50, GRP_SIZE_POST = 80;
+	float wtScale = 0.01f;
+
+	// loop over both CPU and GPU mode.
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		sim = new CARLsim("ConnMon.sparseSnapshot",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+
+		int g0 = sim->createGroup("g0", GRP_SIZE_PRE, EXCITATORY_NEURON, 0);
+		int g1 = sim->createGroup("g1", GRP_SIZE_POST, EXCITATORY_NEURON, 0);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		short int c0 = sim->connect(g0,g1,"random",RangeWeight(wtScale),0.1f,RangeDelay(1),RadiusRF(-1),SYN_PLASTIC);
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		ConnectionMonitor* CM = sim->setConnectionMonitor(g0, g1, "results/weights_sparse.dat");
+		SparseWeightMatrix wt = CM->takeSnapshotSparse();
+		std::vector< std::vector<float> > wtDense = CM->takeSnapshot();
+		ASSERT_EQ(wt.numPre, GRP_SIZE_PRE);
+		ASSERT_EQ(wt.numPost, GRP_SIZE_POST);
+		ASSERT_EQ(wt.rowPtr.size(), GRP_SIZE_PRE+1);
+		EXPECT_EQ(wt.getNumSynapses(), CM->getNumSynapses());
+		EXPECT_EQ(wt.getNumSynapses(), sim->getNumSynapticConnections(c0));
+
+		int nSynDense = 0;
+		for (int i=0; i<GRP_SIZE_PRE; i++) {
+			EXPECT_EQ(wt.rowPtr[i+1]-wt.rowPtr[i], CM->getFanOut(i));
+			for (int pos=wt.rowPtr[i]; pos<wt.rowPtr[i+1]; pos++) {
+				if (pos > wt.rowPtr[i]) {
+					EXPECT_LT(wt.postIds[pos-1], wt.postIds[pos]);
+				}
+				EXPECT_FLOAT_EQ(wt.weights[pos], wtScale);
+				EXPECT_FLOAT_EQ(wtDense[i][wt.postIds[pos]], wt.weights[pos]);
+			}
+			for (int j=0; j<GRP_SIZE_POST; j++) {
+				nSynDense += isnan(wtDense[i][j]) ? 0 : 1;
+			}
+		}
+		EXPECT_EQ(nSynDense, wt.getNumSynapses());
+
+		// the weight changes are reported for the existing synapses
+		sim->runNetwork(1,0);
+		sim->scaleWeights(c0, 0.5f);
+		sim->runNetwork(1,0);
+		SparseWeightMatrix wtChange = CM->calcWeightChangesSparse();
+		ASSERT_EQ(wtChange.getNumSynapses(), wt.getNumSynapses());
+		EXPECT_TRUE(wtChange.postIds == wt.postIds);
+		for (int pos=0; pos<wtChange.getNumSynapses(); pos++) {
+			EXPECT_FLOAT_EQ(wtChange.weights[pos], -0.5f*wtScale);
+		}
+		EXPECT_EQ(CM->getNumWeightsChanged(), wt.getNumSynapses());
+		EXPECT_FLOAT_EQ(CM->getMaxWeight(true), 0.5f*wtScale);
+
+		// the last snapshot in the file stores the weights of the existing synapses only
+		wt = CM->takeSnapshotSparse();
+		delete sim;
+
+		FILE* fid = fopen("results/weights_sparse.dat", "rb");
+		ASSERT_TRUE(fid != NULL);
+		std::vector<float> wtFile(wt.getNumSynapses());
+		fseek(fid, -(long)(wtFile.size()*sizeof(float)), SEEK_END);
+		EXPECT_EQ(fread(&wtFile[0], sizeof(float), wtFile.size(), fid), wtFile.size());
+		fclose(fid);
+		EXPECT_TRUE(wtFile == wt.weights);
+	}
+}
+
+//! With delta snapshots, the conn file stores keyframes with all weights and deltas with the changed weights only.
+//! Reconstruct the snapshots from the file and compare them to the snapshots taken, for lossless deltas and for
+//! deltas that skip changes up to minAbsChange.
+TEST(ConnMon, deltaSnapshots) {
+	const int GRP_SIZE = 20, NUM_SNAPSHOTS = 7, KEYFRAME_INTERVAL = 3;
+	float minAbsChange[2] = {0.0f, 0.05f};
+
+	for (int lossy = 0; lossy <= 1; lossy++) {
+		CARLsim* sim = new CARLsim("ConnMon.deltaSnapshots",CPU_MODE,SILENT,1,42);
+		int g0 = sim->createGroup("g0", GRP_SIZE, EXCITATORY_NEURON, 0);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		short int c0 = sim->connect(g0,g0,"random",RangeWeight(0.0f,0.5f,1.0f),0.2f,RangeDelay(1),RadiusRF(-1),
+			SYN_PLASTIC);
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		ConnectionMonitor* CM = sim->setConnectionMonitor(g0, g0, "results/weights_delta.dat");
+		CM->setUpdateTimeIntervalSec(-1);
+		CM->setDeltaSnapshots(KEYFRAME_INTERVAL, minAbsChange[lossy]);
+
+		// change a few weights between snapshots, some of them by less than minAbsChange
+		std::vector< std::vector<float> > wtTaken;
+		std::vector<int> numChanged;
+		SparseWeightMatrix wt = CM->takeSnapshotSparse();
+		wtTaken.push_back(wt.weights);
+		for (int s = 1; s < NUM_SNAPSHOTS; s++) {
+			int nChanged = 0;
+			for (int i = 0; i < GRP_SIZE; i += 3) {
+				if (wt.rowPtr[i+1] > wt.rowPtr[i]) {
+					int pos = wt.rowPtr[i] + s % (wt.rowPtr[i+1] - wt.rowPtr[i]);
+					float change = (i % 2) ? 0.01f : 0.2f;
+					sim->setWeight(c0, i, wt.postIds[pos], fmod(wt.weights[pos] + change, 1.0f));
+					nChanged++;
+				}
+			}
+			numChanged.push_back(nChanged);
+			sim->runNetwork(0,100);
+			wt = CM->takeSnapshotSparse();
+			wtTaken.push_back(wt.weights);
+		}
+		int nSyn = wt.getNumSynapses();
+		delete sim;
+
+		// skip the header: 55 bytes up to maxWt, the list of synapses, and the encoding of the snapshots
+		FILE* fid = fopen("results/weights_delta.dat", "rb");
+		ASSERT_TRUE(fid != NULL);
+		float version;
+		fseek(fid, sizeof(int), SEEK_SET);
+		EXPECT_EQ(fread(&version, sizeof(float), 1, fid), 1);
+		EXPECT_FLOAT_EQ(version, 0.5f);
+		fseek(fid, 55 + sizeof(int)*(1 + GRP_SIZE+1 + nSyn), SEEK_SET);
+		int keyframeInterval;
+		float minAbs;
+		EXPECT_EQ(fread(&keyframeInterval, sizeof(int), 1, fid), 1);
+		EXPECT_EQ(fread(&minAbs, sizeof(float), 1, fid), 1);
+		EXPECT_EQ(keyframeInterval, KEYFRAME_INTERVAL);
+		EXPECT_FLOAT_EQ(minAbs, minAbsChange[lossy]);
+
+		std::vector<float> wtFile(nSyn);
+		for (int s = 0; s < NUM_SNAPSHOTS; s++) {
+			long long timeMs;
+			int isDelta;
+			ASSERT_EQ(fread(&timeMs, sizeof(long long), 1, fid), 1);
+			ASSERT_EQ(fread(&isDelta, sizeof(int), 1, fid), 1);
+			EXPECT_EQ(timeMs, s*100);
+			EXPECT_EQ(isDelta, (s % KEYFRAME_INTERVAL) != 0);
+			if (isDelta) {
+				int nChanged;
+				ASSERT_EQ(fread(&nChanged, sizeof(int), 1, fid), 1);
+				if (lossy) {
+					EXPECT_LE(nChanged, numChanged[s-1]);
+				} else {
+					EXPECT_EQ(nChanged, numChanged[s-1]);
+				}
+				std::vector<int> idx(nChanged);
+				std::vector<float> val(nChanged);
+				if (nChanged > 0) {
+					ASSERT_EQ(fread(&idx[0], sizeof(int), nChanged, fid), nChanged);
+					ASSERT_EQ(fread(&val[0], sizeof(float), nChanged, fid), nChanged);
+				}
+				for (int k = 0; k < nChanged; k++)
+					wtFile[idx[k]] = val[k];
+			} else {
+				ASSERT_EQ(fread(&wtFile[0], sizeof(float), nSyn, fid), nSyn);
+			}
+
+			for (int pos = 0; pos < nSyn; pos++) {
+				if (lossy) {
+					EXPECT_NEAR(wtFile[pos], wtTaken[s][pos], minAbsChange[lossy] + 1e-6f);
+				} else {
+					EXPECT_FLOAT_EQ(wtFile[pos], wtTaken[s][pos]);
+				}
+			}
+		}
+
+		// the snapshot taken at the end of the simulation has already been stored
+		char c;
+		EXPECT_EQ(fread(&c, 1, 1, fid), 0);
+		fclose(fid);
+	}
+}
@@ -50,6 +50,7 @@
 
 #include <carlsim.h>
 #include <vector>
+#include <algorithm> // std::min_element
 #include <math.h> // sqrt
 
 /// **************************************************************************************************************** ///
@@ -199,6 +200,53 @@ TEST(Connect, connectRandom) {
 }
 
 
+//! Unrestricted random connections draw the gaps between the synapses of a pre-synaptic neuron (skip sampling). Every
+//! pair must still be connected with the connection probability: check the number of synapses, their distribution over
+//! the post-synaptic neurons, and the limit p=1 (full connectivity).
+TEST(Connect, connectRandomSkipSampling) {
+	int numPre = 200, numPost = 1000;
+	float prob[2] = {0.05f, 1.0f};
+
+	for (int i = 0; i < 2; i++) {
+		CARLsim* sim = new CARLsim("Connect.connectRandomSkipSampling", CPU_MODE, SILENT, 0, 42);
+		int gIn = sim->createSpikeGeneratorGroup("input", numPre, EXCITATORY_NEURON);
+		int gOut = sim->createGroup("output", numPost, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		int c0 = sim->connect(gIn, gOut, "random", RangeWeight(0.1f), prob[i], RangeDelay(1, 10), RadiusRF(-1));
+		sim->setConductances(false);
+		sim->setupNetwork();
+
+		ConnectionMonitor* cm = sim->setConnectionMonitor(gIn, gOut, "NULL");
+		std::vector< std::vector<float> > wt = cm->takeSnapshot();
+		int numSynapses = 0;
+		std::vector<int> numPreOfPost(numPost, 0);
+		for (int pre = 0; pre < numPre; pre++) {
+			for (int post = 0; post < numPost; post++) {
+				if (!isnan(wt[pre][post])) {
+					numPreOfPost[post]++;
+					numSynapses++;
+				}
+			}
+		}
+		EXPECT_EQ(numSynapses, sim->getNumSynapticConnections(c0));
+
+		double expected = prob[i] * numPre * numPost;
+		double errorMargin = 7.5 * sqrt(prob[i] * (1 - prob[i]) * numPre * numPost) + 0.5;
+		EXPECT_NEAR(numSynapses, expected, errorMargin);
+
+		// the synapses are spread evenly over the post-synaptic neurons (no bias towards the first or last ones)
+		int numFirstHalf = 0;
+		for (int post = 0; post < numPost / 2; post++)
+			numFirstHalf += numPreOfPost[post];
+		EXPECT_NEAR(numFirstHalf, expected / 2, errorMargin / 2 + 0.5);
+		if (prob[i] == 1.0f) {
+			EXPECT_EQ(*std::min_element(numPreOfPost.begin(), numPreOfPost.end()), numPre);
+		}
+
+		delete sim;
+	}
+}
+
 TEST(Connect, connectGaussian) {
 	CARLsim* sim = NULL;
 
@@ -388,3 +436,141 @@ TEST(Connect, connectGaussian) {
 		}
 	}
 }
+
+//! CPU runtimes store the neuron ids of synapses as 16-bit offsets to the base id of a block of synapses, unless the
+//! ids of a block span more than 16 bits. Check that spikes are delivered to the right neurons and that the
+//! connectivity is restored correctly in a group that is large enough to have both kinds of blocks.
+TEST(Connect, compactSynapsesLargeGroup) {
+	int nIn = 4, nOut = 150000;
+	CARLsim sim("Connect.compactSynapsesLargeGroup", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim.createSpikeGeneratorGroup("input", nIn, EXCITATORY_NEURON);
+	int gOut = sim.createGroup("output", nOut, EXCITATORY_NEURON);
+	sim.setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim.connect(gIn, gOut, "random", RangeWeight(200.0f), 0.0003f, RangeDelay(1, 5));
+	sim.setConductances(false);
+	sim.setupNetwork();
+
+	ConnectionMonitor* connMon = sim.setConnectionMonitor(gIn, gOut, "NULL");
+	SpikeMonitor* spkMon = sim.setSpikeMonitor(gOut, "NULL");
+
+	// every input neuron fires exactly once
+	PoissonRate rate(nIn, false);
+	rate.setRates(1000.0f);
+	sim.setSpikeRate(gIn, &rate);
+	sim.runNetwork(0, 1);
+	rate.setRates(0.0f);
+	sim.setSpikeRate(gIn, &rate);
+
+	spkMon->startRecording();
+	sim.runNetwork(0, 20);
+	spkMon->stopRecording();
+
+	std::vector< std::vector<float> > wt = connMon->takeSnapshot();
+	std::vector< std::vector<int> > spkTimes = spkMon->getSpikeVector2D();
+	int numSynapses = 0;
+	for (int j = 0; j < nOut; j++) {
+		bool hasSynapse = false;
+		for (int i = 0; i < nIn; i++) {
+			if (!isnan(wt[i][j])) {
+				EXPECT_FLOAT_EQ(wt[i][j], 200.0f);
+				hasSynapse = true;
+				numSynapses++;
+			}
+		}
+
+		// a neuron fires iff it receives an input spike
+		EXPECT_EQ(spkTimes[j].size() > 0, hasSynapse);
+	}
+	EXPECT_EQ(numSynapses, connMon->getNumSynapses());
+	EXPECT_GT(numSynapses, 0);
+}
+
+//! The network generated by several connection threads is the same as the one generated by a single thread, including
+//! the order of the synapses in the runtime arrays (compared via network images).
+TEST(Connect, connectionThreadsSameNetwork) {
+	std::vector<char> image[2];
+	for (int run = 0; run < 2; run++) {
+		CARLsim* sim = new CARLsim("Connect.connectionThreadsSameNetwork", CPU_MODE, SILENT, 0, 42);
+		Grid3D grid(10, 10, 1);
+		int gExc = sim->createGroup("exc", grid, EXCITATORY_NEURON, 0, CPU_CORES);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gInh = sim->createGroup("inh", grid, INHIBITORY_NEURON, 1, CPU_CORES); // external connections
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gInput = sim->createSpikeGeneratorGroup("input", grid, EXCITATORY_NEURON, 0, CPU_CORES);
+
+		sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.1f, RangeDelay(1, 10), RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(gExc, gExc, "full-no-direct", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5), RadiusRF(3, 3, -1));
+		sim->connect(gExc, gInh, "gaussian", RangeWeight(0.2f), 0.5f, RangeDelay(1, 3), RadiusRF(4, 4, 0));
+		sim->connect(gInh, gExc, "one-to-one", RangeWeight(0.3f), 1.0f, RangeDelay(2));
+		sim->connect(gInput, gInh, "random", RangeWeight(0.2f), 0.2f, RangeDelay(1, 20), RadiusRF(5, 5, -1));
+		sim->setConductances(false);
+		sim->setNumConnectionThreads(run == 0 ? 1 : 3);
+		sim->setupNetwork();
+		sim->saveSimulation("results/conn_threads.dat", true);
+		delete sim;
+
+		FILE* fid = fopen("results/conn_threads.dat", "rb");
+		ASSERT_TRUE(fid != NULL);
+		char buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), fid)) > 0)
+			image[run].insert(image[run].end(), buf, buf + n);
+		fclose(fid);
+	}
+
+	EXPECT_GT(image[0].size(), 0);
+	EXPECT_TRUE(image[0] == image[1]);
+}
+
+//! Connections with a receptive field only visit the post-synaptic neurons in the bounding box of the RF. Check every
+//! pair against the RF (3D ellipsoid) for grids with non-unit distances and offsets, and for pre- and post-synaptic
+//! groups of different sizes (Gaussian connections scale the pre-synaptic locations to the post-synaptic grid).
+TEST(Connect, connectRFBoundingBox) {
+	CARLsim* sim = new CARLsim("Connect.connectRFBoundingBox", CPU_MODE, SILENT, 0, 42);
+	Grid3D gridIn(12, 0.5f, -2.0f, 9, 1.5f, 3.0f, 2, 2.0f, 0.0f);
+	Grid3D gridOut(7, 1.0f, -1.0f, 6, 2.0f, 4.0f, 3, 1.0f, 0.5f);
+	int gIn = sim->createSpikeGeneratorGroup("input", gridIn, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("output", gridOut, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gOut2 = sim->createGroup("output2", gridIn, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut2, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gOut3 = sim->createGroup("output3", gridOut, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut3, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	RadiusRF radius[3] = {RadiusRF(2.5, 3.0, -1), RadiusRF(1.75, 0, 2.0), RadiusRF(3.0, 4.0, 1.0)};
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1), radius[0]);
+	sim->connect(gIn, gOut2, "random", RangeWeight(0.1f), 1.0f, RangeDelay(1), radius[1]);
+	sim->connect(gIn, gOut3, "gaussian", RangeWeight(0.1f), 1.0f, RangeDelay(1), radius[2]);
+	sim->setConductances(false);
+	sim->setupNetwork();
+
+	int post[3] = {gOut, gOut2, gOut3};
+	for (int c = 0; c < 3; c++) {
+		Grid3D gridPost = sim->getGroupGrid3D(post[c]);
+		Point3D scalePre = (c == 2) ? Point3D(gridPost.numX, gridPost.numY, gridPost.numZ)
+			/ Point3D(gridIn.numX, gridIn.numY, gridIn.numZ) : Point3D(1, 1, 1);
+
+		ConnectionMonitor* cm = sim->setConnectionMonitor(gIn, post[c], "NULL");
+		std::vector< std::vector<float> > wt = cm->takeSnapshot();
+		int numSynapses = 0;
+		for (int i = 0; i < gridIn.N; i++) {
+			Point3D pre = sim->getNeuronLocation3D(gIn, i) * scalePre;
+			for (int j = 0; j < gridPost.N; j++) {
+				Point3D loc = sim->getNeuronLocation3D(post[c], j);
+				const RadiusRF& r = radius[c];
+				bool inRF = !(r.radX == 0 && pre.x != loc.x || r.radY == 0 && pre.y != loc.y
+					|| r.radZ == 0 && pre.z != loc.z);
+				double rfDist = ((r.radX <= 0) ? 0.0 : pow(pre.x - loc.x, 2) / pow(r.radX, 2))
+					+ ((r.radY <= 0) ? 0.0 : pow(pre.y - loc.y, 2) / pow(r.radY, 2))
+					+ ((r.radZ <= 0) ? 0.0 : pow(pre.z - loc.z, 2) / pow(r.radZ, 2));
+				inRF = inRF && rfDist <= 1.0 && (c < 2 || exp(-2.3026 * rfDist) >= 0.1);
+
+				EXPECT_EQ(!isnan(wt[i][j]), inRF);
+				numSynapses += inRF ? 1 : 0;
+			}
+		}
+		EXPECT_GT(numSynapses, 0);
+		EXPECT_LT(numSynapses, gridIn.N * gridPost.N);
+	}
+	delete sim;
+}
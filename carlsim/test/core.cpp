@@ -52,6 +52,9 @@
 #include <vector>
 
 #include <periodic_spikegen.h>
+#include <weight_precision.h>
+#include <checkpoint_writer.h>
+#include <monitor_file_writer.h>
 
 
 /// **************************************************************************************************************** ///
@@ -208,6 +211,59 @@ TEST(Core, setExternalCurrent) {
 	}
 }
 
+// make sure groups with shared neuron parameters (zero standard deviations) and groups with per-neuron parameters
+// are integrated the same way on CPU
+TEST(Core, sharedNeuronParameters) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	int nNeur = 10;
+	for (int model = 0; model < 3; model++) {
+		CARLsim* sim = new CARLsim("Core.sharedNeuronParameters", CPU_MODE, SILENT, 1, 42);
+		int gShared, gHetero;
+		if (model == 0) {
+			gShared = sim->createGroup("shared", nNeur, EXCITATORY_NEURON);
+			gHetero = sim->createGroup("hetero", nNeur, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gShared, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->setNeuronParameters(gHetero, 0.02f, 1e-6f, 0.2f, 1e-6f, -65.0f, 1e-4f, 8.0f, 1e-4f);
+		} else if (model == 1) {
+			gShared = sim->createGroup("shared", nNeur, EXCITATORY_NEURON);
+			gHetero = sim->createGroup("hetero", nNeur, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gShared, 100.0f, 0.7f, -60.0f, -40.0f, 0.03f, -2.0f, 35.0f, -50.0f, 100.0f);
+			sim->setNeuronParameters(gHetero, 100.0f, 1e-4f, 0.7f, 1e-6f, -60.0f, 1e-4f, -40.0f, 1e-4f,
+				0.03f, 1e-6f, -2.0f, 1e-6f, 35.0f, 1e-4f, -50.0f, 1e-4f, 100.0f, 1e-4f);
+		} else {
+			gShared = sim->createGroupLIF("shared", nNeur, EXCITATORY_NEURON);
+			gHetero = sim->createGroupLIF("hetero", nNeur, EXCITATORY_NEURON);
+			sim->setNeuronParametersLIF(gShared, 10, 2, -50.0f, -65.0f, RangeRmem(5.0f));
+			sim->setNeuronParametersLIF(gHetero, 10, 2, -50.0f, -65.0f, RangeRmem(5.0f, 5.0f + 1e-6f));
+		}
+		int gIn = sim->createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+		sim->connect(gIn, gShared, "one-to-one", RangeWeight(0.1f), 1.0f);
+		sim->connect(gIn, gHetero, "one-to-one", RangeWeight(0.1f), 1.0f);
+		sim->setConductances(false);
+		sim->setupNetwork();
+
+		SpikeMonitor* smShared = sim->setSpikeMonitor(gShared, "NULL");
+		SpikeMonitor* smHetero = sim->setSpikeMonitor(gHetero, "NULL");
+
+		float current = (model == 2) ? 4.0f : ((model == 1) ? 100.0f : 7.0f);
+		sim->setExternalCurrent(gShared, current);
+		sim->setExternalCurrent(gHetero, current);
+		smShared->startRecording();
+		smHetero->startRecording();
+		sim->runNetwork(1, 0);
+		smShared->stopRecording();
+		smHetero->stopRecording();
+
+		EXPECT_GT(smShared->getPopNumSpikes(), 0);
+		for (int i = 0; i < nNeur; i++) {
+			EXPECT_EQ(smHetero->getNeuronNumSpikes(i), smShared->getNeuronNumSpikes(i));
+		}
+
+		delete sim;
+	}
+}
+
 TEST(Core, biasWeights) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -491,6 +547,65 @@ TEST(Core, numNeurons) {
 	EXPECT_EQ(sim.getNumNeuronsGen(), sim.getNumNeuronsGenExc() + sim.getNumNeuronsGenInh());
 }
 
+//! a spike generator that makes every neuron of its group fire once, at a fixed time
+class SingleSpikeGenerator : public SpikeGenerator {
+public:
+	SingleSpikeGenerator(int spikeTime) : spikeTime_(spikeTime) {}
+
+	int nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime,
+		int endOfTimeSlice) {
+		return (lastScheduledSpikeTime < spikeTime_ && spikeTime_ < endOfTimeSlice) ? spikeTime_ : -1;
+	}
+
+private:
+	int spikeTime_;
+};
+
+//! Spikes with a delay > 1 ms that are still in flight at the end of a second are moved to the beginning of the
+//! firing table (shiftSpikeTables). Every output neuron has to receive the spike of its own input neuron, also when
+//! another input neuron fired in the ms just before the shifted range (a regression test: the range was taken from
+//! timeTableD2[999] instead of timeTableD2[1000], so the spike of neuron inA was delivered in place of inB's).
+TEST(Core, shiftSpikeTablesDelayedSpikes) {
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		CARLsim* sim = new CARLsim("Core.shiftSpikeTablesDelayedSpikes", mode ? GPU_MODE : CPU_MODE, SILENT, 1, 42);
+		int gOutA = sim->createGroup("outA", 1, EXCITATORY_NEURON);
+		int gOutB = sim->createGroup("outB", 1, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOutA, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(gOutB, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gInA = sim->createSpikeGeneratorGroup("inA", 1, EXCITATORY_NEURON);
+		int gInB = sim->createSpikeGeneratorGroup("inB", 1, EXCITATORY_NEURON);
+
+		// the spikes of the last 20 ms of a second are shifted: inA fires in the ms before, inB within
+		SingleSpikeGenerator spkGenA(979), spkGenB(990);
+		sim->setSpikeGenerator(gInA, &spkGenA);
+		sim->setSpikeGenerator(gInB, &spkGenB);
+		sim->connect(gInA, gOutA, "full", RangeWeight(100.0f), 1.0f, RangeDelay(20));
+		sim->connect(gInB, gOutB, "full", RangeWeight(100.0f), 1.0f, RangeDelay(20));
+		sim->setConductances(false);
+		sim->setupNetwork();
+
+		SpikeMonitor* spkMonA = sim->setSpikeMonitor(gOutA, "NULL");
+		SpikeMonitor* spkMonB = sim->setSpikeMonitor(gOutB, "NULL");
+		spkMonA->startRecording();
+		spkMonB->startRecording();
+		sim->runNetwork(2, 0);
+		spkMonA->stopRecording();
+		spkMonB->stopRecording();
+
+		// outA receives its spike at 999 ms, outB at 1010 ms
+		std::vector<std::vector<int> > spkA = spkMonA->getSpikeVector2D();
+		std::vector<std::vector<int> > spkB = spkMonB->getSpikeVector2D();
+		ASSERT_EQ(spkA[0].size(), 1);
+		ASSERT_EQ(spkB[0].size(), 1);
+		EXPECT_GE(spkA[0][0], 999);
+		EXPECT_LT(spkA[0][0], 1010);
+		EXPECT_GE(spkB[0][0], 1010);
+		EXPECT_LT(spkB[0][0], 1020);
+
+		delete sim;
+	}
+}
+
 TEST(Core, startStopTestingPhase) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -637,6 +752,450 @@ TEST(Core, saveLoadSimulation) {
 	}
 }
 
+//! connects neuron i to neuron j with a weight that depends on both ids, and counts the callbacks
+class CountingConnGen : public ConnectionGenerator {
+public:
+	CountingConnGen() : numCalls(0) {}
+
+	void connect(CARLsim* net, int srcGrp, int i, int destGrp, int j, float& weight, float& maxWt, float& delay,
+		bool& connected) {
+		numCalls++;
+		connected = (i + j) % 3 != 0;
+		weight = 0.01f * ((i * 7 + j) % 11);
+		maxWt = 0.2f;
+		delay = 1 + (i + 2 * j) % 8;
+	}
+
+	int numCalls;
+};
+
+//! A network loaded from an image has the same synapses, weights, and delays as the network that was saved, and
+//! produces the same spikes when run with the same seed and input.
+TEST(Core, loadSimulationSameAsGenerated) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		int numSynapses[2];
+		std::vector<std::vector<float> > weights[2];
+		std::vector<uint8_t> delays[2];
+		std::vector<std::vector<int> > spikesExc[2];
+		std::vector<std::vector<int> > spikesInh[2];
+
+		for (int loadSim = 0; loadSim <= 1; loadSim++) {
+			CARLsim* sim = new CARLsim("Core.loadSimulationSameAsGenerated", mode?GPU_MODE:CPU_MODE, SILENT, 1, 42);
+			int gExc = sim->createGroup("exc", 80, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+			int gInh = sim->createGroup("inh", 20, INHIBITORY_NEURON);
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+			int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON);
+
+			sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.1f, RangeDelay(1, 5), RadiusRF(-1), SYN_PLASTIC);
+			sim->connect(gExc, gExc, "random", RangeWeight(0.2f), 0.1f, RangeDelay(1, 10), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gExc, gInh, "random", RangeWeight(0.5f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gInh, gExc, "random", RangeWeight(0.5f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0012f, 20.0f);
+			sim->setConductances(true);
+
+			FILE* simFid = NULL;
+			if (loadSim) {
+				simFid = fopen("results/image.dat", "rb");
+				sim->loadSimulation(simFid);
+			}
+
+			sim->setupNetwork();
+
+			if (!loadSim)
+				sim->saveSimulation("results/image.dat", true);
+
+			numSynapses[loadSim] = sim->getNumSynapses();
+			ConnectionMonitor* cm = sim->setConnectionMonitor(gInput, gExc, "NULL");
+			weights[loadSim] = cm->takeSnapshot();
+			int numPreN, numPostN;
+			uint8_t* d = sim->getDelays(gExc, gExc, numPreN, numPostN);
+			delays[loadSim].assign(d, d + numPreN * numPostN);
+			delete[] d;
+
+			SpikeMonitor* smExc = sim->setSpikeMonitor(gExc, "NULL");
+			SpikeMonitor* smInh = sim->setSpikeMonitor(gInh, "NULL");
+			PoissonRate in(100);
+			in.setRates(20.0f);
+			sim->setSpikeRate(gInput, &in);
+
+			smExc->startRecording();
+			smInh->startRecording();
+			sim->runNetwork(1, 0, false);
+			smExc->stopRecording();
+			smInh->stopRecording();
+			spikesExc[loadSim] = smExc->getSpikeVector2D();
+			spikesInh[loadSim] = smInh->getSpikeVector2D();
+
+			if (simFid != NULL) fclose(simFid);
+			delete sim;
+		}
+
+		EXPECT_EQ(numSynapses[0], numSynapses[1]);
+		for (int i = 0; i < weights[0].size(); i++) {
+			for (int j = 0; j < weights[0][i].size(); j++) {
+				if (isnan(weights[0][i][j])) {
+					EXPECT_TRUE(isnan(weights[1][i][j]));
+				} else {
+					EXPECT_FLOAT_EQ(weights[0][i][j], weights[1][i][j]);
+				}
+			}
+		}
+		EXPECT_TRUE(delays[0] == delays[1]);
+		EXPECT_GT(spikesExc[0].size(), 0);
+		EXPECT_TRUE(spikesExc[0] == spikesExc[1]);
+		EXPECT_TRUE(spikesInh[0] == spikesInh[1]);
+	}
+}
+
+//! Loading an image skips the ConnectionGenerator callbacks, and restores weights that were changed after setup.
+TEST(Core, loadSimulationSkipsConnectionGeneration) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		std::vector<std::vector<float> > weightsSave;
+
+		for (int loadSim = 0; loadSim <= 1; loadSim++) {
+			CountingConnGen connGen;
+			CARLsim* sim = new CARLsim("Core.loadSimulationSkipsConnectionGeneration", mode?GPU_MODE:CPU_MODE, SILENT, 1, 42);
+			int gOut = sim->createGroup("out", 20, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+			int gIn = sim->createSpikeGeneratorGroup("in", 30, EXCITATORY_NEURON);
+			short int c = sim->connect(gIn, gOut, &connGen, SYN_PLASTIC);
+			sim->setConductances(false);
+
+			FILE* simFid = NULL;
+			if (loadSim) {
+				simFid = fopen("results/image.dat", "rb");
+				sim->loadSimulation(simFid);
+			}
+
+			sim->setupNetwork();
+			ConnectionMonitor* cm = sim->setConnectionMonitor(gIn, gOut, "NULL");
+
+			if (!loadSim) {
+				EXPECT_EQ(connGen.numCalls, 30 * 20);
+
+				// change the weights after setup, as training would
+				sim->scaleWeights(c, 0.5f, false);
+				sim->setWeight(c, 1, 2, 0.123f, false);
+				sim->runNetwork(0, 1, false);
+				weightsSave = cm->takeSnapshot();
+				sim->saveSimulation("results/image.dat", true);
+			} else {
+				EXPECT_EQ(connGen.numCalls, 0);
+
+				sim->runNetwork(0, 1, false);
+				std::vector<std::vector<float> > weightsLoad = cm->takeSnapshot();
+				for (int i = 0; i < 30; i++) {
+					for (int j = 0; j < 20; j++) {
+						if (isnan(weightsSave[i][j])) {
+							EXPECT_TRUE(isnan(weightsLoad[i][j]));
+						} else {
+							EXPECT_FLOAT_EQ(weightsSave[i][j], weightsLoad[i][j]);
+						}
+					}
+				}
+			}
+
+			if (simFid != NULL) fclose(simFid);
+			delete sim;
+		}
+	}
+}
+
+//! An image cannot be loaded into a network that was configured differently, or that was saved without synapses.
+TEST(Core, loadSimulationDeath) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	for (int saveSynapseInfo = 0; saveSynapseInfo <= 1; saveSynapseInfo++) {
+		CARLsim* sim = new CARLsim("Core.loadSimulationDeath", CPU_MODE, SILENT, 1, 42);
+		int gOut = sim->createGroup("out", 10, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+		sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+		sim->setupNetwork();
+		sim->saveSimulation(saveSynapseInfo ? "results/image.dat" : "results/image_nosyn.dat", saveSynapseInfo > 0);
+		delete sim;
+	}
+
+	// different number of neurons
+	CARLsim* sim = new CARLsim("Core.loadSimulationDeath", CPU_MODE, SILENT, 1, 42);
+	int gOut = sim->createGroup("out", 11, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	FILE* simFid = fopen("results/image.dat", "rb");
+	sim->loadSimulation(simFid);
+	EXPECT_DEATH({sim->setupNetwork();},"");
+	fclose(simFid);
+	delete sim;
+
+	// different connection delays
+	sim = new CARLsim("Core.loadSimulationDeath", CPU_MODE, SILENT, 1, 42);
+	gOut = sim->createGroup("out", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 4));
+	simFid = fopen("results/image.dat", "rb");
+	sim->loadSimulation(simFid);
+	EXPECT_DEATH({sim->setupNetwork();},"");
+	fclose(simFid);
+	delete sim;
+
+	// image without synapses
+	sim = new CARLsim("Core.loadSimulationDeath", CPU_MODE, SILENT, 1, 42);
+	gOut = sim->createGroup("out", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	simFid = fopen("results/image_nosyn.dat", "rb");
+	sim->loadSimulation(simFid);
+	EXPECT_DEATH({sim->setupNetwork();},"");
+	fclose(simFid);
+	delete sim;
+}
+
+//! A plastic network resumed from a checkpoint produces the same spikes and weights as the uninterrupted simulation.
+TEST(Core, checkpointResumeSameAsUninterrupted) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::vector<std::vector<int> > spikes[2];
+	std::vector<std::vector<float> > weights[2];
+	int simTimeResumed = 0;
+	int numSpikes = 0;
+	std::string checkpointDir = createTempDir("Core.checkpointResumeSameAsUninterrupted");
+
+	for (int resume = 0; resume <= 1; resume++) {
+		CARLsim* sim = new CARLsim("Core.checkpointResumeSameAsUninterrupted", CPU_MODE, SILENT, 1, 42);
+		int gExc = sim->createGroup("exc", 80, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gInh = sim->createGroup("inh", 20, INHIBITORY_NEURON);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON);
+
+		sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.1f, RangeDelay(1, 5), RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(gExc, gExc, "random", RangeWeight(0.2f), 0.1f, RangeDelay(1, 10), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gInh, "random", RangeWeight(0.5f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc, "random", RangeWeight(0.5f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0012f, 20.0f);
+		sim->setConductances(true);
+
+		if (!resume)
+			sim->setCheckpoint(2, checkpointDir);
+
+		sim->setupNetwork();
+		ConnectionMonitor* cm = sim->setConnectionMonitor(gInput, gExc, "NULL");
+		SpikeMonitor* sm = sim->setSpikeMonitor(gExc, "NULL");
+		PoissonRate in(100);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gInput, &in);
+
+		if (!resume) {
+			// the checkpoint is taken at t=2s, the next one would be at t=4s
+			sim->runNetwork(2, 0, false);
+		} else {
+			sim->loadCheckpoint(checkpointDir);
+			simTimeResumed = sim->getSimTime();
+		}
+
+		sm->startRecording();
+		sim->runNetwork(1, 500, false);
+		sm->stopRecording();
+		spikes[resume] = sm->getSpikeVector2D();
+		numSpikes = sm->getPopNumSpikes();
+		sim->runNetwork(0, 1, false); // update the weights of the manager
+		weights[resume] = cm->takeSnapshot();
+
+		delete sim;
+	}
+	removeTempDir(checkpointDir);
+
+	EXPECT_EQ(simTimeResumed, 2000);
+	EXPECT_GT(numSpikes, 0);
+	EXPECT_TRUE(spikes[0] == spikes[1]);
+	for (int i = 0; i < weights[0].size(); i++) {
+		for (int j = 0; j < weights[0][i].size(); j++) {
+			if (isnan(weights[0][i][j])) {
+				EXPECT_TRUE(isnan(weights[1][i][j]));
+			} else {
+				EXPECT_FLOAT_EQ(weights[0][i][j], weights[1][i][j]);
+			}
+		}
+	}
+}
+
+//! A maximum weight raised by setWeight between two checkpoints is restored from the second checkpoint.
+TEST(Core, checkpointAfterSetWeight) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::vector<std::vector<float> > weights[2];
+	std::string checkpointDir = createTempDir("Core.checkpointAfterSetWeight");
+
+	for (int resume = 0; resume <= 1; resume++) {
+		CARLsim* sim = new CARLsim("Core.checkpointAfterSetWeight", CPU_MODE, SILENT, 1, 42);
+		int gOut = sim->createGroup("out", 10, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+		sim->connect(gIn, gOut, "full", RangeWeight(5.0f), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		short int c = sim->connect(gOut, gOut, "full", RangeWeight(0.0f, 5.0f, 10.0f), 1.0f, RangeDelay(1), RadiusRF(-1),
+			SYN_PLASTIC);
+		sim->setSTDP(gOut, true, STANDARD, 0.001f, 20.0f, 0.0012f, 20.0f);
+		sim->setWeightAndWeightChangeUpdate(INTERVAL_10MS, true, 0.9f);
+		sim->setConductances(false);
+
+		if (!resume)
+			sim->setCheckpoint(1, checkpointDir);
+
+		sim->setupNetwork();
+		ConnectionMonitor* cm = sim->setConnectionMonitor(gOut, gOut, "NULL");
+		PoissonRate in(10);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		if (!resume) {
+			// the first checkpoint is taken at t=1s, before the maximum weight of a single synapse is raised
+			sim->runNetwork(1, 0, false);
+			sim->setWeight(c, 1, 0, 20.0f, true);
+			sim->runNetwork(1, 0, false);
+		} else {
+			sim->loadCheckpoint(checkpointDir);
+		}
+
+		// the weight of the synapse is clamped to its maximum weight by every weight update
+		sim->runNetwork(0, 500, false);
+		weights[resume] = cm->takeSnapshot();
+
+		delete sim;
+	}
+	removeTempDir(checkpointDir);
+
+	EXPECT_GT(weights[0][1][0], 10.0f);
+	for (int i = 0; i < weights[0].size(); i++) {
+		for (int j = 0; j < weights[0][i].size(); j++)
+			EXPECT_FLOAT_EQ(weights[0][i][j], weights[1][i][j]);
+	}
+}
+
+//! After both data files have been written once, a checkpoint only writes the chunks that changed (also when a single
+//! byte changed), and the last complete checkpoint is read back.
+TEST(Core, checkpointWriterIncremental) {
+	std::vector<int> fixedWts(3 * CHECKPOINT_CHUNK_SIZE / sizeof(int), 7);
+	int state = 0;
+	std::string checkpointDir = createTempDir("Core.checkpointWriterIncremental");
+
+	CheckpointWriter* writer = new CheckpointWriter(checkpointDir);
+	writer->addArray("fixedWts", 0, sizeof(int) * fixedWts.size());
+	writer->addArray("state", -1, sizeof(int));
+
+	uint64_t bytesWritten[5];
+	for (int i = 0; i < 5; i++) {
+		state = 100 + i;
+		if (i == 4)
+			fixedWts[CHECKPOINT_CHUNK_SIZE / sizeof(int)] ^= 1; // first word of the second chunk
+		ASSERT_TRUE(writer->beginCheckpoint());
+		writer->setArray(0, &fixedWts[0]);
+		writer->setArray(1, &state);
+		writer->commitCheckpoint(1000 * i);
+		bytesWritten[i] = writer->getBytesWritten();
+	}
+	EXPECT_EQ(writer->getNumCheckpoints(), 5);
+	delete writer;
+
+	// the first checkpoint of each data file is complete, later ones only rewrite the chunk of the state, and the
+	// chunk of the changed weight
+	size_t dataSize = sizeof(int) * fixedWts.size() + 8;
+	EXPECT_EQ(bytesWritten[1], 2 * dataSize);
+	EXPECT_EQ(bytesWritten[2] - bytesWritten[1], dataSize - 3 * CHECKPOINT_CHUNK_SIZE);
+	EXPECT_EQ(bytesWritten[3] - bytesWritten[2], dataSize - 3 * CHECKPOINT_CHUNK_SIZE);
+	EXPECT_EQ(bytesWritten[4] - bytesWritten[3], dataSize - 2 * CHECKPOINT_CHUNK_SIZE);
+
+	CheckpointHeader header;
+	std::vector<CheckpointArrayInfo> arrays;
+	std::vector<char> data;
+	bool readOk = CheckpointWriter::read(checkpointDir, header, arrays, data);
+	removeTempDir(checkpointDir);
+	ASSERT_TRUE(readOk);
+	EXPECT_EQ(header.simTime, 4000);
+	ASSERT_EQ(arrays.size(), 2);
+	EXPECT_STREQ(arrays[1].name, "state");
+	EXPECT_EQ(*(int*)&data[arrays[1].offset], 104);
+	EXPECT_EQ(((int*)&data[arrays[0].offset])[CHECKPOINT_CHUNK_SIZE / sizeof(int)], 6);
+	EXPECT_EQ(((int*)&data[arrays[0].offset])[fixedWts.size() - 1], 7);
+}
+
+//! The background writer of the monitor files writes interleaved records of several files in order, also when the
+//! records exceed the block size and the writer has to wait for the disk.
+TEST(Core, monitorFileWriterOrder) {
+	const int numRecords = 3 * MONITOR_WRITER_BLOCK_SIZE / sizeof(int);
+	FILE* fids[2];
+	fids[0] = fopen("results/monitor_writer0.dat", "wb");
+	fids[1] = fopen("results/monitor_writer1.dat", "wb");
+	ASSERT_TRUE(fids[0] != NULL && fids[1] != NULL);
+
+	MonitorFileWriter* writer = new MonitorFileWriter();
+	for (int i = 0; i < numRecords; i++) {
+		int record = (i % 2 == 0) ? i : -i;
+		writer->write(fids[i % 2], &record, sizeof(int));
+		if (i % 100000 == 0)
+			writer->flush(fids[i % 2]);
+	}
+	EXPECT_TRUE(writer->sync());
+	EXPECT_EQ(writer->getBytesWritten(), numRecords * sizeof(int));
+	delete writer;
+	fclose(fids[0]);
+	fclose(fids[1]);
+
+	for (int f = 0; f < 2; f++) {
+		FILE* fid = fopen(f == 0 ? "results/monitor_writer0.dat" : "results/monitor_writer1.dat", "rb");
+		ASSERT_TRUE(fid != NULL);
+		std::vector<int> records(numRecords / 2 + 1);
+		size_t numRead = fread(&records[0], sizeof(int), records.size(), fid);
+		fclose(fid);
+		ASSERT_EQ(numRead, numRecords / 2);
+		for (int j = 0; j < numRead; j++)
+			ASSERT_EQ(records[j], (f == 0) ? 2 * j : -(2 * j + 1));
+	}
+}
+
+//! A checkpoint cannot be loaded into a different network, or from a directory without a checkpoint.
+TEST(Core, loadCheckpointDeath) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	std::string checkpointDir = createTempDir("Core.loadCheckpointDeath");
+
+	CARLsim* sim = new CARLsim("Core.loadCheckpointDeath", CPU_MODE, SILENT, 1, 42);
+	int gOut = sim->createGroup("out", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	sim->setConductances(false);
+	sim->setCheckpoint(1, checkpointDir);
+	sim->setupNetwork();
+	sim->runNetwork(1, 0, false);
+	delete sim;
+
+	// different number of neurons
+	sim = new CARLsim("Core.loadCheckpointDeath", CPU_MODE, SILENT, 1, 42);
+	gOut = sim->createGroup("out", 11, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	gIn = sim->createSpikeGeneratorGroup("in", 10, EXCITATORY_NEURON);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	sim->setupNetwork();
+	EXPECT_DEATH({sim->loadCheckpoint(checkpointDir);},"");
+	EXPECT_DEATH({sim->loadCheckpoint(checkpointDir + "/no_such_dir");},"");
+	delete sim;
+
+	// directory does not exist
+	sim = new CARLsim("Core.loadCheckpointDeath", CPU_MODE, SILENT, 1, 42);
+	EXPECT_DEATH({sim->setCheckpoint(1, checkpointDir + "/no_such_dir");},"");
+	EXPECT_DEATH({sim->setCheckpoint(0, checkpointDir);},"");
+	delete sim;
+	removeTempDir(checkpointDir);
+}
+
 TEST(Core, synapseIdOverflow) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -651,3 +1210,164 @@ TEST(Core, synapseIdOverflow) {
 	
 	EXPECT_DEATH({ sim.setupNetwork(); }, ""); //sim.setupNetwork();
 }
+
+//! Every fp16 and bfloat16 code (except NaN) converts to a float and back to the same code, floats round to the
+//! nearest code, and values beyond the range of a format saturate.
+TEST(Core, weightPrecisionConversion) {
+	for (int code = 0; code < 65536; code++) {
+		uint16_t h = (uint16_t)code;
+		if ((h & 0x7c00) != 0x7c00 || (h & 0x3ff) == 0) {
+			EXPECT_EQ(floatToHalf(halfToFloat(h)), h);
+		}
+		if ((h & 0x7f80) != 0x7f80 || (h & 0x7f) == 0) {
+			EXPECT_EQ(floatToBFloat16(bFloat16ToFloat(h)), h);
+		}
+	}
+
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(65504.0f)), 65504.0f);
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(1e6f)), 65504.0f);
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(-1e6f)), -65504.0f);
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(1.0f + 1.0f / 2048)), 1.0f); // tie, rounds to even
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(1.0f + 3.0f / 2048)), 1.0f + 1.0f / 512); // tie, rounds to even
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(1.0f + 3.0f / 4096)), 1.0f + 1.0f / 1024);
+	EXPECT_FLOAT_EQ(halfToFloat(floatToHalf(1e-8f)), 0.0f);
+	EXPECT_FLOAT_EQ(bFloat16ToFloat(floatToBFloat16(1.0f + 1.0f / 256)), 1.0f); // tie, rounds to even
+	EXPECT_FLOAT_EQ(bFloat16ToFloat(floatToBFloat16(1e38f * 3.4f)), 3.3895314e38f);
+
+	srand48(42);
+	for (int i = 0; i < 10000; i++) {
+		float wt = (float)(drand48() * 200.0 - 100.0);
+		EXPECT_NEAR(halfToFloat(floatToHalf(wt)), wt, fabs(wt) / 2048);
+		EXPECT_NEAR(bFloat16ToFloat(floatToBFloat16(wt)), wt, fabs(wt) / 256);
+
+		float scale = getInt8WeightScale(100.0f);
+		EXPECT_NEAR(int8ToFloat(floatToInt8(wt, scale), scale), wt, scale / 2 * 1.0001f);
+	}
+	EXPECT_EQ(floatToInt8(1000.0f, getInt8WeightScale(100.0f)), 127);
+	EXPECT_EQ(floatToInt8(-1000.0f, getInt8WeightScale(100.0f)), -127);
+}
+
+// returns the largest error of a weight stored in a precision, where maxWt is the largest weight of the connection
+static float getWeightPrecisionTolerance(WeightPrecision precision, float wt, float maxWt) {
+	switch (precision) {
+	case WT_FP16:
+		return fabs(wt) / 2048;
+	case WT_BF16:
+		return fabs(wt) / 256;
+	case WT_INT8:
+		return maxWt / 127 / 2 * 1.0001f;
+	default:
+		return 0.0f;
+	}
+}
+
+//! setWeight, scaleWeights and biasWeights work on weights stored in reduced precision, and the ConnectionMonitor
+//! reports the rounded weights. Scaling an int8 connection beyond its range rescales the connection.
+TEST(Core, weightPrecisionSetWeight) {
+	int nNeur = 10;
+
+	for (int precision = WT_FP32; precision <= WT_INT8; precision++) {
+		for (int mixed = 0; mixed <= 2; mixed++) {
+			// a second connection to the same group of another precision (fp32, or another reduced precision) makes the
+			// runtime store the weights of each connection in a segment of its width
+			WeightPrecision precision1 = (WeightPrecision)precision;
+			if (mixed == 1)
+				precision1 = WT_FP32;
+			else if (mixed == 2)
+				precision1 = (precision == WT_INT8) ? WT_FP16 : WT_INT8;
+
+			CARLsim sim("Core.weightPrecisionSetWeight", CPU_MODE, SILENT, 0, 42);
+			int gIn = sim.createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+			int gOut = sim.createGroup("output", nNeur, EXCITATORY_NEURON);
+			sim.setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+			short int c0 = sim.connect(gOut, gOut, "full", RangeWeight(0.5f), 1.0f, RangeDelay(1), RadiusRF(-1),
+				SYN_FIXED, 1.0f, 1.0f, (WeightPrecision)precision);
+			sim.connect(gIn, gOut, "full", RangeWeight(0.3f), 1.0f, RangeDelay(1), RadiusRF(-1),
+				SYN_FIXED, 1.0f, 1.0f, precision1);
+			sim.setConductances(false);
+			sim.setupNetwork();
+
+			ConnectionMonitor* CM = sim.setConnectionMonitor(gOut, gOut, "NULL");
+			ConnectionMonitor* CM1 = sim.setConnectionMonitor(gIn, gOut, "NULL");
+			sim.runNetwork(0, 1);
+			for (int i = 0; i < nNeur; i++)
+				for (int j = 0; j < nNeur; j++)
+					sim.setWeight(c0, i, j, 0.5f * (i * nNeur + j) / (nNeur * nNeur), false);
+			sim.runNetwork(0, 10);
+
+			std::vector< std::vector<float> > wt = CM->takeSnapshot();
+			for (int i = 0; i < nNeur; i++) {
+				for (int j = 0; j < nNeur; j++) {
+					float expWt = 0.5f * (i * nNeur + j) / (nNeur * nNeur);
+					EXPECT_NEAR(wt[i][j], expWt, getWeightPrecisionTolerance((WeightPrecision)precision, expWt, 0.5f));
+				}
+			}
+			wt = CM1->takeSnapshot();
+			for (int i = 0; i < nNeur; i++) {
+				for (int j = 0; j < nNeur; j++)
+					EXPECT_NEAR(wt[i][j], 0.3f, getWeightPrecisionTolerance(precision1, 0.3f, 0.3f));
+			}
+
+			// scaling beyond the range of an int8 connection rescales it, every change rounds the weights again
+			sim.scaleWeights(c0, 3.0f, true);
+			sim.biasWeights(c0, 0.1f, true);
+			sim.runNetwork(0, 10);
+			wt = CM->takeSnapshot();
+			for (int i = 0; i < nNeur; i++) {
+				for (int j = 0; j < nNeur; j++) {
+					float setWt = 0.5f * (i * nNeur + j) / (nNeur * nNeur);
+					float expWt = 3.0f * setWt + 0.1f;
+					float tolerance = 3.0f * getWeightPrecisionTolerance((WeightPrecision)precision, setWt, 0.5f)
+						+ getWeightPrecisionTolerance((WeightPrecision)precision, 3.0f * setWt, 1.5f)
+						+ getWeightPrecisionTolerance((WeightPrecision)precision, expWt, 1.6f);
+					EXPECT_NEAR(wt[i][j], expWt, tolerance + 1e-6f);
+				}
+			}
+		}
+	}
+}
+
+//! The firing rates of a recurrent network with plastic synapses change little when the weights are stored in
+//! reduced precision.
+TEST(Core, weightPrecisionFiringRate) {
+	int nExc = 800, nInh = 200, nInput = 100;
+	float rate[WT_INT8 + 1];
+
+	for (int precision = WT_FP32; precision <= WT_INT8; precision++) {
+		CARLsim sim("Core.weightPrecisionFiringRate", CPU_MODE, SILENT, 0, 42);
+		int gExc = sim.createGroup("exc", nExc, EXCITATORY_NEURON);
+		sim.setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gInh = sim.createGroup("inh", nInh, INHIBITORY_NEURON);
+		sim.setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gInput = sim.createSpikeGeneratorGroup("input", nInput, EXCITATORY_NEURON);
+
+		WeightPrecision wtPrecision = (WeightPrecision)precision;
+		sim.connect(gInput, gExc, "random", RangeWeight(0.0f, 15.0f, 30.0f), 0.1f, RangeDelay(1, 20), RadiusRF(-1),
+			SYN_PLASTIC, 1.0f, 1.0f, wtPrecision);
+		sim.connect(gExc, gExc, "random", RangeWeight(0.0f, 3.0f, 6.0f), 0.1f, RangeDelay(1, 20), RadiusRF(-1),
+			SYN_PLASTIC, 1.0f, 1.0f, wtPrecision);
+		sim.connect(gExc, gInh, "random", RangeWeight(6.0f), 0.1f, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED,
+			1.0f, 1.0f, wtPrecision);
+		sim.connect(gInh, gExc, "random", RangeWeight(5.0f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED,
+			1.0f, 1.0f, wtPrecision);
+		sim.setESTDP(gExc, true, STANDARD, ExpCurve(0.1f, 20.0f, -0.12f, 20.0f));
+		sim.setConductances(false);
+		sim.setupNetwork();
+
+		PoissonRate in(nInput);
+		in.setRates(10.0f);
+		sim.setSpikeRate(gInput, &in);
+
+		SpikeMonitor* SM = sim.setSpikeMonitor(gExc, "NULL");
+		SM->startRecording();
+		sim.runNetwork(5, 0);
+		SM->stopRecording();
+
+		rate[precision] = SM->getPopMeanFiringRate();
+	}
+
+	EXPECT_GT(rate[WT_FP32], 0.0f);
+	EXPECT_NEAR(rate[WT_FP16], rate[WT_FP32], 0.03f * rate[WT_FP32]);
+	EXPECT_NEAR(rate[WT_BF16], rate[WT_FP32], 0.05f * rate[WT_FP32]);
+	EXPECT_NEAR(rate[WT_INT8], rate[WT_FP32], 0.05f * rate[WT_FP32]);
+}
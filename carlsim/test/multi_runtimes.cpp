@@ -50,6 +50,7 @@
 #include "gtest/gtest.h"
 #include "carlsim_tests.h"
 #include <carlsim.h>
+#include <periodic_spikegen.h>
 
 /*
 	class FixedRandomConnGen - Subclass of the connectionGenerator class to define custom connections between two groups
@@ -255,3 +256,250 @@ TEST(MultiRuntimes, shuffleGroups) {
 		}
 	}
 }
+
+TEST(MultiRuntimes, spikesSingleVsMultiThreaded) {
+	std::vector<std::vector<int> > spikesExc[2], spikesInh[2], spikesInput[2];
+	std::vector<std::vector<float> > wtInputExc[2];
+	int randSeed = 42;
+
+	// one partition, simulated by a single thread and by 3 threads, whose neuron ranges do not align with the groups
+	for (int run = 0; run < 2; run++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.spikesSingleVsMultiThreaded", CPU_MODE, SILENT, 0, randSeed);
+		sim->setNumThreadsPerPartition(run == 0 ? 1 : 3);
+
+		int gExc = sim->createGroup("exc", 800, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		int gInh = sim->createGroup("inh", 200, INHIBITORY_NEURON);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+		int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON);
+
+		// fixed delays per connection, the network must be identical in both runs
+		sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 10.0f, 30.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(gExc, gExc, "random", RangeWeight(1.0f), 0.1f, RangeDelay(5), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gInh, "random", RangeWeight(6.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc, "random", RangeWeight(5.0f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		sim->setConductances(false);
+		sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.001f, 20.0f, -0.0012f, 20.0f));
+
+		sim->setupNetwork();
+
+		SpikeMonitor* smExc = sim->setSpikeMonitor(gExc, "NULL");
+		SpikeMonitor* smInh = sim->setSpikeMonitor(gInh, "NULL");
+		SpikeMonitor* smInput = sim->setSpikeMonitor(gInput, "NULL");
+		ConnectionMonitor* cmInputExc = sim->setConnectionMonitor(gInput, gExc, "NULL");
+
+		PoissonRate in(100);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gInput, &in);
+
+		smExc->startRecording();
+		smInh->startRecording();
+		smInput->startRecording();
+
+		sim->runNetwork(1, 0, false);
+
+		smExc->stopRecording();
+		smInh->stopRecording();
+		smInput->stopRecording();
+
+		spikesExc[run] = smExc->getSpikeVector2D();
+		spikesInh[run] = smInh->getSpikeVector2D();
+		spikesInput[run] = smInput->getSpikeVector2D();
+		wtInputExc[run] = cmInputExc->takeSnapshot();
+
+		delete sim;
+	}
+
+	// the same spikes at the same time, and therefore the same weight changes
+	EXPECT_EQ(spikesExc[0], spikesExc[1]);
+	EXPECT_EQ(spikesInh[0], spikesInh[1]);
+	EXPECT_EQ(spikesInput[0], spikesInput[1]);
+	for (int i = 0; i < wtInputExc[0].size(); i++) {
+		for (int j = 0; j < wtInputExc[0][i].size(); j++) {
+			if (!isnan(wtInputExc[0][i][j]))
+				EXPECT_FLOAT_EQ(wtInputExc[0][i][j], wtInputExc[1][i][j]);
+		}
+	}
+}
+
+TEST(MultiRuntimes, spikeDeliverySingleVsMultiThreaded) {
+	std::vector<std::vector<int> > spikesExc[2], spikesInh[2];
+	int randSeed = 42;
+
+	// two partitions connected by synapses of different delays, the post-synaptic neurons of every pre-synaptic
+	// neuron are split among 1 or 4 threads, and some of them are external neurons of the other partition
+	for (int run = 0; run < 2; run++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.spikeDeliverySingleVsMultiThreaded", CPU_MODE, SILENT, 0, randSeed);
+		sim->setNumThreadsPerPartition(run == 0 ? 1 : 4);
+
+		int gExc = sim->createGroup("exc", 800, EXCITATORY_NEURON, 0, CPU_CORES);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		int gInh = sim->createGroup("inh", 200, INHIBITORY_NEURON, 1, CPU_CORES);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+		int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+
+		sim->connect(gInput, gExc, "random", RangeWeight(20.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gExc, "random", RangeWeight(0.5f), 0.1f, RangeDelay(3), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gExc, "random", RangeWeight(0.5f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gInh, "random", RangeWeight(6.0f), 0.1f, RangeDelay(2), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc, "random", RangeWeight(5.0f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		sim->setConductances(false);
+
+		sim->setupNetwork();
+
+		SpikeMonitor* smExc = sim->setSpikeMonitor(gExc, "NULL");
+		SpikeMonitor* smInh = sim->setSpikeMonitor(gInh, "NULL");
+
+		PoissonRate in(100);
+		in.setRates(30.0f);
+		sim->setSpikeRate(gInput, &in);
+
+		smExc->startRecording();
+		smInh->startRecording();
+
+		sim->runNetwork(1, 0, false);
+
+		smExc->stopRecording();
+		smInh->stopRecording();
+
+		spikesExc[run] = smExc->getSpikeVector2D();
+		spikesInh[run] = smInh->getSpikeVector2D();
+
+		delete sim;
+	}
+
+	EXPECT_EQ(spikesExc[0], spikesExc[1]);
+	EXPECT_EQ(spikesInh[0], spikesInh[1]);
+}
+
+TEST(MultiRuntimes, partitionAnyGroups) {
+	std::vector<std::vector<int> > spikesExc[2][2];
+	int randSeed = 42;
+
+	// two independent sub-networks of equal size, distributed among 2 CPU partitions either by the partitioner
+	// (run 0) or by hand (run 1)
+	for (int run = 0; run < 2; run++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.partitionAnyGroups", CPU_MODE, SILENT, 0, randSeed);
+		sim->setNumCPUPartitions(2);
+
+		int gExc[2], gInh[2], gInput[2];
+		PeriodicSpikeGenerator spkGen(20.0f, true);
+		for (int net = 0; net < 2; net++) {
+			int partition = (run == 0) ? ANY : net;
+
+			gExc[net] = sim->createGroup("exc", 800, EXCITATORY_NEURON, partition, CPU_CORES);
+			sim->setNeuronParameters(gExc[net], 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+			gInh[net] = sim->createGroup("inh", 200, INHIBITORY_NEURON, partition, CPU_CORES);
+			sim->setNeuronParameters(gInh[net], 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+			gInput[net] = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, partition, CPU_CORES);
+			sim->setSpikeGenerator(gInput[net], &spkGen); // deterministic input, independent of the partitions
+		}
+
+		for (int net = 0; net < 2; net++) {
+			sim->connect(gInput[net], gExc[net], "random", RangeWeight(20.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gExc[net], gInh[net], "random", RangeWeight(6.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gInh[net], gExc[net], "random", RangeWeight(5.0f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		}
+
+		sim->setConductances(false);
+
+		sim->setupNetwork();
+
+		// the sub-networks are balanced, and no spikes are routed between the partitions
+		for (int net = 0; net < 2; net++) {
+			EXPECT_EQ(sim->getGroupPartition(gInh[net]), sim->getGroupPartition(gExc[net]));
+			EXPECT_EQ(sim->getGroupPartition(gInput[net]), sim->getGroupPartition(gExc[net]));
+		}
+		EXPECT_NE(sim->getGroupPartition(gExc[0]), sim->getGroupPartition(gExc[1]));
+
+		SpikeMonitor* smExc[2];
+		for (int net = 0; net < 2; net++)
+			smExc[net] = sim->setSpikeMonitor(gExc[net], "NULL");
+
+		for (int net = 0; net < 2; net++)
+			smExc[net]->startRecording();
+
+		sim->runNetwork(1, 0, false);
+
+		for (int net = 0; net < 2; net++) {
+			smExc[net]->stopRecording();
+			spikesExc[run][net] = smExc[net]->getSpikeVector2D();
+		}
+
+		delete sim;
+	}
+
+	// the partitioner found the same partitions as the user
+	EXPECT_EQ(spikesExc[0][0], spikesExc[1][0]);
+	EXPECT_EQ(spikesExc[0][1], spikesExc[1][1]);
+}
+
+TEST(MultiRuntimes, randomNumbersIndependentOfPartitions) {
+	std::vector<std::vector<int> > spikesExc[3], spikesInput[3];
+	std::vector<uint8_t> delaysExcExc[3];
+	int randSeed = 42;
+
+	// the same network on a single partition and thread (run 0), with the input on another partition (run 1), and
+	// with the inhibitory group on another partition and 3 threads per partition (run 2). Poisson spikes, random
+	// connectivity, and random delays must not depend on the partitioning
+	for (int run = 0; run < 3; run++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.randomNumbersIndependentOfPartitions", CPU_MODE, SILENT, 0, randSeed);
+		sim->setNumThreadsPerPartition(run == 2 ? 3 : 1);
+
+		int gExc = sim->createGroup("exc", 800, EXCITATORY_NEURON, 0, CPU_CORES);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		int gInh = sim->createGroup("inh", 200, INHIBITORY_NEURON, run == 2 ? 1 : 0, CPU_CORES);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f); // FS
+
+		int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, run == 1 ? 1 : 0, CPU_CORES);
+
+		sim->connect(gInput, gExc, "random", RangeWeight(20.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gExc, "random", RangeWeight(0.5f), 0.1f, RangeDelay(1, 10), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gInh, "random", RangeWeight(6.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc, "random", RangeWeight(5.0f), 0.125f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		sim->setConductances(false);
+
+		sim->setupNetwork();
+
+		int numPreN, numPostN;
+		uint8_t* delays = sim->getDelays(gExc, gExc, numPreN, numPostN);
+		delaysExcExc[run].assign(delays, delays + numPreN * numPostN);
+		delete[] delays;
+
+		SpikeMonitor* smExc = sim->setSpikeMonitor(gExc, "NULL");
+		SpikeMonitor* smInput = sim->setSpikeMonitor(gInput, "NULL");
+
+		PoissonRate in(100);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gInput, &in);
+
+		smExc->startRecording();
+		smInput->startRecording();
+
+		sim->runNetwork(1, 0, false);
+
+		smExc->stopRecording();
+		smInput->stopRecording();
+
+		spikesExc[run] = smExc->getSpikeVector2D();
+		spikesInput[run] = smInput->getSpikeVector2D();
+
+		delete sim;
+	}
+
+	for (int run = 1; run < 3; run++) {
+		EXPECT_EQ(delaysExcExc[0], delaysExcExc[run]);
+		EXPECT_EQ(spikesInput[0], spikesInput[run]);
+		EXPECT_EQ(spikesExc[0], spikesExc[run]);
+	}
+}
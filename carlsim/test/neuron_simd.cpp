@@ -0,0 +1,201 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include "gtest/gtest.h"
+#include "carlsim_tests.h"
+
+#include <neuron_simd.h>
+
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+// not a multiple of any SIMD width, so that the scalar remainder of the kernels is tested as well
+#define SIMD_TEST_NUM_NEURONS 1013
+
+// returns a uniform random number in [lo, hi)
+static float randRange(float lo, float hi) {
+	return lo + (hi - lo) * (float)drand48();
+}
+
+// relative tolerance between a SIMD kernel and the scalar kernel
+static void expectNearRel(float simd, float scalar) {
+	EXPECT_NEAR(simd, scalar, 1e-5f * (1.0f + fabs(scalar)));
+}
+
+TEST(NeuronSimd, getSupportedLevel) {
+	SimdLevel level = NeuronSimd::getSupportedLevel();
+	EXPECT_GE(level, SIMD_NONE);
+	EXPECT_LE(level, SIMD_AVX512);
+	EXPECT_EQ(NeuronSimd::getWidth(SIMD_NONE), 1);
+	EXPECT_EQ(NeuronSimd::getWidth(SIMD_SSE42), 4);
+	EXPECT_EQ(NeuronSimd::getWidth(SIMD_AVX2), 8);
+	EXPECT_EQ(NeuronSimd::getWidth(SIMD_AVX512), 16);
+}
+
+// all SIMD levels supported by this machine must integrate Izhikevich neurons like the scalar kernel
+TEST(NeuronSimd, izhikevichVsScalar) {
+	int n = SIMD_TEST_NUM_NEURONS;
+	srand48(42);
+
+	IzhParams p;
+	p.a = 0.02f; p.b = 0.2f; p.c = -65.0f; p.d = 8.0f;
+	p.inverse_C = 1.0f / 100.0f; p.k = 0.7f; p.vr = -60.0f; p.vt = -40.0f; p.vpeak = 35.0f;
+
+	std::vector<float> volt(n), recov(n), current(n);
+	for (int i = 0; i < n; i++) {
+		volt[i] = randRange(-90.0f, 40.0f); // some neurons are about to spike
+		recov[i] = randRange(-20.0f, 20.0f);
+		current[i] = randRange(-10.0f, 300.0f);
+	}
+
+	for (int model9 = 0; model9 <= 1; model9++) {
+		for (int rk4 = 0; rk4 <= 1; rk4++) {
+			integrationMethod_t method = rk4 ? RUNGE_KUTTA4 : FORWARD_EULER;
+			float timeStep = rk4 ? 0.5f : 1.0f;
+
+			std::vector<float> nextVoltRef(n), recovRef(recov);
+			std::vector<char> spikeRef(n, 0);
+			NeuronSimd::updateIzhikevich(SIMD_NONE, model9 > 0, method, n, p, timeStep, &volt[0], &nextVoltRef[0],
+				&recovRef[0], &current[0], (bool*)&spikeRef[0]);
+
+			int numSpikes = 0;
+			for (int i = 0; i < n; i++)
+				numSpikes += spikeRef[i];
+			EXPECT_GT(numSpikes, 0);
+			EXPECT_LT(numSpikes, n);
+
+			for (int level = SIMD_SSE42; level <= NeuronSimd::getSupportedLevel(); level++) {
+				std::vector<float> nextVolt(n), recovSimd(recov);
+				std::vector<char> spike(n, 0);
+				NeuronSimd::updateIzhikevich((SimdLevel)level, model9 > 0, method, n, p, timeStep, &volt[0],
+					&nextVolt[0], &recovSimd[0], &current[0], (bool*)&spike[0]);
+
+				for (int i = 0; i < n; i++) {
+					expectNearRel(nextVolt[i], nextVoltRef[i]);
+					expectNearRel(recovSimd[i], recovRef[i]);
+					EXPECT_EQ(spike[i], spikeRef[i]);
+				}
+			}
+		}
+	}
+}
+
+// all SIMD levels supported by this machine must integrate LIF neurons like the scalar kernel
+TEST(NeuronSimd, lifVsScalar) {
+	int n = SIMD_TEST_NUM_NEURONS;
+	srand48(42);
+
+	LIFParams p;
+	p.tau_m = 10; p.tau_ref = 2; p.vTh = -50.0f; p.vReset = -65.0f; p.gain = 5.0f; p.bias = 0.0f;
+
+	std::vector<float> volt(n), nextVolt(n), current(n);
+	std::vector<int> refCount(n);
+	for (int i = 0; i < n; i++) {
+		volt[i] = randRange(-70.0f, -45.0f);
+		nextVolt[i] = randRange(-70.0f, -45.0f); // some neurons are above threshold
+		current[i] = randRange(-2.0f, 6.0f);
+		refCount[i] = (int)randRange(0.0f, 2.0f) * (int)randRange(0.0f, 4.0f); // about half of them are refractory
+	}
+
+	for (int lastIter = 0; lastIter <= 1; lastIter++) {
+		std::vector<float> nextVoltRef(nextVolt);
+		std::vector<int> refCountRef(refCount);
+		std::vector<char> spikeRef(n, 0);
+		NeuronSimd::updateLIF(SIMD_NONE, n, p, 0.5f, lastIter > 0, &volt[0], &nextVoltRef[0], &refCountRef[0],
+			&current[0], (bool*)&spikeRef[0]);
+
+		for (int level = SIMD_SSE42; level <= NeuronSimd::getSupportedLevel(); level++) {
+			std::vector<float> nextVoltSimd(nextVolt);
+			std::vector<int> refCountSimd(refCount);
+			std::vector<char> spike(n, 0);
+			NeuronSimd::updateLIF((SimdLevel)level, n, p, 0.5f, lastIter > 0, &volt[0], &nextVoltSimd[0],
+				&refCountSimd[0], &current[0], (bool*)&spike[0]);
+
+			for (int i = 0; i < n; i++) {
+				expectNearRel(nextVoltSimd[i], nextVoltRef[i]);
+				EXPECT_EQ(refCountSimd[i], refCountRef[i]);
+				EXPECT_EQ(spike[i], spikeRef[i]);
+			}
+		}
+	}
+}
+
+// all SIMD levels supported by this machine must compute COBA currents like the scalar kernel
+TEST(NeuronSimd, conductanceCurrentVsScalar) {
+	int n = SIMD_TEST_NUM_NEURONS;
+	srand48(42);
+
+	std::vector<float> volt(n), gAMPA(n), gNMDA(n), gNMDA_r(n), gGABAa(n), gGABAb(n), gGABAb_r(n);
+	for (int i = 0; i < n; i++) {
+		volt[i] = randRange(-90.0f, 30.0f);
+		gAMPA[i] = randRange(0.0f, 2.0f);
+		gNMDA[i] = randRange(0.0f, 2.0f);
+		gNMDA_r[i] = randRange(0.0f, 1.0f);
+		gGABAa[i] = randRange(0.0f, 2.0f);
+		gGABAb[i] = randRange(0.0f, 2.0f);
+		gGABAb_r[i] = randRange(0.0f, 1.0f);
+	}
+
+	for (int withRise = 0; withRise <= 1; withRise++) {
+		const float* rNMDA = withRise ? &gNMDA_r[0] : NULL;
+		const float* rGABAb = withRise ? &gGABAb_r[0] : NULL;
+
+		std::vector<float> I_ref(n);
+		NeuronSimd::conductanceCurrent(SIMD_NONE, n, &volt[0], &gAMPA[0], &gNMDA[0], rNMDA, &gGABAa[0], &gGABAb[0],
+			rGABAb, &I_ref[0]);
+
+		for (int level = SIMD_SSE42; level <= NeuronSimd::getSupportedLevel(); level++) {
+			std::vector<float> I_sum(n);
+			NeuronSimd::conductanceCurrent((SimdLevel)level, n, &volt[0], &gAMPA[0], &gNMDA[0], rNMDA, &gGABAa[0],
+				&gGABAb[0], rGABAb, &I_sum[0]);
+
+			for (int i = 0; i < n; i++)
+				expectNearRel(I_sum[i], I_ref[i]);
+		}
+	}
+}
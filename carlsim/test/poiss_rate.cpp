@@ -49,6 +49,10 @@
 #include "carlsim_tests.h"
 
 #include <carlsim.h>
+#include <checkpoint_writer.h>
+#include <snn_definitions.h>	// POISSON_NO_SPIKE
+
+#include <string.h>
 
 // trigger all UserErrors
 TEST(PoissRate, constructDeath) {
@@ -202,3 +206,96 @@ TEST(PoissRate, runSim) {
 	// \TODO test CARLsim integration
 	// \TODO use cuRAND
 }
+
+//! Poisson spikes on CPU are generated by drawing inter-spike intervals. Averaged over a large group, the mean
+//! firing rate has a small standard deviation, so it can be compared to the rate set by PoissonRate. A new rate has
+//! to take effect in the first step after setSpikeRate, also for intervals that exceed the timing wheel.
+TEST(PoissRate, runSimCPU) {
+	int nNeur = 1000;
+	CARLsim sim("PoissRate.runSimCPU", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim.createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+	int gOut = sim.createGroup("output", 1, EXCITATORY_NEURON);
+	sim.setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim.connect(gIn, gOut, "full", RangeWeight(0.0f), 1.0f);
+	sim.setConductances(false);
+	sim.setupNetwork();
+
+	SpikeMonitor* spkMon = sim.setSpikeMonitor(gIn, "NULL");
+	PoissonRate rate(nNeur, false);
+
+	// 10 Hz for 10 s: 100k spikes, the std of the mean rate is 0.03 Hz
+	rate.setRates(10.0f);
+	sim.setSpikeRate(gIn, &rate);
+	spkMon->startRecording();
+	sim.runNetwork(10, 0);
+	spkMon->stopRecording();
+	EXPECT_NEAR(spkMon->getPopMeanFiringRate(), 10.0f, 0.3f);
+
+	// 1000 Hz: every neuron fires in every step, starting with the first step
+	rate.setRates(1000.0f);
+	sim.setSpikeRate(gIn, &rate);
+	spkMon->startRecording();
+	sim.runNetwork(0, 100);
+	spkMon->stopRecording();
+	EXPECT_EQ(spkMon->getPopNumSpikes(), nNeur * 100);
+
+	// 0 Hz: no more spikes, even though spikes were scheduled for the following steps
+	rate.setRates(0.0f);
+	sim.setSpikeRate(gIn, &rate);
+	spkMon->startRecording();
+	sim.runNetwork(1, 0);
+	spkMon->stopRecording();
+	EXPECT_EQ(spkMon->getPopNumSpikes(), 0);
+
+	// 0.5 Hz for 20 s: the mean interval of 2 s is longer than the timing wheel (10k spikes, std 0.005 Hz)
+	rate.setRates(0.5f);
+	sim.setSpikeRate(gIn, &rate);
+	spkMon->startRecording();
+	sim.runNetwork(20, 0);
+	spkMon->stopRecording();
+	EXPECT_NEAR(spkMon->getPopMeanFiringRate(), 0.5f, 0.03f);
+}
+
+//! A Poisson neuron with a rate of zero never fires, so it must not be scheduled on the timing wheel of the CPU
+//! runtime. Its next spike time, which is stored in a checkpoint, has to stay POISSON_NO_SPIKE.
+TEST(PoissRate, zeroRateNotScheduledCPU) {
+	int nNeur = 100;
+	std::string checkpointDir = createTempDir("PoissRate.zeroRateNotScheduledCPU");
+
+	CARLsim* sim = new CARLsim("PoissRate.zeroRateNotScheduledCPU", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", nNeur, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("output", 1, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gOut, "full", RangeWeight(0.0f), 1.0f);
+	sim->setConductances(false);
+	sim->setCheckpoint(1, checkpointDir);
+	sim->setupNetwork();
+
+	SpikeMonitor* spkMon = sim->setSpikeMonitor(gIn, "NULL");
+	PoissonRate rate(nNeur, false);
+	rate.setRates(0.0f);
+	sim->setSpikeRate(gIn, &rate);
+	spkMon->startRecording();
+	sim->runNetwork(1, 0);
+	spkMon->stopRecording();
+	EXPECT_EQ(spkMon->getPopNumSpikes(), 0);
+	delete sim;
+
+	CheckpointHeader header;
+	std::vector<CheckpointArrayInfo> arrays;
+	std::vector<char> data;
+	bool readOk = CheckpointWriter::read(checkpointDir, header, arrays, data);
+	removeTempDir(checkpointDir);
+	ASSERT_TRUE(readOk);
+
+	int numChecked = 0;
+	for (size_t i = 0; i < arrays.size(); i++) {
+		if (strcmp(arrays[i].name, "poissonNextSpikeTime") != 0)
+			continue;
+
+		const unsigned int* nextSpikeTime = (const unsigned int*)&data[arrays[i].offset];
+		for (size_t j = 0; j < arrays[i].size / sizeof(unsigned int); j++, numChecked++)
+			EXPECT_EQ(nextSpikeTime[j], POISSON_NO_SPIKE);
+	}
+	EXPECT_EQ(numChecked, nNeur);
+}
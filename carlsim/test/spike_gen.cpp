@@ -306,6 +306,97 @@ TEST(spikeGenFunc, SpikeGeneratorFromFileLoadFile) {
 	}
 }
 
+//! A compact spike file holds the same spikes as the AER spike file in less space, it does not depend on how the
+//! simulation was sliced, and SpikeGeneratorFromFile schedules the same spikes from it.
+TEST(spikeGenFunc, SpikeGeneratorFromFileCompact) {
+	const int GRP_SIZE = 500;
+	std::string fileNames[3] = {"results/spk_aer.dat", "results/spk_compact0.dat", "results/spk_compact1.dat"};
+	std::vector< std::vector<int> > spkVec[3];
+	int numSpikes = 0;
+
+	for (int run=0; run<3; run++) {
+		CARLsim* sim = new CARLsim("SpikeGeneratorFromFileCompact",CPU_MODE,SILENT,1,42);
+		int g0 = sim->createSpikeGeneratorGroup("g0",GRP_SIZE,EXCITATORY_NEURON);
+		int g1 = sim->createGroup("g1", 1, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g1, 0.02, 0.2, -65.0, 8.0);
+		sim->connect(g0,g1,"full",RangeWeight(0.01f), 1.0f);
+		SpikeGeneratorFromFile* sgf = NULL;
+		if (run==2) {
+			// replay the compact file
+			sgf = new SpikeGeneratorFromFile(fileNames[1]);
+			sim->setSpikeGenerator(g0, sgf);
+		}
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		PoissonRate poiss(GRP_SIZE);
+		poiss.setRates(20.0f);
+		if (run<2)
+			sim->setSpikeRate(g0, &poiss);
+
+		SpikeMonitor* SM = sim->setSpikeMonitor(g0, fileNames[run]);
+		if (run>0)
+			SM->setCompactFile();
+		SM->startRecording();
+		if (run<2) {
+			sim->runNetwork(3,0,false);
+		} else {
+			for (int i=0; i<600; i++)
+				sim->runNetwork(0,5,false);
+		}
+		SM->stopRecording();
+		spkVec[run] = SM->getSpikeVector2D();
+		if (run==0)
+			numSpikes = SM->getPopNumSpikes();
+
+		delete sim;
+		if (sgf != NULL)
+			delete sgf;
+	}
+
+	// same spikes in all runs
+	ASSERT_GT(numSpikes, 0);
+	for (int run=1; run<3; run++)
+		EXPECT_TRUE(spkVec[run] == spkVec[0]);
+
+	// the compact files are identical, and smaller than the AER file
+	std::vector<char> bytes[3];
+	for (int run=0; run<3; run++) {
+		FILE* fid = fopen(fileNames[run].c_str(), "rb");
+		ASSERT_TRUE(fid != NULL);
+		fseek(fid, 0, SEEK_END);
+		bytes[run].resize(ftell(fid));
+		fseek(fid, 0, SEEK_SET);
+		EXPECT_EQ(fread(&bytes[run][0], 1, bytes[run].size(), fid), bytes[run].size());
+		fclose(fid);
+	}
+	EXPECT_EQ(bytes[0].size(), 5*sizeof(int) + 2*sizeof(int)*numSpikes);
+	EXPECT_TRUE(bytes[1] == bytes[2]);
+	EXPECT_LT(bytes[1].size()*3, bytes[0].size());
+	EXPECT_FLOAT_EQ(*(float*)&bytes[1][sizeof(int)], 0.3f);
+
+	// the index covers the three seconds and points to the first block of every second
+	const int* trailer = (const int*)&bytes[1][bytes[1].size() - 4*sizeof(int)];
+	EXPECT_EQ(trailer[0], 0);
+	EXPECT_EQ(trailer[1], 3);
+	EXPECT_EQ(trailer[3], 206661990);
+	int lastSpikeTime = -1;
+	for (int i=0; i<GRP_SIZE; i++)
+		for (int j=0; j<spkVec[0][i].size(); j++)
+			lastSpikeTime = std::max(lastSpikeTime, spkVec[0][i][j]);
+	EXPECT_EQ(trailer[2], lastSpikeTime);
+	const char* index = &bytes[1][bytes[1].size() - 4*sizeof(int) - 3*12];
+	EXPECT_EQ(*(const int64_t*)index, 5*sizeof(int));
+	EXPECT_EQ(*(const int*)(index + 8), -1);
+	for (int sec=1; sec<3; sec++) {
+		int64_t offset = *(const int64_t*)(index + 12*sec);
+		int timeBefore = *(const int*)(index + 12*sec + 8);
+		EXPECT_GT(offset, *(const int64_t*)(index + 12*(sec-1)));
+		EXPECT_LT(timeBefore, 1000*sec);
+		EXPECT_GE(timeBefore, 1000*(sec-1));
+	}
+}
+
 TEST(spikeGenFunc, SpikeGeneratorFromFileDeath) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 	EXPECT_DEATH({SpikeGeneratorFromFile spkGen("");},"");
@@ -180,9 +180,14 @@ TEST(SpikeMon, interfaceDeath) {
 	// set up network and test all API calls that are not valid in certain modes
 	sim.setupNetwork();
 
-	// \TODO SpikeMonitor mode COUNT not yet implemented
-	EXPECT_DEATH(spkMon->setMode(COUNT),"");
-	// after mode is implemented, make sure you cannot call getSpikeVector2D in COUNT mode, etc.
+	// spike times are not available in COUNT mode
+	spkMon->setMode(COUNT);
+	EXPECT_DEATH(spkMon->getSpikeVector2D(),"");
+	spkMon->setMode(AER);
+	EXPECT_DEATH(spkMon->setPSTH(0,10),"");
+	EXPECT_DEATH(spkMon->setPSTH(10,0),"");
+	EXPECT_DEATH(spkMon->getNeuronMeanISI(-1),"");
+	EXPECT_DEATH(spkMon->getNeuronISICV(5),"");
 
 	// test all APIs that cannot be called when recording is on
 	spkMon->startRecording();
@@ -200,6 +205,11 @@ TEST(SpikeMon, interfaceDeath) {
 	EXPECT_DEATH(spkMon->getPercentNeuronsWithFiringRate(0,0),"");
 	EXPECT_DEATH(spkMon->getPercentSilentNeurons(),"");
 	EXPECT_DEATH(spkMon->getSpikeVector2D(),"");
+	EXPECT_DEATH(spkMon->getNeuronMeanISI(0),"");
+	EXPECT_DEATH(spkMon->getNeuronISICV(0),"");
+	EXPECT_DEATH(spkMon->getPSTH(),"");
+	EXPECT_DEATH(spkMon->setMode(COUNT),"");
+	EXPECT_DEATH(spkMon->setPSTH(10,10),"");
 	EXPECT_DEATH(spkMon->print(),"");
 	EXPECT_DEATH(spkMon->startRecording(),"");
 	EXPECT_DEATH(spkMon->setLogFile("meow.dat"),"");
@@ -682,3 +692,113 @@ TEST(SpikeMon, setLogFile) {
 		delete sim;
 	}
 }
+
+//! In COUNT mode, the SpikeMonitor computes the same firing rates, inter-spike interval statistics and PSTH as from
+//! the spike times of AER mode, over several recording periods.
+TEST(SpikeMon, countModeStatistics) {
+	const int GRP_SIZE = 200;
+	const int BIN_SIZE = 100, NUM_BINS = 15;
+	SpikeMonMode modes[2] = {AER, COUNT};
+	std::vector<float> rates[2], psth[2];
+	std::vector<float> meanISI[2], cvISI[2];
+	int numSpikes[2], numSilent[2];
+	std::vector<std::vector<int> > spkVector;
+	float periodicMeanISI, periodicCV;
+
+	for (int m=0; m<2; m++) {
+		CARLsim sim("SpikeMon.countModeStatistics",CPU_MODE,SILENT,1,42);
+		int g0 = sim.createSpikeGeneratorGroup("poisson", GRP_SIZE, EXCITATORY_NEURON);
+		int g1 = sim.createSpikeGeneratorGroup("periodic", 1, EXCITATORY_NEURON);
+		int g2 = sim.createGroup("out", 1, EXCITATORY_NEURON);
+		sim.setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim.connect(g0, g2, "full", RangeWeight(0.0f), 1.0f);
+		sim.connect(g1, g2, "full", RangeWeight(0.0f), 1.0f);
+		PeriodicSpikeGenerator spkGen(20.0f);
+		sim.setSpikeGenerator(g1, &spkGen);
+		sim.setConductances(true);
+		sim.setupNetwork();
+
+		// rates up to 20 Hz, some neurons stay silent
+		PoissonRate poiss(GRP_SIZE);
+		for (int i=0; i<GRP_SIZE; i++)
+			poiss.setRate(i, (i%4==0) ? 0.0f : i*0.1f);
+		sim.setSpikeRate(g0, &poiss);
+
+		SpikeMonitor* SM0 = sim.setSpikeMonitor(g0, "NULL");
+		SpikeMonitor* SM1 = sim.setSpikeMonitor(g1, "NULL");
+		SM0->setMode(modes[m]);
+		SM1->setMode(modes[m]);
+		SM0->setPSTH(BIN_SIZE, NUM_BINS);
+		SM0->setPersistentData(true);
+
+		// two recording periods with a gap, the PSTH covers the end of the first one
+		SM0->startRecording();
+		SM1->startRecording();
+		sim.runNetwork(1,250,false);
+		SM0->stopRecording();
+		sim.runNetwork(0,300,false);
+		SM0->startRecording();
+		sim.runNetwork(0,700,false);
+		SM0->stopRecording();
+		SM1->stopRecording();
+
+		rates[m] = SM0->getAllFiringRates();
+		psth[m] = SM0->getPSTH();
+		numSpikes[m] = SM0->getPopNumSpikes();
+		numSilent[m] = SM0->getNumSilentNeurons();
+		for (int i=0; i<GRP_SIZE; i++) {
+			meanISI[m].push_back(SM0->getNeuronMeanISI(i));
+			cvISI[m].push_back(SM0->getNeuronISICV(i));
+		}
+		if (modes[m]==AER) {
+			spkVector = SM0->getSpikeVector2D();
+		} else {
+			periodicMeanISI = SM1->getNeuronMeanISI(0);
+			periodicCV = SM1->getNeuronISICV(0);
+		}
+	}
+
+	ASSERT_GT(numSpikes[0], 0);
+	EXPECT_EQ(numSpikes[1], numSpikes[0]);
+	EXPECT_EQ(numSilent[1], numSilent[0]);
+	EXPECT_GE(numSilent[1], GRP_SIZE/4);
+	for (int i=0; i<GRP_SIZE; i++)
+		EXPECT_FLOAT_EQ(rates[1][i], rates[0][i]);
+
+	// inter-spike interval statistics from the spike times of AER mode
+	for (int i=0; i<GRP_SIZE; i++) {
+		int n = spkVector[i].size();
+		if (n<2) {
+			EXPECT_TRUE(isnan(meanISI[1][i]));
+			EXPECT_TRUE(isnan(cvISI[1][i]));
+			continue;
+		}
+		double sum = 0.0, sumSq = 0.0;
+		for (int j=1; j<n; j++) {
+			double isi = spkVector[i][j] - spkVector[i][j-1];
+			sum += isi;
+			sumSq += isi*isi;
+		}
+		double mean = sum/(n-1);
+		double std = sqrt(std::max(0.0, sumSq/(n-1) - mean*mean));
+		EXPECT_NEAR(meanISI[1][i], mean, 1e-3);
+		EXPECT_NEAR(cvISI[1][i], std/mean, 1e-3);
+		EXPECT_FLOAT_EQ(meanISI[0][i], meanISI[1][i]);
+	}
+	EXPECT_FLOAT_EQ(periodicMeanISI, 50.0f);
+	EXPECT_NEAR(periodicCV, 0.0f, 1e-6);
+
+	// the recording stopped at 2250 ms, so the PSTH holds the bins 800..2300, the gap 1250..1550 is empty
+	ASSERT_EQ(psth[1].size(), NUM_BINS);
+	std::vector<int> counts(NUM_BINS, 0);
+	for (int i=0; i<GRP_SIZE; i++)
+		for (size_t j=0; j<spkVector[i].size(); j++)
+			if (spkVector[i][j] >= 800)
+				counts[(spkVector[i][j]-800)/BIN_SIZE]++;
+	for (int b=0; b<NUM_BINS; b++) {
+		EXPECT_FLOAT_EQ(psth[1][b], counts[b]*1000.0f/(BIN_SIZE*GRP_SIZE));
+		EXPECT_FLOAT_EQ(psth[0][b], psth[1][b]);
+	}
+	EXPECT_GT(psth[1][0], 0.0f);
+	EXPECT_FLOAT_EQ(psth[1][5], 0.0f); // 1300..1400
+}
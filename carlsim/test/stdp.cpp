@@ -53,6 +53,8 @@
 #include <interactive_spikegen.h>
 #include <pre_post_group_spikegen.h>
 
+#include <cmath>
+
 
 
 /// **************************************************************************************************************** ///
@@ -1139,3 +1141,154 @@ TEST(STDP, ISTDPExpCurve_Adv) {
 		}
 	}
 }
+
+/*!
+ * \brief testing STDP traces against per-synapse spike times
+ * This function tests whether the weights of a network with random delays, spikes from another partition, and
+ * E-STDP and I-STDP curves are the same with and without STDP traces (see CARLsim::setSTDPTraces)
+ */
+TEST(STDP, tracesVsSynSpikeTime) {
+	std::vector<std::vector<float> > wtExc[2], wtInh[2];
+
+	for (int curve = 0; curve < 2; curve++) {
+		for (int traces = 0; traces < 2; traces++) {
+			CARLsim* sim = new CARLsim("STDP.tracesVsSynSpikeTime", CPU_MODE, SILENT, 0, 42);
+
+			// the plastic synapses of gExc receive spikes from the other partition
+			int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+			int gInh = sim->createGroup("inh", 25, INHIBITORY_NEURON, 0, CPU_CORES);
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+			int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 1, CPU_CORES);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+
+			sim->connect(gInput, gInh, "random", RangeWeight(20.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 8.0f, 20.0f), 0.2f, RangeDelay(1, 20), RadiusRF(-1),
+				SYN_PLASTIC);
+			sim->connect(gInh, gExc, "random", RangeWeight(0.0f, 5.0f, 10.0f), 0.2f, RangeDelay(1), RadiusRF(-1),
+				SYN_PLASTIC);
+
+			sim->setConductances(false);
+			if (curve == 0) {
+				sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.2f, 20.0f, -0.24f, 20.0f));
+				sim->setISTDP(gExc, true, STANDARD, ExpCurve(-0.1f, 20.0f, 0.12f, 20.0f));
+			} else {
+				sim->setESTDP(gExc, true, STANDARD, TimingBasedCurve(0.2f, 20.0f, -0.24f, 20.0f, 5.0f));
+				sim->setISTDP(gExc, true, STANDARD, PulseCurve(0.1f, -0.12f, 10.0f, 20.0f));
+			}
+			sim->setSTDPTraces(traces == 1);
+
+			sim->setupNetwork();
+
+			PoissonRate in(100);
+			in.setRates(20.0f);
+			sim->setSpikeRate(gInput, &in);
+
+			ConnectionMonitor* CMexc = sim->setConnectionMonitor(gInput, gExc, "NULL");
+			ConnectionMonitor* CMinh = sim->setConnectionMonitor(gInh, gExc, "NULL");
+			CMexc->setUpdateTimeIntervalSec(-1);
+			CMinh->setUpdateTimeIntervalSec(-1);
+
+			// weights are updated at the end of every second
+			sim->runNetwork(3, 0);
+
+			EXPECT_GT(CMexc->getTotalAbsWeightChange(), 0.0);
+			EXPECT_GT(CMinh->getTotalAbsWeightChange(), 0.0);
+			wtExc[traces] = CMexc->takeSnapshot();
+			wtInh[traces] = CMinh->takeSnapshot();
+
+			delete sim;
+		}
+
+		for (int i = 0; i < wtExc[0].size(); i++) {
+			for (int j = 0; j < wtExc[0][i].size(); j++) {
+				if (!std::isnan(wtExc[0][i][j]))
+					EXPECT_FLOAT_EQ(wtExc[0][i][j], wtExc[1][i][j]);
+			}
+		}
+		for (int i = 0; i < wtInh[0].size(); i++) {
+			for (int j = 0; j < wtInh[0][i].size(); j++) {
+				if (!std::isnan(wtInh[0][i][j]))
+					EXPECT_FLOAT_EQ(wtInh[0][i][j], wtInh[1][i][j]);
+			}
+		}
+	}
+}
+
+/*!
+ * \brief testing sparse weight updates against updates of all plastic synapses
+ *
+ * With sparse weight updates, a CPU partition only visits the neurons with STDP activity since the last weight
+ * update and applies the decay of the weight changes of all other neurons later on. Without decay, this must give the
+ * same weights as updating all plastic synapses. With decay, the missed updates are summed up in one step, which may
+ * only differ by rounding.
+ */
+TEST(STDP, sparseVsDenseWeightUpdate) {
+	std::vector<std::vector<float> > wtExc[2], wtInh[2];
+
+	for (int decay = 0; decay < 2; decay++) {
+		for (int sparse = 0; sparse < 2; sparse++) {
+			CARLsim* sim = new CARLsim("STDP.sparseVsDenseWeightUpdate", CPU_MODE, SILENT, 0, 42);
+			sim->setNumThreadsPerPartition(4);
+
+			int gInput = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+			int gInh = sim->createGroup("inh", 25, INHIBITORY_NEURON, 0, CPU_CORES);
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+			int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+
+			sim->connect(gInput, gInh, "random", RangeWeight(20.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->connect(gInput, gExc, "random", RangeWeight(0.0f, 8.0f, 20.0f), 0.2f, RangeDelay(1, 20), RadiusRF(-1),
+				SYN_PLASTIC);
+			sim->connect(gInh, gExc, "random", RangeWeight(0.0f, 5.0f, 10.0f), 0.2f, RangeDelay(1), RadiusRF(-1),
+				SYN_PLASTIC);
+
+			sim->setConductances(false);
+			sim->setESTDP(gExc, true, STANDARD, ExpCurve(0.2f, 20.0f, -0.24f, 20.0f));
+			sim->setISTDP(gExc, true, STANDARD, ExpCurve(-0.1f, 20.0f, 0.12f, 20.0f));
+			sim->setWeightAndWeightChangeUpdate(INTERVAL_10MS, decay == 1, 0.9f);
+			sim->setSparseWeightUpdate(sparse == 1);
+
+			sim->setupNetwork();
+
+			PoissonRate in(100);
+			in.setRates(5.0f);
+			sim->setSpikeRate(gInput, &in);
+
+			ConnectionMonitor* CMexc = sim->setConnectionMonitor(gInput, gExc, "NULL");
+			ConnectionMonitor* CMinh = sim->setConnectionMonitor(gInh, gExc, "NULL");
+			CMexc->setUpdateTimeIntervalSec(-1);
+			CMinh->setUpdateTimeIntervalSec(-1);
+
+			// stop off the 1-second grid, so that some neurons still have pending updates
+			sim->runNetwork(2, 505);
+
+			EXPECT_GT(CMexc->getTotalAbsWeightChange(), 0.0);
+			EXPECT_GT(CMinh->getTotalAbsWeightChange(), 0.0);
+			wtExc[sparse] = CMexc->takeSnapshot();
+			wtInh[sparse] = CMinh->takeSnapshot();
+
+			delete sim;
+		}
+
+		for (int i = 0; i < wtExc[0].size(); i++) {
+			for (int j = 0; j < wtExc[0][i].size(); j++) {
+				if (std::isnan(wtExc[0][i][j]))
+					continue;
+				if (decay == 0)
+					EXPECT_FLOAT_EQ(wtExc[0][i][j], wtExc[1][i][j]);
+				else
+					EXPECT_NEAR(wtExc[0][i][j], wtExc[1][i][j], 1e-4f);
+			}
+		}
+		for (int i = 0; i < wtInh[0].size(); i++) {
+			for (int j = 0; j < wtInh[0][i].size(); j++) {
+				if (std::isnan(wtInh[0][i][j]))
+					continue;
+				if (decay == 0)
+					EXPECT_FLOAT_EQ(wtInh[0][i][j], wtInh[1][i][j]);
+				else
+					EXPECT_NEAR(wtInh[0][i][j], wtInh[1][i][j], 1e-4f);
+			}
+		}
+	}
+}
@@ -32,6 +32,12 @@ classdef ConnectionReader < handle
         fileVersionMinor;      % required minimum minor version number
         fileSizeByteHeader;    % byte size of header section
         fileSizeByteSnapshot;  % byte size of a single snapshot
+        isSparse;              % whether snapshots store existing synapses only (version >= 0.4)
+        synIdx;                % linear index (pre x post) of every stored synapse
+        keyframeInterval;      % every n-th snapshot is a keyframe, 0: no deltas (version >= 0.5)
+        minAbsChange;          % minimum weight change stored in a delta
+        snapshotOffsets;       % byte offset of every snapshot (delta snapshots)
+        snapshotIsDelta;       % whether a snapshot is a delta (delta snapshots)
 
         weights;
         timeStamps;
@@ -163,6 +169,15 @@ classdef ConnectionReader < handle
             for i=1:numel(snapShots)
                 frame = snapShots(i);
 
+                if obj.keyframeInterval>0
+                    % snapshots have different sizes: reconstruct from the
+                    % last keyframe and the deltas that follow
+                    [timeStamp, wt] = obj.readDeltaSnapshot(frame);
+                    obj.timeStamps = [obj.timeStamps timeStamp];
+                    obj.weights(end+1,:) = wt;
+                    continue
+                end
+
                 % rewind file pointer, skip header
                 fseek(obj.fileId, obj.fileSizeByteHeader, 'bof');
                 
@@ -178,7 +193,14 @@ classdef ConnectionReader < handle
                 
                 % read data and append  to member
                 obj.timeStamps = [obj.timeStamps fread(obj.fileId, 1, 'int64')];
-                obj.weights(end+1,:) = fread(obj.fileId, obj.nNeurPre*obj.nNeurPost, 'float32');
+                if obj.isSparse
+                    % only existing synapses are stored, the others are NaN
+                    wt = nan(1, obj.nNeurPre*obj.nNeurPost);
+                    wt(obj.synIdx) = fread(obj.fileId, numel(obj.synIdx), 'float32');
+                    obj.weights(end+1,:) = wt;
+                else
+                    obj.weights(end+1,:) = fread(obj.fileId, obj.nNeurPre*obj.nNeurPost, 'float32');
+                end
             end
             timeStamps = obj.timeStamps;
             weights = obj.weights;
@@ -200,6 +222,12 @@ classdef ConnectionReader < handle
             obj.fileVersionMinor = 3;
             obj.fileSizeByteHeader = -1;   % to be set in openFile
             obj.fileSizeByteSnapshot = -1; % to be set in openFile
+            obj.isSparse = false;          % to be set in openFile
+            obj.synIdx = [];               % to be set in openFile
+            obj.keyframeInterval = 0;      % to be set in openFile
+            obj.minAbsChange = 0;          % to be set in openFile
+            obj.snapshotOffsets = [];      % to be set in openFile
+            obj.snapshotIsDelta = [];      % to be set in openFile
             
             obj.timeStamps = [];  % to be set in readWeights
             obj.weights = [];     % to be set in readWeights
@@ -323,13 +351,57 @@ classdef ConnectionReader < handle
                         num2str(obj.maxWt) ')'])
             end
             
+            % since version 0.4, the header lists the existing synapses in
+            % CSR format (start of the synapses of every pre-neuron, and
+            % post-neuron ID of every synapse), and snapshots only store
+            % the weights of these synapses
+            obj.isSparse = version >= 0.4-1e-4;
+            if obj.isSparse
+                nSynStored = fread(obj.fileId, 1, 'int32');
+                rowPtr = fread(obj.fileId, obj.nNeurPre+1, 'int32');
+                postIds = fread(obj.fileId, nSynStored, 'int32');
+                if feof(obj.fileId) || nSynStored<0 || rowPtr(end)~=nSynStored
+                    obj.throwError(['Could not find valid list of ' ...
+                        'synapses (' num2str(nSynStored) ')'])
+                    return
+                end
+                preIds = zeros(nSynStored, 1);
+                for i=1:obj.nNeurPre
+                    preIds(rowPtr(i)+1:rowPtr(i+1)) = i-1;
+                end
+                obj.synIdx = preIds*obj.nNeurPost + postIds + 1;
+            end
+
+            % since version 0.5, snapshots can be keyframes followed by
+            % deltas of the changed weights
+            if version >= 0.5-1e-4
+                obj.keyframeInterval = fread(obj.fileId, 1, 'int32');
+                obj.minAbsChange = fread(obj.fileId, 1, 'float32');
+                if feof(obj.fileId) || obj.keyframeInterval<1
+                    obj.throwError(['Could not find valid keyframe ' ...
+                        'interval (' num2str(obj.keyframeInterval) ')'])
+                    return
+                end
+            end
+            
             % store the size of the header section, so that we can skip it
             % when re-reading spikes
             obj.fileSizeByteHeader = ftell(obj.fileId);
             
             % find size of each snapshot: #weights * sizeof(float32) +
             % sizeof(long int)
-            obj.fileSizeByteSnapshot = obj.nNeurPre*obj.nNeurPost*4+8;
+            if obj.isSparse
+                obj.fileSizeByteSnapshot = numel(obj.synIdx)*4+8;
+            else
+                obj.fileSizeByteSnapshot = obj.nNeurPre*obj.nNeurPost*4+8;
+            end
+
+            % delta snapshots have different sizes: find the offset of
+            % every snapshot
+            if obj.keyframeInterval>0
+                obj.scanDeltaSnapshots();
+                return
+            end
 
             % compute number of snapshots present in the file
             % find byte size from here on until end of file, divide it by
@@ -340,6 +412,57 @@ classdef ConnectionReader < handle
                 / obj.fileSizeByteSnapshot );
         end
         
+        function scanDeltaSnapshots(obj)
+            % CR.scanDeltaSnapshots() finds the byte offset of every
+            % snapshot and whether it is a keyframe or a delta.
+            % Every snapshot starts with a timestamp (int64) and a delta
+            % flag (int32). A keyframe stores the weights of all synapses,
+            % a delta the number of changed synapses, their indices
+            % (int32), and their new weights (float32).
+            obj.snapshotOffsets = [];
+            obj.snapshotIsDelta = [];
+            fseek(obj.fileId, 0, 'eof');
+            szByteTot = ftell(obj.fileId);
+            offset = obj.fileSizeByteHeader;
+            while offset+12 <= szByteTot
+                fseek(obj.fileId, offset+8, 'bof');
+                isDelta = fread(obj.fileId, 1, 'int32');
+                if isDelta
+                    nChanged = fread(obj.fileId, 1, 'int32');
+                    szByte = 16 + nChanged*8;
+                else
+                    szByte = 12 + numel(obj.synIdx)*4;
+                end
+                if offset+szByte > szByteTot
+                    break % incomplete snapshot
+                end
+                obj.snapshotOffsets(end+1) = offset;
+                obj.snapshotIsDelta(end+1) = isDelta;
+                offset = offset + szByte;
+            end
+            obj.nSnapshots = numel(obj.snapshotOffsets);
+        end
+
+        function [timeStamp, weights] = readDeltaSnapshot(obj, frame)
+            % [timeStamp,weights] = CR.readDeltaSnapshot(frame) reads a
+            % snapshot from the last keyframe and the deltas up to frame.
+            keyframe = find(~obj.snapshotIsDelta(1:frame), 1, 'last');
+            for s=keyframe:frame
+                fseek(obj.fileId, obj.snapshotOffsets(s), 'bof');
+                timeStamp = fread(obj.fileId, 1, 'int64');
+                isDelta = fread(obj.fileId, 1, 'int32');
+                if isDelta
+                    nChanged = fread(obj.fileId, 1, 'int32');
+                    idx = fread(obj.fileId, nChanged, 'int32');
+                    wt(idx+1) = fread(obj.fileId, nChanged, 'float32');
+                else
+                    wt = fread(obj.fileId, numel(obj.synIdx), 'float32');
+                end
+            end
+            weights = nan(1, obj.nNeurPre*obj.nNeurPost);
+            weights(obj.synIdx) = wt;
+        end
+
         function throwError(obj, errorMsg, errorMode)
             % SR.throwError(errorMsg, errorMode) throws an error with a
             % specific severity (errorMode). In all cases, obj.errorFlag is
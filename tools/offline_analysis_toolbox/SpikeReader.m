@@ -14,6 +14,9 @@ classdef SpikeReader < handle
     % >> stimLengthMs = SR.getSimDurMs();
     % >> % etc.
     %
+    % Both the AER format (version 0.2) and the compact format (version
+    % 0.3, see SpikeMonitor::setCompactFile) of spike files are supported.
+    %
     % Version 5/21/2015
     % Author: Michael Beyeler <mbeyeler@uci.edu>
     
@@ -32,6 +35,8 @@ classdef SpikeReader < handle
         fileVersionMajor;    % required major version number
         fileVersionMinor;    % required minimum minor version number
         fileSizeByteHeader;  % byte size of header section
+        isCompact;           % whether the file is in the compact format
+        compactIndexSignature; % int signature of the index of a compact file
         
         grid3D;              % 3D grid dimensions of group
         binWindow;           % binning window for spike times (ms)
@@ -142,6 +147,16 @@ classdef SpikeReader < handle
             %
             % The total simulation duration is usually stored in a
             % "sim_{simName}.dat" file and can be retrieved by using a
+            if obj.isCompact
+                [~,lastTime] = obj.readCompactIndex();
+                if isnan(lastTime)
+                    % no index, decode the whole file
+                    d = obj.readCompactAER();
+                    lastTime = max([-1 d(1,:)]);
+                end
+                simDurMs = lastTime;
+                return
+            end
             fseek(obj.fileId, -8, 'eof'); % jump to penultimate int
             simDurMs = fread(obj.fileId, 1, 'int32');
         end
@@ -179,44 +194,16 @@ classdef SpikeReader < handle
             d=zeros(0,nrRead);
             spk=[];
             
-            while size(d,2)==nrRead
-                % D is a 2xNRREAD matrix.  Row 1 contains the times that
-                % the neuron spiked. Row 2 contains the neuron id that
-                % spiked at this corresponding time.
-                d = fread(obj.fileId, [2 nrRead], 'int32');
-
-                if ~isempty(d)
-                    if obj.binWindow<0
-                        % Return data in AER format, i.e.: [time;nID]
-                        % Note: Using SPARSE on large matrices that mostly
-                        % contain 0 is inefficient (-> "big sparse matrix")
-                        spk = [spk, d];
-                    else
-                        % Resulting matrix s will have rows corresponding
-                        % to time values with a minimum value of 1 and
-                        % columns organized by neuron ids that are indexed
-                        % starting with 1.  FRAMEDUR effectively bins the
-                        % data. FRAMEDUR=1 bins at 1 ms, FRAMEDUR=1000 bins
-                        % at 1000 ms, etc.
-
-                        % Use sparse matrix to create a matrix S with
-                        % correct dimensions. All firing events for each
-                        % neuron id and time bin are summed automatically
-                        % with ACCUMARRAY.  Finally the matrix is resized
-                        % to include all the zero entries with the correct
-                        % matrix dimensions. ACCUMARRAY is supposed to be
-                        % faster than full(sparse(...)). Make sure the
-                        % first two arguments are column vectors.
-                        subs = [floor(d(1,:)/obj.binWindow)'+1,d(2,:)'+1];
-
-                        % Make sure spk has the right dimensions (defined
-                        % by the max values in subs)
-                        maxDim = max(subs);
-                        if size(spk,1)<maxDim(1) || size(spk,2)<maxDim(2)
-                            spk(maxDim(1),maxDim(2))=0;
-                        end
-                        spk = spk + accumarray(subs, 1, size(spk));
-                    end
+            if obj.isCompact
+                % the compact format is decoded in one piece
+                spk = obj.addSpikes(spk, obj.readCompactAER());
+            else
+                while size(d,2)==nrRead
+                    % D is a 2xNRREAD matrix.  Row 1 contains the times
+                    % that the neuron spiked. Row 2 contains the neuron
+                    % id that spiked at this corresponding time.
+                    d = fread(obj.fileId, [2 nrRead], 'int32');
+                    spk = obj.addSpikes(spk, d);
                 end
             end
             
@@ -237,6 +224,111 @@ classdef SpikeReader < handle
     
     %% PRIVATE METHODS
     methods (Hidden, Access = private)
+        function spk = addSpikes(obj, spk, d)
+            % spk = SR.addSpikes(spk, d) adds the spikes of the AER
+            % matrix d ([times;nIDs]) to spk, binned by obj.binWindow
+            if isempty(d)
+                return
+            end
+            if obj.binWindow<0
+                % Return data in AER format, i.e.: [time;nID]
+                % Note: Using SPARSE on large matrices that mostly
+                % contain 0 is inefficient (-> "big sparse matrix")
+                spk = [spk, d];
+            else
+                % Resulting matrix s will have rows corresponding to time
+                % values with a minimum value of 1 and columns organized
+                % by neuron ids that are indexed starting with 1. FRAMEDUR
+                % effectively bins the data. FRAMEDUR=1 bins at 1 ms,
+                % FRAMEDUR=1000 bins at 1000 ms, etc.
+
+                % Use sparse matrix to create a matrix S with correct
+                % dimensions. All firing events for each neuron id and
+                % time bin are summed automatically with ACCUMARRAY.
+                % Finally the matrix is resized to include all the zero
+                % entries with the correct matrix dimensions. ACCUMARRAY
+                % is supposed to be faster than full(sparse(...)). Make
+                % sure the first two arguments are column vectors.
+                subs = [floor(d(1,:)/obj.binWindow)'+1,d(2,:)'+1];
+
+                % Make sure spk has the right dimensions (defined by the
+                % max values in subs)
+                maxDim = max(subs);
+                if size(spk,1)<maxDim(1) || size(spk,2)<maxDim(2)
+                    spk(maxDim(1),maxDim(2))=0;
+                end
+                spk = spk + accumarray(subs, 1, size(spk));
+            end
+        end
+        
+        function [bodyEnd,lastTime] = readCompactIndex(obj)
+            % [bodyEnd,lastTime] = SR.readCompactIndex() reads the end of
+            % the index section of a compact spike file. Returns the byte
+            % offset where the blocks end and the time of the last spike
+            % (-1 if there are no spikes). If the file has no index (e.g.,
+            % because the simulation crashed), the blocks end at the end
+            % of the file and lastTime is NaN.
+            fseek(obj.fileId, 0, 'eof');
+            fileSize = ftell(obj.fileId);
+            bodyEnd = fileSize;
+            lastTime = NaN;
+            if fileSize >= obj.fileSizeByteHeader+16
+                % <firstSec, numSec, lastTime, signature>, preceded by an
+                % <int64 offset, int32 time> entry for every second
+                fseek(obj.fileId, -16, 'eof');
+                trailer = fread(obj.fileId, [1 4], 'int32');
+                if trailer(4)==obj.compactIndexSignature && trailer(2)>=0 ...
+                        && obj.fileSizeByteHeader+16+12*trailer(2)<=fileSize
+                    bodyEnd = fileSize-16-12*trailer(2);
+                    lastTime = trailer(3);
+                end
+            end
+        end
+        
+        function d = readCompactAER(obj)
+            % d = SR.readCompactAER() decodes the blocks of a compact spike
+            % file into AER format [times;nIDs]. Every block holds the time
+            % difference to the previous block (the first one to -1), the
+            % number of spikes, and the sorted neuron IDs as differences
+            % to the previous ID, all as unsigned LEB128 varints.
+            bodyEnd = obj.readCompactIndex();
+            fseek(obj.fileId, obj.fileSizeByteHeader, 'bof');
+            bytes = fread(obj.fileId, bodyEnd-obj.fileSizeByteHeader, ...
+                'uint8=>double');
+
+            % decode all varints at once: the last byte of a varint is the
+            % one < 128, a varint cut off at the end of the file is ignored
+            isLast = bytes<128;
+            numBytes = find(isLast, 1, 'last');
+            if isempty(numBytes)
+                d = zeros(2,0);
+                return
+            end
+            bytes = bytes(1:numBytes);
+            isLast = isLast(1:numBytes);
+            varId = cumsum([1; isLast(1:end-1)]);
+            firstByte = find([true; isLast(1:end-1)]);
+            shift = (1:numBytes)' - firstByte(varId);
+            vals = accumarray(varId, mod(bytes,128).*128.^shift);
+
+            % walk through the blocks
+            times = zeros(1,numel(vals));
+            nIds = zeros(1,numel(vals));
+            n = 0;
+            pos = 1;
+            t = -1;
+            while pos+1 <= numel(vals)
+                t = t + vals(pos);
+                cnt = min(vals(pos+1), numel(vals)-pos-1);
+                pos = pos + 2;
+                nIds(n+1:n+cnt) = cumsum(vals(pos:pos+cnt-1));
+                times(n+1:n+cnt) = t;
+                n = n + cnt;
+                pos = pos + cnt;
+            end
+            d = [times(1:n); nIds(1:n)];
+        end
+        
         function isSupported = isErrorModeSupported(obj, errMode)
             % determines whether an error mode is currently supported
             isSupported = sum(ismember(obj.supportedErrorModes,errMode))>0;
@@ -249,6 +341,8 @@ classdef SpikeReader < handle
             obj.fileVersionMajor = 0;
             obj.fileVersionMinor = 2;
             obj.fileSizeByteHeader = -1; % to be set in openFile
+            obj.isCompact = false; % to be set in openFile
+            obj.compactIndexSignature = 206661990;
             
             obj.grid3D = -1; % to be set in openFile
             
@@ -313,6 +407,9 @@ classdef SpikeReader < handle
                 return
             end
             
+            % version 0.3 is the compact format
+            obj.isCompact = version > 0.25;
+            
             % read Grid3D
             obj.grid3D = fread(obj.fileId, [1 3], 'int32');
             if feof(obj.fileId) || prod(obj.grid3D)<=0
@@ -62,6 +62,7 @@ SpikeGeneratorFromFile::SpikeGeneratorFromFile(std::string fileName, int offsetT
 
 	nNeur_ = -1;
 	szByteHeader_ = -1;
+	isCompact_ = false;
 	offsetTimeMs_ = offsetTimeMs;
 
 	// move unsafe operations out of constructor
@@ -111,13 +112,19 @@ void SpikeGeneratorFromFile::openFile() {
 	// needs to be updated every time header changes
 	FILE* fp = fpBegin_;
 	szByteHeader_ = 4*sizeof(int)+1*sizeof(float);
-	fseek(fp, sizeof(int)+sizeof(float), SEEK_SET); // skipping signature+version
+	fseek(fp, sizeof(int), SEEK_SET); // skipping signature
+
+	// version 0.3 is the compact format
+	float version;
+	size_t result = fread(&version, sizeof(float), 1, fp);
+	UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+	isCompact_ = version > 0.25f;
 
 	// get number of neurons from header
 	nNeur_ = 1;
 	int grid;
 	for (int i=1; i<=3; i++) {
-		size_t result = fread(&grid, sizeof(int), 1, fp);
+		result = fread(&grid, sizeof(int), 1, fp);
 		UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
 		nNeur_ *= grid;
 	}
@@ -138,6 +145,12 @@ void SpikeGeneratorFromFile::init() {
 	}
 
 	// read spike file
+	if (isCompact_) {
+		readCompactSpikes();
+		rewind(offsetTimeMs_);
+		return;
+	}
+
 	FILE* fp = fpBegin_;
 	fseek(fp, szByteHeader_, SEEK_SET); // skip header section
 
@@ -169,6 +182,55 @@ void SpikeGeneratorFromFile::init() {
 	rewind(offsetTimeMs_);
 }
 
+// reads an unsigned LEB128 varint, returns false at the end of the data
+static bool readVarint(const std::vector<unsigned char>& data, size_t& pos, unsigned int& value) {
+	value = 0;
+	for (int shift=0; pos<data.size() && shift<32; shift+=7) {
+		unsigned char byte = data[pos++];
+		value |= (unsigned int)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+void SpikeGeneratorFromFile::readCompactSpikes() {
+	FILE* fp = fpBegin_;
+	fseek(fp, 0, SEEK_END);
+	long fileSize = ftell(fp);
+
+	// the blocks end where the index section starts (if the file has one, see SpikeMonitorCore::writeCompactIndex)
+	long bodyEnd = fileSize;
+	int trailer[4];
+	if (fileSize >= szByteHeader_ + (long)sizeof(trailer)) {
+		fseek(fp, fileSize - sizeof(trailer), SEEK_SET);
+		if (fread(trailer, sizeof(int), 4, fp) == 4 && trailer[3] == 206661990 && trailer[1] >= 0
+				&& szByteHeader_ + (long)sizeof(trailer) + trailer[1]*12L <= fileSize)
+			bodyEnd = fileSize - sizeof(trailer) - trailer[1]*12L;
+	}
+
+	std::vector<unsigned char> data(bodyEnd - szByteHeader_);
+	fseek(fp, szByteHeader_, SEEK_SET);
+	std::string funcName = "readFile("+fileName_+")";
+	UserErrors::assertTrue(data.empty() || fread(&data[0], 1, data.size(), fp) == data.size(),
+		UserErrors::FILE_CANNOT_READ, funcName, fileName_);
+
+	// every block holds the time difference to the previous block, the number of spikes, and the delta-encoded
+	// neuron IDs; a block cut off at the end of the file (e.g., if the simulation crashed) is ignored
+	size_t pos = 0;
+	int time = -1;
+	unsigned int deltaTime, numSpikes, deltaNeurId;
+	while (readVarint(data, pos, deltaTime) && readVarint(data, pos, numSpikes)) {
+		time += deltaTime;
+		int neurId = 0;
+		for (unsigned int i=0; i<numSpikes && readVarint(data, pos, deltaNeurId); i++) {
+			neurId += deltaNeurId;
+			if (neurId < nNeur_)
+				spikes_[neurId].push_back(time);
+		}
+	}
+}
+
 int SpikeGeneratorFromFile::nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice) {
 	assert(nNeur_>0);
 	assert(nid < nNeur_);
@@ -111,6 +111,9 @@ class CARLsim;
  * sim.runNetwork(1,0);
  * \endcode
  *
+ * Both the AER format (version 0.2) and the compact format (version 0.3, see SpikeMonitor::setCompactFile) of
+ * the spike file are supported.
+ *
  * \note Make sure the new neuron group has the exact same number of neurons as the group that was used to record
  * the spike file.
  * \attention Upon initializiation, all spikes from the spike file will be buffered as vectors of ints, which might
@@ -190,10 +193,12 @@ public:
 private:
 	void openFile();
 	void init();
+	void readCompactSpikes(); //!< reads the spikes of a compact spike file (version 0.3)
 
 	std::string fileName_;		//!< file name
 	FILE* fpBegin_;				//!< pointer to beginning of file
 	int szByteHeader_;          //!< number of bytes in header section
+	bool isCompact_;            //!< whether the spike file is in the compact format
                                 //!< \FIXME: there should be a standardized SpikeReader++ utility
 
 	//! A 2D vector of spike times, first dim=neuron ID, second dim=spike times.